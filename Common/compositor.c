@@ -0,0 +1,481 @@
+/*********************************************************************************************************/
+/* File: compositor.c                                                                                    */
+/* Purpose: Back-buffered drawing with flushes of only the changed regions (see compositor.h).           */
+/*********************************************************************************************************/
+#include <string.h>
+#include "compositor.h"
+
+// A region of the frame, grown row by row and then queued. Corners are inclusive.
+typedef struct {
+    int16_t x0, y0, x1, y1;
+} compositor_rect_t;
+
+static uint16_t compositor_back[COMPOSITOR_HEIGHT][COMPOSITOR_WIDTH];    // The frame being drawn.
+static uint16_t compositor_front[COMPOSITOR_HEIGHT][COMPOSITOR_WIDTH];   // The frame last flushed.
+static int16_t compositor_dirtyMinX[COMPOSITOR_HEIGHT];
+static int16_t compositor_dirtyMaxX[COMPOSITOR_HEIGHT];
+static raster_surface_t compositor_surface;
+static raster_text_t compositor_text;
+static bool compositor_frontValid;   // False: the screen's content is unknown.
+static compositor_rect_t compositor_openRects[COMPOSITOR_MAX_OPEN_RECTS];
+static uint16_t compositor_openRectCount;
+static compositor_stats_t compositor_stats;  // Also counted by the worker thread: use COMPOSITOR_COUNT().
+
+#define COMPOSITOR_COUNT(counter, amount) __atomic_fetch_add(&compositor_stats.counter, (amount), __ATOMIC_RELAXED)
+
+// The frame being sent. The main loop fills the queue only while no frame is in flight; the sender
+// (compositor_task() or the worker thread) then owns the queue and the front buffer until it
+// clears compositor_inFlight.
+static compositor_rect_t compositor_queue[COMPOSITOR_MAX_QUEUED_RECTS];
+static uint16_t compositor_queueCount;
+static bool compositor_queueOverflowed;
+static uint16_t compositor_queueHead;     // Next rectangle to send.
+static int16_t compositor_queueRow;       // Next row of that rectangle.
+static bool compositor_inFlight;          // Accessed with __atomic builtins.
+static bool compositor_flushHeld;
+static bool compositor_async;
+static bool compositor_workerRunning;
+
+/*********************************************************************************************************/
+/* Function: compositor_init                                                                             */
+/* Purpose: Clears the back buffer and the counters; the first flush sends the whole frame. A frame      */
+/*          still being sent is finished first.                                                          */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void compositor_init()
+{
+    compositor_waitFrameComplete();
+    raster_init(&compositor_surface, &compositor_back[0][0], COMPOSITOR_WIDTH, COMPOSITOR_HEIGHT,
+                compositor_dirtyMinX, compositor_dirtyMaxX);
+    raster_fillRect(&compositor_surface, 0, 0, COMPOSITOR_WIDTH, COMPOSITOR_HEIGHT, DISPLAY_BLACK);
+    raster_initText(&compositor_text);
+    compositor_surface.writes = 0;
+    compositor_surface.changes = 0;
+    compositor_stats = (compositor_stats_t) {0, 0, 0, 0, 0, 0, 0, 0};
+    compositor_invalidate();
+}
+
+void compositor_invalidate()
+{
+    compositor_frontValid = false;
+}
+
+void compositor_fillScreen(uint16_t color)
+{
+    raster_fillRect(&compositor_surface, 0, 0, COMPOSITOR_WIDTH, COMPOSITOR_HEIGHT, color);
+}
+
+void compositor_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    raster_drawPixel(&compositor_surface, x, y, color);
+}
+
+void compositor_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    raster_drawLine(&compositor_surface, x0, y0, x1, y1, color);
+}
+
+void compositor_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    raster_fillRect(&compositor_surface, x, y, 1, h, color);
+}
+
+void compositor_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    raster_fillRect(&compositor_surface, x, y, w, 1, color);
+}
+
+void compositor_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    raster_drawRect(&compositor_surface, x, y, w, h, color);
+}
+
+void compositor_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    raster_fillRect(&compositor_surface, x, y, w, h, color);
+}
+
+void compositor_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    raster_drawCircle(&compositor_surface, x0, y0, r, color);
+}
+
+void compositor_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    raster_fillCircle(&compositor_surface, x0, y0, r, color);
+}
+
+void compositor_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+    raster_drawTriangle(&compositor_surface, x0, y0, x1, y1, x2, y2, color);
+}
+
+void compositor_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+    raster_fillTriangle(&compositor_surface, x0, y0, x1, y1, x2, y2, color);
+}
+
+void compositor_setCursor(int16_t x, int16_t y)
+{
+    compositor_text.cursorX = x;
+    compositor_text.cursorY = y;
+}
+
+void compositor_setTextColor(uint16_t color)
+{
+    compositor_text.color = color;
+    compositor_text.backgroundColor = color;
+}
+
+void compositor_setTextColor(uint16_t color, uint16_t backgroundColor)
+{
+    compositor_text.color = color;
+    compositor_text.backgroundColor = backgroundColor;
+}
+
+void compositor_setTextSize(uint8_t size)
+{
+    compositor_text.size = (size > 0) ? size : 1;
+}
+
+void compositor_setTextWrap(bool wrap)
+{
+    compositor_text.wrap = wrap;
+}
+
+void compositor_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t backgroundColor, uint8_t size)
+{
+    raster_drawChar(&compositor_surface, x, y, c, color, backgroundColor, size);
+}
+
+void compositor_print(const char* str)
+{
+    raster_print(&compositor_surface, &compositor_text, str);
+}
+
+/*********************************************************************************************************/
+/* Function: compositor_queueRect                                                                        */
+/* Purpose: Copies a rectangle of the back buffer into the front buffer and queues it for sending.       */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void compositor_queueRect(const compositor_rect_t* rect)
+{
+    if (compositor_queueCount == COMPOSITOR_MAX_QUEUED_RECTS)
+    {
+        compositor_queueOverflowed = true;
+        return;
+    }
+    uint16_t width = rect->x1 - rect->x0 + 1;
+    for (int16_t y = rect->y0; y <= rect->y1; y++)
+    {
+        memcpy(&compositor_front[y][rect->x0], &compositor_back[y][rect->x0], width * sizeof(uint16_t));
+    }
+    compositor_queue[compositor_queueCount++] = *rect;
+}
+
+/*********************************************************************************************************/
+/* Function: compositor_addRun                                                                           */
+/* Purpose: Adds a run of changed pixels on row y. It extends an open rectangle that ended on the row    */
+/*          above and spans it with little to spare; otherwise it opens a rectangle of its own, or is    */
+/*          queued at once when there is no room for one.                                                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void compositor_addRun(int16_t x0, int16_t x1, int16_t y)
+{
+    for (uint16_t i = 0; i < compositor_openRectCount; i++)
+    {
+        compositor_rect_t* rect = &compositor_openRects[i];
+        if (rect->y1 == y - 1 && rect->x0 <= x0 && x1 <= rect->x1 &&
+            (rect->x1 - rect->x0) - (x1 - x0) <= COMPOSITOR_MERGE_GAP_PIXELS)
+        {
+            rect->y1 = y;
+            return;
+        }
+    }
+    compositor_rect_t run = {x0, y, x1, y};
+    if (compositor_openRectCount < COMPOSITOR_MAX_OPEN_RECTS)
+    {
+        compositor_openRects[compositor_openRectCount++] = run;
+    }
+    else
+    {
+        compositor_queueRect(&run);
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: compositor_queueRectsEndingBefore                                                           */
+/* Purpose: Queues and closes the open rectangles that did not grow onto row y.                          */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void compositor_queueRectsEndingBefore(int16_t y)
+{
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < compositor_openRectCount; i++)
+    {
+        if (compositor_openRects[i].y1 < y)
+        {
+            compositor_queueRect(&compositor_openRects[i]);
+        }
+        else
+        {
+            compositor_openRects[kept++] = compositor_openRects[i];
+        }
+    }
+    compositor_openRectCount = kept;
+}
+
+/*********************************************************************************************************/
+/* Function: compositor_startFrame                                                                       */
+/* Purpose: Walks the dirty span of each row, splits it into runs of changed pixels (short unchanged     */
+/*          gaps are sent along rather than starting a new run) and queues the runs as rectangles. Call  */
+/*          only while no frame is in flight.                                                            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void compositor_startFrame()
+{
+    compositor_rect_t screen = {0, 0, COMPOSITOR_WIDTH - 1, COMPOSITOR_HEIGHT - 1};
+    compositor_queueCount = 0;
+    compositor_queueHead = 0;
+    compositor_queueOverflowed = false;
+    if (!compositor_frontValid)
+    {
+        compositor_queueRect(&screen);
+        compositor_frontValid = true;
+    }
+    else
+    {
+        compositor_openRectCount = 0;
+        for (int16_t y = 0; y < COMPOSITOR_HEIGHT; y++)
+        {
+            const uint16_t* back = compositor_back[y];
+            const uint16_t* front = compositor_front[y];
+            int16_t end = compositor_dirtyMaxX[y];
+            for (int16_t x = compositor_dirtyMinX[y]; x <= end; x++)
+            {
+                if (back[x] == front[x])
+                {
+                    continue;
+                }
+                int16_t runStart = x;
+                int16_t runEnd = x;
+                for (x++; x <= end && x - runEnd <= COMPOSITOR_MERGE_GAP_PIXELS; x++)
+                {
+                    runEnd = (back[x] != front[x]) ? x : runEnd;
+                }
+                compositor_addRun(runStart, runEnd, y);
+                x = runEnd;
+            }
+            compositor_queueRectsEndingBefore(y);
+        }
+        compositor_queueRectsEndingBefore(COMPOSITOR_HEIGHT);
+    }
+    if (compositor_queueOverflowed)
+    {
+        compositor_queueCount = 0;
+        compositor_queueRect(&screen);
+        COMPOSITOR_COUNT(wholeFrames, 1);
+    }
+    raster_clearDirty(&compositor_surface);
+    if (compositor_queueCount > 0)
+    {
+        COMPOSITOR_COUNT(frames, 1);
+        compositor_queueRow = compositor_queue[0].y0;
+        __atomic_store_n(&compositor_inFlight, true, __ATOMIC_RELEASE);
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: compositor_sendChunk                                                                        */
+/* Purpose: Sends up to COMPOSITOR_CHUNK_PIXELS of the frame in flight, as one windowed transfer per     */
+/*          rectangle (or part of one) it covers.                                                        */
+/* Returns: True while more of the frame is left to send.                                                */
+/*********************************************************************************************************/
+static bool compositor_sendChunk()
+{
+    uint32_t room = COMPOSITOR_CHUNK_PIXELS;
+    while (compositor_queueHead < compositor_queueCount)
+    {
+        const compositor_rect_t* rect = &compositor_queue[compositor_queueHead];
+        uint16_t width = rect->x1 - rect->x0 + 1;
+        int16_t rows = rect->y1 - compositor_queueRow + 1;
+        if ((uint32_t) width * rows > room)
+        {
+            rows = room / width;
+            if (rows == 0 && room < COMPOSITOR_CHUNK_PIXELS)
+            {
+                break;   // Not a whole row left in this chunk.
+            }
+            rows = (rows > 0) ? rows : 1;
+        }
+        int16_t y0 = compositor_queueRow;
+        display_setAddrWindow(rect->x0, y0, rect->x1, y0 + rows - 1);
+        for (int16_t y = y0; y < y0 + rows; y++)
+        {
+            display_pushColors(&compositor_front[y][rect->x0], width);
+        }
+        COMPOSITOR_COUNT(windows, 1);
+        COMPOSITOR_COUNT(pixelsSent, (uint32_t) width * rows);
+        room -= ((uint32_t) width * rows < room) ? (uint32_t) width * rows : room;
+        compositor_queueRow += rows;
+        if (compositor_queueRow > rect->y1 && ++compositor_queueHead < compositor_queueCount)
+        {
+            compositor_queueRow = compositor_queue[compositor_queueHead].y0;
+        }
+    }
+    COMPOSITOR_COUNT(chunks, 1);
+    if (compositor_queueHead < compositor_queueCount)
+    {
+        return true;
+    }
+    __atomic_store_n(&compositor_inFlight, false, __ATOMIC_RELEASE);
+    return false;
+}
+
+/*********************************************************************************************************/
+/* Function: compositor_flush                                                                            */
+/* Purpose: Queues what changed since the last flush and, unless in async mode, sends it. In async mode  */
+/*          a flush that comes while a frame is in flight is held for compositor_task().                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void compositor_flush()
+{
+    COMPOSITOR_COUNT(flushes, 1);
+    if (compositor_async)
+    {
+        if (__atomic_load_n(&compositor_inFlight, __ATOMIC_ACQUIRE))
+        {
+            compositor_flushHeld = true;
+            COMPOSITOR_COUNT(heldFlushes, 1);
+        }
+        else
+        {
+            compositor_startFrame();
+        }
+        return;
+    }
+    compositor_waitFrameComplete();
+    compositor_startFrame();
+    compositor_waitFrameComplete();
+}
+
+void compositor_setAsync(bool async)
+{
+    if (!async)
+    {
+        compositor_waitFrameComplete();
+    }
+    compositor_async = async;
+}
+
+/*********************************************************************************************************/
+/* Function: compositor_task                                                                             */
+/* Purpose: Queues a held flush once the frame before it is out, then sends one chunk unless the worker  */
+/*          thread is sending them.                                                                      */
+/* Returns: True while there is more to send (for the scheduler: run another slice if there is time).    */
+/*********************************************************************************************************/
+bool compositor_task(void* user)
+{
+    (void) user;
+    bool inFlight = __atomic_load_n(&compositor_inFlight, __ATOMIC_ACQUIRE);
+    if (compositor_flushHeld && !inFlight)
+    {
+        compositor_flushHeld = false;
+        compositor_startFrame();
+        inFlight = __atomic_load_n(&compositor_inFlight, __ATOMIC_ACQUIRE);
+    }
+    if (compositor_workerRunning)
+    {
+        return false;   // The worker sends; come back on a later pass for a held flush.
+    }
+    return (inFlight && compositor_sendChunk()) || compositor_flushHeld;
+}
+
+bool compositor_isFrameComplete()
+{
+    return !compositor_flushHeld && !__atomic_load_n(&compositor_inFlight, __ATOMIC_ACQUIRE);
+}
+
+void compositor_waitFrameComplete()
+{
+    while (!compositor_isFrameComplete())
+    {
+        compositor_task(NULL);
+    }
+}
+
+#if !(defined(__arm__) && !defined(__linux__))
+#include <pthread.h>
+#include <sched.h>
+
+static pthread_t compositor_worker;
+static bool compositor_workerStop;   // Accessed with __atomic builtins.
+
+/*********************************************************************************************************/
+/* Function: compositor_workerMain                                                                       */
+/* Purpose: Host worker thread: sends the chunks of each frame put in flight by the main thread.         */
+/* Returns: NULL.                                                                                        */
+/*********************************************************************************************************/
+static void* compositor_workerMain(void* arg)
+{
+    (void) arg;
+    while (!__atomic_load_n(&compositor_workerStop, __ATOMIC_ACQUIRE))
+    {
+        if (!__atomic_load_n(&compositor_inFlight, __ATOMIC_ACQUIRE) || !compositor_sendChunk())
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void compositor_startWorker()
+{
+    if (compositor_workerRunning)
+    {
+        return;
+    }
+    __atomic_store_n(&compositor_workerStop, false, __ATOMIC_RELEASE);
+    if (pthread_create(&compositor_worker, NULL, compositor_workerMain, NULL) != 0)
+    {
+        printf("compositor_startWorker: could not start the worker thread; chunks are sent by compositor_task().\n\r");
+        return;
+    }
+    compositor_workerRunning = true;
+}
+
+void compositor_stopWorker()
+{
+    if (!compositor_workerRunning)
+    {
+        return;
+    }
+    compositor_waitFrameComplete();
+    __atomic_store_n(&compositor_workerStop, true, __ATOMIC_RELEASE);
+    pthread_join(compositor_worker, NULL);
+    compositor_workerRunning = false;
+}
+#endif
+
+void compositor_getStats(compositor_stats_t* stats)
+{
+    stats->flushes = __atomic_load_n(&compositor_stats.flushes, __ATOMIC_RELAXED);
+    stats->frames = __atomic_load_n(&compositor_stats.frames, __ATOMIC_RELAXED);
+    stats->heldFlushes = __atomic_load_n(&compositor_stats.heldFlushes, __ATOMIC_RELAXED);
+    stats->wholeFrames = __atomic_load_n(&compositor_stats.wholeFrames, __ATOMIC_RELAXED);
+    stats->chunks = __atomic_load_n(&compositor_stats.chunks, __ATOMIC_RELAXED);
+    stats->windows = __atomic_load_n(&compositor_stats.windows, __ATOMIC_RELAXED);
+    stats->pixelsDrawn = compositor_surface.writes;
+    stats->pixelsSent = __atomic_load_n(&compositor_stats.pixelsSent, __ATOMIC_RELAXED);
+}
+
+void compositor_dump(FILE* out)
+{
+    compositor_stats_t stats;
+    compositor_getStats(&stats);
+    fprintf(out, "compositor: %lu flushes (%lu held), %lu frames (%lu sent whole), %lu chunks, %lu windows\n\r",
+            (unsigned long) stats.flushes, (unsigned long) stats.heldFlushes, (unsigned long) stats.frames,
+            (unsigned long) stats.wholeFrames, (unsigned long) stats.chunks, (unsigned long) stats.windows);
+    fprintf(out, "    %llu pixels drawn, %llu sent\n\r", (unsigned long long) stats.pixelsDrawn,
+            (unsigned long long) stats.pixelsSent);
+}
@@ -0,0 +1,106 @@
+#ifndef COMPOSITOR_H_
+#define COMPOSITOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "supportFiles/display.h"
+#include "raster.h"
+
+// Retained-mode layer between the UI modules and the TFT. The compositor_ drawing calls take the
+// same arguments as their display_ counterparts but only draw into a back buffer in memory.
+// compositor_flush() then compares the back buffer with what the screen shows and sends only the
+// pixels that ended up different, so a fill that a later fill covers, or text erased and redrawn
+// the same, costs nothing on the SPI bus. The changed pixels of each row are grouped into runs,
+// runs on consecutive rows with the same extent are merged into rectangles, and each rectangle is
+// sent as one windowed transfer.
+//
+// The compositor assumes it is the only thing drawing on the screen. After drawing with display_
+// calls directly, call compositor_invalidate() so the next flush resends everything.
+//
+// A flush first copies the changed rectangles from the back buffer into the front buffer and
+// queues them; the queue is then sent COMPOSITOR_CHUNK_PIXELS at a time. By default
+// compositor_flush() sends the whole queue before it returns. After compositor_setAsync(true) it
+// returns as soon as the frame is queued and the chunks are sent by compositor_task() (a scheduler
+// task that yields to the detector between chunks, so the detector never waits for more than one
+// chunk) or, on the host, by the worker thread of compositor_startWorker(). Drawing into the back
+// buffer may go on while a frame is being sent. A flush that comes while a frame is still being
+// sent is held, and the held flush is queued once that frame is out, so rapid updates coalesce
+// into the next frame. compositor_isFrameComplete() is the frame-complete flag.
+
+#define COMPOSITOR_WIDTH DISPLAY_WIDTH
+#define COMPOSITOR_HEIGHT DISPLAY_HEIGHT
+#define COMPOSITOR_MERGE_GAP_PIXELS 16   // Unchanged pixels resent rather than opening another window.
+#define COMPOSITOR_MAX_OPEN_RECTS 32     // Rectangles grown at once; more runs are queued row by row.
+#define COMPOSITOR_MAX_QUEUED_RECTS 512  // Rectangles in one frame; a frame with more is sent whole.
+#define COMPOSITOR_CHUNK_PIXELS 2048     // Pixels sent per chunk (a row wider than this goes alone).
+
+// Counters since compositor_init().
+typedef struct {
+    uint32_t flushes;         // Calls to compositor_flush().
+    uint32_t frames;          // Frames queued.
+    uint32_t heldFlushes;     // Flushes held because a frame was still being sent.
+    uint32_t wholeFrames;     // Frames sent whole because they had too many rectangles.
+    uint32_t chunks;          // Chunks sent.
+    uint32_t windows;         // Windowed transfers sent.
+    uint64_t pixelsDrawn;     // Pixels written into the back buffer.
+    uint64_t pixelsSent;      // Pixels sent to the screen.
+} compositor_stats_t;
+
+// Clears the back buffer to black and marks the screen unknown, so the first flush sends the
+// whole frame. Call after display_init().
+void compositor_init();
+
+// Marks the screen unknown: the next flush sends the whole frame.
+void compositor_invalidate();
+
+// Drawing calls, as in display.h.
+void compositor_fillScreen(uint16_t color);
+void compositor_drawPixel(int16_t x, int16_t y, uint16_t color);
+void compositor_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+void compositor_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+void compositor_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+void compositor_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void compositor_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void compositor_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void compositor_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void compositor_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+void compositor_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+void compositor_setCursor(int16_t x, int16_t y);
+void compositor_setTextColor(uint16_t color);
+void compositor_setTextColor(uint16_t color, uint16_t backgroundColor);
+void compositor_setTextSize(uint8_t size);
+void compositor_setTextWrap(bool wrap);
+void compositor_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t backgroundColor, uint8_t size);
+void compositor_print(const char* str);
+
+// Sends what changed since the last flush to the screen; in async mode, queues it and returns.
+void compositor_flush();
+
+// Switches async mode on or off. Switching it off waits for the frame being sent.
+void compositor_setAsync(bool async);
+
+// Starts a held flush once the frame before it is out and, unless the worker thread sends the
+// chunks, sends one chunk. Has the form of a scheduler task: returns true while there is more to send.
+bool compositor_task(void* user);
+
+// The frame-complete flag: true when everything flushed is on the screen.
+bool compositor_isFrameComplete();
+
+// Sends (or waits for the worker to send) everything flushed.
+void compositor_waitFrameComplete();
+
+#if !(defined(__arm__) && !defined(__linux__))
+// Host only: a worker thread sends the chunks, standing in for a DMA engine. Stopping waits for
+// the frame being sent. Counters read while the worker runs may be mid-update.
+void compositor_startWorker();
+void compositor_stopWorker();
+#endif
+
+// Copies the counters.
+void compositor_getStats(compositor_stats_t* stats);
+
+// Prints the counters. Use stdout to dump over the UART on the board.
+void compositor_dump(FILE* out);
+
+#endif /* COMPOSITOR_H_ */
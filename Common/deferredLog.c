@@ -0,0 +1,115 @@
+/*********************************************************************************************************/
+/* File: deferredLog.c                                                                                   */
+/* Purpose: Lock-free ring of binary log records, formatted when they are drained (see deferredLog.h).  */
+/*********************************************************************************************************/
+#include "deferredLog.h"
+
+#ifdef DEFERRED_LOG_ENABLED
+
+#include <stdarg.h>
+#include "xtime_l.h"
+
+#define DEFERRED_LOG_INDEX_MASK (DEFERRED_LOG_CAPACITY - 1)
+#define DEFERRED_LOG_MICROSECONDS_PER_SECOND 1000000ULL
+
+// One record: what DEFERRED_LOG() was given, and when.
+typedef struct {
+    XTime time;                             // XTime_GetTime() when the record was appended.
+    const char* format;                     // Its address is the record's format ID.
+    long args[DEFERRED_LOG_MAX_ARGS];
+    uint16_t sequence;                      // Low 16 bits of its index + 1 once published.
+} deferredLog_record_t;
+
+// The ring. reserveIndex counts slots claimed by writers, drainIndex slots printed; both only grow
+// (and wrap together). A slot is published once its sequence equals the low 16 bits of the index it
+// was claimed at plus one. That is never true of a slot left over from the previous lap, nor of the
+// zeroed ring, so the log works without an init call (the labs log before they init anything).
+static deferredLog_record_t deferredLog_ring[DEFERRED_LOG_CAPACITY];
+static uint32_t deferredLog_reserveIndex;
+static uint32_t deferredLog_drainIndex;
+static uint32_t deferredLog_dropped;
+
+/*********************************************************************************************************/
+/* Function: deferredLog_append                                                                          */
+/* Purpose: Claims a slot with a compare-and-swap, fills it in and publishes it. Drops the record if the */
+/*          ring is full.                                                                                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void deferredLog_append(uint8_t argCount, const char* format, ...)
+{
+    uint32_t index = __atomic_load_n(&deferredLog_reserveIndex, __ATOMIC_RELAXED);
+    do
+    {
+        // The slot is free once the previous lap's record in it has been drained.
+        if (index - __atomic_load_n(&deferredLog_drainIndex, __ATOMIC_ACQUIRE) >= DEFERRED_LOG_CAPACITY)
+        {
+            __atomic_fetch_add(&deferredLog_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&deferredLog_reserveIndex, &index, index + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    deferredLog_record_t* record = &deferredLog_ring[index & DEFERRED_LOG_INDEX_MASK];
+    XTime_GetTime(&record->time);
+    record->format = format;
+    va_list args;
+    va_start(args, format);
+    for (uint8_t i = 0; i < DEFERRED_LOG_MAX_ARGS; i++)
+    {
+        record->args[i] = (i < argCount) ? va_arg(args, long) : 0;
+    }
+    va_end(args);
+    // Publish: the fields above must be visible before the sequence number is.
+    __atomic_store_n(&record->sequence, (uint16_t) (index + 1), __ATOMIC_RELEASE);
+}
+
+/*********************************************************************************************************/
+/* Function: deferredLog_drain                                                                           */
+/* Purpose: Copies published records out of the ring, oldest first, frees their slots and prints them,  */
+/*          until it has printed maxRecords or reaches a slot that is empty or still being written.      */
+/* Returns: The number of records printed.                                                               */
+/*********************************************************************************************************/
+uint32_t deferredLog_drain(FILE* out, uint32_t maxRecords)
+{
+    uint32_t drained = 0;
+    while (maxRecords == DEFERRED_LOG_DRAIN_ALL || drained < maxRecords)
+    {
+        uint32_t index = deferredLog_drainIndex;
+        const deferredLog_record_t* slot = &deferredLog_ring[index & DEFERRED_LOG_INDEX_MASK];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != (uint16_t) (index + 1))
+        {
+            break;
+        }
+        deferredLog_record_t record = *slot;
+        // Hand the slot back to the writers before the (slow) printing.
+        __atomic_store_n(&deferredLog_drainIndex, index + 1, __ATOMIC_RELEASE);
+        uint64_t microseconds = (record.time % COUNTS_PER_SECOND) * DEFERRED_LOG_MICROSECONDS_PER_SECOND / COUNTS_PER_SECOND;
+        fprintf(out, "[%lu.%06lu] ", (unsigned long) (record.time / COUNTS_PER_SECOND), (unsigned long) microseconds);
+        fprintf(out, record.format, record.args[0], record.args[1], record.args[2], record.args[3]);
+        drained++;
+    }
+    return drained;
+}
+
+/*********************************************************************************************************/
+/* Function: deferredLog_task                                                                            */
+/* Purpose: Prints a batch of records to stdout.                                                         */
+/* Returns: true while there are records left to print.                                                  */
+/*********************************************************************************************************/
+bool deferredLog_task(void* user)
+{
+    (void) user;
+    deferredLog_drain(stdout, DEFERRED_LOG_DRAIN_BATCH);
+    return __atomic_load_n(&deferredLog_reserveIndex, __ATOMIC_RELAXED) != deferredLog_drainIndex;
+}
+
+/*********************************************************************************************************/
+/* Function: deferredLog_droppedCount                                                                    */
+/* Purpose: Reports how many records found the ring full.                                                */
+/* Returns: The drop count.                                                                              */
+/*********************************************************************************************************/
+uint32_t deferredLog_droppedCount()
+{
+    return __atomic_load_n(&deferredLog_dropped, __ATOMIC_RELAXED);
+}
+
+#endif /* DEFERRED_LOG_ENABLED */
@@ -0,0 +1,68 @@
+#ifndef DEFERREDLOG_H_
+#define DEFERREDLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Deferred logging for tick functions, timer callbacks and other code that must not wait on the
+// UART (a line at 115200 baud takes a millisecond or more). DEFERRED_LOG() does not format
+// anything: it appends a small binary record (a timestamp, the format string's address as its ID
+// and up to DEFERRED_LOG_MAX_ARGS arguments) to a ring and returns. The records are formatted and
+// printed later, in order, by deferredLog_drain() from the main loop (or deferredLog_task() from
+// the scheduler, or at the end of a host run). When the ring is full new records are dropped and
+// counted rather than blocking the writer.
+//
+// Appending is lock-free, as in eventJournal.c, so the ISR, the main loop and the second core may
+// log at the same time; only one caller may drain.
+//
+// The format must be a string literal (it is printed long after the call) and every argument is
+// stored as a long: cast each one to long and use %ld, %lu or %lx.
+//
+// Each module logs through its own macro (CLOCK_CONTROL_LOG(), TRANSMITTER_LOG(), ...), which is
+// empty unless both DEFERRED_LOG_ENABLED and the module's own toggle are defined, so logging is
+// compiled in one module at a time.
+//
+// Uncomment the line below (or build with -DDEFERRED_LOG_ENABLED) to build the log. When it is
+// commented out the functions below are empty inlines, so there is no run-time cost.
+//#define DEFERRED_LOG_ENABLED
+
+#define DEFERRED_LOG_CAPACITY 256       // Records in the ring; a power of two.
+#define DEFERRED_LOG_MAX_ARGS 4
+#define DEFERRED_LOG_DRAIN_BATCH 8      // Records printed per deferredLog_task() call.
+#define DEFERRED_LOG_DRAIN_ALL 0        // maxRecords for deferredLog_drain(): everything logged so far.
+
+// Counts the arguments after the format (up to DEFERRED_LOG_MAX_ARGS).
+#define DEFERRED_LOG_NTH_ARG(format, a0, a1, a2, a3, n, ...) n
+#define DEFERRED_LOG_ARG_COUNT(...) DEFERRED_LOG_NTH_ARG(__VA_ARGS__, 4, 3, 2, 1, 0, 0)
+
+// DEFERRED_LOG(format, args...): appends a record.
+#define DEFERRED_LOG(...) deferredLog_append(DEFERRED_LOG_ARG_COUNT(__VA_ARGS__), __VA_ARGS__)
+
+#ifdef DEFERRED_LOG_ENABLED
+
+// Appends a record of format and argCount long arguments. Use DEFERRED_LOG(), which counts them.
+void deferredLog_append(uint8_t argCount, const char* format, ...);
+
+// One caller only: prints up to maxRecords records (DEFERRED_LOG_DRAIN_ALL: all of them), oldest
+// first, each preceded by its time in seconds. Use stdout to print over the UART on the board.
+// Returns the number of records printed.
+uint32_t deferredLog_drain(FILE* out, uint32_t maxRecords);
+
+// Has the form of a scheduler task: prints DEFERRED_LOG_DRAIN_BATCH records to stdout and returns
+// true while there are more.
+bool deferredLog_task(void* user);
+
+// Returns the number of records dropped because the ring was full.
+uint32_t deferredLog_droppedCount();
+
+#else
+
+static inline void deferredLog_append(uint8_t, const char*, ...) {}
+static inline uint32_t deferredLog_drain(FILE*, uint32_t) { return 0; }
+static inline bool deferredLog_task(void*) { return false; }
+static inline uint32_t deferredLog_droppedCount() { return 0; }
+
+#endif /* DEFERRED_LOG_ENABLED */
+
+#endif /* DEFERREDLOG_H_ */
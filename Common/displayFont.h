@@ -0,0 +1,21 @@
+#ifndef DISPLAYFONT_H_
+#define DISPLAYFONT_H_
+
+#include <stdint.h>
+
+// The TFT driver's font (supportFiles/glcdfont.c) for code that draws text into memory: the
+// classic 5x7 display font, printable ASCII only, laid out like the driver's table so text
+// matches what the driver draws. Each character is 5 columns of 8 bits, least significant bit at
+// the top; it is drawn in a 6x8 cell (DISPLAY_CHAR_WIDTH x DISPLAY_CHAR_HEIGHT), the sixth
+// column being blank. Bit 7 is only used by descenders.
+
+#define DISPLAY_FONT_FIRST_CHAR ' '
+#define DISPLAY_FONT_LAST_CHAR '~'
+#define DISPLAY_FONT_COLUMNS 5   // Columns with glyph bits; the cell adds one blank column.
+#define DISPLAY_FONT_ROWS 8
+
+// Returns the bits of one column of a character (bit 0 = top row). Characters outside
+// DISPLAY_FONT_FIRST_CHAR..DISPLAY_FONT_LAST_CHAR and columns past the glyph are blank.
+uint8_t displayFont_getColumn(unsigned char c, uint8_t column);
+
+#endif /* DISPLAYFONT_H_ */
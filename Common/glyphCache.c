@@ -0,0 +1,148 @@
+/*********************************************************************************************************/
+/* File: glyphCache.c                                                                                    */
+/* Purpose: Characters rendered once into an atlas and drawn as one window transfer (see glyphCache.h).  */
+/*********************************************************************************************************/
+#include <string.h>
+#include "glyphCache.h"
+#include "supportFiles/display.h"
+#include "raster.h"
+
+#define GLYPH_CACHE_CELL_WIDTH 6     // DISPLAY_CHAR_WIDTH: the glyph and a blank column.
+#define GLYPH_CACHE_CELL_HEIGHT 8    // DISPLAY_CHAR_HEIGHT.
+#define GLYPH_CACHE_INDEX_MASK (GLYPH_CACHE_MAX_GLYPHS - 1)
+#define GLYPH_CACHE_MAX_FILL (GLYPH_CACHE_MAX_GLYPHS * 3 / 4)
+#define GLYPH_CACHE_HASH_MULTIPLIER 2654435761u   // Knuth's multiplicative hash.
+
+// One rendered glyph. A slot with no pixels (size 0) is empty.
+typedef struct {
+    uint16_t color;
+    uint16_t backgroundColor;
+    unsigned char c;
+    uint8_t size;
+    uint32_t offset;     // First pixel in the atlas.
+} glyphCache_entry_t;
+
+static uint16_t glyphCache_atlas[GLYPH_CACHE_ATLAS_PIXELS];
+static uint32_t glyphCache_atlasUsed;
+static glyphCache_entry_t glyphCache_index[GLYPH_CACHE_MAX_GLYPHS];
+static uint16_t glyphCache_glyphCount;
+static glyphCache_stats_t glyphCache_stats;
+
+/*********************************************************************************************************/
+/* Function: glyphCache_empty                                                                            */
+/* Purpose: Forgets every rendered glyph.                                                                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void glyphCache_empty()
+{
+    for (uint16_t i = 0; i < GLYPH_CACHE_MAX_GLYPHS; i++)
+    {
+        glyphCache_index[i].size = 0;
+    }
+    glyphCache_atlasUsed = 0;
+    glyphCache_glyphCount = 0;
+}
+
+void glyphCache_init()
+{
+    glyphCache_empty();
+    memset(&glyphCache_stats, 0, sizeof glyphCache_stats);
+}
+
+/*********************************************************************************************************/
+/* Function: glyphCache_find                                                                             */
+/* Purpose: Looks a glyph up, rendering it into the atlas if it is not there (emptying a full atlas      */
+/*          first).                                                                                      */
+/* Returns: The glyph's first pixel in the atlas.                                                        */
+/*********************************************************************************************************/
+static const uint16_t* glyphCache_find(unsigned char c, uint16_t color, uint16_t backgroundColor, uint8_t size)
+{
+    uint32_t key = ((uint32_t) color << 16 | backgroundColor) ^ ((uint32_t) c << 8 | size);
+    uint32_t pixels = (uint32_t) GLYPH_CACHE_CELL_WIDTH * GLYPH_CACHE_CELL_HEIGHT * size * size;
+    uint16_t slot = (key * GLYPH_CACHE_HASH_MULTIPLIER) >> 16 & GLYPH_CACHE_INDEX_MASK;
+    for (; glyphCache_index[slot].size != 0; slot = (slot + 1) & GLYPH_CACHE_INDEX_MASK)
+    {
+        glyphCache_entry_t* entry = &glyphCache_index[slot];
+        if (entry->c == c && entry->size == size && entry->color == color &&
+            entry->backgroundColor == backgroundColor)
+        {
+            glyphCache_stats.hits++;
+            return &glyphCache_atlas[entry->offset];
+        }
+    }
+    if (glyphCache_glyphCount == GLYPH_CACHE_MAX_FILL || glyphCache_atlasUsed + pixels > GLYPH_CACHE_ATLAS_PIXELS)
+    {
+        glyphCache_empty();
+        glyphCache_stats.resets++;
+        slot = (key * GLYPH_CACHE_HASH_MULTIPLIER) >> 16 & GLYPH_CACHE_INDEX_MASK;
+    }
+    glyphCache_stats.misses++;
+    glyphCache_entry_t* entry = &glyphCache_index[slot];
+    *entry = (glyphCache_entry_t) {color, backgroundColor, c, size, glyphCache_atlasUsed};
+    glyphCache_atlasUsed += pixels;
+    glyphCache_glyphCount++;
+
+    // Render the cell: background first, since the driver only fills the blank pixels of a
+    // character when its background differs from its color.
+    raster_surface_t cell;
+    raster_init(&cell, &glyphCache_atlas[entry->offset], GLYPH_CACHE_CELL_WIDTH * size,
+                GLYPH_CACHE_CELL_HEIGHT * size, NULL, NULL);
+    raster_fillRect(&cell, 0, 0, cell.width, cell.height, backgroundColor);
+    raster_drawChar(&cell, 0, 0, c, color, backgroundColor, size);
+    return &glyphCache_atlas[entry->offset];
+}
+
+/*********************************************************************************************************/
+/* Function: glyphCache_drawChar                                                                         */
+/* Purpose: Sends the cell from the atlas as one window transfer. A cell that would not fit on the       */
+/*          screen, or text larger than GLYPH_CACHE_MAX_SIZE, is drawn by the driver.                    */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void glyphCache_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t backgroundColor,
+                         uint8_t size)
+{
+    int16_t width = GLYPH_CACHE_CELL_WIDTH * size;
+    int16_t height = GLYPH_CACHE_CELL_HEIGHT * size;
+    if (size == 0 || size > GLYPH_CACHE_MAX_SIZE || x < 0 || y < 0 || x + width > DISPLAY_WIDTH ||
+        y + height > DISPLAY_HEIGHT)
+    {
+        glyphCache_stats.fallbacks++;
+        display_drawChar(x, y, c, color, backgroundColor, size);
+        return;
+    }
+    const uint16_t* pixels = glyphCache_find(c, color, backgroundColor, size);
+    display_setAddrWindow(x, y, x + width - 1, y + height - 1);
+    display_pushColors(pixels, (uint32_t) width * height);
+}
+
+/*********************************************************************************************************/
+/* Function: glyphCache_print                                                                            */
+/* Purpose: Draws a string cell by cell. Spaces are skipped: transparent text draws nothing for them,    */
+/*          and the labs use them to leave whatever is beside the text alone.                            */
+/* Returns: The x coordinate just past the last cell.                                                    */
+/*********************************************************************************************************/
+int16_t glyphCache_print(int16_t x, int16_t y, const char* str, uint16_t color, uint16_t backgroundColor,
+                         uint8_t size)
+{
+    for (; *str != '\0'; str++, x += GLYPH_CACHE_CELL_WIDTH * size)
+    {
+        if (*str != ' ')
+        {
+            glyphCache_drawChar(x, y, *str, color, backgroundColor, size);
+        }
+    }
+    return x;
+}
+
+void glyphCache_getStats(glyphCache_stats_t* stats)
+{
+    *stats = glyphCache_stats;
+}
+
+void glyphCache_dump(FILE* out)
+{
+    fprintf(out, "glyph cache: %lu hits, %lu rendered, %lu resets, %lu drawn by the driver; %lu glyphs, %lu pixels\n\r",
+            (unsigned long) glyphCache_stats.hits, (unsigned long) glyphCache_stats.misses,
+            (unsigned long) glyphCache_stats.resets, (unsigned long) glyphCache_stats.fallbacks,
+            (unsigned long) glyphCache_glyphCount, (unsigned long) glyphCache_atlasUsed);
+}
@@ -0,0 +1,57 @@
+#ifndef GLYPHCACHE_H_
+#define GLYPHCACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Pre-rendered text. The driver draws a character one font pixel at a time, each pixel (a
+// size x size square) its own address-window transfer: up to 48 transfers per character. The
+// glyph cache renders a character once per text size and color pair, with the driver's own font
+// and algorithm (Common/raster.c), into an atlas in memory, and from then on draws it as one
+// window transfer of its whole 6x8 cell.
+//
+// Glyphs are rendered on first use. When the atlas or its index is full, it is emptied and
+// filled again from the glyphs used after that.
+//
+// Cached text is opaque: the blank pixels of each cell get the background color. It looks the
+// same as the driver's transparent text wherever text goes on a plain background of that color,
+// which is how the labs draw their labels, digits and scores (and how they erase them: by
+// drawing the old text again in the background color).
+
+// Uncomment to draw the histogram top labels and the WAM scores from the glyph cache. The clock
+// always draws its digits from it.
+//#define GLYPH_CACHE_ENABLED
+
+#define GLYPH_CACHE_ATLAS_PIXELS 65536   // 128 KB: 37 clock digits, or 1365 size-1 characters.
+#define GLYPH_CACHE_MAX_GLYPHS 512       // Index slots (a power of two); filled to three quarters.
+#define GLYPH_CACHE_MAX_SIZE 8           // Larger text is drawn by the driver.
+
+// Counters since glyphCache_init().
+typedef struct {
+    uint32_t hits;          // Characters drawn from the atlas.
+    uint32_t misses;        // Characters rendered into the atlas.
+    uint32_t resets;        // Times the atlas was emptied because it was full.
+    uint32_t fallbacks;     // Characters drawn by the driver (off the edge of the screen, or too large).
+} glyphCache_stats_t;
+
+// Empties the atlas and clears the counters.
+void glyphCache_init();
+
+// Draws one character cell with its top-left corner at (x, y).
+void glyphCache_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t backgroundColor,
+                         uint8_t size);
+
+// Draws a string from (x, y) along one line ('\n' and wrapping are not handled). Spaces are left
+// as they are on the screen, as with transparent text.
+// Returns the x coordinate just past the last cell.
+int16_t glyphCache_print(int16_t x, int16_t y, const char* str, uint16_t color, uint16_t backgroundColor,
+                         uint8_t size);
+
+// Copies the counters.
+void glyphCache_getStats(glyphCache_stats_t* stats);
+
+// Prints the counters. Use stdout to dump over the UART on the board.
+void glyphCache_dump(FILE* out);
+
+#endif /* GLYPHCACHE_H_ */
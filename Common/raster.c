@@ -0,0 +1,353 @@
+/*********************************************************************************************************/
+/* File: raster.c                                                                                        */
+/* Purpose: The TFT driver's drawing primitives, drawn into memory (see raster.h).                       */
+/*********************************************************************************************************/
+#include <stdlib.h>
+#include "raster.h"
+#include "displayFont.h"
+
+#define RASTER_CHAR_WIDTH 6    // DISPLAY_CHAR_WIDTH: the glyph and a blank column.
+#define RASTER_CHAR_HEIGHT 8   // DISPLAY_CHAR_HEIGHT.
+#define RASTER_WHITE 0xFFFF
+
+/*********************************************************************************************************/
+/* Function: raster_writeSpan                                                                            */
+/* Purpose: Writes pixels x0..x1 of one row, clipped, counting the writes and changes and widening the   */
+/*          row's dirty span to the pixels that changed.                                                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void raster_writeSpan(raster_surface_t* surface, int16_t x0, int16_t x1, int16_t y, uint16_t color)
+{
+    if (y < 0 || y >= surface->height)
+    {
+        return;
+    }
+    x0 = (x0 < 0) ? 0 : x0;
+    x1 = (x1 >= surface->width) ? surface->width - 1 : x1;
+    if (x0 > x1)
+    {
+        return;
+    }
+    uint16_t* row = &surface->pixels[(int32_t) y * surface->width];
+    int16_t firstChange = RASTER_CLEAN_ROW_MIN_X;
+    int16_t lastChange = RASTER_CLEAN_ROW_MAX_X;
+    for (int16_t x = x0; x <= x1; x++)
+    {
+        if (row[x] != color)
+        {
+            row[x] = color;
+            firstChange = (x < firstChange) ? x : firstChange;
+            lastChange = x;
+            surface->changes++;
+        }
+    }
+    surface->writes += x1 - x0 + 1;
+    if (surface->dirtyMinX != NULL && lastChange != RASTER_CLEAN_ROW_MAX_X)
+    {
+        surface->dirtyMinX[y] = (firstChange < surface->dirtyMinX[y]) ? firstChange : surface->dirtyMinX[y];
+        surface->dirtyMaxX[y] = (lastChange > surface->dirtyMaxX[y]) ? lastChange : surface->dirtyMaxX[y];
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: raster_init                                                                                 */
+/* Purpose: Sets up a surface over the given pixels, all rows clean and the counters cleared.            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void raster_init(raster_surface_t* surface, uint16_t* pixels, int16_t width, int16_t height,
+                 int16_t* dirtyMinX, int16_t* dirtyMaxX)
+{
+    surface->pixels = pixels;
+    surface->width = width;
+    surface->height = height;
+    surface->dirtyMinX = dirtyMinX;
+    surface->dirtyMaxX = dirtyMaxX;
+    surface->writes = 0;
+    surface->changes = 0;
+    surface->transfers = 0;
+    raster_clearDirty(surface);
+}
+
+/*********************************************************************************************************/
+/* Function: raster_clearDirty                                                                           */
+/* Purpose: Marks every row of a tracking surface clean.                                                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void raster_clearDirty(raster_surface_t* surface)
+{
+    if (surface->dirtyMinX == NULL)
+    {
+        return;
+    }
+    for (int16_t y = 0; y < surface->height; y++)
+    {
+        surface->dirtyMinX[y] = RASTER_CLEAN_ROW_MIN_X;
+        surface->dirtyMaxX[y] = RASTER_CLEAN_ROW_MAX_X;
+    }
+}
+
+void raster_initText(raster_text_t* text)
+{
+    *text = (raster_text_t) {0, 0, RASTER_WHITE, RASTER_WHITE, 1, true};
+}
+
+void raster_drawPixel(raster_surface_t* surface, int16_t x, int16_t y, uint16_t color)
+{
+    if (x >= 0 && x < surface->width && y >= 0 && y < surface->height)
+    {
+        surface->transfers++;
+    }
+    raster_writeSpan(surface, x, x, y, color);
+}
+
+void raster_fillRect(raster_surface_t* surface, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    int16_t y1 = (y + h > surface->height) ? surface->height : y + h;
+    if (x < surface->width && x + w > 0 && y < surface->height && y + h > 0 && w > 0 && h > 0)
+    {
+        surface->transfers++;
+    }
+    for (int16_t row = (y < 0) ? 0 : y; row < y1; row++)
+    {
+        raster_writeSpan(surface, x, x + w - 1, row, color);
+    }
+}
+
+void raster_drawRect(raster_surface_t* surface, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    raster_fillRect(surface, x, y, w, 1, color);
+    raster_fillRect(surface, x, y + h - 1, w, 1, color);
+    raster_fillRect(surface, x, y, 1, h, color);
+    raster_fillRect(surface, x + w - 1, y, 1, h, color);
+}
+
+/*********************************************************************************************************/
+/* Function: raster_drawLine                                                                             */
+/* Purpose: Bresenham line, stepping along the longer axis, as the driver draws it.                      */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void raster_drawLine(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    int16_t swap;
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep)
+    {
+        swap = x0; x0 = y0; y0 = swap;
+        swap = x1; x1 = y1; y1 = swap;
+    }
+    if (x0 > x1)
+    {
+        swap = x0; x0 = x1; x1 = swap;
+        swap = y0; y0 = y1; y1 = swap;
+    }
+    int16_t dx = x1 - x0;
+    int16_t dy = abs(y1 - y0);
+    int16_t err = dx / 2;
+    int16_t yStep = (y0 < y1) ? 1 : -1;
+    for (; x0 <= x1; x0++)
+    {
+        if (steep)
+        {
+            raster_writeSpan(surface, y0, y0, x0, color);
+        }
+        else
+        {
+            raster_writeSpan(surface, x0, x0, y0, color);
+        }
+        err -= dy;
+        if (err < 0)
+        {
+            y0 += yStep;
+            err += dx;
+        }
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: raster_circle                                                                               */
+/* Purpose: Midpoint circle, outline or filled. The fill draws each column twice, as the driver does.    */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void raster_circle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t r, uint16_t color, bool fill)
+{
+    int16_t f = 1 - r;
+    int16_t ddFx = 1;
+    int16_t ddFy = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+    if (fill)
+    {
+        raster_fillRect(surface, x0, y0 - r, 1, 2 * r + 1, color);
+    }
+    else
+    {
+        raster_drawPixel(surface, x0, y0 + r, color);
+        raster_drawPixel(surface, x0, y0 - r, color);
+        raster_drawPixel(surface, x0 + r, y0, color);
+        raster_drawPixel(surface, x0 - r, y0, color);
+    }
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddFy += 2;
+            f += ddFy;
+        }
+        x++;
+        ddFx += 2;
+        f += ddFx;
+        if (fill)
+        {
+            raster_fillRect(surface, x0 + x, y0 - y, 1, 2 * y + 1, color);
+            raster_fillRect(surface, x0 + y, y0 - x, 1, 2 * x + 1, color);
+            raster_fillRect(surface, x0 - x, y0 - y, 1, 2 * y + 1, color);
+            raster_fillRect(surface, x0 - y, y0 - x, 1, 2 * x + 1, color);
+        }
+        else
+        {
+            raster_drawPixel(surface, x0 + x, y0 + y, color);
+            raster_drawPixel(surface, x0 - x, y0 + y, color);
+            raster_drawPixel(surface, x0 + x, y0 - y, color);
+            raster_drawPixel(surface, x0 - x, y0 - y, color);
+            raster_drawPixel(surface, x0 + y, y0 + x, color);
+            raster_drawPixel(surface, x0 - y, y0 + x, color);
+            raster_drawPixel(surface, x0 + y, y0 - x, color);
+            raster_drawPixel(surface, x0 - y, y0 - x, color);
+        }
+    }
+}
+
+void raster_drawCircle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    raster_circle(surface, x0, y0, r, color, false);
+}
+
+void raster_fillCircle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    raster_circle(surface, x0, y0, r, color, true);
+}
+
+void raster_drawTriangle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2,
+                         int16_t y2, uint16_t color)
+{
+    raster_drawLine(surface, x0, y0, x1, y1, color);
+    raster_drawLine(surface, x1, y1, x2, y2, color);
+    raster_drawLine(surface, x2, y2, x0, y0, color);
+}
+
+/*********************************************************************************************************/
+/* Function: raster_fillTriangle                                                                         */
+/* Purpose: Scanline fill, as the driver does it: vertices sorted by y, the upper part down to the       */
+/*          middle vertex, then the lower part.                                                          */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void raster_fillTriangle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2,
+                         int16_t y2, uint16_t color)
+{
+    int16_t swap;
+    if (y0 > y1)
+    {
+        swap = y0; y0 = y1; y1 = swap;
+        swap = x0; x0 = x1; x1 = swap;
+    }
+    if (y1 > y2)
+    {
+        swap = y2; y2 = y1; y1 = swap;
+        swap = x2; x2 = x1; x1 = swap;
+    }
+    if (y0 > y1)
+    {
+        swap = y0; y0 = y1; y1 = swap;
+        swap = x0; x0 = x1; x1 = swap;
+    }
+    if (y0 == y2)
+    {
+        int16_t a = x0;
+        int16_t b = x0;
+        if (x1 < a) a = x1; else if (x1 > b) b = x1;
+        if (x2 < a) a = x2; else if (x2 > b) b = x2;
+        raster_writeSpan(surface, a, b, y0, color);
+        return;
+    }
+    int32_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0;
+    int32_t sb = 0;
+    int16_t last = (y1 == y2) ? y1 : y1 - 1;   // The middle row goes with the upper part only if the bottom is flat.
+    int16_t y;
+    for (y = y0; y <= last; y++)
+    {
+        int16_t a = x0 + sa / dy01;
+        int16_t b = x0 + sb / dy02;
+        sa += dx01;
+        sb += dx02;
+        raster_writeSpan(surface, (a < b) ? a : b, (a < b) ? b : a, y, color);
+    }
+    sa = dx12 * (y - y1);
+    sb = dx02 * (y - y0);
+    for (; y <= y2; y++)
+    {
+        int16_t a = x1 + sa / dy12;
+        int16_t b = x0 + sb / dy02;
+        sa += dx12;
+        sb += dx02;
+        raster_writeSpan(surface, (a < b) ? a : b, (a < b) ? b : a, y, color);
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: raster_drawChar                                                                             */
+/* Purpose: Draws one character cell, each font pixel as a size x size square. Background pixels are     */
+/*          only drawn when the background color differs from the text color.                            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void raster_drawChar(raster_surface_t* surface, int16_t x, int16_t y, unsigned char c, uint16_t color,
+                     uint16_t backgroundColor, uint8_t size)
+{
+    if (x >= surface->width || y >= surface->height || x + RASTER_CHAR_WIDTH * size - 1 < 0 ||
+        y + RASTER_CHAR_HEIGHT * size - 1 < 0)
+    {
+        return;
+    }
+    for (int16_t column = 0; column < RASTER_CHAR_WIDTH; column++)
+    {
+        uint8_t bits = displayFont_getColumn(c, column);
+        for (int16_t row = 0; row < RASTER_CHAR_HEIGHT; row++, bits >>= 1)
+        {
+            if ((bits & 1) || backgroundColor != color)
+            {
+                raster_fillRect(surface, x + column * size, y + row * size, size, size,
+                                (bits & 1) ? color : backgroundColor);
+            }
+        }
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: raster_print                                                                                */
+/* Purpose: Draws a string at the cursor and moves the cursor along, wrapping at the right edge when     */
+/*          wrapping is on. '\n' starts a new line and '\r' is ignored.                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void raster_print(raster_surface_t* surface, raster_text_t* text, const char* str)
+{
+    for (; *str != '\0'; str++)
+    {
+        if (*str == '\n')
+        {
+            text->cursorY += text->size * RASTER_CHAR_HEIGHT;
+            text->cursorX = 0;
+        }
+        else if (*str != '\r')
+        {
+            raster_drawChar(surface, text->cursorX, text->cursorY, *str, text->color, text->backgroundColor,
+                            text->size);
+            text->cursorX += text->size * RASTER_CHAR_WIDTH;
+            if (text->wrap && text->cursorX > surface->width - text->size * RASTER_CHAR_WIDTH)
+            {
+                text->cursorY += text->size * RASTER_CHAR_HEIGHT;
+                text->cursorX = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef RASTER_H_
+#define RASTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Draws the TFT driver's primitives into RGB565 pixels in memory, with the driver's own
+// algorithms (Bresenham lines, midpoint circles, scanline triangles, the 5x7 font), so a
+// surface ends up exactly as the screen would. Everything is clipped to the surface.
+//
+// A surface can track, for each row, the span of pixels that changed since the owner last
+// cleared it (raster_clearDirty()); callers that copy the surface to the screen use it to find
+// what to send.
+
+#define RASTER_CLEAN_ROW_MIN_X INT16_MAX   // Dirty span of a row with no changed pixels.
+#define RASTER_CLEAN_ROW_MAX_X -1
+
+typedef struct {
+    uint16_t* pixels;        // Rows of width pixels, top row first.
+    int16_t width;
+    int16_t height;
+    int16_t* dirtyMinX;      // Per row: first and last changed column. NULL: not tracked.
+    int16_t* dirtyMaxX;
+    uint64_t writes;         // Pixels written.
+    uint64_t changes;        // Pixels written with a new color.
+    uint64_t transfers;      // Pixels and rectangles drawn: the address windows the driver would open.
+} raster_surface_t;
+
+// Text settings and cursor, as kept by the driver.
+typedef struct {
+    int16_t cursorX;
+    int16_t cursorY;
+    uint16_t color;
+    uint16_t backgroundColor;   // Same as color: transparent background.
+    uint8_t size;
+    bool wrap;
+} raster_text_t;
+
+// Sets a surface up over the given pixels. dirtyMinX and dirtyMaxX hold height entries each, or
+// are both NULL when the surface does not track changes. The pixels are left as they are.
+void raster_init(raster_surface_t* surface, uint16_t* pixels, int16_t width, int16_t height,
+                 int16_t* dirtyMinX, int16_t* dirtyMaxX);
+
+// Marks every row clean.
+void raster_clearDirty(raster_surface_t* surface);
+
+// Resets text settings to the driver's defaults: cursor at the origin, white, transparent,
+// size 1, wrapping.
+void raster_initText(raster_text_t* text);
+
+// Drawing primitives, as in display.h.
+void raster_drawPixel(raster_surface_t* surface, int16_t x, int16_t y, uint16_t color);
+void raster_fillRect(raster_surface_t* surface, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void raster_drawRect(raster_surface_t* surface, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void raster_drawLine(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+void raster_drawCircle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void raster_fillCircle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void raster_drawTriangle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2,
+                         int16_t y2, uint16_t color);
+void raster_fillTriangle(raster_surface_t* surface, int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2,
+                         int16_t y2, uint16_t color);
+
+// Text. raster_print() draws at the cursor and moves it, like display_print().
+void raster_drawChar(raster_surface_t* surface, int16_t x, int16_t y, unsigned char c, uint16_t color,
+                     uint16_t backgroundColor, uint8_t size);
+void raster_print(raster_surface_t* surface, raster_text_t* text, const char* str);
+
+#endif /* RASTER_H_ */
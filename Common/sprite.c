@@ -0,0 +1,43 @@
+/*********************************************************************************************************/
+/* File: sprite.c                                                                                        */
+/* Purpose: Shapes rendered once into memory and drawn as one window transfer (see sprite.h).           */
+/*********************************************************************************************************/
+#include "sprite.h"
+#include "supportFiles/display.h"
+
+void sprite_init(sprite_t* sprite, uint16_t* pixels, int16_t width, int16_t height, uint16_t backgroundColor,
+                 raster_surface_t* surface)
+{
+    *sprite = (sprite_t) {pixels, width, height};
+    raster_init(surface, pixels, width, height, NULL, NULL);
+    raster_fillRect(surface, 0, 0, width, height, backgroundColor);
+}
+
+/*********************************************************************************************************/
+/* Function: sprite_draw                                                                                 */
+/* Purpose: Opens a window on the part of the sprite that is on the screen and sends its rows. Nothing   */
+/*          is sent for a sprite entirely off the screen.                                                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void sprite_draw(const sprite_t* sprite, int16_t x, int16_t y)
+{
+    int16_t left = (x < 0) ? -x : 0;
+    int16_t top = (y < 0) ? -y : 0;
+    int16_t right = (x + sprite->width > DISPLAY_WIDTH) ? DISPLAY_WIDTH - x : sprite->width;
+    int16_t bottom = (y + sprite->height > DISPLAY_HEIGHT) ? DISPLAY_HEIGHT - y : sprite->height;
+    if (left >= right || top >= bottom)
+    {
+        return;
+    }
+    display_setAddrWindow(x + left, y + top, x + right - 1, y + bottom - 1);
+    // Whole rows are contiguous: send them in one go.
+    if (left == 0 && right == sprite->width)
+    {
+        display_pushColors(&sprite->pixels[top * sprite->width], (uint32_t) sprite->width * (bottom - top));
+        return;
+    }
+    for (int16_t row = top; row < bottom; row++)
+    {
+        display_pushColors(&sprite->pixels[row * sprite->width + left], (uint32_t) (right - left));
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef SPRITE_H_
+#define SPRITE_H_
+
+#include <stdint.h>
+#include "raster.h"
+
+// Pre-rendered shapes. The driver draws a filled circle as a rectangle per scanline and a line or
+// an outline a pixel at a time, each its own address-window transfer. A sprite is a rectangle of
+// RGB565 pixels in memory: the shape is drawn into it once with the driver's own algorithms
+// (Common/raster.c), and from then on it goes to the screen as one window transfer.
+//
+// Sprites are opaque: the pixels around the shape get the background color given when the sprite
+// is set up. Draw a sprite where its rectangle holds only that background and the shape it
+// replaces (a mole hole on the board, an X in its square).
+//
+// The owner provides the pixels (width * height of them), usually a static array sized by its
+// own layout.
+
+typedef struct {
+    const uint16_t* pixels;     // Rows of width pixels, top row first.
+    int16_t width;
+    int16_t height;
+} sprite_t;
+
+// Sets sprite up over pixels and fills them with backgroundColor. Draw the shape with the
+// raster_*() functions on surface, in sprite coordinates ((0, 0) is the top-left corner).
+void sprite_init(sprite_t* sprite, uint16_t* pixels, int16_t width, int16_t height, uint16_t backgroundColor,
+                 raster_surface_t* surface);
+
+// Draws sprite with its top-left corner at (x, y). A sprite partly off the screen sends only the
+// part that is on it, still in one window.
+void sprite_draw(const sprite_t* sprite, int16_t x, int16_t y);
+
+#endif /* SPRITE_H_ */
@@ -0,0 +1,92 @@
+/*********************************************************************************************************/
+/* File: touchGrid.c                                                                                     */
+/* Purpose: Touch regions cut into column and row bands, resolved by table lookup (see touchGrid.h).    */
+/*********************************************************************************************************/
+#include "touchGrid.h"
+#include <stdio.h>
+#include <string.h>
+
+void touchGrid_init(touchGrid_t* grid)
+{
+    memset(grid->columnOf, 0, sizeof(grid->columnOf));
+    memset(grid->rowOf, 0, sizeof(grid->rowOf));
+    grid->columnCount = 1;
+    grid->rowCount = 1;
+    memset(grid->regions, TOUCH_GRID_NO_REGION, sizeof(grid->regions));
+}
+
+/*********************************************************************************************************/
+/* Function: touchGrid_cut                                                                               */
+/* Purpose: Starts a new band at coordinate at of one axis, if one does not start there already. The     */
+/*          band it splits keeps its regions on both sides, so no lookup changes.                        */
+/* Returns: false if the axis already has TOUCH_GRID_MAX_BANDS bands.                                    */
+/*********************************************************************************************************/
+static bool touchGrid_cut(touchGrid_t* grid, bool columns, int16_t at)
+{
+    uint8_t* bandOf = columns ? grid->columnOf : grid->rowOf;
+    uint8_t* count = columns ? &grid->columnCount : &grid->rowCount;
+    int16_t length = columns ? DISPLAY_WIDTH : DISPLAY_HEIGHT;
+    if (at <= 0 || at >= length || bandOf[at] != bandOf[at - 1])
+    {
+        return true;
+    }
+    if (*count == TOUCH_GRID_MAX_BANDS)
+    {
+        return false;
+    }
+    // Renumber the bands from the cut on, then open a copy of the split band's regions for them.
+    uint8_t band = bandOf[at];
+    for (int16_t i = at; i < length; i++)
+    {
+        bandOf[i]++;
+    }
+    for (uint8_t moved = *count; moved > band; moved--)
+    {
+        for (uint8_t other = 0; other < TOUCH_GRID_MAX_BANDS; other++)
+        {
+            if (columns)
+            {
+                grid->regions[other][moved] = grid->regions[other][moved - 1];
+            }
+            else
+            {
+                grid->regions[moved][other] = grid->regions[moved - 1][other];
+            }
+        }
+    }
+    (*count)++;
+    return true;
+}
+
+/*********************************************************************************************************/
+/* Function: touchGrid_addRect                                                                           */
+/* Purpose: Cuts bands at the rectangle's edges and sets the region of every crossing inside it.         */
+/* Returns: false if the grid ran out of bands (the rectangle is not added).                             */
+/*********************************************************************************************************/
+bool touchGrid_addRect(touchGrid_t* grid, int16_t x, int16_t y, int16_t width, int16_t height,
+                       touchGrid_region_t region)
+{
+    int16_t left = (x < 0) ? 0 : x;
+    int16_t top = (y < 0) ? 0 : y;
+    int16_t right = (x + width > DISPLAY_WIDTH) ? DISPLAY_WIDTH : x + width;
+    int16_t bottom = (y + height > DISPLAY_HEIGHT) ? DISPLAY_HEIGHT : y + height;
+    if (left >= right || top >= bottom)
+    {
+        return true;
+    }
+    // A cut on its own changes no lookup, so cuts made before running out do no harm.
+    if (!touchGrid_cut(grid, true, left) || !touchGrid_cut(grid, true, right) ||
+        !touchGrid_cut(grid, false, top) || !touchGrid_cut(grid, false, bottom))
+    {
+        printf("touchGrid_addRect: more than %d bands needed for region %u\n\r", TOUCH_GRID_MAX_BANDS, region);
+        return false;
+    }
+    for (uint8_t row = grid->rowOf[top]; row <= grid->rowOf[bottom - 1]; row++)
+    {
+        for (uint8_t column = grid->columnOf[left]; column <= grid->columnOf[right - 1]; column++)
+        {
+            grid->regions[row][column] = region;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef TOUCHGRID_H_
+#define TOUCHGRID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "supportFiles/display.h"
+
+// Touch regions resolved by table lookup. A screen's layout is added once, one rectangle per
+// region; the grid cuts the screen into bands of columns and rows at the rectangles' edges and
+// keeps the region of every band crossing. Looking up a touch is then three table reads (its
+// column band, its row band and the region where they cross) however many regions there are.
+//
+// Bands follow the edges exactly, so a lookup gives the same answer as testing the rectangles
+// pixel by pixel. A grid is about 800 bytes; rebuild it whenever the layout changes.
+
+#define TOUCH_GRID_MAX_BANDS 16       // Bands per axis: room for 15 distinct edges each way.
+#define TOUCH_GRID_NO_REGION 0xFF     // Looked up where no rectangle was added.
+
+typedef uint8_t touchGrid_region_t;
+
+typedef struct {
+    uint8_t columnOf[DISPLAY_WIDTH];      // Column band of each x.
+    uint8_t rowOf[DISPLAY_HEIGHT];        // Row band of each y.
+    uint8_t columnCount;
+    uint8_t rowCount;
+    touchGrid_region_t regions[TOUCH_GRID_MAX_BANDS][TOUCH_GRID_MAX_BANDS];   // [row][column].
+} touchGrid_t;
+
+// Empties grid: one band each way, no regions.
+void touchGrid_init(touchGrid_t* grid);
+
+// Gives the rectangle (clipped to the screen) to region, over anything added before.
+// Returns false (and prints an error) if its edges need more than TOUCH_GRID_MAX_BANDS bands.
+bool touchGrid_addRect(touchGrid_t* grid, int16_t x, int16_t y, int16_t width, int16_t height,
+                       touchGrid_region_t region);
+
+// Returns the region at (x, y), or TOUCH_GRID_NO_REGION. Points off the screen count as the
+// nearest edge pixel, as the touch panel can report them.
+static inline touchGrid_region_t touchGrid_lookup(const touchGrid_t* grid, int16_t x, int16_t y)
+{
+    x = (x < 0) ? 0 : (x >= DISPLAY_WIDTH) ? DISPLAY_WIDTH - 1 : x;
+    y = (y < 0) ? 0 : (y >= DISPLAY_HEIGHT) ? DISPLAY_HEIGHT - 1 : y;
+    return grid->regions[grid->rowOf[y]][grid->columnOf[x]];
+}
+
+#endif /* TOUCHGRID_H_ */
@@ -8,21 +8,24 @@
 // Required includes for this program.
 #include "clockControl.h"
 #include "clockDisplay.h"
+#include "clockTime.h"
 #include "supportFiles/display.h"
 #include <stdint.h>
 #include <stdio.h>
+#include "deferredLog.h"
 
-// Required defines to clear the counters.
-#define CLOCK_CONTROL_ADC_COUNTER_CLEAR 0
-#define CLOCK_CONTROL_AUTO_COUNTER_CLEAR 0
-#define CLOCK_CONTROL_RATE_COUNTER_CLEAR 0
-#define CLOCK_CONTROL_ONE_SEC_INCR_CLEAR 0
+// clockControl_debug_print() goes to the deferred log (Common/deferredLog.h), if CLOCK_CONTROL_LOG_ENABLED.
+#if defined(DEFERRED_LOG_ENABLED) && defined(CLOCK_CONTROL_LOG_ENABLED)
+#define CLOCK_CONTROL_LOG DEFERRED_LOG
+#else
+#define CLOCK_CONTROL_LOG(...)
+#endif
 
-// Required defines for the counter max values.
-#define CLOCK_CONTROL_ONE_SEC_INCR 20
-#define CLOCK_CONTROL_ADC_COUNTER_MAX_VALUE 1
-#define CLOCK_CONTROL_AUTO_COUNTER_MAX_VALUE 10
-#define CLOCK_CONTROL_RATE_COUNTER_MAX_VALUE 2
+// Required defines for how long the state machine waits, in global timer counts.
+#define CLOCK_CONTROL_MILLISECONDS_PER_SECOND 1000
+#define CLOCK_CONTROL_ADC_SETTLE_TIME (50 * COUNTS_PER_SECOND / CLOCK_CONTROL_MILLISECONDS_PER_SECOND)      // Lets the touch coordinates settle.
+#define CLOCK_CONTROL_AUTO_DELAY_TIME (500 * COUNTS_PER_SECOND / CLOCK_CONTROL_MILLISECONDS_PER_SECOND)     // Held this long, a touch starts repeating.
+#define CLOCK_CONTROL_RATE_TIME (100 * COUNTS_PER_SECOND / CLOCK_CONTROL_MILLISECONDS_PER_SECOND)           // Time between repeats.
 
 // Volatile variable used to flag when the timer is up.
 volatile unsigned char timer_flag = 0;
@@ -30,11 +33,9 @@ volatile unsigned char timer_flag = 0;
 // Enum used to create the states for the clock control state machine.
 enum clockControl_st_t {clock_control_start_st, clock_control_init_st, clock_control_wait_first_touch_st, clock_control_waiting_for_touch_st, clock_control_increment_sec_st, clock_control_adc_counter_running_st, clock_control_auto_counter_running_st, clock_control_rate_counter_running_st, clock_control_rate_counter_expired_st} current_state = clock_control_start_st;
 
-// Global variables used for the counters in the state machine.
-uint32_t adc_counter = CLOCK_CONTROL_ADC_COUNTER_CLEAR;
-uint32_t auto_counter = CLOCK_CONTROL_AUTO_COUNTER_CLEAR;
-uint32_t rate_counter = CLOCK_CONTROL_RATE_COUNTER_CLEAR;
-uint32_t sec_counter = CLOCK_CONTROL_ONE_SEC_INCR_CLEAR;
+// Global variables used for the deadlines in the state machine: when the current touch state times out, and when the next second begins.
+XTime clock_control_deadline = 0;
+XTime clock_control_next_second = 0;
 
 /*********************************************************************************/
 /* Function: clockControl_debug_print                                            */
@@ -59,316 +60,279 @@ void clockControl_debug_print()
         {
             // If the state machine is in the start state, print that out to the user and break.
             case clock_control_start_st:
-                printf("start_st\n\r");
+                CLOCK_CONTROL_LOG("start_st\n\r");
                 break;
 
             // Else, if the state machine is in the init state, print that out to the user and break.
             case clock_control_init_st:
-                printf("init_st\n\r");
+                CLOCK_CONTROL_LOG("init_st\n\r");
                 break;
 
             // Else, if the state machine is in the wait_first_touch state, print that out to the user and break.
             case clock_control_wait_first_touch_st:
-                printf("wait_first_touch_st\n\r");
+                CLOCK_CONTROL_LOG("wait_first_touch_st\n\r");
                 break;
 
             // Else, if the state machine is in the increment_sec state, print that out to the user and break.
             case clock_control_increment_sec_st:
-                printf("increment_sec_st\n\r");
+                CLOCK_CONTROL_LOG("increment_sec_st\n\r");
                 break;
 
             // Else, if the state machine is in the waiting_for_touch state, print that out to the user and break.
             case clock_control_waiting_for_touch_st:
-                printf("waiting_for_touch_st\n\r");
+                CLOCK_CONTROL_LOG("waiting_for_touch_st\n\r");
                 break;
 
             // Else, if the state machine is in the adc_counter_running state, print that out to the user and break.
             case clock_control_adc_counter_running_st:
-                printf("adc_timer_running_st\n\r");
+                CLOCK_CONTROL_LOG("adc_timer_running_st\n\r");
                 break;
 
             // Else, if the state machine is in the auto_counter_running state, print that out to the user and break.
             case clock_control_auto_counter_running_st:
-                printf("auto_timer_running_st\n\r");
+                CLOCK_CONTROL_LOG("auto_timer_running_st\n\r");
                 break;
 
             // Else, if the state machine is in the rate_counter_running state, print that out to the user and break.
             case clock_control_rate_counter_running_st:
-                printf("rate_timer_running_st\n\r");
+                CLOCK_CONTROL_LOG("rate_timer_running_st\n\r");
                 break;
 
             // Else, if the state machine is in the rate_counter_expired state, print that out to the user and break.
             case clock_control_rate_counter_expired_st:
-                printf("rate_timer_expired_st\n\r");
+                CLOCK_CONTROL_LOG("rate_timer_expired_st\n\r");
                 break;
      }
   }
 }
 
+/*********************************************************************************/
+/* Function: clockControl_expired                                                */
+/* Purpose: To check a deadline against the global timer.                        */
+/* Returns: True if the deadline has been reached.                               */
+/*********************************************************************************/
+static bool clockControl_expired(XTime deadline)
+{
+    XTime now;
+    XTime_GetTime(&now);
+    return now >= deadline;
+}
+
+/*********************************************************************************/
+/* Function: clockControl_startTimeout                                           */
+/* Purpose: To set the deadline of the current touch state to duration from now. */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+static void clockControl_startTimeout(XTime duration)
+{
+    XTime_GetTime(&clock_control_deadline);
+    clock_control_deadline += duration;
+}
+
+/*********************************************************************************/
+/* Function: clockControl_showTime                                               */
+/* Purpose: To draw the time read from the global timer. However many seconds    */
+/*          have passed since the last call, the clock shows the right time.     */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+static void clockControl_showTime()
+{
+    // Read the time and when the next second begins (from one timer reading, so a second that
+    // ends in between is not skipped), then hand the time to the display.
+    int16_t hour, minute, second;
+    clockTime_getWithNextSecond(&hour, &minute, &second, &clock_control_next_second);
+    clockDisplay_setTime(hour, minute, second);
+    clockDisplay_updateTimeDisplay(false);
+}
+
+/*********************************************************************************/
+/* Function: clockControl_incDec                                                 */
+/* Purpose: To apply a touch to the current time and keep the clock running from */
+/*          the new time.                                                        */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+static void clockControl_incDec()
+{
+    // Start from the time right now (the display may be behind while the screen is touched).
+    int16_t hour, minute, second;
+    clockTime_get(&hour, &minute, &second);
+    clockDisplay_setTime(hour, minute, second);
+
+    // Increment or decrement the touched field, then set the clock to the result and draw it.
+    clockDisplay_performIncDec();
+    clockDisplay_getTime(&hour, &minute, &second);
+    clockTime_set(hour, minute, second);
+    clockControl_showTime();
+}
+
 /*********************************************************************************/
 /* Function: clockControl_tick                                                   */
-/* Purpose: To control the state machine for the clock control program.          */
+/* Purpose: To control the state machine for the clock control program. Nothing  */
+/*          is counted: each wait is a deadline on the global timer, so a late   */
+/*          or missed tick only delays a transition and never loses time.        */
 /* Returns: VOID                                                                 */
 /*********************************************************************************/
 void clockControl_tick()
 {
-        // Switch on the current state. This switch statement is for the state machine transitions and mealy outputs.
+    // Switch on the current state. This switch statement is for the state machine transitions and mealy outputs.
     switch (current_state)
     {
-                // If we are in the start state.
+        // If we are in the start state.
         case clock_control_start_st:
-                        // Immediately move to the init state and break.
+            // Immediately move to the init state and break.
             current_state = clock_control_init_st;
             break;
 
-                // Else, if we are in the init state.
+        // Else, if we are in the init state.
         case clock_control_init_st:
-                        // Immediately move to the wait_first_touch state and break.
-                current_state = clock_control_wait_first_touch_st;
-                    break;
+            // Immediately move to the wait_first_touch state and break.
+            current_state = clock_control_wait_first_touch_st;
+            break;
 
-                // Else, if we are in the wait_first_touch state.
+        // Else, if we are in the wait_first_touch state.
         case clock_control_wait_first_touch_st:
-                        // If the display is touched.
-                if (display_isTouched())
-                {
-                            // Set the current state to the waiting_for_touch state and clear the old touch data.
-                    current_state = clock_control_waiting_for_touch_st;
-                    display_clearOldTouchData();
-                }
+            // If the display is touched.
+            if (display_isTouched())
+            {
+                // Set the current state to the waiting_for_touch state and clear the old touch data.
+                current_state = clock_control_waiting_for_touch_st;
+                display_clearOldTouchData();
 
-                        // Otherwise.
-                else
-                {
-                            // Stay in the current state to the wait_first_touch_state.
-                    current_state = clock_control_wait_first_touch_st;
-                }
+                // Start the clock from the time on the display.
+                int16_t hour, minute, second;
+                clockDisplay_getTime(&hour, &minute, &second);
+                clockTime_start(hour, minute, second);
+                clock_control_next_second = clockTime_nextSecond();
+            }
 
-                        // Break.
-                break;
+            // Break.
+            break;
 
-                // Else, if we are in the waiting_for_touch state.
+        // Else, if we are in the waiting_for_touch state.
         case clock_control_waiting_for_touch_st:
-                        // If the display is touched.
+            // If the display is touched.
             if (display_isTouched())
             {
-                                // Set the current state to the adc_counter_running state and clear the old touch data.
+                // Set the current state to the adc_counter_running state, clear the old touch data, and give the touch time to settle.
                 current_state = clock_control_adc_counter_running_st;
                 display_clearOldTouchData();
+                clockControl_startTimeout(CLOCK_CONTROL_ADC_SETTLE_TIME);
             }
 
-                        // Otherwise, if the display is not touched and the sec_counter is greater than or equal to it's max value.
-            else if (!display_isTouched() && sec_counter >= CLOCK_CONTROL_ONE_SEC_INCR)
-            {
-                                // Set the current state to the increment_sec state.
-                    current_state = clock_control_increment_sec_st;
-            }
-
-                        // Otherwise.
-            else
+            // Otherwise, if the next second has begun.
+            else if (clockControl_expired(clock_control_next_second))
             {
-                                // Stay in the waiting_for_touch state.
-                current_state = clock_control_waiting_for_touch_st;
+                // Set the current state to the increment_sec state.
+                current_state = clock_control_increment_sec_st;
             }
 
-                        // Break.
+            // Break.
             break;
 
-                // Else, if we are in the increment_sec state.
+        // Else, if we are in the increment_sec state.
         case clock_control_increment_sec_st:
-                        // Set the current state to waiting_for_touch, advance the time by one second, then update the display.
-                current_state = clock_control_waiting_for_touch_st;
-                clockDisplay_advanceTimeOneSecond();
-                clockDisplay_updateTimeDisplay(false);
+            // Set the current state to waiting_for_touch, then draw the time.
+            current_state = clock_control_waiting_for_touch_st;
+            clockControl_showTime();
 
-                        // Break.
-                break;
+            // Break.
+            break;
 
-                // Else, if we are in the adc_counter_running state.
+        // Else, if we are in the adc_counter_running state.
         case clock_control_adc_counter_running_st:
-                        // If the display is not touched and the adc_counter is greater than or equal to it's max value.
-            if (!display_isTouched() && adc_counter >= CLOCK_CONTROL_ADC_COUNTER_MAX_VALUE)
+            // If the touch has settled.
+            if (clockControl_expired(clock_control_deadline))
             {
-                                // Set the current state to the waiting_for_touch state, increment the time, and update the display.
-                current_state = clock_control_waiting_for_touch_st;
-                clockDisplay_performIncDec();
-                clockDisplay_updateTimeDisplay(false);
-            }
-
-                        // Otherwise, if the display is touched and the adc_counter is greater than or equal to it's max value.
-            else if (display_isTouched() && adc_counter >= CLOCK_CONTROL_ADC_COUNTER_MAX_VALUE)
-            {
-                                // Set the current state to the auto_counter_running state.
-                current_state = clock_control_auto_counter_running_st;
-            }
+                // If the display is no longer touched.
+                if (!display_isTouched())
+                {
+                    // Set the current state to the waiting_for_touch state, then increment or decrement the time.
+                    current_state = clock_control_waiting_for_touch_st;
+                    clockControl_incDec();
+                }
 
-                        // Otherwise.
-            else
-            {
-                                // Stay in the adc_counter_running state.
-                current_state = clock_control_adc_counter_running_st;
+                // Otherwise, the touch is being held.
+                else
+                {
+                    // Set the current state to the auto_counter_running state and wait to start repeating.
+                    current_state = clock_control_auto_counter_running_st;
+                    clockControl_startTimeout(CLOCK_CONTROL_AUTO_DELAY_TIME);
+                }
             }
 
-                        // Break.
+            // Break.
             break;
 
-                // Else, if we are in the auto_counter_running state.
+        // Else, if we are in the auto_counter_running state.
         case clock_control_auto_counter_running_st:
-                        // If the display is not touched.
+            // If the display is not touched.
             if (!display_isTouched())
             {
-                                // Set the current state to the waiting_for_touch state, increment the clock, and update the display.
+                // Set the current state to the waiting_for_touch state, then increment or decrement the time.
                 current_state = clock_control_waiting_for_touch_st;
-                clockDisplay_performIncDec();
-                clockDisplay_updateTimeDisplay(false);
+                clockControl_incDec();
             }
 
-                        // Otherwise, if the display is touched and the auto_counter is greater than or equal to it's max value.
-            else if (display_isTouched() && auto_counter >= CLOCK_CONTROL_AUTO_COUNTER_MAX_VALUE)
+            // Otherwise, if the touch has been held long enough to repeat.
+            else if (clockControl_expired(clock_control_deadline))
             {
-                                // Set the current state to the reate_counter_running state, increment the clock, and update the display.
+                // Set the current state to the rate_counter_running state, increment or decrement the time, and wait for the next repeat.
                 current_state = clock_control_rate_counter_running_st;
-                clockDisplay_performIncDec();
-                clockDisplay_updateTimeDisplay(false);
+                clockControl_incDec();
+                clockControl_startTimeout(CLOCK_CONTROL_RATE_TIME);
             }
 
-                        // Otherwise.
-            else
-            {
-                                // Stay in the auto_counter_running state.
-                current_state = clock_control_auto_counter_running_st;
-            }
-
-                        // Break.
+            // Break.
             break;
 
-                // Else, if we are in the rate_counter_running state.
+        // Else, if we are in the rate_counter_running state.
         case clock_control_rate_counter_running_st:
-                        // If the display is not touced.
+            // If the display is not touched.
             if (!display_isTouched())
             {
-                                // Set the current state to the waiting_for_touch state.
+                // Set the current state to the waiting_for_touch state.
                 current_state = clock_control_waiting_for_touch_st;
             }
 
-                        // Otherwise, if the display is touched and rate_counter is greater than or equal to it's max value.
-            else if (display_isTouched() && rate_counter >= CLOCK_CONTROL_RATE_COUNTER_MAX_VALUE)
+            // Otherwise, if it is time for the next repeat.
+            else if (clockControl_expired(clock_control_deadline))
             {
-                                // Set the current state equal to the rate_counter_expired state.
+                // Set the current state equal to the rate_counter_expired state.
                 current_state = clock_control_rate_counter_expired_st;
             }
 
-                        // Otherwise.
-            else
-            {
-                                // Stay in the rate_counter_running state.
-                current_state = clock_control_rate_counter_running_st;
-            }
-
-                        // Break.
+            // Break.
             break;
 
-                // Else, if we are in the rate_counter_expired state.
+        // Else, if we are in the rate_counter_expired state.
         case clock_control_rate_counter_expired_st:
-                        // If the display is not touched.
+            // If the display is not touched.
             if (!display_isTouched())
             {
-                                // Set the current staet to the waiting_for_touch state.
+                // Set the current state to the waiting_for_touch state.
                 current_state = clock_control_waiting_for_touch_st;
             }
 
-                        // Otherwise, if the display is touched.
-            else if (display_isTouched())
+            // Otherwise, the display is still touched.
+            else
             {
-                                // Set the current state to the rate_counter_running state, increment the clock, and update the display.
+                // Set the current state to the rate_counter_running state, increment or decrement the time, and wait for the next repeat.
                 current_state = clock_control_rate_counter_running_st;
-                clockDisplay_performIncDec();
-                clockDisplay_updateTimeDisplay(false);
+                clockControl_incDec();
+                clockControl_startTimeout(CLOCK_CONTROL_RATE_TIME);
             }
 
-                        // Break.
+            // Break.
             break;
 
-                // Default case (when something terrible goes wrong).
+        // Default case (when something terrible goes wrong).
         default:
-                        // Set the current state to the start state, and break.
+            // Set the current state to the start state, and break.
             current_state = clock_control_start_st;
             break;
     }
 
-        // Switch for the current_state. This switch is used for computations completed in the state (moore outputs).
-    switch (current_state)
-    {
-            // If we are in the init state.
-            case clock_control_start_st:
-                    // Break, because we don't do anything in the start state.
-                    break;
-
-            // Else, if we are in the init state.
-        case clock_control_init_st:
-                    // Reset all of the counters to their "clear" value.
-                adc_counter = CLOCK_CONTROL_ADC_COUNTER_CLEAR;
-                    auto_counter = CLOCK_CONTROL_AUTO_COUNTER_CLEAR;
-                    rate_counter = CLOCK_CONTROL_RATE_COUNTER_CLEAR;
-                    sec_counter = CLOCK_CONTROL_ONE_SEC_INCR_CLEAR;
-
-                    // Break.
-                break;
-
-            // Else, if we are in the wait_first_touch state.
-        case clock_control_wait_first_touch_st:
-                    // Break, because we don't do anything in the wait_first_touch state.
-                break;
-
-            // Else, if we are in the waiting_for_touch state.
-            case clock_control_waiting_for_touch_st:
-                    // Clear the adc, auto, and rate counters.
-            adc_counter = CLOCK_CONTROL_ADC_COUNTER_CLEAR;
-                    auto_counter = CLOCK_CONTROL_AUTO_COUNTER_CLEAR;
-                    rate_counter = CLOCK_CONTROL_RATE_COUNTER_CLEAR;
-
-                    // Increment the sec_counter (keeps control of the incrementing seconds of the clock).
-                    sec_counter++;
-
-                    // Break.
-                    break;
-
-            // Else, if we are in the increment_sec state.
-        case clock_control_increment_sec_st:
-                    // Clear the sec_counter to start over and break.
-            sec_counter = CLOCK_CONTROL_ONE_SEC_INCR_CLEAR;
-            break;
-
-            // Else, if we are in the adc_counter_running state.
-        case clock_control_adc_counter_running_st:
-                    // Increment the adc_counter and break.
-                    adc_counter++;
-            break;
-
-            // Else, if we are in the auto_counter_running state.
-        case clock_control_auto_counter_running_st:
-                    // Increment the auto_counter and break.
-            auto_counter++;
-            break;
-
-            // Else, if we are in the rate_counter_running state.
-        case clock_control_rate_counter_running_st:
-                    // Increment the rate_counter and break.
-            rate_counter++;
-            break;
-
-            // Else, if we are in the rate_counter_expired state.
-        case clock_control_rate_counter_expired_st:
-                    // Rest the rate_counter and break.
-            rate_counter = CLOCK_CONTROL_RATE_COUNTER_CLEAR;
-            break;
-
-            // The default case (when something terrible goes wrong).
-        default:
-                    // Break.
-            break;
-    }
-
-        // Call the clockControl_debug_print function to see what states we are in.
+    // Call the clockControl_debug_print function to see what states we are in.
     clockControl_debug_print();
 }
+
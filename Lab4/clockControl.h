@@ -1,6 +1,10 @@
 #ifndef CLOCKCONTROL_H_
 #define CLOCKCONTROL_H_
 
+// Uncomment to log the clock state machine's state changes (with DEFERRED_LOG_ENABLED, see
+// Common/deferredLog.h).
+//#define CLOCK_CONTROL_LOG_ENABLED
+
 void clockControl_tick();
 
 #endif
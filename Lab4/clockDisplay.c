@@ -9,7 +9,30 @@
 // Required includes for the program.
 #include "clockDisplay.h"
 #include "supportFiles/display.h"
-#include <stdio.h>
+#include "glyphCache.h"
+#include "deferredLog.h"
+
+// The digits drawn go to the deferred log (Common/deferredLog.h), if CLOCK_DISPLAY_LOG_ENABLED.
+#if defined(DEFERRED_LOG_ENABLED) && defined(CLOCK_DISPLAY_LOG_ENABLED)
+#define CLOCK_DISPLAY_LOG DEFERRED_LOG
+#else
+#define CLOCK_DISPLAY_LOG(...)
+#endif
+
+// Required defines to draw either through the compositor (only what changed is sent when the display is flushed) or straight to the display.
+// Straight to the display, each character is one transfer of its whole cell from the glyph cache (Common/glyphCache.h).
+#ifdef CLOCK_DISPLAY_COMPOSITOR_ENABLED
+#include "compositor.h"
+#define CLOCK_DISPLAY_FILL_SCREEN compositor_fillScreen
+#define CLOCK_DISPLAY_FILL_TRIANGLE compositor_fillTriangle
+#define CLOCK_DISPLAY_DRAW_CHAR compositor_drawChar
+#define CLOCK_DISPLAY_FLUSH() compositor_flush()
+#else
+#define CLOCK_DISPLAY_FILL_SCREEN display_fillScreen
+#define CLOCK_DISPLAY_FILL_TRIANGLE display_fillTriangle
+#define CLOCK_DISPLAY_DRAW_CHAR glyphCache_drawChar
+#define CLOCK_DISPLAY_FLUSH()
+#endif
 
 // Required defines to set the test period and test count amounts.
 #define CLOCK_DISPLAY_TEST_PERIOD 50000000
@@ -49,13 +72,19 @@
 #define CLOCK_DISPLAY_PADDING_X (CLOCK_DISPLAY_CHARACTER_WIDTH + 1.5*CLOCK_DISPLAY_TEXT_SIZE)
 
 // Required defines for the time size and positions for the clock display.
-#define CLOCK_DISPLAY_TIME_CHAR_SIZE 1
-#define CLOCK_DISPLAY_TIME_STRING_SIZE 8
-#define CLOCK_DISPLAY_TIME_STRING_WORD 2
 #define CLOCK_DISPLAY_TIME_STRING_HOUR 0
 #define CLOCK_DISPLAY_TIME_STRING_MINUTE 3
 #define CLOCK_DISPLAY_TIME_STRING_SECOND 6
 #define CLOCK_DISPLAY_TIME_FIRST_DIGIT 10
+#define CLOCK_DISPLAY_TIME_X (CLOCK_DISPLAY_TRIANGLE_CENTER_X + CLOCK_DISPLAY_FIRST_TRIANGLE_OFFSET*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) - CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH)
+#define CLOCK_DISPLAY_TIME_Y ((CLOCK_DISPLAY_HALF_DISPLAY - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT) + CLOCK_DISPLAY_CHARACTER_PADDING_Y)
+
+// Required defines for the six digits of "hh:mm:ss" (tens then ones for the hour, minute, and second).
+#define CLOCK_DISPLAY_DIGIT_COUNT 6
+#define CLOCK_DISPLAY_DIGITS_PER_FIELD 2
+#define CLOCK_DISPLAY_FIELD_COUNT 3
+#define CLOCK_DISPLAY_BLANK_DIGIT ' '       // The hour's tens digit below 10.
+#define CLOCK_DISPLAY_COLON ':'
 
 // Required defines for the maximum hour, minute, second, and roll overs.
 #define CLOCK_DISPLAY_TIME_MAX_HOUR 13
@@ -76,56 +105,53 @@
 #define CLOCK_DISPLAY_DEFAULT_MINUTE 0
 #define CLOCK_DISPLAY_DEFAULT_SECOND 0
 
-// Global variables used to keep track of the current and previous time.
+// Global variables used to keep track of the current time.
 int16_t clock_display_current_time_hour = CLOCK_DISPLAY_DEFAULT_HOUR;
 int16_t clock_display_current_time_minute = CLOCK_DISPLAY_DEFAULT_MINUTE;
 int16_t clock_display_current_time_second = CLOCK_DISPLAY_DEFAULT_SECOND;
-int16_t clock_display_last_time_hour = clock_display_current_time_hour;
-int16_t clock_display_last_time_minute = clock_display_current_time_minute;
-int16_t clock_display_last_time_second = clock_display_current_time_second;
+
+// The character positions in "hh:mm:ss" of the first digit of the hour, minute, and second.
+static const int16_t clockDisplay_fieldPositions[CLOCK_DISPLAY_FIELD_COUNT] = {CLOCK_DISPLAY_TIME_STRING_HOUR, CLOCK_DISPLAY_TIME_STRING_MINUTE, CLOCK_DISPLAY_TIME_STRING_SECOND};
+
+// The glyph (character) last drawn in each digit position, so an update only draws the digits that differ from it.
+static unsigned char clockDisplay_shownDigits[CLOCK_DISPLAY_DIGIT_COUNT];
 
 /*********************************************************************************/
-/* Function: clockDisplay_print_time                                             */
-/* Purpose: To output the current time to the LCD display for the Zybo board.    */
+/* Function: clockDisplay_drawCharacter                                          */
+/* Purpose: To draw one character of "hh:mm:ss" as a whole cell: the glyph in    */
+/*          green and the rest of the cell in black. The cell covers whatever    */
+/*          was drawn there before, so nothing needs to be erased first.         */
 /* Returns: VOID                                                                 */
 /*********************************************************************************/
-void clockDisplay_print_time(int16_t index, int16_t value, uint32_t color, bool full_word_update)
+static void clockDisplay_drawCharacter(int16_t position, unsigned char character)
 {
-    // Create a character array used to store the values being changed on the display.
-    char output_value[CLOCK_DISPLAY_TIME_STRING_WORD];
+    // Draw the character at its position along the time.
+    CLOCK_DISPLAY_DRAW_CHAR(CLOCK_DISPLAY_TIME_X + position * CLOCK_DISPLAY_CHARACTER_PADDING_X, CLOCK_DISPLAY_TIME_Y, character, CLOCK_DISPLAY_COLOR, CLOCK_DISPLAY_BACKGROUND_COLOR, CLOCK_DISPLAY_TEXT_SIZE);
+}
 
-    // If we are doing a full word update (two characters).
-    if (full_word_update)
-    {
-        // If the position of the display is the hour position.
-        if (index == CLOCK_DISPLAY_TIME_STRING_HOUR)
-        {
-            // Set the output value to have a leading space instead of a 0.
-            sprintf(output_value, "%2hd", value);
-        }
+/*********************************************************************************/
+/* Function: clockDisplay_getDigits                                              */
+/* Purpose: To split the current time into the glyphs of its six digits, with a  */
+/*          blank instead of a leading 0 in the hour.                            */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+static void clockDisplay_getDigits(unsigned char digits[])
+{
+    // The hour, minute, and second in the order they are displayed.
+    int16_t fields[CLOCK_DISPLAY_FIELD_COUNT] = {clock_display_current_time_hour, clock_display_current_time_minute, clock_display_current_time_second};
 
-        // Otherwise, set the output value to have the leading 0.
-        else
-        {
-            sprintf(output_value, "%02hd", value);
-        }
+    // For loop used to iterate over the fields, writing the tens and then the ones digit of each.
+    for (int i = 0; i < CLOCK_DISPLAY_FIELD_COUNT; i++)
+    {
+        digits[i * CLOCK_DISPLAY_DIGITS_PER_FIELD] = '0' + fields[i] / CLOCK_DISPLAY_TIME_FIRST_DIGIT;
+        digits[i * CLOCK_DISPLAY_DIGITS_PER_FIELD + 1] = '0' + fields[i] % CLOCK_DISPLAY_TIME_FIRST_DIGIT;
     }
 
-    // Otherwise.
-    else
+    // If the hour is a single digit, leave its tens digit blank.
+    if (clock_display_current_time_hour < CLOCK_DISPLAY_TIME_FIRST_DIGIT)
     {
-        // Get the first digit of the display and add a leading space to it. Put that value in the output value.
-        value %= CLOCK_DISPLAY_TIME_FIRST_DIGIT;
-        sprintf(output_value, "%2hd", value);
+        digits[0] = CLOCK_DISPLAY_BLANK_DIGIT;
     }
-
-    // Put the output value into the actual character array.
-    puts(output_value);
-
-    // Set the text color to the passed color, set the cursor to the correct position, and then output the value calculated.
-    display_setTextColor(color);
-    display_setCursor((CLOCK_DISPLAY_TRIANGLE_CENTER_X + CLOCK_DISPLAY_FIRST_TRIANGLE_OFFSET*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) - CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH) + index * CLOCK_DISPLAY_CHARACTER_PADDING_X, (CLOCK_DISPLAY_HALF_DISPLAY - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT) + CLOCK_DISPLAY_CHARACTER_PADDING_Y);
-    display_print(output_value);
 }
 
 /*********************************************************************************/
@@ -138,17 +164,36 @@ void clockDisplay_reset()
     // Update the display to get any "last minute values" out.
     clockDisplay_updateTimeDisplay(true);
 
-    // Set the last time values to the current time values.
-    clock_display_last_time_hour = clock_display_current_time_hour;
-    clock_display_last_time_minute = clock_display_current_time_minute;
-    clock_display_last_time_second = clock_display_current_time_second;
-
     // Set the current time to the default values.
     clock_display_current_time_hour = CLOCK_DISPLAY_DEFAULT_HOUR;
     clock_display_current_time_minute = CLOCK_DISPLAY_DEFAULT_MINUTE;
     clock_display_current_time_second = CLOCK_DISPLAY_DEFAULT_SECOND;
 }
 
+/*********************************************************************************/
+/* Function: clockDisplay_getTime                                                */
+/* Purpose: To read the current time of the clock display.                       */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+void clockDisplay_getTime(int16_t* hour, int16_t* minute, int16_t* second)
+{
+    *hour = clock_display_current_time_hour;
+    *minute = clock_display_current_time_minute;
+    *second = clock_display_current_time_second;
+}
+
+/*********************************************************************************/
+/* Function: clockDisplay_setTime                                                */
+/* Purpose: To set the current time of the clock display.                        */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+void clockDisplay_setTime(int16_t hour, int16_t minute, int16_t second)
+{
+    clock_display_current_time_hour = hour;
+    clock_display_current_time_minute = minute;
+    clock_display_current_time_second = second;
+}
+
 /*********************************************************************************/
 /* Function: mod                                                                 */
 /* Purpose: To get the modulus of two numbers and handling negative values.      */
@@ -267,30 +312,31 @@ void clockDisplay_inc_dec_hour(bool increment)
 /*********************************************************************************/
 void clockDisplay_init()
 {
-    // Create a character array containing an initial time string.
-    char initial_time[CLOCK_DISPLAY_TIME_STRING_SIZE];
-
-    // Init the display, fill the screen with black, set the text color, then set the text size.
+    // Init the display and fill the screen with black.
     display_init();
-    display_fillScreen(CLOCK_DISPLAY_BACKGROUND_COLOR);
-    display_setTextColor(CLOCK_DISPLAY_COLOR);
-    display_setTextSize(CLOCK_DISPLAY_TEXT_SIZE);
+#ifdef CLOCK_DISPLAY_COMPOSITOR_ENABLED
+    compositor_init();
+#endif
+    CLOCK_DISPLAY_FILL_SCREEN(CLOCK_DISPLAY_BACKGROUND_COLOR);
 
-    // Prepare the initial time with the default time and then set that character array.
-    sprintf(initial_time, "%2hd:%02hd:%02hd", clock_display_current_time_hour, clock_display_current_time_minute, clock_display_current_time_second);
-    puts(initial_time);
+    CLOCK_DISPLAY_LOG("clockDisplay: %2ld:%02ld:%02ld\n\r", (long) clock_display_current_time_hour,
+                      (long) clock_display_current_time_minute, (long) clock_display_current_time_second);
 
-    // Set the cursor to the position necessary to start writing the time, then print the time out to the screen.
-    display_setCursor(CLOCK_DISPLAY_TRIANGLE_CENTER_X + CLOCK_DISPLAY_FIRST_TRIANGLE_OFFSET*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) - CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, (CLOCK_DISPLAY_HALF_DISPLAY - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT) + CLOCK_DISPLAY_CHARACTER_PADDING_Y);
-    display_print(initial_time);
+    // Draw the two colons, which never change, then every digit of the time.
+    clockDisplay_drawCharacter(CLOCK_DISPLAY_TIME_STRING_MINUTE - 1, CLOCK_DISPLAY_COLON);
+    clockDisplay_drawCharacter(CLOCK_DISPLAY_TIME_STRING_SECOND - 1, CLOCK_DISPLAY_COLON);
+    clockDisplay_updateTimeDisplay(true);
 
     // For loop used to iterate over the indexes of the triangles.
     for (int i = CLOCK_DISPLAY_FIRST_TRIANGLE_OFFSET; i <= CLOCK_DISPLAY_LAST_TRIANGLE_OFFSET; i++)
     {
         // Output the triangle to the display based on the current index in the for loop.
-        display_fillTriangle(CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X), CLOCK_DISPLAY_TRIANGLE_CENTER_Y - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT - CLOCK_DISPLAY_PADDING_Y - CLOCK_DISPLAY_TRIANGLE_HEIGHT, CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) - CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, CLOCK_DISPLAY_TRIANGLE_CENTER_Y - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT, CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) + CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, CLOCK_DISPLAY_TRIANGLE_CENTER_Y - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT, CLOCK_DISPLAY_COLOR);
-        display_fillTriangle(CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X), CLOCK_DISPLAY_TRIANGLE_CENTER_Y + CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT + CLOCK_DISPLAY_PADDING_Y + CLOCK_DISPLAY_TRIANGLE_HEIGHT, CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) - CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, CLOCK_DISPLAY_TRIANGLE_CENTER_Y + CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT, CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) + CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, CLOCK_DISPLAY_TRIANGLE_CENTER_Y + CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT, CLOCK_DISPLAY_COLOR);
+        CLOCK_DISPLAY_FILL_TRIANGLE(CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X), CLOCK_DISPLAY_TRIANGLE_CENTER_Y - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT - CLOCK_DISPLAY_PADDING_Y - CLOCK_DISPLAY_TRIANGLE_HEIGHT, CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) - CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, CLOCK_DISPLAY_TRIANGLE_CENTER_Y - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT, CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) + CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, CLOCK_DISPLAY_TRIANGLE_CENTER_Y - CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT, CLOCK_DISPLAY_COLOR);
+        CLOCK_DISPLAY_FILL_TRIANGLE(CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X), CLOCK_DISPLAY_TRIANGLE_CENTER_Y + CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT + CLOCK_DISPLAY_PADDING_Y + CLOCK_DISPLAY_TRIANGLE_HEIGHT, CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) - CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, CLOCK_DISPLAY_TRIANGLE_CENTER_Y + CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT, CLOCK_DISPLAY_TRIANGLE_CENTER_X + i*(CLOCK_DISPLAY_TRIANGLE_WIDTH + CLOCK_DISPLAY_PADDING_X) + CLOCK_DISPLAY_TRIANGLE_HALF_WIDTH, CLOCK_DISPLAY_TRIANGLE_CENTER_Y + CLOCK_DISPLAY_CHARACTER_HALF_HEIGHT, CLOCK_DISPLAY_COLOR);
     }
+
+    // Send the finished screen to the display.
+    CLOCK_DISPLAY_FLUSH();
 }
 
 /*********************************************************************************/
@@ -300,90 +346,28 @@ void clockDisplay_init()
 /*********************************************************************************/
 void clockDisplay_updateTimeDisplay(bool forceUpdateAll)
 {
-    // If the forceUpdateAll flag has been set to true.
-    if (forceUpdateAll)
-    {
-        // Do a full update on the hour (black then green).
-        clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_HOUR, clock_display_last_time_hour, CLOCK_DISPLAY_BACKGROUND_COLOR, true);
-        clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_HOUR, clock_display_current_time_hour, CLOCK_DISPLAY_COLOR, true);
+    // Split the current time into its digits.
+    unsigned char digits[CLOCK_DISPLAY_DIGIT_COUNT];
+    clockDisplay_getDigits(digits);
 
-        // Do a full update on the minute (black then green).
-        clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_MINUTE, clock_display_last_time_minute, CLOCK_DISPLAY_BACKGROUND_COLOR, true);
-        clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_MINUTE, clock_display_current_time_minute, CLOCK_DISPLAY_COLOR, true);
-
-        // Do a full update on teh second (black then green).
-        clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_SECOND, clock_display_last_time_second, CLOCK_DISPLAY_BACKGROUND_COLOR, true);
-        clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_SECOND, clock_display_current_time_second, CLOCK_DISPLAY_COLOR, true);
-    }
-
-    // Otherwise, if any of the times are different than the previous times.
-    else if ((clock_display_current_time_hour != clock_display_last_time_hour) || (clock_display_current_time_minute != clock_display_last_time_minute) || (clock_display_current_time_second != clock_display_last_time_second))
+    // For loop used to iterate over the digits, drawing each one that differs from what is on the display (or all of them when forced).
+    for (int i = 0; i < CLOCK_DISPLAY_DIGIT_COUNT; i++)
     {
-        // If the current hour is not equal to the previous hour.
-        if (clock_display_current_time_hour != clock_display_last_time_hour)
+        // If this digit has not changed, leave it alone.
+        if (!forceUpdateAll && digits[i] == clockDisplay_shownDigits[i])
         {
-            // If the first digit in the hour has changed.
-            if (clock_display_current_time_hour / CLOCK_DISPLAY_TIME_FIRST_DIGIT != clock_display_last_time_hour / CLOCK_DISPLAY_TIME_FIRST_DIGIT)
-            {
-                // Do a full update on the hour to the display (black then green).
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_HOUR, clock_display_last_time_hour, CLOCK_DISPLAY_BACKGROUND_COLOR, true);
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_HOUR, clock_display_current_time_hour, CLOCK_DISPLAY_COLOR, true);
-            }
-
-            // Otherwise.
-            else
-            {
-                // Only update the second character as it is the only one that has changed (black then green).
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_HOUR, clock_display_last_time_hour, CLOCK_DISPLAY_BACKGROUND_COLOR, false);
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_HOUR, clock_display_current_time_hour, CLOCK_DISPLAY_COLOR, false);
-            }
+            continue;
         }
 
-        // If the current minute is not equal to the previous minute.
-        if (clock_display_current_time_minute != clock_display_last_time_minute)
-        {
-            // If the first digit in the minute has changed.
-            if (clock_display_current_time_minute / CLOCK_DISPLAY_TIME_FIRST_DIGIT != clock_display_last_time_minute / CLOCK_DISPLAY_TIME_FIRST_DIGIT)
-            {
-                // Do a full update on the minute to the display (black then green).
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_MINUTE, clock_display_last_time_minute, CLOCK_DISPLAY_BACKGROUND_COLOR, true);
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_MINUTE, clock_display_current_time_minute, CLOCK_DISPLAY_COLOR, true);
-            }
-
-            // Otherwise.
-            else
-            {
-                // Only update the second character as it is the only one that has changed (black then green).
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_MINUTE, clock_display_last_time_minute, CLOCK_DISPLAY_BACKGROUND_COLOR, false);
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_MINUTE, clock_display_current_time_minute, CLOCK_DISPLAY_COLOR, false);
-            }
-        }
-
-        // If the current second is not equal to the previous second.
-        if (clock_display_current_time_second != clock_display_last_time_second)
-        {
-            // If the first digit in the second has changed.
-            if (clock_display_current_time_second / CLOCK_DISPLAY_TIME_FIRST_DIGIT != clock_display_last_time_second / CLOCK_DISPLAY_TIME_FIRST_DIGIT)
-            {
-                // Do a full update on the second to the display (black then green).
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_SECOND, clock_display_last_time_second, CLOCK_DISPLAY_BACKGROUND_COLOR, true);
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_SECOND, clock_display_current_time_second, CLOCK_DISPLAY_COLOR, true);
-            }
-
-            // Otherwise.
-            else
-            {
-                // Only update the second character as it is the only one that has changed (black then green).
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_SECOND, clock_display_last_time_second, CLOCK_DISPLAY_BACKGROUND_COLOR, false);
-                clockDisplay_print_time(CLOCK_DISPLAY_TIME_STRING_SECOND, clock_display_current_time_second, CLOCK_DISPLAY_COLOR, false);
-            }
-        }
+        // Log the digit being drawn and where, then draw it over the old one.
+        int16_t position = clockDisplay_fieldPositions[i / CLOCK_DISPLAY_DIGITS_PER_FIELD] + i % CLOCK_DISPLAY_DIGITS_PER_FIELD;
+        CLOCK_DISPLAY_LOG("clockDisplay: glyph %ld at %ld\n\r", (long) digits[i], (long) position);
+        clockDisplay_drawCharacter(position, digits[i]);
+        clockDisplay_shownDigits[i] = digits[i];
     }
 
-    // Set the previous times to the current times.
-    clock_display_last_time_second = clock_display_current_time_second;
-    clock_display_last_time_minute = clock_display_current_time_minute;
-    clock_display_last_time_hour = clock_display_current_time_hour;
+    // Send the changed digits to the display.
+    CLOCK_DISPLAY_FLUSH();
 }
 
 /*********************************************************************************/
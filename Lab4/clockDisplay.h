@@ -1,6 +1,17 @@
 #ifndef CLOCKDISPLAY_H_
 #define CLOCKDISPLAY_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+
+// Uncomment to draw through the compositor (Common/compositor.h): a redrawn digit only sends the
+// pixels that actually changed. Otherwise each changed digit is one transfer of its cell from the
+// glyph cache (Common/glyphCache.h).
+//#define CLOCK_DISPLAY_COMPOSITOR_ENABLED
+
+// Uncomment to log each value drawn (with DEFERRED_LOG_ENABLED, see Common/deferredLog.h).
+//#define CLOCK_DISPLAY_LOG_ENABLED
+
 // Called only once - performs any necessary inits.
 // This is a good place to draw the triangles and any other
 // parts of the clock display that will never change.
@@ -18,6 +29,12 @@ void clockDisplay_performIncDec();
 // Advances the time forward by 1 second and update the display.
 void clockDisplay_advanceTimeOneSecond();
 
+// Reads the time the display holds (what the next update draws).
+void clockDisplay_getTime(int16_t* hour, int16_t* minute, int16_t* second);
+
+// Sets the time the display holds; call clockDisplay_updateTimeDisplay() to draw it.
+void clockDisplay_setTime(int16_t hour, int16_t minute, int16_t second);
+
 // Run a test of clock-display functions.
 void clockDisplay_runTest();
 
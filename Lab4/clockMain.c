@@ -10,6 +10,7 @@
 #include "clockControl.h"
 #include "clockDisplay.h"
 #include "supportFiles/display.h"
+#include "deferredLog.h"
 
 #include "xparameters.h"
 
@@ -18,6 +19,8 @@
 // in the Cortex-A9 MPCore Technical Reference Manual 4-2.
 // Assuming that the prescaler = 0, the formula for computing the load value based upon the desired period is:
 // load-value = (period * timer-clock) - 1
+// The clock keeps time from the global timer (clockTime.c), so this period only sets how often
+// the touch panel is polled: a missed or late tick no longer costs the clock any time.
 #define TIMER_PERIOD 50.0E-3 // You can change this value to a value that you select.
 #define TIMER_CLOCK_FREQUENCY (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
 #define TIMER_LOAD_VALUE ((TIMER_PERIOD * TIMER_CLOCK_FREQUENCY) - 1.0)
@@ -52,9 +55,12 @@ int main()
         personalInterruptCount++;
         clockControl_tick();
           interrupts_isrFlagGlobal = 0;
+      } else {
+        deferredLog_drain(stdout, 1);  // Between ticks, print a logged state change (if CLOCK_CONTROL_LOG_ENABLED).
       }
    }
    interrupts_disableArmInts();
+   deferredLog_drain(stdout, DEFERRED_LOG_DRAIN_ALL);
    printf("isr invocation count: %ld\n\r", interrupts_isrInvocationCount());
    printf("internal interrupt count: %ld\n\r", personalInterruptCount);
    return 0;
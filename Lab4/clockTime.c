@@ -0,0 +1,120 @@
+/*********************************************************************************/
+/* File: clockTime.c                                                             */
+/* Purpose: To keep the clock's time from the global timer instead of counting   */
+/*          state machine ticks (see clockTime.h).                               */
+/*********************************************************************************/
+
+// Required includes for the program.
+#include "clockTime.h"
+
+// Required defines for the lengths of the units of time.
+#define CLOCK_TIME_SECONDS_PER_MINUTE 60
+#define CLOCK_TIME_SECONDS_PER_HOUR 3600
+#define CLOCK_TIME_HOURS_PER_CYCLE 12
+#define CLOCK_TIME_SECONDS_PER_CYCLE (CLOCK_TIME_HOURS_PER_CYCLE * CLOCK_TIME_SECONDS_PER_HOUR)
+
+// The global timer value at the start of a second, and the time of day (seconds past 12:00:00) at that moment.
+static XTime clockTime_epoch;
+static uint32_t clockTime_epochSeconds;
+static bool clockTime_running = false;
+
+/*********************************************************************************/
+/* Function: clockTime_toSeconds                                                 */
+/* Purpose: To convert a time to seconds past 12:00:00 (12 counts as 0).         */
+/* Returns: The seconds into the twelve hour cycle.                              */
+/*********************************************************************************/
+static uint32_t clockTime_toSeconds(int16_t hour, int16_t minute, int16_t second)
+{
+    return (hour % CLOCK_TIME_HOURS_PER_CYCLE) * CLOCK_TIME_SECONDS_PER_HOUR + minute * CLOCK_TIME_SECONDS_PER_MINUTE + second;
+}
+
+/*********************************************************************************/
+/* Function: clockTime_elapsedSeconds                                            */
+/* Purpose: To find how many whole seconds have passed since the epoch at the    */
+/*          global timer value now.                                              */
+/* Returns: The number of whole seconds.                                         */
+/*********************************************************************************/
+static uint64_t clockTime_elapsedSeconds(XTime now)
+{
+    return (now - clockTime_epoch) / COUNTS_PER_SECOND;
+}
+
+/*********************************************************************************/
+/* Function: clockTime_now                                                       */
+/* Purpose: To read the global timer.                                            */
+/* Returns: The global timer value.                                              */
+/*********************************************************************************/
+static XTime clockTime_now()
+{
+    XTime now;
+    XTime_GetTime(&now);
+    return now;
+}
+
+void clockTime_start(int16_t hour, int16_t minute, int16_t second)
+{
+    // The second starts now.
+    XTime_GetTime(&clockTime_epoch);
+    clockTime_epochSeconds = clockTime_toSeconds(hour, minute, second);
+    clockTime_running = true;
+}
+
+/*********************************************************************************/
+/* Function: clockTime_set                                                       */
+/* Purpose: To set the time, moving the epoch up to the start of the current     */
+/*          second so the second boundaries stay where they were.                */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+void clockTime_set(int16_t hour, int16_t minute, int16_t second)
+{
+    // If the clock is not running yet, there are no second boundaries to keep.
+    if (!clockTime_running)
+    {
+        clockTime_start(hour, minute, second);
+        return;
+    }
+
+    // Move the epoch up by whole seconds, then give it the new time.
+    clockTime_epoch += clockTime_elapsedSeconds(clockTime_now()) * COUNTS_PER_SECOND;
+    clockTime_epochSeconds = clockTime_toSeconds(hour, minute, second);
+}
+
+bool clockTime_isRunning()
+{
+    return clockTime_running;
+}
+
+void clockTime_get(int16_t* hour, int16_t* minute, int16_t* second)
+{
+    XTime nextSecond;
+    clockTime_getWithNextSecond(hour, minute, second, &nextSecond);
+}
+
+/*********************************************************************************/
+/* Function: clockTime_getWithNextSecond                                         */
+/* Purpose: To work out the time of day from the seconds since the epoch, and    */
+/*          when the next second begins, from one reading of the global timer.   */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+void clockTime_getWithNextSecond(int16_t* hour, int16_t* minute, int16_t* second, XTime* nextSecond)
+{
+    uint64_t elapsedSeconds = clockTime_elapsedSeconds(clockTime_now());
+    *nextSecond = clockTime_epoch + (elapsedSeconds + 1) * COUNTS_PER_SECOND;
+
+    // Find the seconds into the twelve hour cycle, then split them into the hour, minute, and second.
+    uint32_t seconds = (clockTime_epochSeconds + elapsedSeconds) % CLOCK_TIME_SECONDS_PER_CYCLE;
+    *hour = seconds / CLOCK_TIME_SECONDS_PER_HOUR;
+    *minute = seconds % CLOCK_TIME_SECONDS_PER_HOUR / CLOCK_TIME_SECONDS_PER_MINUTE;
+    *second = seconds % CLOCK_TIME_SECONDS_PER_MINUTE;
+
+    // If the hour is 0, it is shown as 12.
+    if (*hour == 0)
+    {
+        *hour = CLOCK_TIME_HOURS_PER_CYCLE;
+    }
+}
+
+XTime clockTime_nextSecond()
+{
+    return clockTime_epoch + (clockTime_elapsedSeconds(clockTime_now()) + 1) * COUNTS_PER_SECOND;
+}
@@ -0,0 +1,33 @@
+#ifndef CLOCKTIME_H_
+#define CLOCKTIME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "xtime_l.h"
+
+// Timekeeping for the clock, read from the free-running 64-bit global timer (XTime_GetTime()).
+// Setting the time records the timer value as an epoch; the time of day is worked out from the
+// timer whenever it is asked for, so a late or missed tick never makes the clock lose time.
+// The global timer wraps after centuries, so elapsed time is never ambiguous.
+
+// Starts the clock at hour:minute:second (hour 1 - 12).
+void clockTime_start(int16_t hour, int16_t minute, int16_t second);
+
+// Sets the clock to hour:minute:second without moving its second boundaries, so setting the
+// time while it runs does not shorten or stretch the second under way.
+void clockTime_set(int16_t hour, int16_t minute, int16_t second);
+
+// Returns true once clockTime_start() has been called.
+bool clockTime_isRunning();
+
+// Reads the current time (hour 1 - 12).
+void clockTime_get(int16_t* hour, int16_t* minute, int16_t* second);
+
+// Reads the current time like clockTime_get() and the global timer value at which the next second
+// begins, both from the same reading of the timer, so the deadline always follows the time returned.
+void clockTime_getWithNextSecond(int16_t* hour, int16_t* minute, int16_t* second, XTime* nextSecond);
+
+// Returns the global timer value at which the next second begins.
+XTime clockTime_nextSecond();
+
+#endif /* CLOCKTIME_H_ */
@@ -12,6 +12,14 @@
 #include "supportFiles/display.h"
 #include <stdbool.h>
 #include <stdio.h>
+#include "deferredLog.h"
+
+// ticTacToeControl_debug_print() goes to the deferred log (Common/deferredLog.h), if TIC_TAC_TOE_CONTROL_LOG_ENABLED.
+#if defined(DEFERRED_LOG_ENABLED) && defined(TIC_TAC_TOE_CONTROL_LOG_ENABLED)
+#define TIC_TAC_TOE_CONTROL_LOG DEFERRED_LOG
+#else
+#define TIC_TAC_TOE_CONTROL_LOG(...)
+#endif
 
 // Necessary defines to control the timing of the state machine.
 #define TIC_TAC_TOE_CONTROL_START_TIME_COUNTER_MAX 40
@@ -108,61 +116,61 @@ void ticTacToeControl_debug_print()
         {
             // If we are in the start state, then output that result to the user.
             case ticTacToeControl_start_st:
-                printf("start_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("start_st\n\r");
                 break;
 
             // Otherwise, if we are in the intro init state, then output that result to the user.
             case ticTacToeControl_intro_init_st:
-                printf("intro_init_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("intro_init_st\n\r");
                 break;
 
             // Otherwise, if we are in the intro state, then output that result to the user.
             case ticTacToeControl_intro_st:
-                printf("intro_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("intro_st\n\r");
                 break;
 
             // Otherwise, if we are in the intro uninit state, then output that result to the user.
             case ticTacToeControl_intro_uninit_st:
-                printf("intro_uninit_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("intro_uninit_st\n\r");
 
             // Otherwise, if we are in the init state, then output that result to the user.
             case ticTacToeControl_init_st:
-                printf("init_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("init_st\n\r");
                 break;
 
             // Otherwise, if we are in the game start state, then output that result to the user.
             case ticTacToeControl_game_start_st:
-                printf("game_start_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("game_start_st\n\r");
                 break;
 
             // Otherwise, if we are in the minimax state, then output that result to the user.
             case ticTacToeControl_minimax_st:
-                printf("minimax_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("minimax_st\n\r");
                 break;
 
             // Otherwise, if we are in the mark computer state, then output that result to the user.
             case ticTacToeControl_mark_computer_st:
-                printf("mark_computer_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("mark_computer_st\n\r");
                 break;
 
             // Otherwise, if we are in the game over state, then output that result to the user.
             case ticTacToeControl_game_over_st:
-                printf("game_over_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("game_over_st\n\r");
                 break;
 
             // Otherwise, if we are in the wait for touch state, then output that result to the user.
             case ticTacToeControl_wait_for_touch_st:
-                printf("wait_for_touch_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("wait_for_touch_st\n\r");
                 break;
 
             // Otherwise, if we are in the wait adc state, then output that result to the user.
             case ticTacToeControl_wait_adc_st:
-                printf("wait_adc_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("wait_adc_st\n\r");
                 break;
 
             // Otherwise, if we are in the already marked plahyer state, then output that result to the user.
             case ticTacToeControl_is_already_marked_player_st:
-                printf("is_already_marked_st\n\r");
+                TIC_TAC_TOE_CONTROL_LOG("is_already_marked_st\n\r");
                 break;
      }
   }
@@ -7,6 +7,9 @@
 #ifndef TICTACTOECONTROL_H_
 #define TICTACTOECONTROL_H_
 
+// Uncomment to log the game's state changes (with DEFERRED_LOG_ENABLED, see Common/deferredLog.h).
+//#define TIC_TAC_TOE_CONTROL_LOG_ENABLED
+
 /*********************************************************************************/
 /* Function: ticTacToeControl_tick                                               */
 /* Purpose: To run a "tick" for the tic-tac-toe state machine. This runs through */
@@ -7,8 +7,10 @@
 /*********************************************************************************/
 #include "ticTacToeDisplay.h"
 #include "supportFiles/display.h"
-#include "../lab2/buttons.h"
-#include "../lab2/switches.h"
+#include "touchGrid.h"
+#include "sprite.h"
+#include "../Lab2/buttons.h"
+#include "../Lab2/switches.h"
 #include "supportFiles/utils.h"
 #include <math.h>
 
@@ -41,6 +43,12 @@
 #define TIC_TAC_TOE_DISPLAY_CHARACTER_RADIUS TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / 2 - TIC_TAC_TOE_DISPLAY_PADDING
 #define TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT ((TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT - 4 * TIC_TAC_TOE_DISPLAY_PADDING) / 2) * sqrt(2.0)
 
+// Necessary defines to size the X and O sprites. The X's lines end a truncated CHARACTER_WIDTH_HEIGHT from the center, one pixel further on the left and top.
+#define TIC_TAC_TOE_DISPLAY_X_SPRITE_CENTER ((int16_t) (TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT) + 1)
+#define TIC_TAC_TOE_DISPLAY_X_SPRITE_SIZE (2 * TIC_TAC_TOE_DISPLAY_X_SPRITE_CENTER)
+#define TIC_TAC_TOE_DISPLAY_O_SPRITE_CENTER (TIC_TAC_TOE_DISPLAY_CHARACTER_RADIUS)
+#define TIC_TAC_TOE_DISPLAY_O_SPRITE_SIZE (2 * TIC_TAC_TOE_DISPLAY_O_SPRITE_CENTER + 1)
+
 // Necessary defines to set the text size and padding.
 #define TIC_TAC_TOE_DISPLAY_TEXT_SIZE 5
 #define TIC_TAC_TOE_DISPLAY_TEXT_PADDING 15
@@ -51,6 +59,40 @@
 #define TIC_TAC_TOE_DISPLAY_IS_O 0b0001
 #define TIC_TAC_TOE_DISPLAY_TOUCH_DELAY 50
 
+// Static global variable holding the touch grid of the squares (see Common/touchGrid.h): each square's region is its row times the number of columns plus its column.
+static touchGrid_t ticTacToeDisplay_touchGrid;
+
+// Static global variables holding the X and O pre-rendered once in init (see Common/sprite.h).
+static uint16_t ticTacToeDisplay_xPixels[TIC_TAC_TOE_DISPLAY_X_SPRITE_SIZE * TIC_TAC_TOE_DISPLAY_X_SPRITE_SIZE];
+static uint16_t ticTacToeDisplay_oPixels[TIC_TAC_TOE_DISPLAY_O_SPRITE_SIZE * TIC_TAC_TOE_DISPLAY_O_SPRITE_SIZE];
+static sprite_t ticTacToeDisplay_xSprite;
+static sprite_t ticTacToeDisplay_oSprite;
+
+/*********************************************************************************/
+/* Function: ticTacToeDisplay_drawCharacter                                      */
+/* Purpose: To draw a character's sprite centered in the square at the row and   */
+/*          column, or to erase its box with the background color.               */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+static void ticTacToeDisplay_drawCharacter(const sprite_t* sprite, int16_t center, uint8_t row, uint8_t column, bool erase)
+{
+    // Find the top-left corner of the sprite's box from the center of the square.
+    int16_t x = (column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF - center;
+    int16_t y = (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF - center;
+
+    // If the erase flag is set, clear the whole box: nothing else is drawn inside it.
+    if (erase)
+    {
+        display_fillRect(x, y, sprite->width, sprite->height, TIC_TAC_TOE_DISPLAY_BACKGROUND_COLOR);
+    }
+
+    // Otherwise, send the sprite as one transfer.
+    else
+    {
+        sprite_draw(sprite, x, y);
+    }
+}
+
 /*********************************************************************************/
 /* Function: ticTacToeDisplay_init                                               */
 /* Purpose: To initialize the LCD display in order to use it for the game.       */
@@ -66,6 +108,32 @@ void ticTacToeDisplay_init()
     display_setTextSize(TIC_TAC_TOE_DISPLAY_TEXT_SIZE);
     display_setTextColor(TIC_TAC_TOE_DISPLAY_GAME_COLOR);
     display_setCursor(TIC_TAC_TOE_DISPLAY_ABSOLUTE_LEFT + TIC_TAC_TOE_DISPLAY_TEXT_PADDING, TIC_TAC_TOE_DISPLAY_HEIGHT_HALF);
+
+    // Render the X as four lines spanning out at 45 degree angles from the center of its sprite.
+    raster_surface_t surface;
+    int16_t center = TIC_TAC_TOE_DISPLAY_X_SPRITE_CENTER;
+    sprite_init(&ticTacToeDisplay_xSprite, ticTacToeDisplay_xPixels, TIC_TAC_TOE_DISPLAY_X_SPRITE_SIZE, TIC_TAC_TOE_DISPLAY_X_SPRITE_SIZE, TIC_TAC_TOE_DISPLAY_BACKGROUND_COLOR, &surface);
+    raster_drawLine(&surface, center, center, center - TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, center + TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, TIC_TAC_TOE_DISPLAY_GAME_COLOR);
+    raster_drawLine(&surface, center, center, center - TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, center - TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, TIC_TAC_TOE_DISPLAY_GAME_COLOR);
+    raster_drawLine(&surface, center, center, center + TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, center + TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, TIC_TAC_TOE_DISPLAY_GAME_COLOR);
+    raster_drawLine(&surface, center, center, center + TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, center - TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, TIC_TAC_TOE_DISPLAY_GAME_COLOR);
+
+    // Render the O as a circle around the center of its sprite.
+    center = TIC_TAC_TOE_DISPLAY_O_SPRITE_CENTER;
+    sprite_init(&ticTacToeDisplay_oSprite, ticTacToeDisplay_oPixels, TIC_TAC_TOE_DISPLAY_O_SPRITE_SIZE, TIC_TAC_TOE_DISPLAY_O_SPRITE_SIZE, TIC_TAC_TOE_DISPLAY_BACKGROUND_COLOR, &surface);
+    raster_drawCircle(&surface, center, center, TIC_TAC_TOE_DISPLAY_CHARACTER_RADIUS, TIC_TAC_TOE_DISPLAY_GAME_COLOR);
+
+    // Add every square to the touch grid, each one reaching up to where the next row and column start.
+    touchGrid_init(&ticTacToeDisplay_touchGrid);
+    for (uint8_t y = TIC_TAC_TOE_DISPLAY_DEFAULT_SQUARE; y < TIC_TAC_TOE_DISPLAY_ROWS; y++)
+    {
+        for (uint8_t x = TIC_TAC_TOE_DISPLAY_DEFAULT_SQUARE; x < TIC_TAC_TOE_DISPLAY_COLUMNS; x++)
+        {
+            int16_t left = x * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH;
+            int16_t top = y * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT;
+            touchGrid_addRect(&ticTacToeDisplay_touchGrid, left, top, (x + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH - left, (y + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT - top, y * TIC_TAC_TOE_DISPLAY_COLUMNS + x);
+        }
+    }
 }
 
 /*********************************************************************************/
@@ -95,20 +163,8 @@ void ticTacToeDisplay_reset()
 /*********************************************************************************/
 void ticTacToeDisplay_drawX(uint8_t row, uint8_t column, bool erase)
 {
-    // Set the text color.
-    uint16_t color = TIC_TAC_TOE_DISPLAY_GAME_COLOR;
-
-    // If the erase flag is set, then change the text color to the background color.
-    if (erase)
-    {
-        color = TIC_TAC_TOE_DISPLAY_BACKGROUND_COLOR;
-    }
-
-    // Draw an X on the screen by drawing four lines centered at the middle of the row and column specified and spanning out at 45 degree angles.
-    display_drawLine((column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF, (column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF - TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF + TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, color);
-    display_drawLine((column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF, (column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF - TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF - TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, color);
-    display_drawLine((column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF, (column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF + TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF + TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, color);
-    display_drawLine((column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF, (column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF + TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF - TIC_TAC_TOE_DISPLAY_CHARACTER_WIDTH_HEIGHT, color);
+    // Draw (or erase) the X sprite centered in the square at the row and column specified.
+    ticTacToeDisplay_drawCharacter(&ticTacToeDisplay_xSprite, TIC_TAC_TOE_DISPLAY_X_SPRITE_CENTER, row, column, erase);
 }
 
 /*********************************************************************************/
@@ -118,17 +174,8 @@ void ticTacToeDisplay_drawX(uint8_t row, uint8_t column, bool erase)
 /*********************************************************************************/
 void ticTacToeDisplay_drawO(uint8_t row, uint8_t column, bool erase)
 {
-    // Set the text color.
-    uint16_t color = TIC_TAC_TOE_DISPLAY_GAME_COLOR;
-
-    // If the erase flag is set, then change the text color to the background color.
-    if (erase)
-    {
-        color = TIC_TAC_TOE_DISPLAY_BACKGROUND_COLOR;
-    }
-
-    // Draw an O on the screen by drawing a circle that radiates out from the center of the speicified square at the row and column passed.
-    display_drawCircle((column % TIC_TAC_TOE_DISPLAY_COLUMNS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH + TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH / TIC_TAC_TOE_DISPLAY_COLUMNS_HALF, (row % TIC_TAC_TOE_DISPLAY_ROWS + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE / TIC_TAC_TOE_DISPLAY_ROWS_HALF) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT + TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT / TIC_TAC_TOE_DISPLAY_ROWS_HALF, TIC_TAC_TOE_DISPLAY_CHARACTER_RADIUS, color);
+    // Draw (or erase) the O sprite centered in the square at the row and column specified.
+    ticTacToeDisplay_drawCharacter(&ticTacToeDisplay_oSprite, TIC_TAC_TOE_DISPLAY_O_SPRITE_CENTER, row, column, erase);
 }
 
 /*********************************************************************************/
@@ -146,27 +193,10 @@ void ticTacToeDisplay_touchScreenComputeBoardRowColumn(uint8_t* row, uint8_t* co
     // Get the touched points from the display.
     display_getTouchedPoint(&display_touch_x, &display_touch_y, &display_touch_intensity);
 
-    // For every row (y) in the tic-tac-toe display.
-    for (uint8_t y = TIC_TAC_TOE_DISPLAY_DEFAULT_SQUARE; y < TIC_TAC_TOE_DISPLAY_ROWS; y++)
-    {
-        // If the touched point is less than the specified row (starting at the next square), set the row to that value and break the loop.
-        if (display_touch_y < ((y + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE) * TIC_TAC_TOE_DISPLAY_SQUARE_HEIGHT))
-        {
-            *row = y;
-            break;
-        }
-    }
-
-    // For every column (x) in the tic-tac-toe display.
-    for (uint8_t x = TIC_TAC_TOE_DISPLAY_DEFAULT_SQUARE; x < TIC_TAC_TOE_DISPLAY_COLUMNS; x++)
-    {
-        // If the touched point is less than the specified column (starting at the next square), set the column to that value and break the loop.
-        if (display_touch_x < ((x + TIC_TAC_TOE_DISPLAY_NEXT_SQUARE) * TIC_TAC_TOE_DISPLAY_SQUARE_WIDTH))
-        {
-            *column = x;
-            break;
-        }
-    }
+    // Look the touched square up in the touch grid, then split its region into the row and column.
+    touchGrid_region_t square = touchGrid_lookup(&ticTacToeDisplay_touchGrid, display_touch_x, display_touch_y);
+    *row = square / TIC_TAC_TOE_DISPLAY_COLUMNS;
+    *column = square % TIC_TAC_TOE_DISPLAY_COLUMNS;
 }
 
 /*********************************************************************************/
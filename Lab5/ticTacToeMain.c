@@ -10,6 +10,7 @@
 #include "ticTacToeControl.h"
 #include "ticTacToeDisplay.h"
 #include "supportFiles/display.h"
+#include "deferredLog.h"
 
 #include "xparameters.h"
 
@@ -54,6 +55,8 @@ int main() {
             personalInterruptCount++;
             ticTacToeControl_tick();
             interrupts_isrFlagGlobal = 0;
+        } else {
+            deferredLog_drain(stdout, 1);   // One logged record per idle pass keeps the next tick on time.
         }
     }
     interrupts_disableArmInts();
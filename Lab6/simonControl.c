@@ -16,6 +16,14 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "deferredLog.h"
+
+// simonControl_debug_print() goes to the deferred log (Common/deferredLog.h), if SIMON_CONTROL_LOG_ENABLED.
+#if defined(DEFERRED_LOG_ENABLED) && defined(SIMON_CONTROL_LOG_ENABLED)
+#define SIMON_CONTROL_LOG DEFERRED_LOG
+#else
+#define SIMON_CONTROL_LOG(...)
+#endif
 
 // Necessary defines to set the maximum timer wait length.
 #define SIMON_CONTROL_ADC_WAIT_TIME 1
@@ -128,57 +136,57 @@ void simonControl_debug_print()
         {
             // If we are in the start state, then output that result to the user.
             case simonControl_start_st:
-                printf("simonControl_start_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_start_st\n\r");
                 break;
 
             // Otherwise, if we are in the splash screen state, then output that result to the user.
             case simonControl_splash_screen_st:
-                printf("simonControl_splash_screen_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_splash_screen_st\n\r");
                 break;
 
             // Otherwise, if we are in the splash screen wait ADC state, then output that result to the user.
             case simonControl_splash_screen_wait_adc_st:
-                printf("simonControl_splash_screen_wait_adc_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_splash_screen_wait_adc_st\n\r");
                 break;
 
             // Otherwise, if we are in the init state, then output that result to the user.
             case simonControl_init_st:
-                printf("simonControl_init_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_init_st\n\r");
                 break;
 
             // Otherwise, if we are in the wait flash sequence state, then output that result to the user.
             case simonControl_wait_flash_sequence_st:
-                printf("simonControl_wait_flash_sequence_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_wait_flash_sequence_st\n\r");
                 break;
 
             // Otherwise, if we are in the wait verify sequence state, then output that result to the user.
             case simonControl_wait_verify_sequence_st:
-                printf("simonControl_wait_verify_sequence_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_wait_verify_sequence_st\n\r");
                 break;
 
             // Otherwise, if we are in the is game over state, then output that result to the user.
             case simonControl_is_game_over_st:
-                printf("simonControl_is_game_over_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_is_game_over_st\n\r");
                 break;
 
             // Otherwise, if we are in the correct sequence state, then output that result to the user.
             case simonControl_correct_sequence_st:
-                printf("simonControl_correct_sequence_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_correct_sequence_st\n\r");
                 break;
 
             // Otherwise, if we are in the continue state, then output that result to the user.
             case simonControl_continue_st:
-                printf("simonControl_continue_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_continue_st\n\r");
                 break;
 
             // Otherwise, if we are in the continue wait ADC state, then output that result to the user.
             case simonControl_continue_wait_adc_st:
-                printf("simonControl_continue_wait_adc_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_continue_wait_adc_st\n\r");
                 break;
 
             // Otherwise, if we are in the show max sequence count state, then output that result to the user.
             case simonControl_show_max_sequence_count_st:
-                printf("simonControl_show_max_sequence_count_st\n\r");
+                SIMON_CONTROL_LOG("simonControl_show_max_sequence_count_st\n\r");
                 break;
      }
   }
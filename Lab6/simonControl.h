@@ -1,6 +1,9 @@
 #ifndef SIMONCONTROL_H_
 #define SIMONCONTROL_H_
 
+// Uncomment to log the game's state changes (with DEFERRED_LOG_ENABLED, see Common/deferredLog.h).
+//#define SIMON_CONTROL_LOG_ENABLED
+
 void simonControl_initialize_display();
 void simonControl_tick();
 
@@ -7,6 +7,7 @@
 /*********************************************************************************/
 #include "simonDisplay.h"
 #include "supportFiles/display.h"
+#include "touchGrid.h"
 
 // Necessary define to give the number of regions.
 #define SIMON_DISPLAY_REGION_COUNT 4
@@ -47,6 +48,28 @@ const uint16_t SIMON_DISPLAY_REGION_X_LUT[SIMON_DISPLAY_REGION_COUNT] = {SIMON_D
 const uint16_t SIMON_DISPLAY_REGION_Y_LUT[SIMON_DISPLAY_REGION_COUNT] = {SIMON_DISPLAY_TOP_COORDINATE, SIMON_DISPLAY_TOP_COORDINATE, SIMON_DISPLAY_BOTTOM_COORDINATE, SIMON_DISPLAY_BOTTOM_COORDINATE};
 const uint32_t SIMON_DISPLAY_REGION_COLOR_LUT[SIMON_DISPLAY_REGION_COUNT] = {SIMON_DISPLAY_REGION_0_COLOR, SIMON_DISPLAY_REGION_1_COLOR, SIMON_DISPLAY_REGION_2_COLOR, SIMON_DISPLAY_REGION_3_COLOR};
 
+// Static global variables holding the touch grid of the four regions (see Common/touchGrid.h), built the first time a touch is looked up.
+static touchGrid_t simonDisplay_touchGrid;
+static bool simonDisplay_touchGridBuilt = false;
+
+/*********************************************************************************/
+/* Function: simonDisplay_buildTouchGrid                                         */
+/* Purpose: To add each region (a quarter of the display, with the bottom right  */
+/*          corner from the lookup tables) to the touch grid.                    */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+static void simonDisplay_buildTouchGrid()
+{
+    touchGrid_init(&simonDisplay_touchGrid);
+
+    // For loop to iterate through all of the regions on the LCD.
+    for (uint8_t i = 0; i < SIMON_DISPLAY_REGION_COUNT; i++)
+    {
+        touchGrid_addRect(&simonDisplay_touchGrid, SIMON_DISPLAY_REGION_X_LUT[i] - SIMON_DISPLAY_LEFT_COORDINATE, SIMON_DISPLAY_REGION_Y_LUT[i] - SIMON_DISPLAY_TOP_COORDINATE, SIMON_DISPLAY_LEFT_COORDINATE, SIMON_DISPLAY_TOP_COORDINATE, i);
+    }
+    simonDisplay_touchGridBuilt = true;
+}
+
 /*********************************************************************************/
 /* Function: simonDisplay_computeRegionNumber                                    */
 /* Purpose: To compute the button region based on a passed x and y coordinate.   */
@@ -54,41 +77,14 @@ const uint32_t SIMON_DISPLAY_REGION_COLOR_LUT[SIMON_DISPLAY_REGION_COUNT] = {SIM
 /*********************************************************************************/
 int8_t simonDisplay_computeRegionNumber(int16_t x, int16_t y)
 {
-    // If the passed x coordinate is less than the left half of the display.
-    if (x < SIMON_DISPLAY_LEFT_COORDINATE)
+    // If this is the first touch, build the touch grid.
+    if (!simonDisplay_touchGridBuilt)
     {
-        // If the passed y coordinate is less than the top half of the display.
-        if (y < SIMON_DISPLAY_TOP_COORDINATE)
-        {
-            // Return region 0.
-            return SIMON_DISPLAY_REGION_0;
-        }
-
-        // Otherwise.
-        else
-        {
-            // Return region 2.
-            return SIMON_DISPLAY_REGION_2;
-        }
+        simonDisplay_buildTouchGrid();
     }
 
-    // Otherwise.
-    else
-    {
-        // If the passed y coordinate is less than the top half of the display.
-        if (y < SIMON_DISPLAY_TOP_COORDINATE)
-        {
-            // Return region 1.
-            return SIMON_DISPLAY_REGION_1;
-        }
-
-        // Otherwise.
-        else
-        {
-            // Return region 3.
-            return SIMON_DISPLAY_REGION_3;
-        }
-    }
+    // Return the region the touch grid has for the coordinates.
+    return touchGrid_lookup(&simonDisplay_touchGrid, x, y);
 }
 
 /*********************************************************************************/
@@ -26,6 +26,7 @@ void isr_function() {}*/
 #include <stdint.h>
 #include "simonControl.h"
 #include "supportFiles/display.h"
+#include "deferredLog.h"
 
 #include "xparameters.h"
 
@@ -70,6 +71,8 @@ int main() {
             personalInterruptCount++;
             simonControl_tick();
             interrupts_isrFlagGlobal = 0;
+        } else {
+            deferredLog_drain(stdout, 1);   // Print logged state changes between ticks, one at a time.
         }
     }
     interrupts_disableArmInts();
@@ -7,6 +7,15 @@
 /*********************************************************************************/
 #include "wamControl.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include "deferredLog.h"
+
+// wamControl_debug_print() goes to the deferred log (Common/deferredLog.h), if WAM_CONTROL_LOG_ENABLED.
+#if defined(DEFERRED_LOG_ENABLED) && defined(WAM_CONTROL_LOG_ENABLED)
+#define WAM_CONTROL_LOG DEFERRED_LOG
+#else
+#define WAM_CONTROL_LOG(...)
+#endif
 
 // Necessary defines to set the maximum amount of ticks for an ADC settle and to reset the ADC timer.
 #define WAM_CONTROL_ADC_WAIT_TIME 1
@@ -57,22 +66,22 @@ void wamControl_debug_print()
         {
             // If we are in the start state, then output that result to the user.
             case wamControl_start_st:
-                printf("wamControl_start_st\n\r");
+                WAM_CONTROL_LOG("wamControl_start_st\n\r");
                 break;
 
             // If we are in the wait touch state, then output that result to the user.
             case wamControl_wait_touch_st:
-                printf("wamControl_wait_touch_st\n\r");
+                WAM_CONTROL_LOG("wamControl_wait_touch_st\n\r");
                 break;
 
             // If we are in the ADC wait state, then output that result to the user.
             case wamControl_adc_wait_st:
-                printf("wamControl_adc_wait_st\n\r");
+                WAM_CONTROL_LOG("wamControl_adc_wait_st\n\r");
                 break;
 
             // If we are in the wait stop touch state, then output that result to the user.
             case wamControl_wait_stop_touch_st:
-                printf("wamControl_wait_stop_touch_st\n\r");
+                WAM_CONTROL_LOG("wamControl_wait_stop_touch_st\n\r");
                 break;
      }
   }
@@ -4,6 +4,9 @@
 #include "wamDisplay.h"
 #include <stdint.h>
 
+// Uncomment to log the controller's state changes (with DEFERRED_LOG_ENABLED, see Common/deferredLog.h).
+//#define WAM_CONTROL_LOG_ENABLED
+
 // Call this before using any wamControl_ functions.
 void wamControl_init();
 
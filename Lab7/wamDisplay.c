@@ -8,6 +8,9 @@
 #include "wamControl.h"
 #include "supportFiles/display.h"
 #include "supportFiles/utils.h"
+#include "glyphCache.h"
+#include "touchGrid.h"
+#include "sprite.h"
 #include "../Lab2/switches.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -115,6 +118,7 @@
 #define WAM_DISPLAY_MOLE_RADIUS 25
 #define WAM_DISPLAY_MOLE_INDEX_ERROR -1
 #define WAM_DISPLAY_MOLE_EVEN_MODULUS 2
+#define WAM_DISPLAY_MOLE_SPRITE_SIZE (2 * WAM_DISPLAY_MOLE_RADIUS + 1)   // The circle and its center pixel.
 
 // Necessary defines to set the increment value, interval band, and minimum interval for the moles.
 #define WAM_DISPLAY_INCREMENT_VALUE 1
@@ -156,6 +160,15 @@ typedef struct {
 // Static global variable used to point to mole info structs.
 static wamDisplay_moleInfo_t** wamDisplay_moleInfo;
 
+// Static global variables holding the active mole and the empty hole drawn on the board, each rendered once by wamDisplay_init() (see Common/sprite.h).
+static uint16_t wamDisplay_activeMolePixels[WAM_DISPLAY_MOLE_SPRITE_SIZE * WAM_DISPLAY_MOLE_SPRITE_SIZE];
+static uint16_t wamDisplay_moleHolePixels[WAM_DISPLAY_MOLE_SPRITE_SIZE * WAM_DISPLAY_MOLE_SPRITE_SIZE];
+static sprite_t wamDisplay_activeMoleSprite;
+static sprite_t wamDisplay_moleHoleSprite;
+
+// Static global variable holding the touch grid of the mole holes (see Common/touchGrid.h), rebuilt with the mole info for each board.
+static touchGrid_t wamDisplay_touchGrid;
+
 // Static global variables used to set the number of moles (for the mole board), the time interval, and current number of hits, misses, and the current level.
 static wamDisplay_moleCount_e mole_count;
 static uint16_t time_interval_band;
@@ -340,8 +353,8 @@ wamDisplay_moleIndex_t wamDisplay_get_mole_y(uint8_t mole_number)
 /*********************************************************************************/
 void wamDisplay_draw_active_mole_hole(uint8_t mole_number, bool erase)
 {
-    // Draw (or erase) the active mole hole based on the passed mole number.
-    display_fillCircle(wamDisplay_get_mole_x(mole_number), wamDisplay_get_mole_y(mole_number), WAM_DISPLAY_MOLE_RADIUS, (erase ? WAM_DISPLAY_BACKGROUND_COLOR : WAM_DISPLAY_ACTIVE_MOLE_COLOR));
+    // Draw (or erase) the active mole hole based on the passed mole number, as one transfer of the pre-rendered mole (or hole) around its origin.
+    sprite_draw((erase ? &wamDisplay_moleHoleSprite : &wamDisplay_activeMoleSprite), wamDisplay_get_mole_x(mole_number) - WAM_DISPLAY_MOLE_RADIUS, wamDisplay_get_mole_y(mole_number) - WAM_DISPLAY_MOLE_RADIUS);
 }
 
 /*********************************************************************************/
@@ -381,6 +394,9 @@ void wamDisplay_computeMoleInfo()
         wamDisplay_moleInfo[i] = (wamDisplay_moleInfo_t*) malloc(sizeof(wamDisplay_moleInfo_t));
     }
 
+    // Start a new touch grid for this board.
+    touchGrid_init(&wamDisplay_touchGrid);
+
     // For ever mole allocated.
     for (wamDisplay_moleIndex_t i = WAM_DISPLAY_MOLE_START; i < wamDisplay_get_mole_count(mole_count); i++)
     {
@@ -389,6 +405,9 @@ void wamDisplay_computeMoleInfo()
         wamDisplay_moleInfo[i]->origin.y = wamDisplay_get_mole_y(i);
         wamDisplay_moleInfo[i]->ticksUntilAwake = WAM_DISPLAY_MS_WAIT_RESET;
         wamDisplay_moleInfo[i]->ticksUntilDormant = WAM_DISPLAY_MS_WAIT_RESET;
+
+        // Add the square around the mole (the radius either side of its origin) to the touch grid.
+        touchGrid_addRect(&wamDisplay_touchGrid, wamDisplay_moleInfo[i]->origin.x - WAM_DISPLAY_MOLE_RADIUS, wamDisplay_moleInfo[i]->origin.y - WAM_DISPLAY_MOLE_RADIUS, 2 * WAM_DISPLAY_MOLE_RADIUS + 1, 2 * WAM_DISPLAY_MOLE_RADIUS + 1, i);
     }
 }
 
@@ -416,6 +435,13 @@ void wamDisplay_init()
 
     // Set the default interval value.
     time_interval_band = WAM_DISPLAY_TIME_INTERVAL_BAND;
+
+    // Render the active mole and the empty hole, each a circle on the board color, so the game never has to draw a circle.
+    raster_surface_t surface;
+    sprite_init(&wamDisplay_activeMoleSprite, wamDisplay_activeMolePixels, WAM_DISPLAY_MOLE_SPRITE_SIZE, WAM_DISPLAY_MOLE_SPRITE_SIZE, WAM_DISPLAY_BOARD_BACKGROUND_COLOR, &surface);
+    raster_fillCircle(&surface, WAM_DISPLAY_MOLE_RADIUS, WAM_DISPLAY_MOLE_RADIUS, WAM_DISPLAY_MOLE_RADIUS, WAM_DISPLAY_ACTIVE_MOLE_COLOR);
+    sprite_init(&wamDisplay_moleHoleSprite, wamDisplay_moleHolePixels, WAM_DISPLAY_MOLE_SPRITE_SIZE, WAM_DISPLAY_MOLE_SPRITE_SIZE, WAM_DISPLAY_BOARD_BACKGROUND_COLOR, &surface);
+    raster_fillCircle(&surface, WAM_DISPLAY_MOLE_RADIUS, WAM_DISPLAY_MOLE_RADIUS, WAM_DISPLAY_MOLE_RADIUS, WAM_DISPLAY_BACKGROUND_COLOR);
 }
 
 /*********************************************************************************/
@@ -515,38 +541,37 @@ void wamDisplay_activateRandomMole()
 /*********************************************************************************/
 wamDisplay_moleIndex_t wamDisplay_whackMole(wamDisplay_point_t* whackOrigin)
 {
-    // For every mole hole on the mole board.
-    for (uint16_t i = WAM_DISPLAY_MOLE_START; i < wamDisplay_get_mole_count(mole_count); i++)
+    // Look up which mole hole (if any) the touch point is within the radius of.
+    touchGrid_region_t i = touchGrid_lookup(&wamDisplay_touchGrid, whackOrigin->x, whackOrigin->y);
+
+    // If the touch point is on a mole hole.
+    if (i != TOUCH_GRID_NO_REGION)
     {
-        // If the current mole has ticks until dormant set, that means it is active.
+        // If the mole has ticks until dormant set, that means it is active.
         if (wamDisplay_moleInfo[i]->ticksUntilDormant)
         {
-            // If the touch point is within the radius of the origin of the mole.
-            if ((whackOrigin->x >= wamDisplay_moleInfo[i]->origin.x - WAM_DISPLAY_MOLE_RADIUS && whackOrigin->x <= wamDisplay_moleInfo[i]->origin.x + WAM_DISPLAY_MOLE_RADIUS) && (whackOrigin->y >= wamDisplay_moleInfo[i]->origin.y - WAM_DISPLAY_MOLE_RADIUS && whackOrigin->y <= wamDisplay_moleInfo[i]->origin.y + WAM_DISPLAY_MOLE_RADIUS))
-            {
-                // Set the ticks until dormant to their default value, erase the active mole hole, and then increment the hit score.
-                wamDisplay_moleInfo[i]->ticksUntilDormant = WAM_DISPLAY_MS_WAIT_RESET;
-                wamDisplay_draw_active_mole_hole(i, true);
-                wamDisplay_setHitScore(current_hits + WAM_DISPLAY_INCREMENT_VALUE);
+            // Set the ticks until dormant to their default value, erase the active mole hole, and then increment the hit score.
+            wamDisplay_moleInfo[i]->ticksUntilDormant = WAM_DISPLAY_MS_WAIT_RESET;
+            wamDisplay_draw_active_mole_hole(i, true);
+            wamDisplay_setHitScore(current_hits + WAM_DISPLAY_INCREMENT_VALUE);
 
-                // If it has been the value needed to increment the speed (which also increases the level).
-                if (!(wamDisplay_getHitScore() % WAM_DISPLAY_LEVEL_INCREASE_SPEED_EVERY))
-                {
-                    // Increment the level and increase the speed.
-                    wamDisplay_incrementLevel();
-                    time_interval_band /= WAM_DISPLAY_SPEED_INCREASE;
-                }
-
-                // If it has been the value needed to increment the number of moles.
-                if (!(wamDisplay_getHitScore() % WAM_DISPLAY_LEVEL_INCREASE_COUNT_EVERY) && wamControl_getMaxActiveMoles() < wamDisplay_get_mole_count(mole_count))
-                {
-                    // Increment the number of moles that are allowed to be active.
-                    wamControl_setMaxActiveMoles(wamControl_getMaxActiveMoles() + WAM_DISPLAY_COUNT_INCREASE);
-                }
+            // If it has been the value needed to increment the speed (which also increases the level).
+            if (!(wamDisplay_getHitScore() % WAM_DISPLAY_LEVEL_INCREASE_SPEED_EVERY))
+            {
+                // Increment the level and increase the speed.
+                wamDisplay_incrementLevel();
+                time_interval_band /= WAM_DISPLAY_SPEED_INCREASE;
+            }
 
-                // Return the index of the changed mole.
-                return i;
+            // If it has been the value needed to increment the number of moles.
+            if (!(wamDisplay_getHitScore() % WAM_DISPLAY_LEVEL_INCREASE_COUNT_EVERY) && wamControl_getMaxActiveMoles() < wamDisplay_get_mole_count(mole_count))
+            {
+                // Increment the number of moles that are allowed to be active.
+                wamControl_setMaxActiveMoles(wamControl_getMaxActiveMoles() + WAM_DISPLAY_COUNT_INCREASE);
             }
+
+            // Return the index of the changed mole.
+            return i;
         }
     }
 
@@ -618,6 +643,25 @@ uint16_t wamDisplay_getActiveMoleCount()
     return count;
 }
 
+/*********************************************************************************/
+/* Function: wamDisplay_print_score_text                                         */
+/* Purpose: To print score text on the score line in the passed color.           */
+/* Returns: VOID                                                                 */
+/*********************************************************************************/
+static void wamDisplay_print_score_text(int16_t x, const char* text, uint16_t color)
+{
+#ifdef GLYPH_CACHE_ENABLED
+    // The score line is on the background, so each character can be drawn as one transfer from the glyph cache.
+    glyphCache_print(x, WAM_DISPLAY_SCORE_Y, text, color, WAM_DISPLAY_BACKGROUND_COLOR, WAM_DISPLAY_SCORE_TEXT_SIZE);
+#else
+    // Set the text color, size, cursor, and then print the text to the display.
+    display_setTextColor(color);
+    display_setTextSize(WAM_DISPLAY_SCORE_TEXT_SIZE);
+    display_setCursor(x, WAM_DISPLAY_SCORE_Y);
+    display_print(text);
+#endif
+}
+
 /*********************************************************************************/
 /* Function: wamDisplay_setHitScore                                              */
 /* Purpose: To set the hit score on the score board below the mole board.        */
@@ -631,21 +675,15 @@ void wamDisplay_setHitScore(uint16_t hits)
     // Put the necessary values in the hit string (the current hit value before being changed).
     sprintf(hit_string, WAM_DISPLAY_SCORE_HIT_TEXT, current_hits);
 
-    // Set the text color, size, cursor, and then erase the hit string on the display.
-    display_setTextColor(WAM_DISPLAY_BACKGROUND_COLOR);
-    display_setTextSize(WAM_DISPLAY_SCORE_TEXT_SIZE);
-    display_setCursor(WAM_DISPLAY_SCORE_HIT_X, WAM_DISPLAY_SCORE_Y);
-    display_print(hit_string);
+    // Erase the hit string on the display.
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_HIT_X, hit_string, WAM_DISPLAY_BACKGROUND_COLOR);
 
     // Set the current hits to the passed hits value and put the necessary values in the hit string.
     current_hits = hits;
     sprintf(hit_string, WAM_DISPLAY_SCORE_HIT_TEXT, current_hits);
 
-    // Set the text color, size, cursor, and then print the hit string to the display.
-    display_setTextColor(WAM_DISPLAY_TEXT_COLOR);
-    display_setTextSize(WAM_DISPLAY_SCORE_TEXT_SIZE);
-    display_setCursor(WAM_DISPLAY_SCORE_HIT_X, WAM_DISPLAY_SCORE_Y);
-    display_print(hit_string);
+    // Print the hit string to the display.
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_HIT_X, hit_string, WAM_DISPLAY_TEXT_COLOR);
 }
 
 /*********************************************************************************/
@@ -669,23 +707,18 @@ void wamDisplay_setMissScore(uint16_t misses)
     // Set the miss string.
     char miss_string[WAM_DISPLAY_SCORE_MISS_STRING_SIZE];
 
-    // Set the text size and put the current value of misses in the miss string.
-    display_setTextSize(WAM_DISPLAY_SCORE_TEXT_SIZE);
+    // Put the current value of misses in the miss string.
     sprintf(miss_string, WAM_DISPLAY_SCORE_MISS_TEXT, current_misses);
 
-    // Set the text color, cursor position, and erase the old miss string on the display.
-    display_setTextColor(WAM_DISPLAY_BACKGROUND_COLOR);
-    display_setCursor(WAM_DISPLAY_SCORE_MISS_X, WAM_DISPLAY_SCORE_Y);
-    display_print(miss_string);
+    // Erase the old miss string on the display.
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_MISS_X, miss_string, WAM_DISPLAY_BACKGROUND_COLOR);
 
     // Set the value of current misses to the passed misses value then set the missing string with the right values.
     current_misses = misses;
     sprintf(miss_string, WAM_DISPLAY_SCORE_MISS_TEXT, current_misses);
 
-    // Set the text color, cursor position, and then print the new string to the display.
-    display_setTextColor(WAM_DISPLAY_TEXT_COLOR);
-    display_setCursor(WAM_DISPLAY_SCORE_MISS_X, WAM_DISPLAY_SCORE_Y);
-    display_print(miss_string);
+    // Print the new string to the display.
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_MISS_X, miss_string, WAM_DISPLAY_TEXT_COLOR);
 }
 
 /*********************************************************************************/
@@ -712,21 +745,15 @@ void wamDisplay_incrementLevel()
     // Put the appropriate values into the level string.
     sprintf(level_string, WAM_DISPLAY_SCORE_LEVEL_TEXT, current_level);
 
-    // Set the text color, size, cursor position, and erase the old level string.
-    display_setTextColor(WAM_DISPLAY_BACKGROUND_COLOR);
-    display_setTextSize(WAM_DISPLAY_SCORE_TEXT_SIZE);
-    display_setCursor(WAM_DISPLAY_SCORE_LEVEL_X, WAM_DISPLAY_SCORE_Y);
-    display_print(level_string);
+    // Erase the old level string.
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_LEVEL_X, level_string, WAM_DISPLAY_BACKGROUND_COLOR);
 
     // Increment the current level and put the appropriate values in the level string.
     current_level++;
     sprintf(level_string, WAM_DISPLAY_SCORE_LEVEL_TEXT, current_level);
 
-    // Set the text color, size, cursor position, and print the level string to the display.
-    display_setTextColor(WAM_DISPLAY_TEXT_COLOR);
-    display_setTextSize(WAM_DISPLAY_SCORE_TEXT_SIZE);
-    display_setCursor(WAM_DISPLAY_SCORE_LEVEL_X, WAM_DISPLAY_SCORE_Y);
-    display_print(level_string);
+    // Print the level string to the display.
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_LEVEL_X, level_string, WAM_DISPLAY_TEXT_COLOR);
 }
 
 /*********************************************************************************/
@@ -757,21 +784,11 @@ void wamDisplay_drawScoreScreen(bool erase)
     sprintf(miss_string, WAM_DISPLAY_SCORE_MISS_TEXT, current_misses);
     sprintf(level_string, WAM_DISPLAY_SCORE_LEVEL_TEXT, current_level);
 
-    // Set the text color and size.
-    display_setTextColor((erase ? WAM_DISPLAY_BACKGROUND_COLOR : WAM_DISPLAY_TEXT_COLOR));
-    display_setTextSize(WAM_DISPLAY_SCORE_TEXT_SIZE);
-
-    // Set the cursor position and print the hit string.
-    display_setCursor(WAM_DISPLAY_SCORE_HIT_X, WAM_DISPLAY_SCORE_Y);
-    display_print(hit_string);
-
-    // Set the cursor position and print the miss string.
-    display_setCursor(WAM_DISPLAY_SCORE_MISS_X, WAM_DISPLAY_SCORE_Y);
-    display_print(miss_string);
-
-    // Set the cursor position and print the level string.
-    display_setCursor(WAM_DISPLAY_SCORE_LEVEL_X, WAM_DISPLAY_SCORE_Y);
-    display_print(level_string);
+    // Print (or erase) the hit, miss, and level strings.
+    uint16_t color = (erase ? WAM_DISPLAY_BACKGROUND_COLOR : WAM_DISPLAY_TEXT_COLOR);
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_HIT_X, hit_string, color);
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_MISS_X, miss_string, color);
+    wamDisplay_print_score_text(WAM_DISPLAY_SCORE_LEVEL_X, level_string, color);
 }
 
 /*********************************************************************************/
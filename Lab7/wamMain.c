@@ -2,6 +2,7 @@
 #include "wamControl.h"
 #include "supportFiles/utils.h"
 #include "supportFiles/display.h"
+#include "deferredLog.h"
 #include "../Lab3/intervalTimer.h"  // Modify as necessary to point to your intervalTimer.h
 #include "supportFiles/leds.h"
 #include "supportFiles/interrupts.h"
@@ -86,9 +87,12 @@ int main() {
                 interrupts_isrFlagGlobal = 0;   // Reset the interrupt flag.
                 personalInterruptCount++;       // Count interrupts.
                 wamControl_tick();              // tick the WAM controller.
+            } else {
+                deferredLog_drain(stdout, 1);   // Between ticks: print the oldest logged record, if any.
             }
         }
         interrupts_disableArmInts();            // Game is over, turn off interrupts.
+        deferredLog_drain(stdout, DEFERRED_LOG_DRAIN_ALL);
         // Print out the interrupt counts to ensure that you didn't miss any interrupts.
         printf("isr invocation count: %ld\n\r", interrupts_isrInvocationCount());
         printf("internal interrupt count: %ld\n\r", personalInterruptCount);
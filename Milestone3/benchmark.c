@@ -0,0 +1,398 @@
+/*********************************************************************************************************/
+/* File: benchmark.c                                                                                     */
+/* Purpose: Stage-by-stage and end-to-end timing of the detector pipeline, with JSON output and          */
+/*          comparison against a saved baseline.                                                         */
+/*********************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xtime_l.h"
+#include "benchmark.h"
+#include "capture.h"
+#include "detector.h"
+#include "filter.h"
+#include "isr.h"
+#include "lockoutTimer.h"
+#include "hitLedTimer.h"
+#include "timerWheel.h"
+#include "sort.h"
+#include "queue.h"
+
+// Batch shape for the per-stage benchmarks. Each batch is timed as a whole (so timer
+// overhead doesn't swamp the short stages) and the per-call time of each batch is kept
+// for the percentiles.
+#define BENCHMARK_CALLS_PER_BATCH 100
+#define BENCHMARK_BATCH_COUNT 1000
+#define BENCHMARK_MAX_BATCHES 4096
+
+// The end-to-end benchmark lets this many samples accumulate in the ADC buffer before
+// each call to detector() (10 ms of input, about one main-loop pass with the display).
+#define BENCHMARK_DETECTOR_CHUNK_SIZE 1000
+
+// Queue size used by the queue benchmarks (same as the FIR input queue).
+#define BENCHMARK_QUEUE_SIZE FILTER_X_QUEUE_SIZE
+#define BENCHMARK_QUEUE_NAME "benchmarkQueue"
+
+// Samples used for the synthesized capture in benchmark_runTest().
+#define BENCHMARK_TEST_SAMPLE_COUNT 50000
+#define BENCHMARK_TEST_SHOT_SPACING 25000
+#define BENCHMARK_TEST_AMPLITUDE 1000
+#define BENCHMARK_TEST_SEED 1
+
+// Conversion constants.
+#define BENCHMARK_NS_PER_SECOND 1.0e9
+#define BENCHMARK_PERCENT 100.0
+#define BENCHMARK_P50 0.50
+#define BENCHMARK_P90 0.90
+#define BENCHMARK_P99 0.99
+#define BENCHMARK_ADC_HALF_SCALE 2047.5
+
+// The JSON keys used in the output and when reading a baseline.
+#define BENCHMARK_JSON_NAME_KEY "\"name\": \""
+#define BENCHMARK_JSON_NS_PER_SAMPLE_KEY "\"ns_per_sample\":"
+
+// A benchmark body: performs one call of the operation being timed.
+typedef void (*benchmark_function_t)(uint32_t call);
+
+// The capture being replayed and the position of the next sample.
+static const uint16_t* benchmark_samples;
+static uint32_t benchmark_sampleCount;
+static uint32_t benchmark_sampleIndex;
+
+// Queue used by the queue benchmarks.
+static queue_t benchmark_queue;
+
+// Per-batch time per call, in ns.
+static double benchmark_batchNs[BENCHMARK_MAX_BATCHES];
+
+/*********************************************************************************************************/
+/* Function: benchmark_nextSample                                                                        */
+/* Purpose: Returns the next capture sample, wrapping around at the end of the capture.                  */
+/* Returns: The raw ADC sample.                                                                          */
+/*********************************************************************************************************/
+static uint16_t benchmark_nextSample()
+{
+    uint16_t sample = benchmark_samples[benchmark_sampleIndex];
+    benchmark_sampleIndex = (benchmark_sampleIndex + 1) % benchmark_sampleCount;
+    return sample;
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_scaledSample                                                                      */
+/* Purpose: Returns the next capture sample scaled to -1.0 .. 1.0 the way detector() scales it.          */
+/* Returns: The scaled sample.                                                                           */
+/*********************************************************************************************************/
+static double benchmark_scaledSample()
+{
+    return (benchmark_nextSample() - BENCHMARK_ADC_HALF_SCALE) / BENCHMARK_ADC_HALF_SCALE;
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_elapsedNs                                                                         */
+/* Purpose: Converts an XTime interval to nanoseconds.                                                   */
+/* Returns: The interval in ns.                                                                          */
+/*********************************************************************************************************/
+static double benchmark_elapsedNs(XTime start, XTime end)
+{
+    return (double) (end - start) * BENCHMARK_NS_PER_SECOND / (double) COUNTS_PER_SECOND;
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_percentile                                                                        */
+/* Purpose: Picks a percentile out of batch times already sorted by quicksort() (largest first).         */
+/* Returns: The percentile value.                                                                        */
+/*********************************************************************************************************/
+static double benchmark_percentile(const double sortedDescending[], uint32_t count, double percentile)
+{
+    uint32_t rank = (uint32_t) ((1.0 - percentile) * (count - 1) + 0.5);
+    return sortedDescending[rank];
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_finish                                                                            */
+/* Purpose: Fills in a result from the collected batch times.                                            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void benchmark_finish(benchmark_result_t* result, const char* name, uint32_t batchCount, uint32_t callsPerBatch, double samplesPerCall, double totalNs)
+{
+    strncpy(result->name, name, BENCHMARK_NAME_SIZE - 1);
+    result->name[BENCHMARK_NAME_SIZE - 1] = '\0';
+    result->calls = batchCount * callsPerBatch;
+    result->samplesPerCall = samplesPerCall;
+    result->nsPerCall = totalNs / result->calls;
+    result->nsPerSample = result->nsPerCall / samplesPerCall;
+    result->samplesPerSecond = (result->nsPerSample > 0.0) ? BENCHMARK_NS_PER_SECOND / result->nsPerSample : 0.0;
+    // quicksort() sorts largest first.
+    quicksort(benchmark_batchNs, batchCount);
+    result->maxNs = benchmark_batchNs[0];
+    result->p50Ns = benchmark_percentile(benchmark_batchNs, batchCount, BENCHMARK_P50);
+    result->p90Ns = benchmark_percentile(benchmark_batchNs, batchCount, BENCHMARK_P90);
+    result->p99Ns = benchmark_percentile(benchmark_batchNs, batchCount, BENCHMARK_P99);
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_measure                                                                           */
+/* Purpose: Times batchCount batches of callsPerBatch calls to function (after one untimed warm-up       */
+/*          batch) and fills in result.                                                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void benchmark_measure(benchmark_result_t* result, const char* name, benchmark_function_t function, double samplesPerCall)
+{
+    // Warm up the caches and branch predictors.
+    for (uint32_t call = 0; call < BENCHMARK_CALLS_PER_BATCH; call++)
+    {
+        function(call);
+    }
+    double totalNs = 0.0;
+    for (uint32_t batch = 0; batch < BENCHMARK_BATCH_COUNT; batch++)
+    {
+        XTime start, end;
+        XTime_GetTime(&start);
+        for (uint32_t call = 0; call < BENCHMARK_CALLS_PER_BATCH; call++)
+        {
+            function(batch * BENCHMARK_CALLS_PER_BATCH + call);
+        }
+        XTime_GetTime(&end);
+        double batchNs = benchmark_elapsedNs(start, end);
+        totalNs += batchNs;
+        benchmark_batchNs[batch] = batchNs / BENCHMARK_CALLS_PER_BATCH;
+    }
+    benchmark_finish(result, name, BENCHMARK_BATCH_COUNT, BENCHMARK_CALLS_PER_BATCH, samplesPerCall, totalNs);
+}
+
+// Benchmark bodies. Each performs one call of the operation named in the result.
+static void benchmark_queueOverwritePush(uint32_t call)
+{
+    (void) call;
+    queue_overwritePush(&benchmark_queue, benchmark_scaledSample());
+}
+
+static volatile queue_data_t benchmark_sink;
+static void benchmark_queueReadElementAt(uint32_t call)
+{
+    benchmark_sink = queue_readElementAt(&benchmark_queue, call % BENCHMARK_QUEUE_SIZE);
+}
+
+static void benchmark_firFilter(uint32_t call)
+{
+    (void) call;
+    // A decimation step: FILTER_DECIMATION_VALUE new inputs, then one FIR output.
+    for (uint16_t i = 0; i < FILTER_DECIMATION_VALUE; i++)
+    {
+        filter_addNewInput(benchmark_scaledSample());
+    }
+    benchmark_sink = filter_firFilter();
+}
+
+static void benchmark_iirFilter(uint32_t call)
+{
+    // Feed the IIR bank a fresh FIR output once per pass over the players.
+    if (call % FILTER_NUMBER_OF_PLAYERS == 0)
+    {
+        benchmark_firFilter(call);
+    }
+    benchmark_sink = filter_iirFilter(call % FILTER_NUMBER_OF_PLAYERS);
+}
+
+static void benchmark_computePower(uint32_t call)
+{
+    benchmark_sink = filter_computePower(call % FILTER_NUMBER_OF_PLAYERS, false, false);
+}
+
+static void benchmark_hitDetection(uint32_t call)
+{
+    (void) call;
+    detector_hit_detection_algorithm();
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_detector                                                                          */
+/* Purpose: Replays the whole capture through detector() in chunks, timing each call. Filling the ADC    */
+/*          buffer and advancing the lockout and hit-LED timers (the ISR's job) are not timed.           */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void benchmark_detector(benchmark_result_t* result)
+{
+    uint32_t chunkCount = benchmark_sampleCount / BENCHMARK_DETECTOR_CHUNK_SIZE;
+    if (chunkCount > BENCHMARK_MAX_BATCHES)
+    {
+        chunkCount = BENCHMARK_MAX_BATCHES;
+    }
+    if (chunkCount == 0)
+    {
+        chunkCount = 1;
+    }
+    benchmark_sampleIndex = 0;
+    double totalNs = 0.0;
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        // Let the "ISR" fill the buffer and run the timers for the chunk's worth of ticks.
+        for (uint32_t i = 0; i < BENCHMARK_DETECTOR_CHUNK_SIZE; i++)
+        {
+            isr_addDataToAdcBuffer(benchmark_nextSample());
+            timerWheel_tick();
+        }
+        XTime start, end;
+        XTime_GetTime(&start);
+        detector(false, false);
+        XTime_GetTime(&end);
+        double chunkNs = benchmark_elapsedNs(start, end);
+        totalNs += chunkNs;
+        benchmark_batchNs[chunk] = chunkNs;
+    }
+    benchmark_finish(result, "detector", chunkCount, 1, BENCHMARK_DETECTOR_CHUNK_SIZE, totalNs);
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_resetPipeline                                                                     */
+/* Purpose: Puts the filter, detector, isr and timers back into their initial state.                     */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void benchmark_resetPipeline()
+{
+    static bool filterInitialized = false;
+    // filter_init() allocates the queues, so only call it once and reset the instance afterwards.
+    if (!filterInitialized)
+    {
+        filter_init();
+        filterInitialized = true;
+    }
+    else
+    {
+        filter_ctx_reset(filter_getDefaultCtx());
+    }
+    detector_init();
+    isr_init();
+    lockoutTimer_init();
+    hitLedTimer_init();
+    benchmark_sampleIndex = 0;
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_runAll                                                                            */
+/* Purpose: Runs every benchmark in the suite over the capture.                                          */
+/* Returns: The number of results written.                                                               */
+/*********************************************************************************************************/
+uint16_t benchmark_runAll(const uint16_t samples[], uint32_t sampleCount, benchmark_result_t results[])
+{
+    uint16_t resultCount = 0;
+    benchmark_samples = samples;
+    benchmark_sampleCount = sampleCount;
+
+    // Queue primitives on a queue the size of the FIR input queue.
+    benchmark_resetPipeline();
+    queue_init(&benchmark_queue, BENCHMARK_QUEUE_SIZE, BENCHMARK_QUEUE_NAME);
+    filter_fillQueue(&benchmark_queue, FILTER_QUEUE_INIT_VALUE);
+    benchmark_measure(&results[resultCount++], "queue_overwritePush", benchmark_queueOverwritePush, 1.0);
+    benchmark_measure(&results[resultCount++], "queue_readElementAt", benchmark_queueReadElementAt, 1.0);
+    queue_garbageCollect(&benchmark_queue);
+
+    // Filter stages. One FIR call consumes a decimation's worth of samples; the IIR and power
+    // stages run once per player per decimated sample.
+    benchmark_resetPipeline();
+    benchmark_measure(&results[resultCount++], "fir_filter", benchmark_firFilter, FILTER_DECIMATION_VALUE);
+    benchmark_measure(&results[resultCount++], "iir_filter", benchmark_iirFilter, (double) FILTER_DECIMATION_VALUE / FILTER_NUMBER_OF_PLAYERS);
+    benchmark_measure(&results[resultCount++], "compute_power", benchmark_computePower, (double) FILTER_DECIMATION_VALUE / FILTER_NUMBER_OF_PLAYERS);
+    benchmark_measure(&results[resultCount++], "hit_detection", benchmark_hitDetection, FILTER_DECIMATION_VALUE);
+
+    // End to end over the capture.
+    benchmark_resetPipeline();
+    benchmark_detector(&results[resultCount++]);
+    benchmark_resetPipeline();
+    return resultCount;
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_printJson                                                                         */
+/* Purpose: Writes the results as JSON.                                                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void benchmark_printJson(FILE* out, const benchmark_result_t results[], uint16_t resultCount)
+{
+    fprintf(out, "{\n  \"benchmarks\": [\n");
+    for (uint16_t i = 0; i < resultCount; i++)
+    {
+        const benchmark_result_t* r = &results[i];
+        fprintf(out, "    {" BENCHMARK_JSON_NAME_KEY "%s\", \"calls\": %lu, \"samples_per_call\": %.2f, "
+                "\"ns_per_call\": %.2f, " BENCHMARK_JSON_NS_PER_SAMPLE_KEY " %.3f, \"samples_per_second\": %.0f, "
+                "\"p50_ns\": %.2f, \"p90_ns\": %.2f, \"p99_ns\": %.2f, \"max_ns\": %.2f}%s\n",
+                r->name, (unsigned long) r->calls, r->samplesPerCall, r->nsPerCall, r->nsPerSample,
+                r->samplesPerSecond, r->p50Ns, r->p90Ns, r->p99Ns, r->maxNs,
+                (i + 1 < resultCount) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_baselineNsPerSample                                                               */
+/* Purpose: Finds the ns_per_sample of the named benchmark in a baseline JSON document.                  */
+/* Returns: True if the benchmark was found (value written to *nsPerSample).                             */
+/*********************************************************************************************************/
+static bool benchmark_baselineNsPerSample(const char* baselineJson, const char* name, double* nsPerSample)
+{
+    // Look for "name": "<name>" followed by its closing quote.
+    char key[BENCHMARK_NAME_SIZE + sizeof(BENCHMARK_JSON_NAME_KEY) + 1];
+    snprintf(key, sizeof(key), BENCHMARK_JSON_NAME_KEY "%s\"", name);
+    const char* entry = strstr(baselineJson, key);
+    if (entry == NULL)
+    {
+        return false;
+    }
+    const char* value = strstr(entry, BENCHMARK_JSON_NS_PER_SAMPLE_KEY);
+    if (value == NULL)
+    {
+        return false;
+    }
+    return sscanf(value + strlen(BENCHMARK_JSON_NS_PER_SAMPLE_KEY), "%lf", nsPerSample) == 1;
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_compareToBaseline                                                                 */
+/* Purpose: Prints the change in ns-per-sample of every benchmark relative to a baseline.                */
+/* Returns: The number of benchmarks slower than the baseline by more than tolerancePercent.             */
+/*********************************************************************************************************/
+uint16_t benchmark_compareToBaseline(const benchmark_result_t results[], uint16_t resultCount, const char* baselineJson, double tolerancePercent)
+{
+    uint16_t regressionCount = 0;
+    printf("%-24s %14s %14s %9s\n", "benchmark", "baseline ns", "current ns", "change");
+    for (uint16_t i = 0; i < resultCount; i++)
+    {
+        double baselineNs;
+        if (!benchmark_baselineNsPerSample(baselineJson, results[i].name, &baselineNs) || baselineNs <= 0.0)
+        {
+            printf("%-24s %14s %14.3f %9s\n", results[i].name, "-", results[i].nsPerSample, "new");
+            continue;
+        }
+        double changePercent = (results[i].nsPerSample - baselineNs) * BENCHMARK_PERCENT / baselineNs;
+        bool regressed = changePercent > tolerancePercent;
+        if (regressed)
+        {
+            regressionCount++;
+        }
+        printf("%-24s %14.3f %14.3f %+8.1f%%%s\n", results[i].name, baselineNs, results[i].nsPerSample,
+               changePercent, regressed ? "  REGRESSION" : "");
+    }
+    return regressionCount;
+}
+
+/*********************************************************************************************************/
+/* Function: benchmark_runTest                                                                           */
+/* Purpose: Runs the suite on a synthesized capture and prints the JSON results.                         */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void benchmark_runTest()
+{
+    printf("Started benchmark run test...\n\r");
+    uint16_t* samples = (uint16_t*) malloc(BENCHMARK_TEST_SAMPLE_COUNT * sizeof(uint16_t));
+    if (samples == NULL)
+    {
+        printf("benchmark_runTest: could not allocate the capture.\n\r");
+        return;
+    }
+    capture_synthesizeShots(samples, BENCHMARK_TEST_SAMPLE_COUNT, BENCHMARK_TEST_SHOT_SPACING, BENCHMARK_TEST_AMPLITUDE, BENCHMARK_TEST_SEED);
+    benchmark_result_t results[BENCHMARK_MAX_RESULTS];
+    uint16_t resultCount = benchmark_runAll(samples, BENCHMARK_TEST_SAMPLE_COUNT, results);
+    benchmark_printJson(stdout, results, resultCount);
+    free(samples);
+    printf("Ended benchmark run test.\n\r");
+}
@@ -0,0 +1,49 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// The benchmark times the detector pipeline stage by stage (queue operations, FIR, IIR,
+// power, hit detection) and end to end (detector() draining the ADC buffer) while
+// replaying a capture (see capture.h). Timing uses XTime_GetTime() so the same code
+// runs on the board and on a PC. Results are reported as JSON and can be compared
+// against a previously saved JSON baseline to catch regressions.
+
+#define BENCHMARK_MAX_RESULTS 8         // Number of benchmarks in the suite.
+#define BENCHMARK_NAME_SIZE 32          // Longest benchmark name.
+#define BENCHMARK_DEFAULT_TOLERANCE 10.0 // Percent slowdown reported as a regression.
+
+// Timing results for a single benchmark. Percentiles are taken over batches of calls
+// and are expressed per call.
+typedef struct {
+    char name[BENCHMARK_NAME_SIZE];
+    uint32_t calls;            // Number of timed calls.
+    double samplesPerCall;     // ADC samples accounted for by one call in the real pipeline.
+    double nsPerCall;          // Mean time per call.
+    double nsPerSample;        // Mean time per ADC sample (nsPerCall / samplesPerCall).
+    double samplesPerSecond;   // ADC samples per second this stage can sustain.
+    double p50Ns;              // Median time per call.
+    double p90Ns;              // 90th percentile time per call.
+    double p99Ns;              // 99th percentile time per call.
+    double maxNs;              // Slowest batch, per call.
+} benchmark_result_t;
+
+// Runs the whole suite over the given capture and fills results[].
+// Returns the number of results written (at most BENCHMARK_MAX_RESULTS).
+// Re-initializes the filter, detector, isr and timer modules.
+uint16_t benchmark_runAll(const uint16_t samples[], uint32_t sampleCount, benchmark_result_t results[]);
+
+// Writes the results as a JSON document.
+void benchmark_printJson(FILE* out, const benchmark_result_t results[], uint16_t resultCount);
+
+// Compares ns-per-sample against a baseline JSON document (as written by benchmark_printJson()),
+// printing one line per benchmark. Returns the number of benchmarks that are more than
+// tolerancePercent slower than the baseline.
+uint16_t benchmark_compareToBaseline(const benchmark_result_t results[], uint16_t resultCount, const char* baselineJson, double tolerancePercent);
+
+// Runs the suite on a synthesized capture and prints the JSON to stdout (the UART on the board).
+void benchmark_runTest();
+
+#endif /* BENCHMARK_H_ */
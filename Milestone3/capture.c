@@ -0,0 +1,123 @@
+/*********************************************************************************************************/
+/* File: capture.c                                                                                       */
+/* Purpose: Loading, saving, and synthesizing raw ADC captures for the benchmark and offline tools.     */
+/*********************************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "capture.h"
+#include "filter.h"
+#include "transmitter.h"
+
+// Bytes per sample in a capture file and the shift of the high byte.
+#define CAPTURE_BYTES_PER_SAMPLE 2
+#define CAPTURE_BYTE_SHIFT 8
+#define CAPTURE_BYTE_MASK 0xFF
+
+// Peak-to-peak noise (in ADC codes) added to synthesized captures.
+#define CAPTURE_NOISE_AMPLITUDE 8
+
+// Constants for the linear congruential noise generator.
+#define CAPTURE_LCG_MULTIPLIER 1664525u
+#define CAPTURE_LCG_INCREMENT 1013904223u
+#define CAPTURE_LCG_SHIFT 16
+
+/*********************************************************************************************************/
+/* Function: capture_load                                                                                */
+/* Purpose: Reads a raw little-endian 16-bit capture file into a newly allocated array.                  */
+/* Returns: The number of samples read (0 on failure).                                                   */
+/*********************************************************************************************************/
+uint32_t capture_load(const char* path, uint16_t** samples)
+{
+    // Open the capture and find its length.
+    *samples = NULL;
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        printf("capture_load: could not open %s\n\r", path);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long byteCount = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint32_t sampleCount = (byteCount > 0) ? (uint32_t) (byteCount / CAPTURE_BYTES_PER_SAMPLE) : 0;
+    if (sampleCount == 0)
+    {
+        printf("capture_load: %s is empty\n\r", path);
+        fclose(file);
+        return 0;
+    }
+    // Read the samples, assembling each from its two bytes so the host byte order doesn't matter.
+    *samples = (uint16_t*) malloc(sampleCount * sizeof(uint16_t));
+    uint8_t bytes[CAPTURE_BYTES_PER_SAMPLE];
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        if (fread(bytes, 1, CAPTURE_BYTES_PER_SAMPLE, file) != CAPTURE_BYTES_PER_SAMPLE)
+        {
+            sampleCount = i;
+            break;
+        }
+        (*samples)[i] = (uint16_t) (bytes[0] | (bytes[1] << CAPTURE_BYTE_SHIFT));
+    }
+    fclose(file);
+    return sampleCount;
+}
+
+/*********************************************************************************************************/
+/* Function: capture_save                                                                                */
+/* Purpose: Writes samples to a raw little-endian 16-bit capture file.                                   */
+/* Returns: True if every sample was written.                                                            */
+/*********************************************************************************************************/
+bool capture_save(const char* path, const uint16_t samples[], uint32_t sampleCount)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        printf("capture_save: could not open %s\n\r", path);
+        return false;
+    }
+    // Write each sample low byte first.
+    bool written = true;
+    for (uint32_t i = 0; i < sampleCount && written; i++)
+    {
+        uint8_t bytes[CAPTURE_BYTES_PER_SAMPLE] = {(uint8_t) (samples[i] & CAPTURE_BYTE_MASK),
+                                                   (uint8_t) (samples[i] >> CAPTURE_BYTE_SHIFT)};
+        written = (fwrite(bytes, 1, CAPTURE_BYTES_PER_SAMPLE, file) == CAPTURE_BYTES_PER_SAMPLE);
+    }
+    fclose(file);
+    return written;
+}
+
+/*********************************************************************************************************/
+/* Function: capture_synthesizeShots                                                                     */
+/* Purpose: Fills samples with a noisy baseline and a 200 ms square-wave shot every shotSpacing samples,  */
+/*          cycling through the player frequencies.                                                      */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void capture_synthesizeShots(uint16_t samples[], uint32_t sampleCount, uint32_t shotSpacing, uint16_t amplitude, uint32_t seed)
+{
+    uint32_t noise = seed;
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        // Noise from a small LCG so the capture is repeatable for a given seed.
+        noise = noise * CAPTURE_LCG_MULTIPLIER + CAPTURE_LCG_INCREMENT;
+        int32_t value = CAPTURE_ADC_MID_SCALE + (int32_t) ((noise >> CAPTURE_LCG_SHIFT) % CAPTURE_NOISE_AMPLITUDE) - (CAPTURE_NOISE_AMPLITUDE / 2);
+        // Add the square wave if this sample falls inside a shot.
+        uint32_t shot = i / shotSpacing;
+        uint32_t offset = i % shotSpacing;
+        if (offset < TRANSMITTER_PULSE_WIDTH)
+        {
+            uint16_t halfPeriod = filter_frequencyTickTable[shot % FILTER_FREQUENCY_COUNT] / 2;
+            value += ((offset / halfPeriod) % 2) ? -(int32_t) amplitude : (int32_t) amplitude;
+        }
+        // Clip to the ADC range.
+        if (value < 0)
+        {
+            value = 0;
+        }
+        else if (value > CAPTURE_ADC_MAX_VALUE)
+        {
+            value = CAPTURE_ADC_MAX_VALUE;
+        }
+        samples[i] = (uint16_t) value;
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// A capture is a recording of raw ADC samples taken at the 100 kHz system tick rate.
+// On disk a capture is stored as raw little-endian unsigned 16-bit ADC codes (0 - 4095),
+// one per tick, with no header. Captures feed the benchmark and offline tools so that the
+// same input can be replayed through the detector on the board and on a PC.
+
+#define CAPTURE_SAMPLE_RATE_HZ 100000   // One sample per system tick.
+#define CAPTURE_ADC_MID_SCALE 2048      // ADC code for 0 V (center of the 12-bit range).
+#define CAPTURE_ADC_MAX_VALUE 4095      // Largest 12-bit ADC code.
+
+// Loads a capture file into a newly allocated array (*samples). The caller frees the array.
+// Returns the number of samples loaded, or 0 if the file could not be read.
+uint32_t capture_load(const char* path, uint16_t** samples);
+
+// Saves sampleCount samples to a capture file. Returns true if the file was written.
+bool capture_save(const char* path, const uint16_t samples[], uint32_t sampleCount);
+
+// Synthesizes a capture of shots arriving every shotSpacing samples. Shot k is a
+// TRANSMITTER_PULSE_WIDTH long square wave on player (k % FILTER_FREQUENCY_COUNT)'s
+// frequency with the given peak amplitude (in ADC codes), on top of a little noise.
+// seed makes the noise repeatable.
+void capture_synthesizeShots(uint16_t samples[], uint32_t sampleCount, uint32_t shotSpacing, uint16_t amplitude, uint32_t seed);
+
+#endif /* CAPTURE_H_ */
@@ -0,0 +1,65 @@
+/*********************************************************************************************************/
+/* File: cycleCounter.c                                                                                  */
+/* Purpose: Enables the cycle counter and determines its rate (see cycleCounter.h).                      */
+/*********************************************************************************************************/
+#include <time.h>
+#include "cycleCounter.h"
+#include "xparameters.h"
+
+// PMU control values: PMCR enable (E) and cycle counter reset (C); PMCNTENSET cycle counter bit.
+#define CYCLE_COUNTER_PMCR_ENABLE 0x1
+#define CYCLE_COUNTER_PMCR_CYCLE_COUNTER_RESET 0x4
+#define CYCLE_COUNTER_PMCNTENSET_CYCLE_COUNTER 0x80000000
+
+#define CYCLE_COUNTER_HZ_PER_MHZ 1000000.0
+#define CYCLE_COUNTER_NS_PER_US 1000.0
+#define CYCLE_COUNTER_CALIBRATION_NS 10000000   // Measure the host counter rate over 10 ms.
+#define CYCLE_COUNTER_NS_PER_SECOND 1000000000LL
+
+static double cycleCounter_cyclesPerMicrosecond = 0.0;
+
+/*********************************************************************************************************/
+/* Function: cycleCounter_init                                                                           */
+/* Purpose: Starts the PMU cycle counter on the board, or times the host counter against the monotonic   */
+/*          clock. Only the first call does any work.                                                    */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void cycleCounter_init()
+{
+    if (cycleCounter_cyclesPerMicrosecond > 0.0)
+    {
+        return;
+    }
+#if defined(__arm__) && !defined(__linux__)
+    // Enable and reset the PMU cycle counter; it runs at the CPU clock.
+    __asm__ volatile("mcr p15, 0, %0, c9, c12, 0" : : "r"(CYCLE_COUNTER_PMCR_ENABLE | CYCLE_COUNTER_PMCR_CYCLE_COUNTER_RESET));
+    __asm__ volatile("mcr p15, 0, %0, c9, c12, 1" : : "r"(CYCLE_COUNTER_PMCNTENSET_CYCLE_COUNTER));
+    cycleCounter_cyclesPerMicrosecond = XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / CYCLE_COUNTER_HZ_PER_MHZ;
+#elif defined(__x86_64__) || defined(__i386__)
+    // The TSC rate isn't known up front, so time it against the monotonic clock.
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    cycleCounter_cycles_t startCycles = cycleCounter_read();
+    long long elapsedNs = 0;
+    while (elapsedNs < CYCLE_COUNTER_CALIBRATION_NS)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsedNs = (now.tv_sec - start.tv_sec) * CYCLE_COUNTER_NS_PER_SECOND + (now.tv_nsec - start.tv_nsec);
+    }
+    cycleCounter_cycles_t elapsedCycles = cycleCounter_read() - startCycles;
+    cycleCounter_cyclesPerMicrosecond = elapsedCycles * CYCLE_COUNTER_NS_PER_US / elapsedNs;
+#else
+    // clock_gettime() fallback counts nanoseconds.
+    cycleCounter_cyclesPerMicrosecond = CYCLE_COUNTER_NS_PER_US;
+#endif
+}
+
+/*********************************************************************************************************/
+/* Function: cycleCounter_getCyclesPerMicrosecond                                                        */
+/* Purpose: Returns the rate of cycleCounter_read().                                                     */
+/* Returns: Counts per microsecond (0 before cycleCounter_init()).                                       */
+/*********************************************************************************************************/
+double cycleCounter_getCyclesPerMicrosecond()
+{
+    return cycleCounter_cyclesPerMicrosecond;
+}
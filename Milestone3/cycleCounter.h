@@ -0,0 +1,45 @@
+#ifndef CYCLECOUNTER_H_
+#define CYCLECOUNTER_H_
+
+#include <stdint.h>
+
+// Free-running cycle counter for fine-grained timing. On the board this is the
+// Cortex-A9 PMU cycle counter (CPU clock); on an x86 host it is the time-stamp counter,
+// and on other hosts it falls back to clock_gettime() nanoseconds. The counter is
+// 32 bits wide, so only differences are meaningful (it wraps every few seconds).
+
+typedef uint32_t cycleCounter_cycles_t;
+
+#if defined(__arm__) && !defined(__linux__)
+// Reads the PMU cycle counter (PMCCNTR). cycleCounter_init() enables it.
+static inline cycleCounter_cycles_t cycleCounter_read()
+{
+    uint32_t cycles;
+    __asm__ volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(cycles));
+    return cycles;
+}
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+// Reads the time-stamp counter.
+static inline cycleCounter_cycles_t cycleCounter_read()
+{
+    return (cycleCounter_cycles_t) __rdtsc();
+}
+#else
+#include <time.h>
+// No cycle counter available: count nanoseconds instead.
+static inline cycleCounter_cycles_t cycleCounter_read()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (cycleCounter_cycles_t) ((uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec);
+}
+#endif
+
+// Enables the counter (board) or measures its rate (host). Safe to call more than once.
+void cycleCounter_init();
+
+// Returns the number of counts per microsecond.
+double cycleCounter_getCyclesPerMicrosecond();
+
+#endif /* CYCLECOUNTER_H_ */
@@ -30,7 +30,9 @@
 #include "lockoutTimer.h"
 #include "hitLedTimer.h"
 #include "sort.h"
-#include "../../supportFiles/interrupts.h"
+#include "profiler.h"
+#include "eventJournal.h"
+#include "telemetry.h"
 #include <stdio.h>
 #define MAX_HIT_COUNT 10
 #define DETECTOR_HIT_ARRAY_SIZE 10
@@ -57,12 +59,8 @@
 #define DETECTOR_FUDGE_FACTOR 3000
 //Fudge factor
 
-volatile static bool hit_detected;
-//Keep track of whether there was a hit
-volatile static uint32_t adc_queue_elements_count;
-//Keep track of the number of elements in the adc queue
-volatile static detector_hitCount_t number_of_hits[FILTER_NUMBER_OF_PLAYERS];
-//Keep track of the number of hit per player
+static detector_ctx_t detector_defaultCtx;
+//Instance run by detector(); its hooks drive the lockout and hit-LED timers
 
 double detector_scaled_adc_value(uint16_t value)
 {
@@ -70,52 +68,125 @@ double detector_scaled_adc_value(uint16_t value)
     //Scaled adc value
 }
 
-//Detection algorithm to determine hits
-void detector_hit_detection_algorithm()
+//Power a player has to exceed to count as hit
+double detector_getHitThreshold(const double power[])
 {
-    double filter_power_values[FILTER_NUMBER_OF_PLAYERS];
-    //Create a vector for power values for all players
-    double original_filter_power_values[FILTER_NUMBER_OF_PLAYERS];
-    //Keep track of the power values for each of the players in a different vector
+    double sorted_power_values[FILTER_NUMBER_OF_PLAYERS];
+    //Sorted copy of the power values so the caller's array is left alone
 
     for (uint16_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
     {
-        filter_power_values[i] = filter_getCurrentPowerValue(i);
-        //Fill power value vector with current power values
-        original_filter_power_values[i] = filter_power_values[i];
-        //Set original vector with current power value
+        sorted_power_values[i] = power[i];
+        //Copy each player's power value
     }
 
-    quicksort(filter_power_values, FILTER_NUMBER_OF_PLAYERS);
+    quicksort(sorted_power_values, FILTER_NUMBER_OF_PLAYERS);
     //Call quicksort function for each power value for all players
 
-    for (int8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
+    return sorted_power_values[DETECTOR_HALF_MAX_NEW_INPUT_COUNT] * DETECTOR_FUDGE_FACTOR;
+    //Median power multiplied by our fudge factor
+}
+
+//First player whose power exceeds threshold
+static int16_t detector_findPlayerAbove(const double power[], double threshold)
+{
+    for (int16_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
     {
         //if original power value is greater than sorted power value multiplied by our fudge factor
-        if (original_filter_power_values[i] > filter_power_values[DETECTOR_HALF_MAX_NEW_INPUT_COUNT] * DETECTOR_FUDGE_FACTOR)
+        if (power[i] > threshold)
         {
-            //Set hit detected to true
-            hit_detected = true;
-            //Increment number of hits for that player
-            number_of_hits[i]++;
-            //Start lockout timer
-            lockoutTimer_start();
-            //Start hit led timer
-            hitLedTimer_start();
-
-            break;
+            return i;
+            //This player was hit
         }
     }
+    return DETECTOR_NO_HIT;
+    //Nobody stands out
 }
 
-// Always have to init things.
-void detector_init()
+//Hit-detection rule shared by the live detector and the detector instances
+int16_t detector_findHitPlayer(const double power[])
+{
+    return detector_findPlayerAbove(power, detector_getHitThreshold(power));
+    //Player whose power stands out from the others
+}
+
+//Lockout hook of the built-in instance
+static bool detector_lockoutTimerRunning(detector_ctx_t* ctx)
+{
+    (void) ctx;
+    //The timer is global, so the instance is not needed
+    return lockoutTimer_running();
+    //Suppress detection while the lockout timer runs
+}
+
+//Hit hook of the built-in instance
+static void detector_startHitTimers(detector_ctx_t* ctx, int16_t player)
+{
+    eventJournal_append(EVENT_JOURNAL_HIT, (uint8_t) player, (float) ctx->filter->currentPower[player], (float) ctx->hitThreshold);
+    //Record the hit with the power that caused it
+    lockoutTimer_start();
+    //Start lockout timer
+    hitLedTimer_start();
+    //Start hit led timer
+}
+
+//Clears everything but the filter and the hooks
+static void detector_clearState(detector_ctx_t* ctx)
 {
     for (uint8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
     {
-        number_of_hits[i] = DETECTOR_CLEAR_HIT_COUNT;
+        ctx->hitCounts[i] = DETECTOR_CLEAR_HIT_COUNT;
         //Set player hit count to 0 for each player
     }
+    ctx->hitDetected = false;
+    ctx->inputCount = DETECTOR_NEW_INPUT_COUNT_CLEAR;
+    ctx->lockoutRemaining = 0;
+    ctx->hitThreshold = 0;
+    ctx->sampleCount = 0;
+}
+
+//Runs the hit rule on the instance's power values and records any hit, ignoring the lockout
+static int16_t detector_detectHit(detector_ctx_t* ctx)
+{
+    double threshold = detector_getHitThreshold(ctx->filter->currentPower);
+    int16_t hit_player = detector_findPlayerAbove(ctx->filter->currentPower, threshold);
+    //Find the player that was hit, if any
+
+    if (hit_player != DETECTOR_NO_HIT)
+    {
+        //Set hit detected to true and keep the threshold for the hit hook
+        ctx->hitDetected = true;
+        ctx->hitThreshold = threshold;
+        //Increment number of hits for that player
+        ctx->hitCounts[hit_player]++;
+        if (ctx->onHit != NULL)
+        {
+            ctx->onHit(ctx, hit_player);
+            //Let the owner start its timers
+        }
+        else
+        {
+            ctx->lockoutRemaining = LOCKOUT_TIMER_EXPIRE_VALUE;
+            //Lock out further hits for as many samples as the lockout timer would count ticks
+        }
+    }
+    return hit_player;
+}
+
+//Detection algorithm to determine hits
+void detector_hit_detection_algorithm()
+{
+    detector_detectHit(&detector_defaultCtx);
+    //Run the hit rule on the built-in instance
+}
+
+// Always have to init things.
+void detector_init()
+{
+    detector_ctx_initWithFilter(&detector_defaultCtx, filter_getDefaultCtx());
+    //The built-in instance runs on the built-in filter
+    detector_ctx_setHooks(&detector_defaultCtx, detector_lockoutTimerRunning, detector_startHitTimers, NULL);
+    //Lockout and hit LED come from the hardware timers
 }
 
 // Runs the entire detector: decimating fir-filter, iir-filters, power-computation, hit-detection.
@@ -130,15 +201,15 @@ void detector_init()
 // Your frequency is simply the frequency indicated by the slide switches.
 void detector(bool interruptsEnabled, bool ignoreSelf)
 {
-    static uint8_t add_new_input_count = DETECTOR_NEW_INPUT_COUNT_CLEAR;
-    //We made this value static so it keeps it's value.
-    adc_queue_elements_count = isr_adcBufferElementCount();
+    uint32_t adc_queue_elements_count = isr_adcBufferElementCount();
     //We have a variable that keeps track of the elements.
     uint16_t raw_value;
     //This variable keeps track of the value that we are getting rid of.
 
     for (uint32_t i = 0; i < adc_queue_elements_count; i++)
     {
+        PROFILER_BEGIN(PROFILER_STAGE_ADC_DRAIN);
+        //Time the removal of one sample
         if (interruptsEnabled) //Interrupts are enabled
         {
             interrupts_disableArmInts(); //Disable interrupts briefly
@@ -151,31 +222,14 @@ void detector(bool interruptsEnabled, bool ignoreSelf)
             raw_value = isr_removeDataFromAdcBuffer();
             //Set raw value to remove from buffer
         }
+        PROFILER_END(PROFILER_STAGE_ADC_DRAIN);
 
-        filter_addNewInput(detector_scaled_adc_value(raw_value));
-        //Add new scaled input to filter
-        add_new_input_count++;
-        //Increment count
-
-        if (add_new_input_count >= DETECTOR_MAX_NEW_INPUT_COUNT) //Input count greater than 10
+        int16_t hit_player = detector_ctx_addSample(&detector_defaultCtx, raw_value);
+        //Run the sample through the built-in instance
+        if (detector_defaultCtx.inputCount == DETECTOR_NEW_INPUT_COUNT_CLEAR)
         {
-            add_new_input_count = DETECTOR_NEW_INPUT_COUNT_CLEAR;
-            //Clear input count
-            filter_firFilter();
-            //Call FIR filter
-            for (uint16_t j = 0; j < FILTER_NUMBER_OF_PLAYERS; j++)
-            {
-                filter_iirFilter(j);
-                //Call iir filter for every player
-                filter_computePower(j, false, false);
-                //Compute power for each player
-            }
-
-            if (!lockoutTimer_running())
-            {
-                detector_hit_detection_algorithm();
-                //Call hit detection algorithm
-            }
+            telemetry_publish(detector_defaultCtx.filter->currentPower, hit_player);
+            //A decimated sample was just processed: offer its power vector to telemetry
         }
     }
 }
@@ -183,14 +237,14 @@ void detector(bool interruptsEnabled, bool ignoreSelf)
 // Returns true if a hit was detected.
 bool detector_hitDetected()
 {
-    return hit_detected;
+    return detector_ctx_hitDetected(&detector_defaultCtx);
     //Return if there was a hit or not
 }
 
 // Clear the detected hit once you have accounted for it.
 void detector_clearHit()
 {
-    hit_detected = false;
+    detector_ctx_clearHit(&detector_defaultCtx);
     //Set hit detected to false
 }
 
@@ -198,10 +252,165 @@ void detector_clearHit()
 // Copy the current hit counts into the user-provided hitArray
 // using a for-loop.
 void detector_getHitCounts(detector_hitCount_t hitArray[])
+{
+    detector_ctx_getHitCounts(&detector_defaultCtx, hitArray);
+    //Fill array given with the number of hits array that we've been keeping track of
+}
+
+// Allocates a private filter for ctx and clears its hit counts, lockout and hooks.
+void detector_ctx_init(detector_ctx_t* ctx)
+{
+    filter_ctx_init(&ctx->ownFilter);
+    //Allocate the instance's filter queues
+    detector_ctx_initWithFilter(ctx, &ctx->ownFilter);
+    ctx->ownsFilter = true;
+    //The instance frees this filter on destroy
+}
+
+// Same as detector_ctx_init() but runs on an existing, already initialized filter that ctx does not own.
+void detector_ctx_initWithFilter(detector_ctx_t* ctx, filter_ctx_t* filter)
+{
+    ctx->filter = filter;
+    ctx->ownsFilter = false;
+    //Borrow the filter
+    detector_ctx_setHooks(ctx, NULL, NULL, NULL);
+    //Sample-counted lockout by default
+    detector_clearState(ctx);
+    //Clear the hit counts and lockout
+}
+
+// Installs the lockout and hit hooks of ctx (either may be NULL for the sample-counted lockout).
+void detector_ctx_setHooks(detector_ctx_t* ctx, detector_lockoutHook_t lockoutRunning, detector_hitHook_t onHit, void* user)
+{
+    ctx->lockoutRunning = lockoutRunning;
+    ctx->onHit = onHit;
+    ctx->user = user;
+}
+
+// Frees the storage allocated by detector_ctx_init(). A shared filter is left alone.
+void detector_ctx_destroy(detector_ctx_t* ctx)
+{
+    if (ctx->ownsFilter)
+    {
+        filter_ctx_destroy(&ctx->ownFilter);
+        //Free the instance's filter queues
+    }
+}
+
+// Returns ctx and its filter to the just-initialized state without reallocating. Hooks are kept.
+void detector_ctx_reset(detector_ctx_t* ctx)
+{
+    filter_ctx_reset(ctx->filter);
+    //Refill the filter queues and clear the power values
+    detector_clearState(ctx);
+    //Clear the hit counts and lockout
+}
+
+// Runs hit detection once on the current power values of ctx, applying the lockout and hooks.
+// Returns the player that was hit, or DETECTOR_NO_HIT.
+int16_t detector_ctx_runHitDetection(detector_ctx_t* ctx)
+{
+    bool locked_out = (ctx->lockoutRunning != NULL) ? ctx->lockoutRunning(ctx) : (ctx->lockoutRemaining > 0);
+    //Ask the hook, or look at the sample-counted lockout
+    if (locked_out)
+    {
+        return DETECTOR_NO_HIT;
+    }
+    int16_t hit_player;
+    PROFILER_BEGIN(PROFILER_STAGE_HIT_DETECTION);
+    hit_player = detector_detectHit(ctx);
+    //Call hit detection algorithm
+    PROFILER_END(PROFILER_STAGE_HIT_DETECTION);
+    return hit_player;
+}
+
+//Runs the iir filters, power computation and hit detection on the newest FIR output of ctx
+static int16_t detector_runFilterBank(detector_ctx_t* ctx)
+{
+    PROFILER_BEGIN(PROFILER_STAGE_IIR_BANK);
+    for (uint16_t j = 0; j < FILTER_NUMBER_OF_PLAYERS; j++)
+    {
+        filter_ctx_iirFilter(ctx->filter, j);
+        //Call iir filter for every player
+    }
+    PROFILER_END(PROFILER_STAGE_IIR_BANK);
+    PROFILER_BEGIN(PROFILER_STAGE_POWER);
+    for (uint16_t j = 0; j < FILTER_NUMBER_OF_PLAYERS; j++)
+    {
+        filter_ctx_computePower(ctx->filter, j, false, false);
+        //Compute power for each player
+    }
+    PROFILER_END(PROFILER_STAGE_POWER);
+
+    return detector_ctx_runHitDetection(ctx);
+    //Call hit detection algorithm unless locked out
+}
+
+// Runs one raw ADC sample through the instance (filtering, power, hit detection and lockout).
+// Returns the player that was hit on this sample, or DETECTOR_NO_HIT.
+int16_t detector_ctx_addSample(detector_ctx_t* ctx, uint16_t rawAdcValue)
+{
+    int16_t hit_player = DETECTOR_NO_HIT;
+    //Nobody hit unless the algorithm says so
+
+    ctx->sampleCount++;
+    //One more sample seen
+    if (ctx->lockoutRemaining > 0)
+    {
+        ctx->lockoutRemaining--;
+        //The lockout counts samples the same way the lockout timer counts ISR ticks
+    }
+
+    filter_ctx_addNewInput(ctx->filter, detector_scaled_adc_value(rawAdcValue));
+    //Add new scaled input to filter
+    ctx->inputCount++;
+    //Increment count
+
+    if (ctx->inputCount >= DETECTOR_MAX_NEW_INPUT_COUNT) //Input count greater than 10
+    {
+        ctx->inputCount = DETECTOR_NEW_INPUT_COUNT_CLEAR;
+        //Clear input count
+        PROFILER_BEGIN(PROFILER_STAGE_FIR);
+        filter_ctx_firFilter(ctx->filter);
+        //Call FIR filter
+        PROFILER_END(PROFILER_STAGE_FIR);
+        hit_player = detector_runFilterBank(ctx);
+        //Call the iir filters, compute power and run hit detection
+    }
+    return hit_player;
+}
+
+// Runs one FIR output (one decimated sample) through the rest of the instance: iir filters, power,
+// hit detection and lockout. Returns the player that was hit, or DETECTOR_NO_HIT.
+int16_t detector_ctx_addFirOutput(detector_ctx_t* ctx, double firOutput)
+{
+    ctx->sampleCount += DETECTOR_MAX_NEW_INPUT_COUNT;
+    //One FIR output stands for a full decimation's worth of samples
+    ctx->lockoutRemaining = (ctx->lockoutRemaining > DETECTOR_MAX_NEW_INPUT_COUNT) ? ctx->lockoutRemaining - DETECTOR_MAX_NEW_INPUT_COUNT : 0;
+    //Count the lockout down by the same number of samples
+    filter_ctx_pushFirOutput(ctx->filter, firOutput);
+    //Hand the FIR output to the iir filters
+    return detector_runFilterBank(ctx);
+}
+
+// Returns true if the instance detected a hit that has not been cleared.
+bool detector_ctx_hitDetected(detector_ctx_t* ctx)
+{
+    return ctx->hitDetected;
+}
+
+// Clears the detected hit of the instance.
+void detector_ctx_clearHit(detector_ctx_t* ctx)
+{
+    ctx->hitDetected = false;
+}
+
+// Copies the hit counts of the instance into hitArray.
+void detector_ctx_getHitCounts(detector_ctx_t* ctx, detector_hitCount_t hitArray[])
 {
     for (uint8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
     {
-        hitArray[i] = number_of_hits[i];
+        hitArray[i] = ctx->hitCounts[i];
         //Fill array given with the number of hits array that we've been keeping track of
     }
 }
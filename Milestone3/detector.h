@@ -4,10 +4,41 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "queue.h"
+#include "filter.h"
 
 
 typedef uint16_t detector_hitCount_t;
 
+// Returned by detector_findHitPlayer() and detector_ctx_addSample() when no hit was detected.
+#define DETECTOR_NO_HIT -1
+
+typedef struct detector_ctx detector_ctx_t;
+
+// Per-instance lockout hook: returns true while hit detection should be suppressed.
+typedef bool (*detector_lockoutHook_t)(detector_ctx_t* ctx);
+
+// Per-instance hit hook: called once for every detected hit, after the hit has been counted.
+typedef void (*detector_hitHook_t)(detector_ctx_t* ctx, int16_t player);
+
+// All of the state needed to run one detector over a stream of raw ADC samples.
+// An instance never touches the ADC buffer. With no hooks installed the lockout is counted in samples,
+// so any number of instances can run side by side (e.g. one per thread). detector() runs the built-in
+// instance, whose hooks use the lockout timer and the hit-LED timer.
+struct detector_ctx {
+    filter_ctx_t* filter;                                    // Filter pipeline in use (ownFilter or a shared one).
+    filter_ctx_t ownFilter;                                  // Storage used by detector_ctx_init().
+    bool ownsFilter;                                         // True if filter == &ownFilter.
+    detector_lockoutHook_t lockoutRunning;                   // NULL: use lockoutRemaining.
+    detector_hitHook_t onHit;                                // NULL: start the sample-counted lockout.
+    void* user;                                              // Free for the hooks' use.
+    detector_hitCount_t hitCounts[FILTER_NUMBER_OF_PLAYERS]; // Hits detected per player.
+    bool hitDetected;                                        // Set on a hit, cleared by the caller.
+    uint8_t inputCount;                                      // Samples added since the last decimated output.
+    uint32_t lockoutRemaining;                               // Samples left before hit detection resumes.
+    double hitThreshold;                                     // Threshold the last detected hit exceeded.
+    uint64_t sampleCount;                                    // Samples added since init/reset.
+};
+
 // Always have to init things.
 void detector_init();
 
@@ -23,6 +54,10 @@ void detector_init();
 // Your frequency is simply the frequency indicated by the slide switches.
 void detector(bool interruptsEnabled, bool ignoreSelf);
 
+// Runs the hit-detection algorithm once on the current filter power values.
+// Called by detector() after each decimated sample unless the lockout timer is running.
+void detector_hit_detection_algorithm();
+
 // Returns true if a hit was detected.
 bool detector_hitDetected();
 
@@ -34,6 +69,49 @@ void detector_clearHit();
 // using a for-loop.
 void detector_getHitCounts(detector_hitCount_t hitArray[]);
 
+// Scales a raw 12-bit ADC code to the -1.0 .. 1.0 range the filters expect.
+double detector_scaled_adc_value(uint16_t value);
+
+// Returns the power a player has to exceed to count as hit (the median power times the fudge factor).
+double detector_getHitThreshold(const double power[]);
+
+// Returns the player whose power stands out from the others (the hit-detection rule used by detector()),
+// or DETECTOR_NO_HIT. Does not modify power[].
+int16_t detector_findHitPlayer(const double power[]);
+
+// Allocates a private filter for ctx and clears its hit counts, lockout and hooks.
+void detector_ctx_init(detector_ctx_t* ctx);
+
+// Same as detector_ctx_init() but runs on an existing, already initialized filter that ctx does not own.
+void detector_ctx_initWithFilter(detector_ctx_t* ctx, filter_ctx_t* filter);
+
+// Installs the lockout and hit hooks of ctx (either may be NULL for the sample-counted lockout).
+void detector_ctx_setHooks(detector_ctx_t* ctx, detector_lockoutHook_t lockoutRunning, detector_hitHook_t onHit, void* user);
+
+// Frees the storage allocated by detector_ctx_init(). A shared filter is left alone.
+void detector_ctx_destroy(detector_ctx_t* ctx);
+
+// Returns ctx and its filter to the just-initialized state without reallocating. Hooks are kept.
+void detector_ctx_reset(detector_ctx_t* ctx);
+
+// Runs hit detection once on the current power values of ctx, applying the lockout and hooks.
+// Returns the player that was hit, or DETECTOR_NO_HIT.
+int16_t detector_ctx_runHitDetection(detector_ctx_t* ctx);
+
+// Runs one raw ADC sample through the instance (filtering, power, hit detection and lockout).
+// Returns the player that was hit on this sample, or DETECTOR_NO_HIT.
+int16_t detector_ctx_addSample(detector_ctx_t* ctx, uint16_t rawAdcValue);
+
+// Runs one FIR output computed elsewhere through the IIR filters, power computation, hit detection
+// and lockout of ctx (the second half of detector_ctx_addSample()). Used by the pipelined detector.
+// Returns the player that was hit, or DETECTOR_NO_HIT.
+int16_t detector_ctx_addFirOutput(detector_ctx_t* ctx, double firOutput);
+
+// Same as detector_hitDetected(), detector_clearHit() and detector_getHitCounts() for an instance.
+bool detector_ctx_hitDetected(detector_ctx_t* ctx);
+void detector_ctx_clearHit(detector_ctx_t* ctx);
+void detector_ctx_getHitCounts(detector_ctx_t* ctx, detector_hitCount_t hitArray[]);
+
 // Test function
 void detector_runTest();
 
@@ -0,0 +1,162 @@
+/*********************************************************************************************************/
+/* File: displayThrottle.c                                                                               */
+/* Purpose: Lowers and restores the histogram refresh with the ADC backlog (see displayThrottle.h).      */
+/*********************************************************************************************************/
+#include "displayThrottle.h"
+#include "histogram.h"
+
+static const char* displayThrottle_levelNames[DISPLAY_THROTTLE_LEVEL_COUNT] = {
+    "full", "reduced_rate", "no_labels", "coalesced"
+};
+
+static scheduler_taskId_t displayThrottle_displayTask;
+static uint32_t displayThrottle_fullPeriodTicks;
+static uint32_t displayThrottle_windowHighWater;   // Highest backlog in the current window.
+static uint32_t displayThrottle_quietWindows;      // Consecutive windows below the lower threshold.
+static displayThrottle_stats_t displayThrottle_stats;
+
+/*********************************************************************************************************/
+/* Function: displayThrottle_apply                                                                       */
+/* Purpose: Sets the histogram task period and the histogram load shedding for the current level.        */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void displayThrottle_apply()
+{
+    displayThrottle_level_t level = displayThrottle_stats.level;
+    scheduler_setPeriod(displayThrottle_displayTask, (level >= DISPLAY_THROTTLE_REDUCED_RATE) ?
+                        displayThrottle_fullPeriodTicks * DISPLAY_THROTTLE_RATE_DIVISOR : displayThrottle_fullPeriodTicks);
+    histogram_setTopLabelsEnabled(level < DISPLAY_THROTTLE_NO_LABELS);
+    histogram_setMinBarChange((level >= DISPLAY_THROTTLE_COALESCED) ?
+                              DISPLAY_THROTTLE_COALESCE_PIXELS : HISTOGRAM_MIN_BAR_CHANGE_ANY);
+}
+
+/*********************************************************************************************************/
+/* Function: displayThrottle_init                                                                        */
+/* Purpose: Clears the counters and starts at full refresh.                                              */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void displayThrottle_init(scheduler_taskId_t displayTask, uint32_t fullPeriodTicks)
+{
+    displayThrottle_displayTask = displayTask;
+    displayThrottle_fullPeriodTicks = fullPeriodTicks;
+    displayThrottle_windowHighWater = 0;
+    displayThrottle_quietWindows = 0;
+    displayThrottle_stats = (displayThrottle_stats_t) {DISPLAY_THROTTLE_FULL, 0, 0, 0, {0}, 0, 0, 0, 0};
+    displayThrottle_apply();
+}
+
+/*********************************************************************************************************/
+/* Function: displayThrottle_noteBacklog                                                                 */
+/* Purpose: Raises the window's high-water mark.                                                         */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void displayThrottle_noteBacklog(uint32_t samples)
+{
+    if (samples > displayThrottle_windowHighWater)
+    {
+        displayThrottle_windowHighWater = samples;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: displayThrottle_update                                                                      */
+/* Purpose: Ends a window. One level up at once when the detector fell behind; one level down after a    */
+/*          run of quiet windows.                                                                        */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void displayThrottle_update()
+{
+    displayThrottle_stats_t* stats = &displayThrottle_stats;
+    uint32_t highWater = displayThrottle_windowHighWater;
+    displayThrottle_windowHighWater = 0;
+    stats->windows++;
+    stats->windowsAtLevel[stats->level]++;
+    stats->lastHighWater = highWater;
+    if (highWater > stats->maxHighWater)
+    {
+        stats->maxHighWater = highWater;
+    }
+
+    displayThrottle_level_t level = stats->level;
+    if (highWater > DISPLAY_THROTTLE_RAISE_SAMPLES)
+    {
+        displayThrottle_quietWindows = 0;
+        if (level + 1 < DISPLAY_THROTTLE_LEVEL_COUNT)
+        {
+            level = (displayThrottle_level_t) (level + 1);
+            stats->raises++;
+        }
+    }
+    else if (highWater < DISPLAY_THROTTLE_LOWER_SAMPLES)
+    {
+        if (++displayThrottle_quietWindows >= DISPLAY_THROTTLE_LOWER_WINDOWS && level > DISPLAY_THROTTLE_FULL)
+        {
+            displayThrottle_quietWindows = 0;
+            level = (displayThrottle_level_t) (level - 1);
+            stats->lowers++;
+        }
+    }
+    else
+    {
+        displayThrottle_quietWindows = 0;   // In between: hold the level.
+    }
+    if (level != stats->level)
+    {
+        stats->level = level;
+        displayThrottle_apply();
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: displayThrottle_task                                                                        */
+/* Purpose: Scheduler task wrapper for displayThrottle_update().                                         */
+/* Returns: False (done in one slice).                                                                   */
+/*********************************************************************************************************/
+bool displayThrottle_task(void* user)
+{
+    (void) user;
+    displayThrottle_update();
+    return false;
+}
+
+/*********************************************************************************************************/
+/* Function: displayThrottle_getStats                                                                    */
+/* Purpose: Copies the counters, with the histogram's skip counts filled in.                             */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void displayThrottle_getStats(displayThrottle_stats_t* stats)
+{
+    *stats = displayThrottle_stats;
+    stats->coalescedBars = histogram_getCoalescedBarCount();
+    stats->skippedLabels = histogram_getSkippedLabelCount();
+}
+
+/*********************************************************************************************************/
+/* Function: displayThrottle_getLevelName                                                                */
+/* Purpose: Looks up the name of a level.                                                                */
+/* Returns: The name, or "?" for an unknown level.                                                       */
+/*********************************************************************************************************/
+const char* displayThrottle_getLevelName(displayThrottle_level_t level)
+{
+    return (level < DISPLAY_THROTTLE_LEVEL_COUNT) ? displayThrottle_levelNames[level] : "?";
+}
+
+/*********************************************************************************************************/
+/* Function: displayThrottle_dump                                                                        */
+/* Purpose: Prints the counters.                                                                         */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void displayThrottle_dump(FILE* out)
+{
+    displayThrottle_stats_t stats;
+    displayThrottle_getStats(&stats);
+    fprintf(out, "display throttle: level %s, %lu windows, %lu raises, %lu lowers, high water %lu (max %lu)\n\r",
+            displayThrottle_getLevelName(stats.level), (unsigned long) stats.windows, (unsigned long) stats.raises,
+            (unsigned long) stats.lowers, (unsigned long) stats.lastHighWater, (unsigned long) stats.maxHighWater);
+    for (uint16_t i = 0; i < DISPLAY_THROTTLE_LEVEL_COUNT; i++)
+    {
+        fprintf(out, "    %-14s %lu windows\n\r", displayThrottle_levelNames[i], (unsigned long) stats.windowsAtLevel[i]);
+    }
+    fprintf(out, "    %lu bar redraws coalesced, %lu top labels skipped\n\r", (unsigned long) stats.coalescedBars,
+            (unsigned long) stats.skippedLabels);
+}
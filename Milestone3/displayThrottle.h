@@ -0,0 +1,69 @@
+#ifndef DISPLAYTHROTTLE_H_
+#define DISPLAYTHROTTLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "scheduler.h"
+
+// Sheds display work when the detector falls behind. The detector task reports the ADC backlog it
+// finds each time it runs; every window the throttle looks at the highest backlog seen (the
+// high-water mark). A high-water mark above DISPLAY_THROTTLE_RAISE_SAMPLES moves one level up; a run
+// of DISPLAY_THROTTLE_LOWER_WINDOWS windows below DISPLAY_THROTTLE_LOWER_SAMPLES moves one level
+// down, so full refresh comes back only once there is steady headroom. Each level keeps the
+// measures of the levels below it:
+//   reduced rate:  the histogram task runs DISPLAY_THROTTLE_RATE_DIVISOR times less often;
+//   no labels:     top labels are not redrawn;
+//   coalesced:     bars are not redrawn until they move DISPLAY_THROTTLE_COALESCE_PIXELS.
+
+#define DISPLAY_THROTTLE_WINDOW_TICKS 10000     // 100 ms of ISR ticks per high-water window.
+#define DISPLAY_THROTTLE_RAISE_SAMPLES 1000     // 10 ms behind: shed more.
+#define DISPLAY_THROTTLE_LOWER_SAMPLES 200      // 2 ms behind: headroom.
+#define DISPLAY_THROTTLE_LOWER_WINDOWS 10       // 1 s of headroom before restoring a level.
+#define DISPLAY_THROTTLE_RATE_DIVISOR 4
+#define DISPLAY_THROTTLE_COALESCE_PIXELS 8
+
+typedef enum {
+    DISPLAY_THROTTLE_FULL,
+    DISPLAY_THROTTLE_REDUCED_RATE,
+    DISPLAY_THROTTLE_NO_LABELS,
+    DISPLAY_THROTTLE_COALESCED,
+    DISPLAY_THROTTLE_LEVEL_COUNT
+} displayThrottle_level_t;
+
+// Counters for the decisions taken.
+typedef struct {
+    displayThrottle_level_t level;                      // Current level.
+    uint32_t windows;                                   // Windows evaluated.
+    uint32_t raises;                                    // Moves to a higher level.
+    uint32_t lowers;                                    // Moves to a lower level.
+    uint32_t windowsAtLevel[DISPLAY_THROTTLE_LEVEL_COUNT];
+    uint32_t lastHighWater;                             // High-water mark of the last window.
+    uint32_t maxHighWater;                              // Highest backlog seen.
+    uint32_t coalescedBars;                             // From histogram_getCoalescedBarCount().
+    uint32_t skippedLabels;                             // From histogram_getSkippedLabelCount().
+} displayThrottle_stats_t;
+
+// Starts at full refresh. displayTask is the histogram task and fullPeriodTicks its full-rate period.
+void displayThrottle_init(scheduler_taskId_t displayTask, uint32_t fullPeriodTicks);
+
+// Called by the detector with the ADC backlog it is about to drain.
+void displayThrottle_noteBacklog(uint32_t samples);
+
+// Ends a window: takes the high-water mark, moves the level if needed and applies it. Call every
+// DISPLAY_THROTTLE_WINDOW_TICKS (as a scheduler task, see displayThrottle_task()).
+void displayThrottle_update();
+
+// displayThrottle_update() in the form of a scheduler task.
+bool displayThrottle_task(void* user);
+
+// Copies the counters.
+void displayThrottle_getStats(displayThrottle_stats_t* stats);
+
+// Returns the printable name of a level.
+const char* displayThrottle_getLevelName(displayThrottle_level_t level);
+
+// Prints the counters. Use stdout to dump over the UART on the board.
+void displayThrottle_dump(FILE* out);
+
+#endif /* DISPLAYTHROTTLE_H_ */
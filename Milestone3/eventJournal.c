@@ -0,0 +1,196 @@
+/*********************************************************************************************************/
+/* File: eventJournal.c                                                                                  */
+/* Purpose: Lock-free ring of timestamped event records with batched flushes to a sink                   */
+/*          (see eventJournal.h).                                                                        */
+/*********************************************************************************************************/
+#include "eventJournal.h"
+
+#ifdef EVENT_JOURNAL_ENABLED
+
+#include <stdio.h>
+#include <string.h>
+#include "isr.h"
+#if defined(__arm__) && !defined(__linux__)
+#include "xil_printf.h"
+#endif
+
+#define EVENT_JOURNAL_INDEX_MASK (EVENT_JOURNAL_CAPACITY - 1)
+#define EVENT_JOURNAL_CRC_POLYNOMIAL 0x1021
+
+// The ring. reserveIndex counts slots claimed by writers, flushIndex slots handed to the sink; both
+// only grow (and wrap together). A slot is published once its sequence equals the low 16 bits of
+// the index it was claimed at, which is never true of a slot left over from the previous lap.
+static eventJournal_record_t eventJournal_ring[EVENT_JOURNAL_CAPACITY];
+static uint32_t eventJournal_reserveIndex;
+static uint32_t eventJournal_flushIndex;
+static uint32_t eventJournal_dropped;
+static eventJournal_sink_t eventJournal_sink;
+
+#if !(defined(__arm__) && !defined(__linux__))
+static FILE* eventJournal_hostFile = NULL;
+#endif
+
+/*********************************************************************************************************/
+/* Function: eventJournal_crc16                                                                          */
+/* Purpose: Bitwise CRC-16/CCITT, the same one telemetry frames carry.                                   */
+/* Returns: The updated CRC.                                                                             */
+/*********************************************************************************************************/
+uint16_t eventJournal_crc16(uint16_t crc, const uint8_t bytes[], uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        crc ^= (uint16_t) (bytes[i] << 8);
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ EVENT_JOURNAL_CRC_POLYNOMIAL) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*********************************************************************************************************/
+/* Function: eventJournal_defaultSink                                                                    */
+/* Purpose: Frames each record and writes the frames over the UART (board) or to                         */
+/*          EVENT_JOURNAL_HOST_FILE (host).                                                              */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void eventJournal_defaultSink(const eventJournal_record_t records[], uint32_t count)
+{
+    uint8_t frames[EVENT_JOURNAL_FLUSH_BATCH * EVENT_JOURNAL_FRAME_SIZE];
+    uint8_t* frame = frames;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        frame[0] = EVENT_JOURNAL_SYNC_0;
+        frame[1] = EVENT_JOURNAL_SYNC_1;
+        frame[EVENT_JOURNAL_LENGTH_INDEX] = (uint8_t) sizeof(eventJournal_record_t);
+        memcpy(&frame[EVENT_JOURNAL_FRAME_HEADER_SIZE], &records[i], sizeof(eventJournal_record_t));
+        uint32_t crcIndex = EVENT_JOURNAL_FRAME_SIZE - EVENT_JOURNAL_CRC_SIZE;
+        uint16_t crc = eventJournal_crc16(EVENT_JOURNAL_CRC_INITIAL_VALUE, &frame[EVENT_JOURNAL_LENGTH_INDEX], crcIndex - EVENT_JOURNAL_LENGTH_INDEX);
+        frame[crcIndex] = (uint8_t) crc;
+        frame[crcIndex + 1] = (uint8_t) (crc >> 8);
+        frame += EVENT_JOURNAL_FRAME_SIZE;
+    }
+    uint32_t byteCount = (uint32_t) (frame - frames);
+#if defined(__arm__) && !defined(__linux__)
+    for (uint32_t i = 0; i < byteCount; i++)
+    {
+        outbyte(frames[i]);
+    }
+#else
+    if (eventJournal_hostFile == NULL)
+    {
+        eventJournal_hostFile = fopen(EVENT_JOURNAL_HOST_FILE, "ab");
+        if (eventJournal_hostFile == NULL)
+        {
+            printf("eventJournal: cannot open %s\n", EVENT_JOURNAL_HOST_FILE);
+            return;
+        }
+    }
+    fwrite(frames, 1, byteCount, eventJournal_hostFile);
+    fflush(eventJournal_hostFile);
+#endif
+}
+
+/*********************************************************************************************************/
+/* Function: eventJournal_init                                                                           */
+/* Purpose: Empties the ring, clears the drop count and selects the default sink.                        */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void eventJournal_init()
+{
+    // Mark every slot as belonging to the lap before the first one.
+    for (uint32_t i = 0; i < EVENT_JOURNAL_CAPACITY; i++)
+    {
+        eventJournal_ring[i].sequence = (uint16_t) (i - EVENT_JOURNAL_CAPACITY);
+    }
+    eventJournal_reserveIndex = 0;
+    eventJournal_flushIndex = 0;
+    eventJournal_dropped = 0;
+    eventJournal_sink = eventJournal_defaultSink;
+}
+
+/*********************************************************************************************************/
+/* Function: eventJournal_setSink                                                                        */
+/* Purpose: Replaces the sink; NULL selects the default one.                                             */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void eventJournal_setSink(eventJournal_sink_t sink)
+{
+    eventJournal_sink = (sink == NULL) ? eventJournal_defaultSink : sink;
+}
+
+/*********************************************************************************************************/
+/* Function: eventJournal_append                                                                         */
+/* Purpose: Claims a slot with a compare-and-swap, fills it in and publishes it. Drops the event if the  */
+/*          ring is full.                                                                                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void eventJournal_append(eventJournal_type_t type, uint8_t player, float power, float reference)
+{
+    uint32_t index = __atomic_load_n(&eventJournal_reserveIndex, __ATOMIC_RELAXED);
+    do
+    {
+        // The slot is free once the previous lap's record in it has been flushed.
+        if (index - __atomic_load_n(&eventJournal_flushIndex, __ATOMIC_ACQUIRE) >= EVENT_JOURNAL_CAPACITY)
+        {
+            __atomic_fetch_add(&eventJournal_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&eventJournal_reserveIndex, &index, index + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    eventJournal_record_t* record = &eventJournal_ring[index & EVENT_JOURNAL_INDEX_MASK];
+    record->tick = isr_getTickCount();
+    record->type = (uint8_t) type;
+    record->player = player;
+    record->power = power;
+    record->reference = reference;
+    // Publish: the fields above must be visible before the sequence number is.
+    __atomic_store_n(&record->sequence, (uint16_t) index, __ATOMIC_RELEASE);
+}
+
+/*********************************************************************************************************/
+/* Function: eventJournal_flush                                                                          */
+/* Purpose: Copies published records, oldest first, into a batch, frees their slots and hands the batch  */
+/*          to the sink, until it reaches a slot that is empty or still being written.                   */
+/* Returns: The number of records flushed.                                                               */
+/*********************************************************************************************************/
+uint32_t eventJournal_flush()
+{
+    eventJournal_record_t batch[EVENT_JOURNAL_FLUSH_BATCH];
+    uint32_t flushed = 0;
+    while (true)
+    {
+        uint32_t index = eventJournal_flushIndex;
+        uint32_t count = 0;
+        while (count < EVENT_JOURNAL_FLUSH_BATCH)
+        {
+            const eventJournal_record_t* record = &eventJournal_ring[(index + count) & EVENT_JOURNAL_INDEX_MASK];
+            if (__atomic_load_n(&record->sequence, __ATOMIC_ACQUIRE) != (uint16_t) (index + count))
+            {
+                break;
+            }
+            batch[count++] = *record;
+        }
+        if (count == 0)
+        {
+            break;
+        }
+        // Hand the slots back to the writers before the (possibly slow) sink runs.
+        __atomic_store_n(&eventJournal_flushIndex, index + count, __ATOMIC_RELEASE);
+        eventJournal_sink(batch, count);
+        flushed += count;
+    }
+    return flushed;
+}
+
+/*********************************************************************************************************/
+/* Function: eventJournal_droppedCount                                                                   */
+/* Purpose: Reports how many events found the ring full.                                                 */
+/* Returns: The drop count.                                                                              */
+/*********************************************************************************************************/
+uint32_t eventJournal_droppedCount()
+{
+    return __atomic_load_n(&eventJournal_dropped, __ATOMIC_RELAXED);
+}
+
+#endif /* EVENT_JOURNAL_ENABLED */
@@ -0,0 +1,95 @@
+#ifndef EVENTJOURNAL_H_
+#define EVENTJOURNAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The event journal keeps a timestamped record of every hit, shot, lockout and frequency change so
+// that a game can be reconstructed afterwards and the scores of several vests reconciled.
+//
+// Records are appended to a ring from wherever the event happens (the ISR, the main loop or the
+// second core). Appending is lock-free: a writer claims a slot with one compare-and-swap, fills it
+// in and publishes it by writing its sequence number last. The main loop calls eventJournal_flush()
+// to hand the published records, in order, to a sink a batch at a time. When the ring is full new
+// events are dropped and counted rather than blocking the writer.
+//
+// The default sink streams the records over the UART with outbyte() on the board and appends them
+// to EVENT_JOURNAL_HOST_FILE on a host, one frame per record:
+//   0xA5 0xC3 | length | record | CRC-16
+// The record is written as it is laid out in memory (eventJournal_record_t, little-endian on both the
+// Zynq and a PC) and length is its size. The CRC-16/CCITT (polynomial 0x1021, initial 0xFFFF) covers
+// length and record. printf output shares the UART, so a decoder looks for the sync bytes and skips
+// anything whose CRC does not match (see host/eventJournalMain.c).
+//
+// Uncomment the line below (or build with -DEVENT_JOURNAL_ENABLED) to record events. When it is
+// commented out the functions below are empty inlines, so there is no run-time cost.
+//#define EVENT_JOURNAL_ENABLED
+
+#define EVENT_JOURNAL_CAPACITY 256          // Records in the ring; a power of two.
+#define EVENT_JOURNAL_FLUSH_BATCH 32        // Records handed to the sink per call.
+#define EVENT_JOURNAL_NO_PLAYER 0xFF        // Player field of events that are not about a player.
+#define EVENT_JOURNAL_HOST_FILE "eventJournal.bin"
+
+// Frames written by the default sink. The second sync byte differs from telemetry's.
+#define EVENT_JOURNAL_SYNC_0 0xA5
+#define EVENT_JOURNAL_SYNC_1 0xC3
+#define EVENT_JOURNAL_LENGTH_INDEX 2        // The CRC covers the frame from here to the record's end.
+#define EVENT_JOURNAL_FRAME_HEADER_SIZE 3   // Sync and length.
+#define EVENT_JOURNAL_CRC_SIZE 2
+#define EVENT_JOURNAL_CRC_INITIAL_VALUE 0xFFFF
+
+// Event types.
+typedef enum {
+    EVENT_JOURNAL_HIT = 1,                  // player was hit; power is its power, reference the hit threshold.
+    EVENT_JOURNAL_SHOT,                     // This vest fired on frequency player.
+    EVENT_JOURNAL_LOCKOUT_START,            // The lockout timer started.
+    EVENT_JOURNAL_FREQUENCY_CHANGE          // This vest now fires on frequency player.
+} eventJournal_type_t;
+
+// One journal record (16 bytes).
+typedef struct {
+    uint32_t tick;          // isr_getTickCount() when the event was appended (low 32 bits).
+    uint8_t type;           // eventJournal_type_t.
+    uint8_t player;         // Player (frequency number) or EVENT_JOURNAL_NO_PLAYER.
+    uint16_t sequence;      // Append order (wraps). Events dropped on a full ring never get one (see
+                            // eventJournal_droppedCount()); a gap in a decoded stream is a frame lost on the way.
+    float power;            // Power snapshot (0 if not applicable).
+    float reference;        // Reference the power was compared against (0 if not applicable).
+} eventJournal_record_t;
+
+#define EVENT_JOURNAL_FRAME_SIZE (EVENT_JOURNAL_FRAME_HEADER_SIZE + sizeof(eventJournal_record_t) + EVENT_JOURNAL_CRC_SIZE)
+
+// Receives a batch of flushed records, oldest first.
+typedef void (*eventJournal_sink_t)(const eventJournal_record_t records[], uint32_t count);
+
+#ifdef EVENT_JOURNAL_ENABLED
+
+// Empties the ring, clears the drop count and selects the default sink.
+void eventJournal_init();
+
+// Replaces the sink (NULL selects the default sink).
+void eventJournal_setSink(eventJournal_sink_t sink);
+
+// Appends an event. Safe to call from the ISR, the main loop and the second core at the same time.
+void eventJournal_append(eventJournal_type_t type, uint8_t player, float power, float reference);
+
+// Main loop only: hands every published record to the sink. Returns the number of records flushed.
+uint32_t eventJournal_flush();
+
+// Returns the number of events dropped because the ring was full.
+uint32_t eventJournal_droppedCount();
+
+// CRC-16/CCITT of a byte range, continuing from crc (start a frame with EVENT_JOURNAL_CRC_INITIAL_VALUE).
+uint16_t eventJournal_crc16(uint16_t crc, const uint8_t bytes[], uint32_t count);
+
+#else
+
+static inline void eventJournal_init() {}
+static inline void eventJournal_setSink(eventJournal_sink_t) {}
+static inline void eventJournal_append(eventJournal_type_t, uint8_t, float, float) {}
+static inline uint32_t eventJournal_flush() { return 0; }
+static inline uint32_t eventJournal_droppedCount() { return 0; }
+
+#endif /* EVENT_JOURNAL_ENABLED */
+
+#endif /* EVENTJOURNAL_H_ */
@@ -95,12 +95,8 @@ const double FILTER_IIR_B_COEFF[FILTER_NUMBER_OF_PLAYERS][FILTER_IIR_B_COEFF_COU
 	{9.0906203307668878e-10,   0.0000000000000000e+00,  -4.5453101653834434e-09,   0.0000000000000000e+00,   9.0906203307668868e-09,   0.0000000000000000e+00,  -9.0906203307668868e-09,   0.0000000000000000e+00,   4.5453101653834434e-09,   0.0000000000000000e+00,  -9.0906203307668878e-10},
 };
 
-// Define the static variables used in the filter program (xQueue, yQueue, zQueue, outputQueue, and the last power computed).
-static queue_t xQueue;
-static queue_t yQueue;
-static queue_t zQueue[FILTER_NUMBER_OF_PLAYERS];
-static queue_t outputQueue[FILTER_NUMBER_OF_PLAYERS];
-static double last_power_computed = 0.0;
+// Define the filter instance used by the filter_* functions (xQueue, yQueue, zQueue, outputQueue, and the power values).
+static filter_ctx_t filter_defaultCtx;
 
 /*********************************************************************************************************/
 /* Function: square                                                                                      */
@@ -115,34 +111,34 @@ double square(double value)
 
 /*********************************************************************************************************/
 /* Function: initXQueue                                                                                  */
-/* Purpose: To initialize the xQueue for the program.                                                    */
+/* Purpose: To initialize the xQueue for the passed filter instance.                                     */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
-void initXQueue()
+void initXQueue(filter_ctx_t* ctx)
 {
 	// Initialize the queue and fill it with init values.
-    queue_init(&xQueue, FILTER_X_QUEUE_SIZE, "xQueue");
-    filter_fillQueue(&xQueue, FILTER_QUEUE_INIT_VALUE);
+    queue_init(&ctx->xQueue, FILTER_X_QUEUE_SIZE, "xQueue");
+    filter_fillQueue(&ctx->xQueue, FILTER_QUEUE_INIT_VALUE);
 }
 
 /*********************************************************************************************************/
 /* Function: initYQueue                                                                                  */
-/* Purpose: To initialize the yQueue for the program.                                                    */
+/* Purpose: To initialize the yQueue for the passed filter instance.                                     */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
-void initYQueue()
+void initYQueue(filter_ctx_t* ctx)
 {
 	// Initialize the queue and fill it with init values.
-    queue_init(&yQueue, FILTER_Y_QUEUE_SIZE, FILTER_Y_QUEUE_NAME);
-    filter_fillQueue(&yQueue, FILTER_QUEUE_INIT_VALUE);
+    queue_init(&ctx->yQueue, FILTER_Y_QUEUE_SIZE, FILTER_Y_QUEUE_NAME);
+    filter_fillQueue(&ctx->yQueue, FILTER_QUEUE_INIT_VALUE);
 }
 
 /*********************************************************************************************************/
 /* Function: initZQueue                                                                                  */
-/* Purpose: To initialize the zQueue for the program.                                                    */
+/* Purpose: To initialize the zQueues for the passed filter instance.                                    */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
- void initZQueue()
+ void initZQueue(filter_ctx_t* ctx)
 {
 	// For every single number of players (the number of filters used).
     for(uint8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
@@ -152,17 +148,17 @@ void initYQueue()
 
 		// Create the queue name, initialize the queue, and fill it with queue init values.
         sprintf(temp_string, "%s #%d", FILTER_FILTER_Z_QUEUE_NAME, i);
-        queue_init(&zQueue[i], FILTER_Z_QUEUE_SIZE, temp_string);
-        filter_fillQueue(&zQueue[i], FILTER_QUEUE_INIT_VALUE);
+        queue_init(&ctx->zQueue[i], FILTER_Z_QUEUE_SIZE, temp_string);
+        filter_fillQueue(&ctx->zQueue[i], FILTER_QUEUE_INIT_VALUE);
     }
 }
 
 /*********************************************************************************************************/
 /* Function: initOutputQueue                                                                             */
-/* Purpose: To initialize the output queue for the program.                                              */
+/* Purpose: To initialize the output queues for the passed filter instance.                              */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
-void initOutputQueue()
+void initOutputQueue(filter_ctx_t* ctx)
 {
 	// For every single number of players (the number of filters used).
     for(uint8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
@@ -172,22 +168,109 @@ void initOutputQueue()
 
 		// Create the queue name, initialize the queue, and fill it will queue init values.
 		sprintf(temp_string, "%s #%d", FILTER_OUTPUT_QUEUE_NAME, i);
-        queue_init(&(outputQueue[i]), FILTER_OUTPUT_QUEUE_SIZE, temp_string);
-        filter_fillQueue(&outputQueue[i], FILTER_QUEUE_INIT_VALUE);
+        queue_init(&(ctx->outputQueue[i]), FILTER_OUTPUT_QUEUE_SIZE, temp_string);
+        filter_fillQueue(&ctx->outputQueue[i], FILTER_QUEUE_INIT_VALUE);
     }
 }
 
+/*********************************************************************************************************/
+/* Function: clearPowerValues                                                                            */
+/* Purpose: To zero the current, previous and oldest power values of the passed filter instance.         */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void clearPowerValues(filter_ctx_t* ctx)
+{
+	// For every single player number, clear the power bookkeeping.
+    for(uint8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
+    {
+        ctx->currentPower[i] = FILTER_QUEUE_INIT_VALUE;
+        ctx->previousPower[i] = FILTER_QUEUE_INIT_VALUE;
+        ctx->oldestValue[i] = FILTER_QUEUE_INIT_VALUE;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: filter_getDefaultCtx                                                                        */
+/* Purpose: To give other modules (the detector) access to the instance behind the filter_* functions.   */
+/* Returns: A pointer to the built-in filter instance.                                                   */
+/*********************************************************************************************************/
+filter_ctx_t* filter_getDefaultCtx()
+{
+	// Return the address of the built-in instance.
+    return &filter_defaultCtx;
+}
+
+/*********************************************************************************************************/
+/* Function: filter_ctx_init                                                                             */
+/* Purpose: To initialize all of the queues and power values of a filter instance.                       */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void filter_ctx_init(filter_ctx_t* ctx)
+{
+	// Initialize the x, y, z, and output queue of the instance and clear its power values.
+    initXQueue(ctx);
+    initYQueue(ctx);
+    initZQueue(ctx);
+    initOutputQueue(ctx);
+    clearPowerValues(ctx);
+}
+
+/*********************************************************************************************************/
+/* Function: filter_ctx_destroy                                                                          */
+/* Purpose: To free the queue storage allocated by filter_ctx_init.                                      */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void filter_ctx_destroy(filter_ctx_t* ctx)
+{
+	// Free the x and y queues.
+    queue_garbageCollect(&ctx->xQueue);
+    queue_garbageCollect(&ctx->yQueue);
+	// Free the z and output queues of every filter.
+    for(uint8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
+    {
+        queue_garbageCollect(&ctx->zQueue[i]);
+        queue_garbageCollect(&ctx->outputQueue[i]);
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: filter_ctx_reset                                                                            */
+/* Purpose: To return a filter instance to its just-initialized state without reallocating its queues.   */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void filter_ctx_reset(filter_ctx_t* ctx)
+{
+	// Refill the x and y queues.
+    filter_fillQueue(&ctx->xQueue, FILTER_QUEUE_INIT_VALUE);
+    filter_fillQueue(&ctx->yQueue, FILTER_QUEUE_INIT_VALUE);
+	// Refill the z and output queues of every filter.
+    for(uint8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
+    {
+        filter_fillQueue(&ctx->zQueue[i], FILTER_QUEUE_INIT_VALUE);
+        filter_fillQueue(&ctx->outputQueue[i], FILTER_QUEUE_INIT_VALUE);
+    }
+	// Clear the power values.
+    clearPowerValues(ctx);
+}
+
 /*********************************************************************************************************/
 /* Function: filter_init                                                                                 */
 /* Purpose: To initialize all of the queues in the program.                                              */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
 void filter_init(){
-	// Initialize the x, y, z, and output queue for use in the program.
-    initXQueue();
-    initYQueue();
-    initZQueue();
-    initOutputQueue();
+	// Initialize the built-in filter instance.
+    filter_ctx_init(&filter_defaultCtx);
+}
+
+/*********************************************************************************************************/
+/* Function: filter_ctx_addNewInput                                                                      */
+/* Purpose: To copy an input into the input queue of the FIR-filter (xQueue) of a filter instance.       */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void filter_ctx_addNewInput(filter_ctx_t* ctx, double x){
+	// Push the input (x) onto the xQueue.
+    queue_overwritePush(&ctx->xQueue, x);
 }
 
 /*********************************************************************************************************/
@@ -196,8 +279,8 @@ void filter_init(){
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
 void filter_addNewInput(double x){
-	// Push the input (x) onto the xQueue.
-    queue_overwritePush(&xQueue, x);
+	// Push the input (x) onto the xQueue of the built-in instance.
+    filter_ctx_addNewInput(&filter_defaultCtx, x);
 }
 
 /*********************************************************************************************************/
@@ -216,11 +299,11 @@ void filter_fillQueue(queue_t* q, double fillValue)
 }
 
 /*********************************************************************************************************/
-/* Function: filter_firFilter                                                                            */
-/* Purpose: Invokes the FIR-filter. Input is contents of xQueue.                                         */
+/* Function: filter_ctx_firFilter                                                                        */
+/* Purpose: Invokes the FIR-filter of a filter instance. Input is contents of its xQueue.                */
 /* Returns: A double value that is the value pushed onto the yQueue.                                     */
 /*********************************************************************************************************/
-double filter_firFilter(){
+double filter_ctx_firFilter(filter_ctx_t* ctx){
 	// Create a temporary queue data type and initialize it with a queue init value.
     queue_data_t temp_y = FILTER_QUEUE_INIT_VALUE;
 
@@ -228,22 +311,42 @@ double filter_firFilter(){
     for (uint8_t i = 0; i < FILTER_FIR_B_COEFF_COUNT; i++)
     {
 		// Take the current value in the temporary queue data type and multiply it by the current xQueue value and B coefficient value.
-        temp_y += queue_readElementAt(&xQueue, FILTER_FIR_B_COEFF_COUNT - 1 - i) * FILTER_FIR_B_COEFF[i];
+        temp_y += queue_readElementAt(&ctx->xQueue, FILTER_FIR_B_COEFF_COUNT - 1 - i) * FILTER_FIR_B_COEFF[i];
     }
 
 	// Push the temporary queue data type onto the yQueue.
-    queue_overwritePush(&yQueue, temp_y);
+    queue_overwritePush(&ctx->yQueue, temp_y);
 
 	// Return the temporary queue data type.
     return temp_y;
 }
 
 /*********************************************************************************************************/
-/* Function: filter_iirFilter                                                                            */
-/* Purpose: To invoke a single iir filter. Input comes from yQueue.                                      */
+/* Function: filter_ctx_pushFirOutput                                                                    */
+/* Purpose: To feed a FIR output produced outside this instance into its IIR filters (yQueue).           */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void filter_ctx_pushFirOutput(filter_ctx_t* ctx, double firOutput){
+	// Push the FIR output onto the yQueue.
+    queue_overwritePush(&ctx->yQueue, firOutput);
+}
+
+/*********************************************************************************************************/
+/* Function: filter_firFilter                                                                            */
+/* Purpose: Invokes the FIR-filter. Input is contents of xQueue.                                         */
+/* Returns: A double value that is the value pushed onto the yQueue.                                     */
+/*********************************************************************************************************/
+double filter_firFilter(){
+	// Run the FIR-filter of the built-in instance.
+    return filter_ctx_firFilter(&filter_defaultCtx);
+}
+
+/*********************************************************************************************************/
+/* Function: filter_ctx_iirFilter                                                                        */
+/* Purpose: To invoke a single iir filter of a filter instance. Input comes from its yQueue.             */
 /* Returns: A double value that is the value pushed onto the zQueue[filterNumber].                       */
 /*********************************************************************************************************/
-double filter_iirFilter(uint16_t filterNumber){
+double filter_ctx_iirFilter(filter_ctx_t* ctx, uint16_t filterNumber){
 	// Create two temporary queue data type variables and initialize them with queue init values.
     queue_data_t temp_z1 = FILTER_QUEUE_INIT_VALUE;
     queue_data_t temp_z2 = FILTER_QUEUE_INIT_VALUE;
@@ -252,68 +355,96 @@ double filter_iirFilter(uint16_t filterNumber){
     for (uint8_t i = 0; i < FILTER_IIR_B_COEFF_COUNT; i++)
     {
 		// Take the current value of the temporary queue value (z1) and add it to the current yQueue value and B coefficient value.
-        temp_z1 += queue_readElementAt(&yQueue, FILTER_IIR_B_COEFF_COUNT - 1 - i) * FILTER_IIR_B_COEFF[filterNumber][i];
+        temp_z1 += queue_readElementAt(&ctx->yQueue, FILTER_IIR_B_COEFF_COUNT - 1 - i) * FILTER_IIR_B_COEFF[filterNumber][i];
     }
 
 	// For every IIR A coefficient value.
     for (uint8_t i = 0; i < FILTER_IIR_A_COEFF_COUNT; i++)
     {
 		// Take the current value of the temporary queue value (z2) and add it to the current zQueue value and A coefficient value.
-        temp_z2 += queue_readElementAt(&zQueue[filterNumber], FILTER_IIR_A_COEFF_COUNT -1 - i) * FILTER_IIR_A_COEFF[filterNumber][i];
+        temp_z2 += queue_readElementAt(&ctx->zQueue[filterNumber], FILTER_IIR_A_COEFF_COUNT -1 - i) * FILTER_IIR_A_COEFF[filterNumber][i];
     }
 
 	// Push the value of the temporary queue data types z1 and z2 into the zQueue. Also push that value onto the outputQueue.
-    queue_overwritePush(&zQueue[filterNumber], (temp_z1 - temp_z2));
-    queue_overwritePush(&outputQueue[filterNumber], (temp_z1 - temp_z2));
+    queue_overwritePush(&ctx->zQueue[filterNumber], (temp_z1 - temp_z2));
+    queue_overwritePush(&ctx->outputQueue[filterNumber], (temp_z1 - temp_z2));
 
 	// Return the difference between the temporary queue data types z1 and z2.
     return (temp_z1 - temp_z2);
 }
 
-// Use this to compute the power for values contained in an outputQueue.
-// If force == true, then recompute power by using all values in the outputQueue.
-// This option is necessary so that you can correctly compute power values the first time.
-// After that, you can incrementally compute power values by:
-// 1. Keeping track of the power computed in a previous run, call this prev-power.
-// 2. Keeping track of the oldest outputQueue value used in a previous run, call this oldest-value.
-// 3. Get the newest value from the power queue, call this newest-value.
-// 4. Compute new power as: prev-power - (oldest-value * oldest-value) + (newest-value * newest-value).
-// Note that this function will probably need an array to keep track of these values for each
-// of the 10 output queues.
-double previous_power[FILTER_NUMBER_OF_PLAYERS] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
-double current_power[FILTER_NUMBER_OF_PLAYERS] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
-double powerVals[FILTER_NUMBER_OF_PLAYERS];
-static double OLDEST_POWER[FILTER_NUMBER_OF_PLAYERS] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+/*********************************************************************************************************/
+/* Function: filter_iirFilter                                                                            */
+/* Purpose: To invoke a single iir filter. Input comes from yQueue.                                      */
+/* Returns: A double value that is the value pushed onto the zQueue[filterNumber].                       */
+/*********************************************************************************************************/
+double filter_iirFilter(uint16_t filterNumber){
+	// Run the requested IIR filter of the built-in instance.
+    return filter_ctx_iirFilter(&filter_defaultCtx, filterNumber);
+}
 
-double filter_computePower(uint16_t filterNumber, bool forceComputeFromScratch, bool debugPrint){
-    double temp_power = 0.0;
+/*********************************************************************************************************/
+/* Function: filter_ctx_computePower                                                                     */
+/* Purpose: To compute the power for the values contained in an outputQueue of a filter instance.        */
+/*          If force == true, recompute power using all values in the outputQueue. Otherwise compute     */
+/*          it incrementally as prev-power - (oldest-value^2) + (newest-value^2).                        */
+/* Returns: A double value that is the newly computed power.                                             */
+/*********************************************************************************************************/
+double filter_ctx_computePower(filter_ctx_t* ctx, uint16_t filterNumber, bool forceComputeFromScratch, bool debugPrint){
+    queue_t* output_queue = &ctx->outputQueue[filterNumber];
     double prev_power = 0.0;
     double newest_value = 0.0;
     double new_power = 0.0;
 
     if (forceComputeFromScratch)
     {
-		OLDEST_POWER[filterNumber] = queue_readElementAt(&outputQueue[filterNumber], 0);
+		// Remember the oldest value and sum the squares of the whole window.
+		ctx->oldestValue[filterNumber] = queue_readElementAt(output_queue, 0);
 
 		for(uint16_t i = 0; i < FILTER_OUTPUT_QUEUE_SIZE; i++){
-					//queue_readElementAt
-			prev_power += queue_readElementAt(&outputQueue[filterNumber], i)*queue_readElementAt(&outputQueue[filterNumber], i);
+			prev_power += queue_readElementAt(output_queue, i)*queue_readElementAt(output_queue, i);
 		}
 
-		previous_power[filterNumber] = prev_power;
-		current_power[filterNumber] = prev_power;
+		ctx->previousPower[filterNumber] = prev_power;
+		ctx->currentPower[filterNumber] = prev_power;
     }
 
     else
     {
-        newest_value = queue_readElementAt(&outputQueue[filterNumber], queue_elementCount(&outputQueue[filterNumber]) - 1);
-		new_power = previous_power[filterNumber] - (OLDEST_POWER[filterNumber]*OLDEST_POWER[filterNumber]) + (newest_value*newest_value);
-		current_power[filterNumber] = new_power;
-		OLDEST_POWER[filterNumber] = outputQueue[filterNumber].data[outputQueue[filterNumber].indexOut];
-		previous_power[filterNumber] = new_power;
+		// Drop the oldest value's contribution and add the newest one.
+        newest_value = queue_readElementAt(output_queue, queue_elementCount(output_queue) - 1);
+		new_power = ctx->previousPower[filterNumber] - (ctx->oldestValue[filterNumber]*ctx->oldestValue[filterNumber]) + (newest_value*newest_value);
+		ctx->currentPower[filterNumber] = new_power;
+		ctx->oldestValue[filterNumber] = output_queue->data[output_queue->indexOut];
+		ctx->previousPower[filterNumber] = new_power;
     }
     
-   return current_power[filterNumber];
+   return ctx->currentPower[filterNumber];
+}
+
+// Use this to compute the power for values contained in an outputQueue.
+// If force == true, then recompute power by using all values in the outputQueue.
+// This option is necessary so that you can correctly compute power values the first time.
+// After that, you can incrementally compute power values by:
+// 1. Keeping track of the power computed in a previous run, call this prev-power.
+// 2. Keeping track of the oldest outputQueue value used in a previous run, call this oldest-value.
+// 3. Get the newest value from the power queue, call this newest-value.
+// 4. Compute new power as: prev-power - (oldest-value * oldest-value) + (newest-value * newest-value).
+// Note that this function will probably need an array to keep track of these values for each
+// of the 10 output queues.
+double filter_computePower(uint16_t filterNumber, bool forceComputeFromScratch, bool debugPrint){
+    return filter_ctx_computePower(&filter_defaultCtx, filterNumber, forceComputeFromScratch, debugPrint);
+}
+
+/*********************************************************************************************************/
+/* Function: filter_ctx_getCurrentPowerValue                                                             */
+/* Purpose: To return the last-computed output power value for the IIR filter [filterNumber] of a filter */
+/*          instance.                                                                                    */
+/* Returns: A double value that is the last-computed output power value for the IIR filter.              */
+/*********************************************************************************************************/
+double filter_ctx_getCurrentPowerValue(filter_ctx_t* ctx, uint16_t filterNumber){
+	// Return the current power for the passed filter number.
+    return ctx->currentPower[filterNumber];
 }
 
 /*********************************************************************************************************/
@@ -322,53 +453,83 @@ double filter_computePower(uint16_t filterNumber, bool forceComputeFromScratch,
 /* Returns: A double value that is the last-computed output power value for the IIR filter.              */
 /*********************************************************************************************************/
 double filter_getCurrentPowerValue(uint16_t filterNumber){
-	// Return the current power for the passed filter number.
-    return current_power[filterNumber];
+	// Return the current power of the built-in instance for the passed filter number.
+    return filter_ctx_getCurrentPowerValue(&filter_defaultCtx, filterNumber);
 }
 
 /*********************************************************************************************************/
-/* Function: filter_getCurrentPowerValue                                                                 */
-/* Purpose: To copy the already computed values into a previously-declared array so that they can be     */
-/*          accessed from outside the filter software by the detector.                                   */
+/* Function: filter_ctx_getCurrentPowerValues                                                            */
+/* Purpose: To copy the already computed values of a filter instance into a previously-declared array.   */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
-void filter_getCurrentPowerValues(double powerValues[]){
+void filter_ctx_getCurrentPowerValues(filter_ctx_t* ctx, double powerValues[]){
 	// Set the power values to the current power.
     for (uint16_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++)
     {
-        powerValues[i] = current_power[i];
+        powerValues[i] = ctx->currentPower[i];
     }
 }
 
 /*********************************************************************************************************/
-/* Function: filter_getNormalizedPowerValues                                                             */
-/* Purpose: To normalize the previously computed power values by dividing all of the values in           */
-/*          normalizedArray by the maximum power value contained in currentPowerValue[].                 */
+/* Function: filter_getCurrentPowerValues                                                                */
+/* Purpose: To copy the already computed values into a previously-declared array so that they can be     */
+/*          accessed from outside the filter software by the detector.                                   */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
-void filter_getNormalizedPowerValues(double normalizedArray[], uint16_t* indexOfMaxValue){
-	// Create a temporary variable to hold the largest value in the array.
+void filter_getCurrentPowerValues(double powerValues[]){
+	// Copy the power values of the built-in instance.
+    filter_ctx_getCurrentPowerValues(&filter_defaultCtx, powerValues);
+}
+
+/*********************************************************************************************************/
+/* Function: filter_ctx_getNormalizedPowerValues                                                         */
+/* Purpose: To normalize the previously computed power values of a filter instance by dividing all of    */
+/*          the values in normalizedArray by the maximum power value contained in currentPower[].        */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void filter_ctx_getNormalizedPowerValues(filter_ctx_t* ctx, double normalizedArray[], uint16_t* indexOfMaxValue){
+	// Create a temporary variable to hold the largest value in the array, and its index.
     double largest_value = FILTER_QUEUE_INIT_VALUE;
+    uint16_t largest_index = 0;
 
 	// For every single player number.
     for(uint8_t i = 0; i < FILTER_NUMBER_OF_PLAYERS; i++){
+		// Copy the current power into the caller's array.
+        normalizedArray[i] = ctx->currentPower[i];
 		// If the current power at the current index is greater than the temporary largest power value.
-        if(current_power[i] > largest_value){
+        if(ctx->currentPower[i] > largest_value){
 			// Set the largest power value to the current power at the current index.
-            largest_value = current_power[i];
+            largest_value = ctx->currentPower[i];
+            largest_index = i;
         }
     }
 	
-	// Set the normalized array to be the current power array.
-    normalizedArray = current_power;
+	// Report where the largest value was found.
+    *indexOfMaxValue = largest_index;
+
+	// All-zero power has nothing to normalize against, leave the copy as it is.
+    if(largest_value <= FILTER_QUEUE_INIT_VALUE){
+        return;
+    }
 
 	// For every single player number.
     for(uint8_t j = 0; j < FILTER_NUMBER_OF_PLAYERS; j++){
-		// Normalize the power array by dividing all of the values in the array by the largest value.
+		// Normalize the copy by dividing all of the values in the array by the largest value.
         normalizedArray[j] = normalizedArray[j]/largest_value;
     }
 }
 
+/*********************************************************************************************************/
+/* Function: filter_getNormalizedPowerValues                                                             */
+/* Purpose: To normalize the previously computed power values by dividing all of the values in           */
+/*          normalizedArray by the maximum power value contained in currentPowerValue[].                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void filter_getNormalizedPowerValues(double normalizedArray[], uint16_t* indexOfMaxValue){
+	// Normalize the power values of the built-in instance.
+    filter_ctx_getNormalizedPowerValues(&filter_defaultCtx, normalizedArray, indexOfMaxValue);
+}
+
 /*********************************************************************************************************
 ********************************** Verification-assisting functions. *************************************
 ********* Test functions access the internal data structures of the filter.c via these functions. ********
@@ -442,7 +603,7 @@ uint32_t filter_getIirBCoefficientCount(){
 /*********************************************************************************************************/
 uint32_t filter_getYQueueSize(){
 	// Return the size of the yQueue.
-    return yQueue.size;
+    return filter_defaultCtx.yQueue.size;
 }
 
 /*********************************************************************************************************/
@@ -462,7 +623,7 @@ uint16_t filter_getDecimationValue(){
 /*********************************************************************************************************/
 queue_t* filter_getXQueue(){
 	// Return the address of the xQueue.
-    return &xQueue;
+    return &filter_defaultCtx.xQueue;
 }
 
 /*********************************************************************************************************/
@@ -472,7 +633,7 @@ queue_t* filter_getXQueue(){
 /*********************************************************************************************************/
 queue_t* filter_getYQueue(){
 	// Return the address of the yQueue.
-    return &yQueue;
+    return &filter_defaultCtx.yQueue;
 }
 
 /*********************************************************************************************************/
@@ -482,7 +643,7 @@ queue_t* filter_getYQueue(){
 /*********************************************************************************************************/
 queue_t* filter_getZQueue(uint16_t filterNumber){
 	// Return the address of the zQueue for the passed filter number.
-    return &zQueue[filterNumber];
+    return &filter_defaultCtx.zQueue[filterNumber];
 }
 
 /*********************************************************************************************************/
@@ -492,7 +653,7 @@ queue_t* filter_getZQueue(uint16_t filterNumber){
 /*********************************************************************************************************/
 queue_t* filter_getIirOutputQueue(uint16_t filterNumber){
 	// Return the address of the outputQueue for the passed filter number.
-    return &outputQueue[filterNumber];
+    return &filter_defaultCtx.outputQueue[filterNumber];
 }
 
 // Returns the address of the firOutputDebugQueue.
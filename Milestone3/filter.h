@@ -48,7 +48,20 @@
 #define QUEUE_STRING_SIZE 20
 
 const uint16_t filter_frequencyTickTable[FILTER_FREQUENCY_COUNT] = {68, 58, 50, 44, 38, 34, 30, 28, 26, 24};
- 
+
+// All of the state needed by one filter pipeline (queues plus the running power sums).
+// The filter_* functions below operate on a single built-in instance; the filter_ctx_* functions
+// let a caller run any number of independent pipelines, e.g. one per thread on the host.
+typedef struct {
+    queue_t xQueue;                                          // FIR input (raw scaled samples).
+    queue_t yQueue;                                          // FIR output / IIR input.
+    queue_t zQueue[FILTER_NUMBER_OF_PLAYERS];                // IIR feedback history.
+    queue_t outputQueue[FILTER_NUMBER_OF_PLAYERS];           // IIR output window used for power.
+    double currentPower[FILTER_NUMBER_OF_PLAYERS];           // Last computed power per filter.
+    double previousPower[FILTER_NUMBER_OF_PLAYERS];          // Power from the previous computation.
+    double oldestValue[FILTER_NUMBER_OF_PLAYERS];            // Oldest outputQueue value used in the last computation.
+} filter_ctx_t;
+
 // Filtering routines for the laser-tag project.
 // Filtering is performed by a two-stage filter, as described below.
  
@@ -102,8 +115,50 @@ void filter_getCurrentPowerValues(double powerValues[]);
 // Using the previously-computed power values that are current stored in currentPowerValue[] array,
 // Copy these values into the normalizedArray[] argument and then normalize them by dividing
 // all of the values in normalizedArray by the maximum power value contained in currentPowerValue[].
+// The index of that maximum is returned through indexOfMaxValue. The stored power values are not changed.
 void filter_getNormalizedPowerValues(double normalizedArray[], uint16_t* indexOfMaxValue);
- 
+
+/*********************************************************************************************************
+**************************************** Instance Filter Functions ***************************************
+**********************************************************************************************************/
+
+// Returns the instance used by the filter_* functions above (initialized by filter_init()).
+filter_ctx_t* filter_getDefaultCtx();
+
+// Allocates and fills the queues of ctx and clears its power values. Call before any other filter_ctx_* function.
+void filter_ctx_init(filter_ctx_t* ctx);
+
+// Frees the queue storage allocated by filter_ctx_init().
+void filter_ctx_destroy(filter_ctx_t* ctx);
+
+// Refills every queue of ctx with the init value and clears its power values without reallocating.
+void filter_ctx_reset(filter_ctx_t* ctx);
+
+// Same as filter_addNewInput() but for the given instance.
+void filter_ctx_addNewInput(filter_ctx_t* ctx, double x);
+
+// Same as filter_firFilter() but for the given instance.
+double filter_ctx_firFilter(filter_ctx_t* ctx);
+
+// Pushes a FIR output computed elsewhere (e.g. by another instance on another core) onto the yQueue
+// of ctx, as if filter_ctx_firFilter() had produced it.
+void filter_ctx_pushFirOutput(filter_ctx_t* ctx, double firOutput);
+
+// Same as filter_iirFilter() but for the given instance.
+double filter_ctx_iirFilter(filter_ctx_t* ctx, uint16_t filterNumber);
+
+// Same as filter_computePower() but for the given instance.
+double filter_ctx_computePower(filter_ctx_t* ctx, uint16_t filterNumber, bool forceComputeFromScratch, bool debugPrint);
+
+// Same as filter_getCurrentPowerValue() but for the given instance.
+double filter_ctx_getCurrentPowerValue(filter_ctx_t* ctx, uint16_t filterNumber);
+
+// Same as filter_getCurrentPowerValues() but for the given instance.
+void filter_ctx_getCurrentPowerValues(filter_ctx_t* ctx, double powerValues[]);
+
+// Same as filter_getNormalizedPowerValues() but for the given instance.
+void filter_ctx_getNormalizedPowerValues(filter_ctx_t* ctx, double normalizedArray[], uint16_t* indexOfMaxValue);
+
 /*********************************************************************************************************
 ********************************** Verification-assisting functions. *************************************
 ********* Test functions access the internal data structures of the filter.c via these functions. ********
@@ -0,0 +1,163 @@
+/*********************************************************************************************************/
+/* File: gpioEdge.c                                                                                      */
+/* Purpose: Both-edge interrupts on MIO input pins, timestamped with the timer wheel tick count          */
+/*          (see gpioEdge.h).                                                                            */
+/*********************************************************************************************************/
+#include <stdio.h>
+#include "gpioEdge.h"
+#include "timerWheel.h"
+#include "supportFiles/mio.h"
+#if defined(__arm__) && !defined(__linux__)
+#include "xparameters.h"
+#include "xgpiops.h"
+#include "xscugic.h"
+#endif
+
+#define GPIO_EDGE_PIN_COUNT (GPIO_EDGE_MAX_PIN + 1)
+#define GPIO_EDGE_BANK_PINS 32          // MIO bank 0 is pins 0-31, bank 1 pins 32-53.
+
+static gpioEdge_callback_t gpioEdge_callbacks[GPIO_EDGE_PIN_COUNT];
+
+#if defined(__arm__) && !defined(__linux__)
+
+static XGpioPs gpioEdge_gpio;
+static bool gpioEdge_initialized = false;
+
+/*********************************************************************************************************/
+/* Function: gpioEdge_interruptHandler                                                                   */
+/* Purpose: Called by XGpioPs_IntrHandler() with the pins of one bank that saw an edge (their status     */
+/*          is already cleared). Reads each pin's new level and calls its callback.                      */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void gpioEdge_interruptHandler(void* callbackRef, u32 bank, u32 status)
+{
+    uint32_t tick = timerWheel_now();
+    for (uint8_t bit = 0; bit < GPIO_EDGE_BANK_PINS && status != 0; bit++, status >>= 1)
+    {
+        uint32_t pin = bank * GPIO_EDGE_BANK_PINS + bit;
+        if ((status & 1) && pin < GPIO_EDGE_PIN_COUNT && gpioEdge_callbacks[pin] != NULL)
+        {
+            gpioEdge_callbacks[pin]((uint8_t) pin, (uint8_t) XGpioPs_ReadPin(&gpioEdge_gpio, pin), tick);
+        }
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: gpioEdge_init                                                                               */
+/* Purpose: Initializes the GPIO driver and hooks its interrupt into the GIC that interrupts_initAll()   */
+/*          set up (through the register-level calls, so the GIC is not initialized twice).              */
+/* Returns: True if the GPIO interrupt is connected.                                                     */
+/*********************************************************************************************************/
+bool gpioEdge_init()
+{
+    if (gpioEdge_initialized)
+    {
+        return true;
+    }
+    XGpioPs_Config* config = XGpioPs_LookupConfig(XPAR_XGPIOPS_0_DEVICE_ID);
+    if (config == NULL || XGpioPs_CfgInitialize(&gpioEdge_gpio, config, config->BaseAddr) != XST_SUCCESS)
+    {
+        printf("gpioEdge_init: GPIO initialization failed.\n\r");
+        return false;
+    }
+    XGpioPs_SetCallbackHandler(&gpioEdge_gpio, &gpioEdge_gpio, gpioEdge_interruptHandler);
+    XScuGic_RegisterHandler(XPAR_SCUGIC_0_CPU_BASEADDR, XPS_GPIO_INT_ID,
+                            (Xil_InterruptHandler) XGpioPs_IntrHandler, &gpioEdge_gpio);
+    XScuGic_EnableIntr(XPAR_SCUGIC_0_DIST_BASEADDR, XPS_GPIO_INT_ID);
+    gpioEdge_initialized = true;
+    return true;
+}
+
+/*********************************************************************************************************/
+/* Function: gpioEdge_enablePin                                                                          */
+/* Purpose: Sets pin to interrupt on both edges and enables its interrupt.                               */
+/* Returns: False if pin is out of range or the GPIO is not initialized.                                 */
+/*********************************************************************************************************/
+bool gpioEdge_enablePin(uint8_t pin, gpioEdge_callback_t callback)
+{
+    if (pin > GPIO_EDGE_MAX_PIN || !gpioEdge_initialized)
+    {
+        return false;
+    }
+    gpioEdge_callbacks[pin] = callback;
+    XGpioPs_SetIntrTypePin(&gpioEdge_gpio, pin, XGPIOPS_IRQ_TYPE_EDGE_BOTH);
+    XGpioPs_IntrClearPin(&gpioEdge_gpio, pin);
+    XGpioPs_IntrEnablePin(&gpioEdge_gpio, pin);
+    return true;
+}
+
+/*********************************************************************************************************/
+/* Function: gpioEdge_disablePin                                                                         */
+/* Purpose: Disables the interrupt of pin.                                                               */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void gpioEdge_disablePin(uint8_t pin)
+{
+    if (pin > GPIO_EDGE_MAX_PIN || !gpioEdge_initialized)
+    {
+        return;
+    }
+    XGpioPs_IntrDisablePin(&gpioEdge_gpio, pin);
+    gpioEdge_callbacks[pin] = NULL;
+}
+
+#else
+
+/*********************************************************************************************************/
+/* Function: gpioEdge_init                                                                               */
+/* Purpose: Nothing to connect on a host.                                                                */
+/* Returns: True.                                                                                        */
+/*********************************************************************************************************/
+bool gpioEdge_init()
+{
+    return true;
+}
+
+/*********************************************************************************************************/
+/* Function: gpioEdge_enablePin                                                                          */
+/* Purpose: Records the callback gpioEdge_simulateLevel() calls for pin.                                 */
+/* Returns: False if pin is out of range.                                                                */
+/*********************************************************************************************************/
+bool gpioEdge_enablePin(uint8_t pin, gpioEdge_callback_t callback)
+{
+    if (pin > GPIO_EDGE_MAX_PIN)
+    {
+        return false;
+    }
+    gpioEdge_callbacks[pin] = callback;
+    return true;
+}
+
+/*********************************************************************************************************/
+/* Function: gpioEdge_disablePin                                                                         */
+/* Purpose: Forgets the callback of pin.                                                                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void gpioEdge_disablePin(uint8_t pin)
+{
+    if (pin <= GPIO_EDGE_MAX_PIN)
+    {
+        gpioEdge_callbacks[pin] = NULL;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: gpioEdge_simulateLevel                                                                      */
+/* Purpose: Plays the part of the pin and the GPIO interrupt.                                            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void gpioEdge_simulateLevel(uint8_t pin, uint8_t level)
+{
+    level = level ? 1 : 0;
+    if (pin > GPIO_EDGE_MAX_PIN || mio_readPin(pin) == level)
+    {
+        return;
+    }
+    mio_writePin(pin, level);
+    if (gpioEdge_callbacks[pin] != NULL)
+    {
+        gpioEdge_callbacks[pin](pin, level, timerWheel_now());
+    }
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef GPIOEDGE_H_
+#define GPIOEDGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Interrupts on both edges of MIO input pins. Each edge calls the pin's callback, from the GPIO
+// interrupt, with the new level and the timer wheel tick count at which it was seen. Nothing is
+// polled, so an input that is not changing costs nothing.
+//
+// Callbacks run outside the 100 kHz ISR: use timerWheel_schedule()/timerWheel_cancel() from them,
+// not the *FromIsr() functions.
+//
+// On a host there is no GPIO interrupt: gpioEdge_simulateLevel() sets a pin and calls the callback
+// the way the interrupt would.
+
+#define GPIO_EDGE_MAX_PIN 53            // MIO pins 0-53 (banks 0 and 1).
+
+// Called on each edge of an enabled pin.
+typedef void (*gpioEdge_callback_t)(uint8_t pin, uint8_t level, uint32_t tick);
+
+// Connects the GPIO interrupt. Returns false (and prints why) if the GPIO cannot be set up.
+bool gpioEdge_init();
+
+// Calls callback on every edge of pin from now on. Returns false if pin is out of range.
+bool gpioEdge_enablePin(uint8_t pin, gpioEdge_callback_t callback);
+
+// Stops calling back for pin.
+void gpioEdge_disablePin(uint8_t pin);
+
+#if !(defined(__arm__) && !defined(__linux__))
+// Host only: sets the level of an input pin and, if it changed and the pin is enabled, calls back.
+void gpioEdge_simulateLevel(uint8_t pin, uint8_t level);
+#endif
+
+#endif /* GPIOEDGE_H_ */
@@ -7,6 +7,28 @@
 #include "supportFiles/utils.h"
 #include <string.h>
 #include "filter.h"
+#include "glyphCache.h"
+
+#ifdef HISTOGRAM_COMPOSITOR_ENABLED
+#include "compositor.h"
+// Draw into the compositor's back buffer; HISTOGRAM_FLUSH() sends what changed to the TFT.
+#define HISTOGRAM_FILL_SCREEN compositor_fillScreen
+#define HISTOGRAM_FILL_RECT compositor_fillRect
+#define HISTOGRAM_SET_CURSOR compositor_setCursor
+#define HISTOGRAM_SET_TEXT_COLOR compositor_setTextColor
+#define HISTOGRAM_SET_TEXT_SIZE compositor_setTextSize
+#define HISTOGRAM_PRINT compositor_print
+#define HISTOGRAM_FLUSH() compositor_flush()
+#else
+// Draw straight to the TFT.
+#define HISTOGRAM_FILL_SCREEN display_fillScreen
+#define HISTOGRAM_FILL_RECT display_fillRect
+#define HISTOGRAM_SET_CURSOR display_setCursor
+#define HISTOGRAM_SET_TEXT_COLOR display_setTextColor
+#define HISTOGRAM_SET_TEXT_SIZE display_setTextSize
+#define HISTOGRAM_PRINT display_print
+#define HISTOGRAM_FLUSH()
+#endif
 
 #define TOP_LABEL_TEXT_SIZE 1
 #define HISTOGRAM_DEFAULT_BAR_COUNT 10
@@ -18,6 +40,12 @@ static histogram_data_t previousBarData[HISTOGRAM_MAX_BAR_COUNT];	// Keep the ol
 static char topLabel[HISTOGRAM_MAX_BAR_COUNT][HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS];		// Labels at top of histogram bars.
 static char oldTopLabel[HISTOGRAM_MAX_BAR_COUNT][HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS];	// Old label so you only update as necessary.
 
+// Load shedding (see histogram_setTopLabelsEnabled() and histogram_setMinBarChange()).
+static bool histogram_topLabelsEnabled = true;
+static histogram_data_t histogram_minBarChange = HISTOGRAM_MIN_BAR_CHANGE_ANY;
+static uint32_t histogram_coalescedBarCount = 0;	// Bar redraws put off because the change was too small.
+static uint32_t histogram_skippedLabelCount = 0;	// Top-label draws skipped while labels are off.
+
 #define ONE_HALF(x) ((x)/2)  // Integer divide by 2.
 
 static bool initFlag = false;	// Keep track whether histogram_init() has been called.
@@ -46,11 +74,11 @@ static char histogram_label[HISTOGRAM_MAX_BAR_COUNT][HISTOGRAM_MAX_BAR_LABEL_WID
 // The bottom labels are drawn at the bottom of the bar and are static.
 void histogram_drawBottomLabels() {
   uint16_t labelOffset = ONE_HALF(histogram_barWidth - (DISPLAY_CHAR_WIDTH * HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE));  // Center the label.
-  display_setTextSize(HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE);	// Set the text-size.
+  HISTOGRAM_SET_TEXT_SIZE(HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE);	// Set the text-size.
   for (int i=0; i<histogram_barCount; i++) {		//
-    display_setCursor(i*(histogram_barWidth+HISTOGRAM_BAR_X_GAP) + labelOffset, display_height()-(DISPLAY_CHAR_HEIGHT * HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE));
-    display_setTextColor(histogram_barColors[i]);
-    display_print(histogram_label[i]);
+    HISTOGRAM_SET_CURSOR(i*(histogram_barWidth+HISTOGRAM_BAR_X_GAP) + labelOffset, display_height()-(DISPLAY_CHAR_HEIGHT * HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE));
+    HISTOGRAM_SET_TEXT_COLOR(histogram_barColors[i]);
+    HISTOGRAM_PRINT(histogram_label[i]);
   }
 }
 
@@ -61,6 +89,9 @@ void histogram_init(uint16_t barCount) {
     exit(0);
   }
   display_init();								// Init the display package.
+#ifdef HISTOGRAM_COMPOSITOR_ENABLED
+  compositor_init();
+#endif
   histogram_barWidth = (display_width() / histogram_barCount) - HISTOGRAM_BAR_X_GAP;
   topLabelMaxWidthInChars = (histogram_barWidth/DISPLAY_CHAR_WIDTH);		// The top-label can be this wide.
   // But, double-check to make sure that it will fit in the memory allocated for the label array. Set to fit allocated area in any case.
@@ -78,19 +109,38 @@ void histogram_init(uint16_t barCount) {
     histogram_barColors[i] = histogram_defaultBarColors[i];
     histogram_barTopLabelColors[i] = histogram_defaultBarTopLabelColors[i];
   }
-  display_fillScreen(DISPLAY_BLACK);
+  histogram_topLabelsEnabled = true;
+  histogram_minBarChange = HISTOGRAM_MIN_BAR_CHANGE_ANY;
+  histogram_coalescedBarCount = 0;
+  histogram_skippedLabelCount = 0;
+  HISTOGRAM_FILL_SCREEN(DISPLAY_BLACK);
   histogram_drawBottomLabels();
+  HISTOGRAM_FLUSH();
   initFlag = true;
 }
 
 // Simply erases all of the pixels in the label area under the histogram bars and redraws the labels.
 void histogram_redrawBottomLabels() {
-  display_fillRect(0, display_height() - (DISPLAY_CHAR_HEIGHT * HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE),
+  HISTOGRAM_FILL_RECT(0, display_height() - (DISPLAY_CHAR_HEIGHT * HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE),
       display_width(), display_height(), DISPLAY_BLACK);
   histogram_drawBottomLabels();
+  HISTOGRAM_FLUSH();
 }
 
 
+// Internal helper function.
+// Keeps as much of the top label as fits over the bar. oldTopLabel holds the label on the screen, so
+// histogram_drawBar() redraws the label only when what it shows would change.
+static void histogram_setTopLabel(histogram_index_t barIndex, const char barTopLabel[]) {
+  uint16_t length = 0;
+  // Only copy as many characters as will fit in the available screen space.
+  while (length < topLabelMaxWidthInChars && barTopLabel[length] != 0) {
+    topLabel[barIndex][length] = barTopLabel[length];
+    length++;
+  }
+  topLabel[barIndex][length] = 0;	// Null terminate the string in any case.
+}
+
 // This function only updates the data for the histogram. histogram_updateDisplay() will do the actual drawing.
 // barIndex is the index of the histogram bar, 0 is left, larger indices to the right.
 // data is the value of the bar in PIXELS.
@@ -111,83 +161,155 @@ bool histogram_setBarData(histogram_index_t barIndex, histogram_data_t data, con
     printf("Error! histogram_setBarData(): data (%d) is greater than maximum (%d) for index(%d) \n\r", data, HISTOGRAM_MAX_BAR_DATA_IN_PIXELS-1, barIndex);
     return false;
   }
-  // If it has changed, update the data in the array but don't render anything on the display.
-  if (data != currentBarData[barIndex]) {													// Only modify the data if it has changed.
-    previousBarData[barIndex] = currentBarData[barIndex];	// Save the old data so you render things properly.
-    // Copy the old string so that you can render things properly.
-    currentBarData[barIndex] = data;															// Store the data because it changed.
-  }
-  // If the label has changed, move the previous data to old, new data to current.
+  // Update the data in the array but don't render anything on the display.
+  // previousBarData keeps the height last drawn, so several updates between draws erase properly.
+  currentBarData[barIndex] = data;
   // Labels are handled separately from data because the label may change even if the underlying bar data does not.
   // This allows the top label to change and to be redrawn even if the bars stay the same height.
-  if (strncmp(barTopLabel, topLabel[barIndex], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS)) {
-    // If you get here, the new label is different from the last one.
-    strncpy(oldTopLabel[barIndex], topLabel[barIndex], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
-    // Copy the current label to become the new old label.
-    strncpy(topLabel[barIndex], barTopLabel, HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
-    // Copy the new label to become the current label.
-    uint16_t barTopLabelLength = strlen(barTopLabel);									// Get the length of the label.
-    // Only copy as many characters as will fit in the available screen space.
-    uint16_t charCopyLimit = (barTopLabelLength < topLabelMaxWidthInChars) ? barTopLabelLength : topLabelMaxWidthInChars;
-    for (uint16_t i=0; i<charCopyLimit; i++)
-      topLabel[barIndex][i] = barTopLabel[i];
-    // Null terminate the string in any case.
-    topLabel[barIndex][charCopyLimit] = 0;
-  }
+  histogram_setTopLabel(barIndex, barTopLabel);
   return true;  // Everything is OK.
 }
 
+// Sets every bar at once, like a histogram_setBarData() call per bar. Nothing is changed if a value is out of range.
+// labels may be NULL to leave the top labels as they are.
+bool histogram_setAllBars(const histogram_data_t values[], const char labels[][HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS]) {
+  if (!initFlag) {
+    printf("Error! histogram_setAllBars(): must call histogram_init() before calling this function.\n\r");
+    return false;
+  }
+  for (histogram_index_t i=0; i<histogram_barCount; i++) {
+    if (values[i] > HISTOGRAM_MAX_BAR_DATA_IN_PIXELS) {
+      printf("Error! histogram_setAllBars(): data (%d) is greater than maximum (%d) for index(%d) \n\r", values[i], HISTOGRAM_MAX_BAR_DATA_IN_PIXELS-1, i);
+      return false;
+    }
+  }
+  for (histogram_index_t i=0; i<histogram_barCount; i++) {
+    currentBarData[i] = values[i];
+    if (labels)
+      histogram_setTopLabel(i, labels[i]);
+  }
+  return true;
+}
+
 // Internal helper function.
 // Erases the old text (using a fillRect because it is small and fast) to erase the old label, if required.
 // Finds the position for the label, just above the top of the bar.
 void histogram_drawTopLabel(uint16_t barIndex, histogram_data_t data, const char topLabel[], bool eraseOldLabel) {
   if (eraseOldLabel) {
     // Erase with a fillRect because the rect is small and should be faster than hitting individual label pixels.
-    display_fillRect(barIndex*(histogram_barWidth+HISTOGRAM_BAR_X_GAP),
+    HISTOGRAM_FILL_RECT(barIndex*(histogram_barWidth+HISTOGRAM_BAR_X_GAP),
         display_height() - data - HISTOGRAM_BAR_Y_GAP - DISPLAY_CHAR_HEIGHT - 1,
         histogram_barWidth, DISPLAY_CHAR_HEIGHT, DISPLAY_BLACK);
 
   }
   uint16_t topLabelXOffset = ONE_HALF(histogram_barWidth - (strlen(topLabel)*DISPLAY_CHAR_WIDTH));  // This helps to center the label over the bar.
-  display_setCursor(barIndex*(histogram_barWidth+HISTOGRAM_BAR_X_GAP) + topLabelXOffset,				// This is the location of the top label.
+#if defined(GLYPH_CACHE_ENABLED) && !defined(HISTOGRAM_COMPOSITOR_ENABLED)
+  // The label goes on black (just erased, or above the bar), so it can be drawn from the glyph cache.
+  glyphCache_print(barIndex*(histogram_barWidth+HISTOGRAM_BAR_X_GAP) + topLabelXOffset,
+      display_height() - data - HISTOGRAM_BAR_Y_GAP - DISPLAY_CHAR_HEIGHT - 1, topLabel,
+      histogram_barTopLabelColors[barIndex], DISPLAY_BLACK, TOP_LABEL_TEXT_SIZE);
+#else
+  HISTOGRAM_SET_CURSOR(barIndex*(histogram_barWidth+HISTOGRAM_BAR_X_GAP) + topLabelXOffset,				// This is the location of the top label.
       display_height() - data - HISTOGRAM_BAR_Y_GAP - DISPLAY_CHAR_HEIGHT - 1);
-  display_setTextSize(TOP_LABEL_TEXT_SIZE);																																				// Use tiny text to pack more characters into the label.
-  display_setTextColor(histogram_barTopLabelColors[barIndex]);		// Set the color of the label.
-  display_print(topLabel);																				// Draw the label.
+  HISTOGRAM_SET_TEXT_SIZE(TOP_LABEL_TEXT_SIZE);																																				// Use tiny text to pack more characters into the label.
+  HISTOGRAM_SET_TEXT_COLOR(histogram_barTopLabelColors[barIndex]);		// Set the color of the label.
+  HISTOGRAM_PRINT(topLabel);																				// Draw the label.
+#endif
 }
 
-// This updates the display.
-// It loops across all bars, checking:
-// If the height of the bar has changed, redraw both the bar and the top label.
+// Internal helper function: draws one bar without flushing.
+// If the height of the bar has changed, only the slice between the old and the new height is drawn: a bar that grew
+// gets the slice in its color, a bar that shrank gets it erased. The top label moves with the top of the bar.
 // If the height of the bar has not changed, but the top label has changed, update the label.
+static void histogram_drawBar(histogram_index_t i) {
+  histogram_data_t oldData = previousBarData[i];	// Get the previous data.
+  histogram_data_t data = currentBarData[i];			// Get the current bar data.
+  histogram_data_t change = (data > oldData) ? data - oldData : oldData - data;
+  uint16_t x = i*(histogram_barWidth+HISTOGRAM_BAR_X_GAP);
+  // A bar of height data fills data-1 rows from display_height() - data - HISTOGRAM_BAR_Y_GAP down; its label sits in
+  // the DISPLAY_CHAR_HEIGHT + 1 rows above that.
+  histogram_data_t oldFilled = (oldData > 0) ? oldData : 1;
+  histogram_data_t filled = (data > 0) ? data : 1;
+  if (oldData != data && change < histogram_minBarChange) {	// Too small to be worth drawing yet: let it build up.
+    histogram_coalescedBarCount++;
+  } else if (oldData != data) {											// If the are not equal, redraw the slice and the top-label.
+    if (data > oldData) {
+      // Erase what the new bar does not cover of the old label, then draw the slice the bar grew by.
+      if (oldData != 0 && change < DISPLAY_CHAR_HEIGHT + 1)
+        HISTOGRAM_FILL_RECT(x, display_height() - oldData - HISTOGRAM_BAR_Y_GAP - DISPLAY_CHAR_HEIGHT - 1,
+            histogram_barWidth, DISPLAY_CHAR_HEIGHT + 1 - change, DISPLAY_BLACK);
+      HISTOGRAM_FILL_RECT(x, display_height() - data - HISTOGRAM_BAR_Y_GAP, histogram_barWidth, filled - oldFilled,
+          histogram_barColors[i]);
+    } else {
+      // Erase the old label and the slice the bar shrank by at once.
+      HISTOGRAM_FILL_RECT(x, display_height() - oldData - HISTOGRAM_BAR_Y_GAP - DISPLAY_CHAR_HEIGHT - 1,
+          histogram_barWidth, oldData - filled + DISPLAY_CHAR_HEIGHT + 1, DISPLAY_BLACK);
+    }
+    previousBarData[i] = currentBarData[i];	// Old data and new data are the same after the update.
+    if (data != 0 && !histogram_topLabelsEnabled) {
+      histogram_skippedLabelCount++;
+      oldTopLabel[i][0] = 0;	// Not on the screen: draw it once labels are back on.
+    } else if (data != 0) {	// Only draw the top label if the bar-data != 0.
+      histogram_drawTopLabel(i, data, topLabel[i], false);			// false means that the old label is already erased.
+      // Old label and new label are the same after the update.
+      strncpy(oldTopLabel[i], topLabel[i], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
+    }
+  } else if ((data != 0) && strncmp(topLabel[i], oldTopLabel[i], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS)) {
+    if (!histogram_topLabelsEnabled) {	// Leave the old label up until labels are back on.
+      histogram_skippedLabelCount++;
+      return;
+    }
+    histogram_drawTopLabel(i, data, topLabel[i], true);		// True means that the old label needs to be erased.
+    // After the update, copy the label to old data so that it won't reupdate until the next change.
+    strncpy(oldTopLabel[i], topLabel[i], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
+  }
+}
+
+// This updates one bar of the display (see histogram_drawBar()).
+void histogram_updateDisplayBar(histogram_index_t i) {
+  if (!initFlag || i >= histogram_barCount) {
+    printf("Error! histogram_updateDisplayBar(): call histogram_init() first; barIndex(%d) must be below %d.\n\r", i, histogram_barCount);
+    return;
+  }
+  histogram_drawBar(i);
+  HISTOGRAM_FLUSH();
+}
+
+// This updates the display, one bar at a time, and sends all of the bars at once.
 void histogram_updateDisplay() {
   if (!initFlag) {
     printf("Error! histogram_displayUpdate(): must call histogram_init() before calling this function.\n\r");
     return;
   }
   for (int i=0; i<histogram_barCount; i++) {
-    histogram_data_t oldData = previousBarData[i];	// Get the previous data.
-    histogram_data_t data = currentBarData[i];			// Get the current bar data.
-    if (oldData != data) {													// If the are not equal, redraw the bar and the top-label.
-      // Erase the old bar and extend the erase rectangle to include the top-label so that everything is erased at once.
-      // Also, redraw the top label.
-      display_fillRect(i*(histogram_barWidth+HISTOGRAM_BAR_X_GAP), display_height() - oldData - HISTOGRAM_BAR_Y_GAP - DISPLAY_CHAR_HEIGHT - 1,
-          histogram_barWidth, oldData + DISPLAY_CHAR_HEIGHT + 1, DISPLAY_BLACK);
-      // Draw the new bar.
-      display_fillRect(i*(histogram_barWidth+HISTOGRAM_BAR_X_GAP), display_height() - data - HISTOGRAM_BAR_Y_GAP,
-          histogram_barWidth, data-1, histogram_barColors[i]);
-      if (data != 0) {	// Only draw the top label if the bar-data != 0.
-        histogram_drawTopLabel(i, data, topLabel[i], false);			// false means that the old label does not need to be erased.
-        previousBarData[i] = currentBarData[i];	// Old data and new data are the same after the update.
-        // Old label and new label are the same after the update.
-        strncpy(oldTopLabel[i], topLabel[i], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
-      }
-    } else if ((data != 0) && strncmp(topLabel[i], oldTopLabel[i], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS)) {
-      histogram_drawTopLabel(i, data, topLabel[i], true);		// True means that the old label needs to be erased.
-      // After the update, copy the label to old data so that it won't reupdate until the next change.
-      strncpy(oldTopLabel[i], topLabel[i], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS);
-    }
+    histogram_drawBar(i);
   }
+  HISTOGRAM_FLUSH();
+}
+
+// Returns the number of bars given to histogram_init().
+uint16_t histogram_getBarCount() {
+  return histogram_barCount;
+}
+
+// Turns the drawing of top labels off (to save time under load) or back on.
+void histogram_setTopLabelsEnabled(bool enabled) {
+  histogram_topLabelsEnabled = enabled;
+}
+
+// Bars that moved fewer than minChange pixels since they were last drawn are left as they are.
+void histogram_setMinBarChange(histogram_data_t minChange) {
+  histogram_minBarChange = minChange;
+}
+
+// Number of bar redraws put off by histogram_setMinBarChange().
+uint32_t histogram_getCoalescedBarCount() {
+  return histogram_coalescedBarCount;
+}
+
+// Number of top-label draws skipped by histogram_setTopLabelsEnabled(false).
+uint32_t histogram_getSkippedLabelCount() {
+  return histogram_skippedLabelCount;
 }
 
 // Set the bar-color for each bar. This overwrites the defaults. Call histogram_init() to restore the defaults.
@@ -266,32 +388,37 @@ void histogram_normalizePowerValues(double normalizedValues[], double origValues
     normalizedValues[i] = origValues[i] / maxValue;
 }
 
-// Used to plot the power response for user frequencies 0-9.
-void histogram_plotUserFrequencyPower(double powerValues[]) {
+// Sets the bars to the power response for user frequencies 0-9 without drawing.
+// Any bars past the user frequencies are set to 0.
+void histogram_setUserFrequencyPower(double powerValues[]) {
   double normalizedPowerValues[FILTER_FREQUENCY_COUNT];
   histogram_normalizePowerValues(normalizedPowerValues, powerValues, FILTER_FREQUENCY_COUNT);
+  histogram_data_t histogramBarValues[HISTOGRAM_MAX_BAR_COUNT] = {0};
+  char labels[HISTOGRAM_MAX_BAR_COUNT][HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS] = {{0}};	// Buffers for the labels.
   for (int i=0; i<FILTER_FREQUENCY_COUNT; i++) {  // Update across all filters.
     // The height of the histogram bar depends upon the normalized value.
-    histogram_data_t histogramBarValue = ((double) (HISTOGRAM_MAX_BAR_DATA_IN_PIXELS)) * normalizedPowerValues[i];
+    histogramBarValues[i] = ((double) (HISTOGRAM_MAX_BAR_DATA_IN_PIXELS)) * normalizedPowerValues[i];
     // You can have a dynamic label at the top of the bar.
-    char label[HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS];	// Get a buffer for the label.
     // Create the label, based upon the actual power value.
-    if (snprintf(label, HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS, "%0.0e", powerValues[i]) == -1)
+    if (snprintf(labels[i], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS, "%0.0e", powerValues[i]) == -1)
       printf("Error: snprintf encountered an error during conversion.\n\r");
     // Pull out the 'e' from the exponent to make better use of your characters.
-    trimLabel(label);
-    // Have the bar value and the label, send the data to the histogram.
-    if (!histogram_setBarData(i, histogramBarValue, label)) {
-      // If returns false, histogram_setBarData() is not happy. Print out some information.
-      printf("Error:histogram_setBarData() histogramBarValue(%d) out of range.\n\r", histogramBarValue);
-      printf("Provided normalizedPowerValue[%d]:%lf\n\r", i, normalizedPowerValues[i]);
-      printf("Dumping current and normalized power values.\n\r");
-      for (int tmp_i=0; tmp_i<FILTER_FREQUENCY_COUNT; tmp_i++) {
-        printf("currentPowerValue[%d]:%lf\n\r", tmp_i, filter_getCurrentPowerValue(tmp_i));
-        printf("normalizedPowerValue[%d]:%lf\n\r", tmp_i, normalizedPowerValues[tmp_i]);
-      }
+    trimLabel(labels[i]);
+  }
+  // Have the bar values and the labels, send the data to the histogram.
+  if (!histogram_setAllBars(histogramBarValues, labels)) {
+    // If returns false, histogram_setAllBars() is not happy. Print out some information.
+    printf("Dumping current and normalized power values.\n\r");
+    for (int tmp_i=0; tmp_i<FILTER_FREQUENCY_COUNT; tmp_i++) {
+      printf("currentPowerValue[%d]:%lf\n\r", tmp_i, filter_getCurrentPowerValue(tmp_i));
+      printf("normalizedPowerValue[%d]:%lf\n\r", tmp_i, normalizedPowerValues[tmp_i]);
     }
   }
+}
+
+// Used to plot the power response for user frequencies 0-9.
+void histogram_plotUserFrequencyPower(double powerValues[]) {
+  histogram_setUserFrequencyPower(powerValues);
   histogram_updateDisplay();
 }
 
@@ -309,18 +436,26 @@ void histogram_computeNormalizedHitValues(double normalizedHitValues[], uint16_t
     normalizedHitValues[i] = (double) hitArray[i] / maxHitValue;
 }
 
-// Used to plot hits for frequencies 0-9.
-void histogram_plotUserHits(uint16_t hitCounts[]) {
+// Sets the bars to the hits for frequencies 0-9 without drawing.
+// Any bars past the user frequencies are set to 0.
+void histogram_setUserHits(uint16_t hitCounts[]) {
   double normalizedHitValues[FILTER_FREQUENCY_COUNT];				// Store normalized values here for the histogram.
   histogram_computeNormalizedHitValues(normalizedHitValues, hitCounts);	// Get the normalized hit values.
+  histogram_data_t histogramBarValues[HISTOGRAM_MAX_BAR_COUNT] = {0};
+  char labels[HISTOGRAM_MAX_BAR_COUNT][HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS] = {{0}};	// Buffers for the labels.
   for (int i=0; i<FILTER_FREQUENCY_COUNT; i++) {							// Iterate through the results for each channel.
-    char label[HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS];		// Get a buffer for the label.
+    histogramBarValues[i] = normalizedHitValues[i] * HISTOGRAM_MAX_BAR_DATA_IN_PIXELS;
     // Create the label, based upon the actual power value.
-    if (snprintf(label, HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS, "%d", hitCounts[i]) == -1)
+    if (snprintf(labels[i], HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS, "%d", hitCounts[i]) == -1)
       printf("Error: snprintf encountered an error during conversion.\n\r");
-    histogram_setBarData(i, normalizedHitValues[i] * HISTOGRAM_MAX_BAR_DATA_IN_PIXELS, label);
-    histogram_updateDisplay();	// Redraw the histogram.
   }
+  histogram_setAllBars(histogramBarValues, labels);
+}
+
+// Used to plot hits for frequencies 0-9.
+void histogram_plotUserHits(uint16_t hitCounts[]) {
+  histogram_setUserHits(hitCounts);
+  histogram_updateDisplay();	// Redraw the histogram.
 }
 
 // Normalizes the values in the array argument.
@@ -23,6 +23,11 @@
 #define DISPLAY_CHAR_HEIGHT 8
 #endif
 
+// Uncomment to draw through the compositor (Common/compositor.h): bars and labels are drawn into a
+// back buffer and each update sends only the pixels that changed to the TFT. The running modes send
+// them asynchronously, a chunk per scheduler slice (see compositor_task()).
+//#define HISTOGRAM_COMPOSITOR_ENABLED
+
 #define HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE 2	// Max text-size for the bottom label.
 
 // Allow up to this many chars for the label on top of the histogram bar. Actually printed chars depends upon width of bar.
@@ -37,6 +42,7 @@
 #define HISTOGRAM_BAR_Y_GAP (DISPLAY_CHAR_HEIGHT * HISTOGRAM_BOTTOM_LABEL_TEXT_SIZE)	// Leave room for a small label.
 #define HISTOGRAM_MAX_BAR_DATA_IN_PIXELS (DISPLAY_HEIGHT - HISTOGRAM_BAR_Y_GAP -  HISTOGRAM_TOP_LABEL_HEIGHT)	// Max value (height) for histogram bar, in pixels.
 #define HISTOGRAM_MAX_BAR_LABEL_WIDTH 6	// Defined in terms of characters.
+#define HISTOGRAM_MIN_BAR_CHANGE_ANY 1	// Default for histogram_setMinBarChange(): redraw on any change.
 
 typedef uint16_t histogram_index_t;	// Used to index each histogram bar.
 typedef uint16_t histogram_data_t;	// The data associated with each bar.
@@ -49,6 +55,12 @@ void histogram_init(uint16_t barCount);
 // Returns false if there is something wrong with the provided arguments.
 bool histogram_setBarData(histogram_index_t barIndex, histogram_data_t data, const char barTopLabel[]);
 
+// Sets the heights (values) and top labels (labels) of all of the bars at once. labels may be NULL to keep the
+// top labels. Does NOT render the histogram onto the TFT; histogram_updateDisplay() then draws only the slice each
+// bar grew or shrank by, and redraws only the top labels that changed.
+// Returns false, changing nothing, if a value is out of range.
+bool histogram_setAllBars(const histogram_data_t values[], const char labels[][HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS]);
+
 // Set the bar-color for each bar. This overwrites the defaults.
 void histogram_setBarColor(histogram_index_t barIndex, uint16_t color);
 
@@ -64,12 +76,32 @@ void histogram_setBottomLabelTextSize(uint16_t);
 // Call this to draw the histogram with the data from histogram_setBarData().
 void histogram_updateDisplay();
 
+// Draws one bar (and its top label) if it changed. Lets a caller spread an update over several calls.
+void histogram_updateDisplayBar(histogram_index_t barIndex);
+
+// Returns the number of bars given to histogram_init().
+uint16_t histogram_getBarCount();
+
+// Load shedding. With top labels off, labels are only erased with their bar and are drawn again once
+// labels are back on. A bar that moved fewer than minChange pixels since it was drawn is not redrawn
+// until the change adds up. The counters report how much was skipped.
+void histogram_setTopLabelsEnabled(bool enabled);
+void histogram_setMinBarChange(histogram_data_t minChange);
+uint32_t histogram_getCoalescedBarCount();
+uint32_t histogram_getSkippedLabelCount();
+
 // Used to plot the power response for user frequencies 0-9.
 void histogram_plotUserFrequencyPower(double powerValue[]);
 
+// Same as histogram_plotUserFrequencyPower() but does not draw: follow with histogram_updateDisplay[Bar]().
+void histogram_setUserFrequencyPower(double powerValue[]);
+
 // Used to plot hits for frequencies 0-9.
 void histogram_plotUserHits(uint16_t hit[]);
 
+// Same as histogram_plotUserHits() but does not draw: follow with histogram_updateDisplay[Bar]().
+void histogram_setUserHits(uint16_t hit[]);
+
 // Plots the FIR power (frequency response).
 // This plotting routine assumes that:
 // 1. The size of the array is FILTER_FIR_POWER_TEST_PERIOD_COUNT and it contains power for these tested frequencies.
@@ -1,13 +1,13 @@
 #include <stdio.h>
 #include <stdint.h>
 #include "hitLedTimer.h"
+#include "oneShotTimer.h"
 #include "../Lab2/buttons.h"
 #include "supportFiles/leds.h"
 #include "supportFiles/utils.h"
 #include "supportFiles/mio.h"
 
 #define HIT_LED_TIMER_TIME_UP 50000
-#define HIT_LED_TIMER_CLEAR 0
 
 #define HIT_LED_JF_MIO_PIN 11
 #define HIT_LED_MIO_HIGH 1
@@ -20,45 +20,26 @@
 #define HIT_LED_TEST_MS_DELAY 500
 #define HIT_LED_TEST_DEBOUCE 300
 
-enum hitLedTimer_st_t
-{
-    hitLedTimer_idle_st,
-    hitLedTimer_led_on_st
-} hit_led_timer_current_state = hitLedTimer_idle_st;
-
-volatile static  bool hit_led_timer_running;
-volatile static bool hit_led_timer_hit_detected;
-volatile static uint32_t hit_led_timer_count;
+// hitLedTimer_running() checks the deadline; the timer wheel callback only has to turn the LED off.
+static oneShotTimer_t hit_led_timer_deadline;
+static timerWheel_timer_t hit_led_timer_off_timer;
 
-void hitLedTimer_debug_print()
+// Timer wheel callback: the LED has been on long enough (unless a new hit restarted the deadline
+// before this callback's reschedule was applied).
+static void hitLedTimer_expired(timerWheel_timer_t* timer)
 {
-    static hitLedTimer_st_t previous_state;
-    static bool firstPass = true;
-
-    if (previous_state != hit_led_timer_current_state || firstPass)
+    (void) timer;
+    if (!oneShotTimer_running(&hit_led_timer_deadline))
     {
-        firstPass = false;
-        previous_state = hit_led_timer_current_state;
-
-        switch(hit_led_timer_current_state)
-        {
-            case hitLedTimer_idle_st:
-                printf("hitLedTimer_idle_st\n\r");
-                break;
-
-            case hitLedTimer_led_on_st:
-                printf("hitLedTimer_led_on_st\n\r");
-                break;
-        }
+        hitLedTimer_turnLedOff();
     }
 }
 
 // Standard init function. Implement it even if it is not necessary. You may need it later.
 void hitLedTimer_init()
 {
-    hit_led_timer_running = false;
-    hit_led_timer_hit_detected = false;
-    hit_led_timer_count = HIT_LED_TIMER_CLEAR;
+    oneShotTimer_stop(&hit_led_timer_deadline);
+    timerWheel_initTimer(&hit_led_timer_off_timer, hitLedTimer_expired, NULL);
 
     leds_init(true);
     mio_init(false);
@@ -69,70 +50,16 @@ void hitLedTimer_init()
 // Calling this starts the timer.
 void hitLedTimer_start()
 {
-    hit_led_timer_hit_detected = true;
-    hit_led_timer_running = true;
+    // The deadline is started before the callback is scheduled, so the callback is never due before it.
+    oneShotTimer_start(&hit_led_timer_deadline, HIT_LED_TIMER_TIME_UP);
+    timerWheel_schedule(&hit_led_timer_off_timer, HIT_LED_TIMER_TIME_UP);
+    hitLedTimer_turnLedOn();
 }
 
 // Returns true if the timer is currently running.
 bool hitLedTimer_running()
 {
-    return hit_led_timer_running;
-}
-
-// Standard tick function.
-void hitLedTimer_tick()
-{
-    //hitLedTimer_debug_print();
-
-    switch (hit_led_timer_current_state)
-    {
-        case hitLedTimer_idle_st:
-            if (hit_led_timer_hit_detected)
-            {
-                hit_led_timer_hit_detected = false;
-                hit_led_timer_running = true;
-                hitLedTimer_turnLedOn();
-                hit_led_timer_current_state = hitLedTimer_led_on_st;
-            }
-
-            else
-            {
-                hit_led_timer_current_state = hitLedTimer_idle_st;
-            }
-
-            break;
-
-        case hitLedTimer_led_on_st:
-            if (hit_led_timer_count >= HIT_LED_TIMER_TIME_UP)
-            {
-                hit_led_timer_count = HIT_LED_TIMER_CLEAR;
-                hit_led_timer_running = false;
-                hitLedTimer_turnLedOff();
-                hit_led_timer_current_state = hitLedTimer_idle_st;
-            }
-
-            else
-            {
-                hit_led_timer_current_state = hitLedTimer_led_on_st;
-            }
-
-            break;
-
-        default:
-            hit_led_timer_count = HIT_LED_TIMER_CLEAR;
-            hit_led_timer_current_state = hitLedTimer_idle_st;
-            break;
-    }
-
-    switch (hit_led_timer_current_state)
-    {
-        case hitLedTimer_idle_st:
-            break;
-
-        case hitLedTimer_led_on_st:
-            hit_led_timer_count++;
-            break;
-    }
+    return oneShotTimer_running(&hit_led_timer_deadline);
 }
 
 // Turns the gun's hit-LED on.
@@ -15,9 +15,6 @@ void hitLedTimer_start();
 // Returns true if the timer is currently running.
 bool hitLedTimer_running();
 
-// Standard tick function.
-void hitLedTimer_tick();
-
 // Turns the gun's hit-LED on.
 void hitLedTimer_turnLedOn();
 
@@ -5,16 +5,16 @@
      *      Author: hutch
      */
 
-#include "transmitter.h"
 #include "supportFiles/interrupts.h"
 #include "queue.h"
-#include "trigger.h"
-#include "lockoutTimer.h"
-#include "hitLedTimer.h"
+#include "timerWheel.h"
+#include "profiler.h"
+#include "isrMonitor.h"
+#include "multiSensor.h"
 #include <stdio.h>
 
-// Keep track of how many times isr_function() is called.
-//static uint64_t isr_totalXadcSampleCount = 0;
+// Keep track of how many times isr_function() is called (timestamps for the event journal).
+static volatile uint32_t isr_tickCount = 0;
 
 // This implements a dedicated buffer for storing values from the ADC
 // until they are read and processed by detector().
@@ -40,6 +40,12 @@ void adcBufferInit() {
 // Init everything in isr.
 void isr_init() {
 	adcBufferInit();  // init the local adcBuffer.
+	isr_tickCount = 0;
+}
+
+// Number of times isr_function() has run since isr_init().
+uint32_t isr_getTickCount() {
+	return isr_tickCount;
 }
 
 // Implemented as a fixed-size circular buffer.
@@ -77,10 +83,19 @@ uint32_t isr_adcBufferElementCount() {
 }
 
 void isr_function() {
+	ISR_MONITOR_ENTRY();
+	isr_tickCount++;
+#ifdef MULTI_SENSOR_ENABLED
+	multiSensor_acquire();
+#else
 	uint32_t adcData = interrupts_getAdcData();
 	isr_addDataToAdcBuffer(adcData);
-	transmitter_tick();
-	trigger_tick();
-	lockoutTimer_tick();
-	hitLedTimer_tick();
+#endif
+	ISR_MONITOR_SUBTICK_DONE(ISR_MONITOR_SUBTICK_ADC);
+	// The transmitter, trigger, lockout and hit-LED timers are all driven by the timer wheel.
+	PROFILER_BEGIN(PROFILER_STAGE_TIMER_WHEEL_TICK);
+	timerWheel_tick();
+	PROFILER_END(PROFILER_STAGE_TIMER_WHEEL_TICK);
+	ISR_MONITOR_SUBTICK_DONE(ISR_MONITOR_SUBTICK_TIMER_WHEEL);
+	ISR_MONITOR_EXIT();
 }
@@ -23,5 +23,8 @@
     // This returns the number of values in the ADC buffer.
     uint32_t isr_adcBufferElementCount();
 
+    // This returns the number of times isr_function() has run since isr_init() (wraps after about 12 hours).
+    uint32_t isr_getTickCount();
+
     #endif /* ISR_H_ */
 
@@ -0,0 +1,284 @@
+/*********************************************************************************************************/
+/* File: isrMonitor.c                                                                                    */
+/* Purpose: Per-tick ISR duration, inter-arrival jitter, and budget-overrun tracking (see isrMonitor.h). */
+/*********************************************************************************************************/
+#include <stdlib.h>
+#include "isrMonitor.h"
+
+// Histogram bins span twice the budget; the extra bin at the end catches everything beyond.
+#define ISR_MONITOR_BUDGET_SPAN 2
+#define ISR_MONITOR_OVERFLOW_BIN ISR_MONITOR_BIN_COUNT
+#define ISR_MONITOR_OTHER_SUBTICK ISR_MONITOR_SUBTICK_COUNT   // Overruns outside any sub-tick.
+#define ISR_MONITOR_REPORT_P50 0.50
+#define ISR_MONITOR_REPORT_P99 0.99
+#define ISR_MONITOR_REPORT_P999 0.999
+
+static const char* isrMonitor_subtickNames[ISR_MONITOR_SUBTICK_COUNT + 1] = {
+    "adc", "timerWheel_tick", "isr overhead"
+};
+
+// Timestamps for the tick in progress.
+static volatile cycleCounter_cycles_t isrMonitor_entryCycles;
+static volatile cycleCounter_cycles_t isrMonitor_subtickDoneCycles[ISR_MONITOR_SUBTICK_COUNT];
+static volatile cycleCounter_cycles_t isrMonitor_previousEntryCycles;
+static volatile bool isrMonitor_havePreviousEntry;
+
+// Configuration, in cycles.
+static double isrMonitor_budgetMicroseconds = ISR_MONITOR_DEFAULT_BUDGET_US;
+static cycleCounter_cycles_t isrMonitor_budgetCycles;
+static cycleCounter_cycles_t isrMonitor_binCycles;
+static cycleCounter_cycles_t isrMonitor_nominalPeriodCycles;
+
+// Measurements.
+static volatile uint32_t isrMonitor_tickCount;
+static volatile uint32_t isrMonitor_durationBins[ISR_MONITOR_BIN_COUNT + 1];
+static volatile uint32_t isrMonitor_jitterBins[ISR_MONITOR_BIN_COUNT + 1];
+static volatile uint32_t isrMonitor_jitterCount;
+static volatile cycleCounter_cycles_t isrMonitor_maxDurationCycles;
+static volatile int32_t isrMonitor_maxLateCycles;     // Largest inter-arrival beyond nominal.
+static volatile int32_t isrMonitor_maxEarlyCycles;    // Largest inter-arrival short of nominal.
+static volatile cycleCounter_cycles_t isrMonitor_subtickMaxCycles[ISR_MONITOR_SUBTICK_COUNT];
+static volatile uint64_t isrMonitor_subtickTotalCycles[ISR_MONITOR_SUBTICK_COUNT];
+static volatile uint32_t isrMonitor_overrunCount;
+static volatile uint32_t isrMonitor_overrunsBySubtick[ISR_MONITOR_SUBTICK_COUNT + 1];
+static volatile isrMonitor_overrun_t isrMonitor_overrunLog[ISR_MONITOR_OVERRUN_LOG_SIZE];
+
+/*********************************************************************************************************/
+/* Function: isrMonitor_toMicroseconds                                                                   */
+/* Purpose: Converts cycles to microseconds.                                                             */
+/* Returns: The duration in microseconds.                                                                */
+/*********************************************************************************************************/
+static double isrMonitor_toMicroseconds(double cycles)
+{
+    return cycles / cycleCounter_getCyclesPerMicrosecond();
+}
+
+/*********************************************************************************************************/
+/* Function: isrMonitor_binFor                                                                           */
+/* Purpose: Maps a duration to its histogram bin.                                                        */
+/* Returns: The bin index (ISR_MONITOR_OVERFLOW_BIN for anything past twice the budget).                 */
+/*********************************************************************************************************/
+static uint32_t isrMonitor_binFor(cycleCounter_cycles_t cycles)
+{
+    uint32_t bin = cycles / isrMonitor_binCycles;
+    return (bin < ISR_MONITOR_BIN_COUNT) ? bin : ISR_MONITOR_OVERFLOW_BIN;
+}
+
+/*********************************************************************************************************/
+/* Function: isrMonitor_percentile                                                                       */
+/* Purpose: Walks a histogram until the requested fraction of entries is covered.                        */
+/* Returns: The top of the bin reached, in microseconds.                                                 */
+/*********************************************************************************************************/
+static double isrMonitor_percentile(const volatile uint32_t bins[], uint32_t count, double percentile, double maxMicroseconds)
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    uint32_t target = (uint32_t) (percentile * count);
+    uint32_t covered = 0;
+    for (uint32_t bin = 0; bin < ISR_MONITOR_BIN_COUNT; bin++)
+    {
+        covered += bins[bin];
+        if (covered >= target && covered > 0)
+        {
+            double top = isrMonitor_toMicroseconds((double) (bin + 1) * isrMonitor_binCycles);
+            return (top < maxMicroseconds) ? top : maxMicroseconds;
+        }
+    }
+    // Only the overflow bin is left; the maximum is the best answer available.
+    return maxMicroseconds;
+}
+
+// Standard init function.
+void isrMonitor_init()
+{
+    cycleCounter_init();
+    isrMonitor_nominalPeriodCycles = (cycleCounter_cycles_t) (ISR_MONITOR_NOMINAL_PERIOD_US * cycleCounter_getCyclesPerMicrosecond());
+    isrMonitor_setBudgetMicroseconds(ISR_MONITOR_DEFAULT_BUDGET_US);
+}
+
+// Clears all of the measurements.
+void isrMonitor_reset()
+{
+    isrMonitor_havePreviousEntry = false;
+    isrMonitor_tickCount = 0;
+    isrMonitor_jitterCount = 0;
+    isrMonitor_maxDurationCycles = 0;
+    isrMonitor_maxLateCycles = 0;
+    isrMonitor_maxEarlyCycles = 0;
+    isrMonitor_overrunCount = 0;
+    for (uint32_t bin = 0; bin <= ISR_MONITOR_BIN_COUNT; bin++)
+    {
+        isrMonitor_durationBins[bin] = 0;
+        isrMonitor_jitterBins[bin] = 0;
+    }
+    for (uint16_t i = 0; i < ISR_MONITOR_SUBTICK_COUNT; i++)
+    {
+        isrMonitor_subtickMaxCycles[i] = 0;
+        isrMonitor_subtickTotalCycles[i] = 0;
+    }
+    for (uint16_t i = 0; i <= ISR_MONITOR_SUBTICK_COUNT; i++)
+    {
+        isrMonitor_overrunsBySubtick[i] = 0;
+    }
+}
+
+// Sets the overrun budget. The histograms are rescaled, so the measurements are cleared.
+void isrMonitor_setBudgetMicroseconds(double budgetMicroseconds)
+{
+    isrMonitor_budgetMicroseconds = budgetMicroseconds;
+    isrMonitor_budgetCycles = (cycleCounter_cycles_t) (budgetMicroseconds * cycleCounter_getCyclesPerMicrosecond());
+    isrMonitor_binCycles = (isrMonitor_budgetCycles * ISR_MONITOR_BUDGET_SPAN) / ISR_MONITOR_BIN_COUNT;
+    if (isrMonitor_binCycles == 0)
+    {
+        isrMonitor_binCycles = 1;
+    }
+    isrMonitor_reset();
+}
+
+// Timestamps ISR entry and measures the time since the previous entry.
+void isrMonitor_entry()
+{
+    cycleCounter_cycles_t now = cycleCounter_read();
+    isrMonitor_entryCycles = now;
+    if (isrMonitor_havePreviousEntry)
+    {
+        int32_t jitter = (int32_t) (now - isrMonitor_previousEntryCycles - isrMonitor_nominalPeriodCycles);
+        if (jitter > isrMonitor_maxLateCycles)
+        {
+            isrMonitor_maxLateCycles = jitter;
+        }
+        if (-jitter > isrMonitor_maxEarlyCycles)
+        {
+            isrMonitor_maxEarlyCycles = -jitter;
+        }
+        isrMonitor_jitterBins[isrMonitor_binFor((cycleCounter_cycles_t) abs(jitter))]++;
+        isrMonitor_jitterCount++;
+    }
+    isrMonitor_previousEntryCycles = now;
+    isrMonitor_havePreviousEntry = true;
+}
+
+// Timestamps the end of a sub-tick.
+void isrMonitor_subtickDone(isrMonitor_subtick_t subtick)
+{
+    isrMonitor_subtickDoneCycles[subtick] = cycleCounter_read();
+}
+
+// Timestamps ISR exit and folds the tick into the statistics.
+void isrMonitor_exit()
+{
+    cycleCounter_cycles_t duration = cycleCounter_read() - isrMonitor_entryCycles;
+    isrMonitor_tickCount++;
+    isrMonitor_durationBins[isrMonitor_binFor(duration)]++;
+    if (duration > isrMonitor_maxDurationCycles)
+    {
+        isrMonitor_maxDurationCycles = duration;
+    }
+    // Per sub-tick costs, and the sub-tick during which the budget ran out (if it did).
+    uint16_t overrunSubtick = ISR_MONITOR_OTHER_SUBTICK;
+    cycleCounter_cycles_t previous = isrMonitor_entryCycles;
+    for (uint16_t i = 0; i < ISR_MONITOR_SUBTICK_COUNT; i++)
+    {
+        cycleCounter_cycles_t done = isrMonitor_subtickDoneCycles[i];
+        cycleCounter_cycles_t subtickCycles = done - previous;
+        isrMonitor_subtickTotalCycles[i] += subtickCycles;
+        if (subtickCycles > isrMonitor_subtickMaxCycles[i])
+        {
+            isrMonitor_subtickMaxCycles[i] = subtickCycles;
+        }
+        if (overrunSubtick == ISR_MONITOR_OTHER_SUBTICK && done - isrMonitor_entryCycles > isrMonitor_budgetCycles)
+        {
+            overrunSubtick = i;
+        }
+        previous = done;
+    }
+    if (duration > isrMonitor_budgetCycles)
+    {
+        volatile isrMonitor_overrun_t* entry = &isrMonitor_overrunLog[isrMonitor_overrunCount % ISR_MONITOR_OVERRUN_LOG_SIZE];
+        entry->tick = isrMonitor_tickCount;
+        entry->cycles = duration;
+        entry->subtick = (isrMonitor_subtick_t) overrunSubtick;
+        isrMonitor_overrunsBySubtick[overrunSubtick]++;
+        isrMonitor_overrunCount++;
+    }
+}
+
+uint32_t isrMonitor_getTickCount()
+{
+    return isrMonitor_tickCount;
+}
+
+uint32_t isrMonitor_getOverrunCount()
+{
+    return isrMonitor_overrunCount;
+}
+
+uint32_t isrMonitor_getOverrunCountForSubtick(isrMonitor_subtick_t subtick)
+{
+    return isrMonitor_overrunsBySubtick[subtick];
+}
+
+double isrMonitor_getMaxDurationMicroseconds()
+{
+    return isrMonitor_toMicroseconds(isrMonitor_maxDurationCycles);
+}
+
+double isrMonitor_getDurationPercentileMicroseconds(double percentile)
+{
+    return isrMonitor_percentile(isrMonitor_durationBins, isrMonitor_tickCount, percentile, isrMonitor_getMaxDurationMicroseconds());
+}
+
+double isrMonitor_getJitterPercentileMicroseconds(double percentile)
+{
+    return isrMonitor_percentile(isrMonitor_jitterBins, isrMonitor_jitterCount, percentile, isrMonitor_getMaxJitterMicroseconds());
+}
+
+double isrMonitor_getMaxJitterMicroseconds()
+{
+    int32_t worst = (isrMonitor_maxLateCycles > isrMonitor_maxEarlyCycles) ? isrMonitor_maxLateCycles : isrMonitor_maxEarlyCycles;
+    return isrMonitor_toMicroseconds(worst);
+}
+
+/*********************************************************************************************************/
+/* Function: isrMonitor_dump                                                                             */
+/* Purpose: Prints the ISR duration and jitter statistics, the per sub-tick costs, and the overruns.     */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void isrMonitor_dump(FILE* out)
+{
+    fprintf(out, "ISR monitor: %lu ticks, budget %.2f us\n\r", (unsigned long) isrMonitor_tickCount, isrMonitor_budgetMicroseconds);
+    fprintf(out, "duration us: p50 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n\r",
+            isrMonitor_getDurationPercentileMicroseconds(ISR_MONITOR_REPORT_P50),
+            isrMonitor_getDurationPercentileMicroseconds(ISR_MONITOR_REPORT_P99),
+            isrMonitor_getDurationPercentileMicroseconds(ISR_MONITOR_REPORT_P999),
+            isrMonitor_getMaxDurationMicroseconds());
+    fprintf(out, "jitter us:   p50 %.2f  p99 %.2f  p99.9 %.2f  max late %.2f  max early %.2f\n\r",
+            isrMonitor_getJitterPercentileMicroseconds(ISR_MONITOR_REPORT_P50),
+            isrMonitor_getJitterPercentileMicroseconds(ISR_MONITOR_REPORT_P99),
+            isrMonitor_getJitterPercentileMicroseconds(ISR_MONITOR_REPORT_P999),
+            isrMonitor_toMicroseconds(isrMonitor_maxLateCycles),
+            isrMonitor_toMicroseconds(isrMonitor_maxEarlyCycles));
+    fprintf(out, "%-18s %10s %10s %10s\n\r", "sub-tick", "mean us", "max us", "overruns");
+    for (uint16_t i = 0; i <= ISR_MONITOR_SUBTICK_COUNT; i++)
+    {
+        double meanMicroseconds = 0.0;
+        double maxMicroseconds = 0.0;
+        if (i < ISR_MONITOR_SUBTICK_COUNT && isrMonitor_tickCount > 0)
+        {
+            meanMicroseconds = isrMonitor_toMicroseconds((double) isrMonitor_subtickTotalCycles[i] / isrMonitor_tickCount);
+            maxMicroseconds = isrMonitor_toMicroseconds(isrMonitor_subtickMaxCycles[i]);
+        }
+        fprintf(out, "%-18s %10.3f %10.3f %10lu\n\r", isrMonitor_subtickNames[i], meanMicroseconds, maxMicroseconds,
+                (unsigned long) isrMonitor_overrunsBySubtick[i]);
+    }
+    fprintf(out, "overruns: %lu\n\r", (unsigned long) isrMonitor_overrunCount);
+    uint32_t logged = (isrMonitor_overrunCount < ISR_MONITOR_OVERRUN_LOG_SIZE) ? isrMonitor_overrunCount : ISR_MONITOR_OVERRUN_LOG_SIZE;
+    for (uint32_t i = 0; i < logged; i++)
+    {
+        const volatile isrMonitor_overrun_t* entry = &isrMonitor_overrunLog[(isrMonitor_overrunCount - logged + i) % ISR_MONITOR_OVERRUN_LOG_SIZE];
+        fprintf(out, "    tick %10lu  %8.2f us  in %s\n\r", (unsigned long) entry->tick,
+                isrMonitor_toMicroseconds(entry->cycles), isrMonitor_subtickNames[entry->subtick]);
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef ISRMONITOR_H_
+#define ISRMONITOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "cycleCounter.h"
+
+// The ISR monitor timestamps isr_function() on entry, after each of its sub-ticks, and on
+// exit, every tick. It keeps:
+// - the ISR duration (max and percentiles from a linear histogram),
+// - the inter-arrival time of successive ISR entries and its jitter relative to the
+//   nominal 10 us tick,
+// - overruns: ticks whose duration exceeds the budget (10 us unless changed), each
+//   attributed to the sub-tick that was running when the budget ran out.
+// runningModes_isrLatency() runs the system under full load with the monitor on and
+// reports the results.
+//
+// Uncomment the line below (or build with -DISR_MONITOR_ENABLED) to compile the
+// monitor into isr_function(). When it is commented out the ISR_MONITOR_* macros
+// expand to nothing.
+//#define ISR_MONITOR_ENABLED
+
+// The pieces of work isr_function() performs, in order.
+typedef enum {
+    ISR_MONITOR_SUBTICK_ADC,            // Reading the XADC and filling the ADC buffer.
+    ISR_MONITOR_SUBTICK_TIMER_WHEEL,    // timerWheel_tick(), including the callbacks it runs.
+    ISR_MONITOR_SUBTICK_COUNT
+} isrMonitor_subtick_t;
+
+#define ISR_MONITOR_DEFAULT_BUDGET_US 10.0   // One tick at 100 kHz.
+#define ISR_MONITOR_NOMINAL_PERIOD_US 10.0   // Expected time between ISR entries.
+#define ISR_MONITOR_BIN_COUNT 200            // Histogram bins spanning 0 - 2x budget.
+#define ISR_MONITOR_OVERRUN_LOG_SIZE 16      // Most recent overruns kept for the report.
+
+// One recorded overrun.
+typedef struct {
+    uint32_t tick;                   // Monitored tick number.
+    cycleCounter_cycles_t cycles;    // ISR duration.
+    isrMonitor_subtick_t subtick;    // Sub-tick running when the budget ran out.
+} isrMonitor_overrun_t;
+
+// Standard init function: starts the cycle counter, sets the default budget and resets.
+void isrMonitor_init();
+
+// Clears all of the measurements (the budget is kept).
+void isrMonitor_reset();
+
+// Sets the budget, in microseconds, above which a tick counts as an overrun.
+void isrMonitor_setBudgetMicroseconds(double budgetMicroseconds);
+
+// Called by isr_function() through the macros below.
+void isrMonitor_entry();
+void isrMonitor_subtickDone(isrMonitor_subtick_t subtick);
+void isrMonitor_exit();
+
+// Results.
+uint32_t isrMonitor_getTickCount();
+uint32_t isrMonitor_getOverrunCount();
+uint32_t isrMonitor_getOverrunCountForSubtick(isrMonitor_subtick_t subtick);
+double isrMonitor_getMaxDurationMicroseconds();
+// percentile is 0.0 - 1.0. Resolution is one histogram bin (budget / 100).
+double isrMonitor_getDurationPercentileMicroseconds(double percentile);
+double isrMonitor_getJitterPercentileMicroseconds(double percentile);
+double isrMonitor_getMaxJitterMicroseconds();
+
+// Prints the full report (durations, jitter, per sub-tick costs, overruns).
+// stdout goes out over the UART on the board.
+void isrMonitor_dump(FILE* out);
+
+#ifdef ISR_MONITOR_ENABLED
+#define ISR_MONITOR_ENTRY() isrMonitor_entry()
+#define ISR_MONITOR_SUBTICK_DONE(subtick) isrMonitor_subtickDone(subtick)
+#define ISR_MONITOR_EXIT() isrMonitor_exit()
+#else
+#define ISR_MONITOR_ENTRY()
+#define ISR_MONITOR_SUBTICK_DONE(subtick)
+#define ISR_MONITOR_EXIT()
+#endif
+
+#endif /* ISRMONITOR_H_ */
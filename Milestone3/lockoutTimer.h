@@ -17,9 +17,6 @@ void lockoutTimer_start();
 // Returns true if the timer is running.
 bool lockoutTimer_running();
 
-// Standard tick function.
-void lockoutTimer_tick();
-
 void lockoutTimer_runTest();
 
 #endif /* LOCKOUTTIMER_H_ */
@@ -6,12 +6,19 @@
 #include <stdio.h>
 
 #define BUTTONS_BTN2_MASK 0x4   // Bit mask for BTN2
+#define MAIN_ISR_BUDGET_US 10.0 // ISR budget for the latency measurement mode (one 100 kHz tick).
 
 // The program comes up in continuous mode.
 // Hold BTN2 while the program starts to come up in shooter mode.
+// Hold BTN1 while the program starts to measure ISR latency (needs ISR_MONITOR_ENABLED).
 int main() {
     buttons_init();  // Init the buttons.
-    if (buttons_read() & BUTTONS_BTN2_MASK)
+    if (buttons_read() & BUTTONS_BTN1_MASK)
+    {
+        printf("running modes isr latency\n");
+        runningModes_isrLatency(MAIN_ISR_BUDGET_US);  // Measure the ISR under full load.
+    }
+    else if (buttons_read() & BUTTONS_BTN2_MASK)
     {
         // Read the buttons to see if BTN2 is drepressed.
         printf("running modes shooter\n");
@@ -0,0 +1,399 @@
+/*********************************************************************************************************/
+/* File: multiSensor.c                                                                                   */
+/* Purpose: Channel-interleaved acquisition, per-channel detection and hit fusion (see multiSensor.h).   */
+/*********************************************************************************************************/
+#include <string.h>
+#include "multiSensor.h"
+#include "filter.h"
+#include "lockoutTimer.h"
+#include "hitLedTimer.h"
+#include "eventJournal.h"
+#include "supportFiles/interrupts.h"
+#include "xparameters.h"
+#include "xil_io.h"
+
+#define MULTI_SENSOR_DECIMATION FILTER_FIR_DECIMATION_FACTOR
+#define MULTI_SENSOR_BLOCK_STEPS (MULTI_SENSOR_BLOCK_FRAMES / MULTI_SENSOR_DECIMATION)
+#define MULTI_SENSOR_VOTE_ROW_SIZE 128        // Votes of one channel; a whole number of cache lines.
+#define MULTI_SENSOR_NO_VOTE_FRAME UINT64_MAX // lastVoteFrame of a channel that has not voted yet.
+
+// Frame buffer filled by the ISR and emptied by the main loop. Only the ISR writes indexIn and only
+// the main loop writes indexOut, so neither side needs to disable interrupts.
+static uint16_t multiSensor_frames[MULTI_SENSOR_FRAME_BUFFER_FRAMES * MULTI_SENSOR_MAX_CHANNELS];
+static volatile uint32_t multiSensor_indexIn;
+static volatile uint32_t multiSensor_indexOut;
+static volatile uint32_t multiSensor_overflows;
+
+// Configuration.
+static uint8_t multiSensor_channelCount;
+static uint8_t multiSensor_quorum;
+static bool multiSensor_useHardwareTimers;
+static const uint8_t multiSensor_xadcChannels[MULTI_SENSOR_MAX_CHANNELS] = MULTI_SENSOR_XADC_CHANNELS;
+
+// Per-channel detectors and the votes they cast during the current block (DETECTOR_NO_HIT: no vote).
+static detector_ctx_t multiSensor_detectors[MULTI_SENSOR_MAX_CHANNELS];
+static bool multiSensor_detectorsInitialized = false;
+static int8_t multiSensor_votes[MULTI_SENSOR_MAX_CHANNELS][MULTI_SENSOR_VOTE_ROW_SIZE] __attribute__((aligned(MULTI_SENSOR_VOTE_ROW_SIZE)));
+
+// Fusion state.
+static uint64_t multiSensor_frameNumber;                              // Frames fused so far.
+static uint64_t multiSensor_lastVoteFrame[MULTI_SENSOR_MAX_CHANNELS];
+static int16_t multiSensor_lastVotePlayer[MULTI_SENSOR_MAX_CHANNELS];
+static uint64_t multiSensor_lockoutEndFrame;
+static bool multiSensor_hit;
+static multiSensor_hit_t multiSensor_lastHit;
+static detector_hitCount_t multiSensor_hitCounts[FILTER_NUMBER_OF_PLAYERS];
+static uint32_t multiSensor_sensorHitCounts[MULTI_SENSOR_MAX_CHANNELS];
+
+/*********************************************************************************************************/
+/* Function: multiSensor_neverLockedOut                                                                  */
+/* Purpose: Channel lockout hook: a channel keeps voting; the lockout is applied after fusion.           */
+/* Returns: false                                                                                        */
+/*********************************************************************************************************/
+static bool multiSensor_neverLockedOut(detector_ctx_t* ctx)
+{
+    (void) ctx;
+    return false;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_ignoreChannelHit                                                                */
+/* Purpose: Channel hit hook: a channel hit is only a vote, so there is nothing to start.                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void multiSensor_ignoreChannelHit(detector_ctx_t* ctx, int16_t player)
+{
+    (void) ctx;
+    (void) player;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_init                                                                            */
+/* Purpose: Configures the channels and quorum and clears the frame buffer and fusion state.             */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void multiSensor_init(uint8_t channelCount, uint8_t quorum, bool useHardwareTimers)
+{
+    if (channelCount < 1)
+        channelCount = 1;
+    if (channelCount > MULTI_SENSOR_MAX_CHANNELS)
+        channelCount = MULTI_SENSOR_MAX_CHANNELS;
+    if (quorum < MULTI_SENSOR_ANY_CHANNEL)
+        quorum = MULTI_SENSOR_ANY_CHANNEL;
+    if (quorum > channelCount)
+        quorum = channelCount;
+    multiSensor_channelCount = channelCount;
+    multiSensor_quorum = quorum;
+    multiSensor_useHardwareTimers = useHardwareTimers;
+
+    // The channel filters are allocated once for every possible channel and reset afterwards.
+    for (uint8_t c = 0; c < MULTI_SENSOR_MAX_CHANNELS; c++)
+    {
+        if (!multiSensor_detectorsInitialized)
+            detector_ctx_init(&multiSensor_detectors[c]);
+        else
+            detector_ctx_reset(&multiSensor_detectors[c]);
+        detector_ctx_setHooks(&multiSensor_detectors[c], multiSensor_neverLockedOut, multiSensor_ignoreChannelHit, NULL);
+        multiSensor_lastVoteFrame[c] = MULTI_SENSOR_NO_VOTE_FRAME;
+        multiSensor_lastVotePlayer[c] = DETECTOR_NO_HIT;
+        multiSensor_sensorHitCounts[c] = 0;
+    }
+    multiSensor_detectorsInitialized = true;
+    for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+        multiSensor_hitCounts[p] = 0;
+
+    multiSensor_indexIn = 0;
+    multiSensor_indexOut = 0;
+    multiSensor_overflows = 0;
+    multiSensor_frameNumber = 0;
+    multiSensor_lockoutEndFrame = 0;
+    multiSensor_hit = false;
+    memset(&multiSensor_lastHit, 0, sizeof(multiSensor_lastHit));
+    multiSensor_lastHit.player = DETECTOR_NO_HIT;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_getChannelCount                                                                 */
+/* Purpose: Returns the configured number of channels.                                                   */
+/* Returns: The channel count.                                                                           */
+/*********************************************************************************************************/
+uint8_t multiSensor_getChannelCount()
+{
+    return multiSensor_channelCount;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_addFrame                                                                        */
+/* Purpose: Appends one frame to the frame buffer, or counts an overflow if it is full.                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void multiSensor_addFrame(const uint16_t frame[])
+{
+    uint32_t indexIn = multiSensor_indexIn;
+    uint32_t next = (indexIn + 1) % MULTI_SENSOR_FRAME_BUFFER_FRAMES;
+    if (next == multiSensor_indexOut)
+    {
+        multiSensor_overflows++;
+        return;
+    }
+    uint16_t* slot = &multiSensor_frames[indexIn * multiSensor_channelCount];
+    for (uint8_t c = 0; c < multiSensor_channelCount; c++)
+        slot[c] = frame[c];
+    // The frame must be complete before the main loop can see it.
+    __atomic_store_n(&multiSensor_indexIn, next, __ATOMIC_RELEASE);
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_acquire                                                                         */
+/* Purpose: Reads every channel once and stores the readings as one frame. Called from isr_function().   */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void multiSensor_acquire()
+{
+    uint16_t frame[MULTI_SENSOR_MAX_CHANNELS];
+    for (uint8_t c = 0; c < multiSensor_channelCount; c++)
+    {
+#if defined(__arm__) && !defined(__linux__)
+        uint32_t offset = MULTI_SENSOR_XADC_DATA_OFFSET + 4 * (MULTI_SENSOR_XADC_AUX_CHANNEL_BASE + multiSensor_xadcChannels[c]);
+        frame[c] = (uint16_t) (Xil_In32(XPAR_XADC_WIZ_0_BASEADDR + offset) >> MULTI_SENSOR_XADC_DATA_SHIFT);
+#else
+        // The host has a single simulated ADC value; every channel sees it.
+        frame[c] = (uint16_t) interrupts_getAdcData();
+#endif
+    }
+    multiSensor_addFrame(frame);
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_frameCount                                                                      */
+/* Purpose: Returns the number of frames waiting in the frame buffer.                                    */
+/* Returns: The frame count.                                                                             */
+/*********************************************************************************************************/
+uint32_t multiSensor_frameCount()
+{
+    uint32_t indexIn = __atomic_load_n(&multiSensor_indexIn, __ATOMIC_ACQUIRE);
+    return (indexIn + MULTI_SENSOR_FRAME_BUFFER_FRAMES - multiSensor_indexOut) % MULTI_SENSOR_FRAME_BUFFER_FRAMES;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_overflowCount                                                                   */
+/* Purpose: Returns the number of frames dropped because the buffer was full.                            */
+/* Returns: The overflow count.                                                                          */
+/*********************************************************************************************************/
+uint32_t multiSensor_overflowCount()
+{
+    return multiSensor_overflows;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_runChannels                                                                     */
+/* Purpose: Runs channels [firstChannel, lastChannel) over a block of frames and records, for each       */
+/*          decimated sample, which player (if any) each channel votes for.                              */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void multiSensor_runChannels(const uint16_t frames[], uint32_t frameCount, uint8_t firstChannel, uint8_t lastChannel)
+{
+    uint8_t stride = multiSensor_channelCount;
+    for (uint8_t c = firstChannel; c < lastChannel; c++)
+    {
+        detector_ctx_t* detector = &multiSensor_detectors[c];
+        int8_t* votes = multiSensor_votes[c];
+        // Walk this channel's column of the interleaved block; a vote can only come on a decimated sample.
+        for (uint32_t f = 0; f < frameCount; f++)
+        {
+            int16_t player = detector_ctx_addSample(detector, frames[f * stride + c]);
+            if ((f % MULTI_SENSOR_DECIMATION) == (MULTI_SENSOR_DECIMATION - 1))
+                votes[f / MULTI_SENSOR_DECIMATION] = (int8_t) player;
+        }
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_declareHit                                                                      */
+/* Purpose: Records a fused hit and starts the lockout.                                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void multiSensor_declareHit(uint64_t frame, int16_t player, uint8_t sensorMask, uint8_t sensorCount)
+{
+    multiSensor_lastHit.frame = frame;
+    multiSensor_lastHit.player = player;
+    multiSensor_lastHit.sensorMask = sensorMask;
+    multiSensor_lastHit.sensorCount = sensorCount;
+    multiSensor_hit = true;
+    multiSensor_hitCounts[player]++;
+    // Journal the power seen by the first sensor that agreed.
+    uint8_t firstSensor = 0;
+    while (!(sensorMask & (1 << firstSensor)))
+        firstSensor++;
+    const detector_ctx_t* detector = &multiSensor_detectors[firstSensor];
+    eventJournal_append(EVENT_JOURNAL_HIT, (uint8_t) player, (float) detector->filter->currentPower[player], (float) detector->hitThreshold);
+    for (uint8_t c = 0; c < multiSensor_channelCount; c++)
+        if (sensorMask & (1 << c))
+            multiSensor_sensorHitCounts[c]++;
+    if (multiSensor_useHardwareTimers)
+    {
+        lockoutTimer_start();
+        hitLedTimer_start();
+    }
+    else
+    {
+        multiSensor_lockoutEndFrame = frame + LOCKOUT_TIMER_EXPIRE_VALUE;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_fuse                                                                            */
+/* Purpose: Walks the votes of the block in time order and declares a hit when enough sensors agree on   */
+/*          a player within the coincidence window.                                                      */
+/* Returns: The number of hits declared.                                                                 */
+/*********************************************************************************************************/
+uint32_t multiSensor_fuse(uint32_t frameCount)
+{
+    uint32_t hitCount = 0;
+    uint32_t stepCount = frameCount / MULTI_SENSOR_DECIMATION;
+    for (uint32_t s = 0; s < stepCount; s++)
+    {
+        uint64_t frame = multiSensor_frameNumber + (uint64_t) s * MULTI_SENSOR_DECIMATION + (MULTI_SENSOR_DECIMATION - 1);
+        // Remember the latest vote of every channel.
+        for (uint8_t c = 0; c < multiSensor_channelCount; c++)
+        {
+            int8_t vote = multiSensor_votes[c][s];
+            if (vote != DETECTOR_NO_HIT)
+            {
+                multiSensor_lastVoteFrame[c] = frame;
+                multiSensor_lastVotePlayer[c] = vote;
+            }
+        }
+        bool lockedOut = multiSensor_useHardwareTimers ? lockoutTimer_running() : (frame < multiSensor_lockoutEndFrame);
+        if (lockedOut)
+            continue;
+        // Count the recent votes per player and keep the best-supported one.
+        uint8_t votesPerPlayer[FILTER_NUMBER_OF_PLAYERS] = {0};
+        uint8_t maskPerPlayer[FILTER_NUMBER_OF_PLAYERS] = {0};
+        int16_t bestPlayer = DETECTOR_NO_HIT;
+        for (uint8_t c = 0; c < multiSensor_channelCount; c++)
+        {
+            if (multiSensor_lastVoteFrame[c] == MULTI_SENSOR_NO_VOTE_FRAME || frame - multiSensor_lastVoteFrame[c] > MULTI_SENSOR_COINCIDENCE_SAMPLES)
+                continue;
+            int16_t player = multiSensor_lastVotePlayer[c];
+            votesPerPlayer[player]++;
+            maskPerPlayer[player] |= (uint8_t) (1 << c);
+            if (bestPlayer == DETECTOR_NO_HIT || votesPerPlayer[player] > votesPerPlayer[bestPlayer])
+                bestPlayer = player;
+        }
+        if (bestPlayer != DETECTOR_NO_HIT && votesPerPlayer[bestPlayer] >= multiSensor_quorum)
+        {
+            multiSensor_declareHit(frame, bestPlayer, maskPerPlayer[bestPlayer], votesPerPlayer[bestPlayer]);
+            hitCount++;
+        }
+    }
+    multiSensor_frameNumber += (uint64_t) stepCount * MULTI_SENSOR_DECIMATION;
+    return hitCount;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_processFrames                                                                   */
+/* Purpose: Runs interleaved frames through every channel and the fusion stage, a block at a time.       */
+/* Returns: The number of hits declared.                                                                 */
+/*********************************************************************************************************/
+uint32_t multiSensor_processFrames(const uint16_t frames[], uint32_t frameCount)
+{
+    uint32_t hitCount = 0;
+    for (uint32_t done = 0; done < frameCount; done += MULTI_SENSOR_BLOCK_FRAMES)
+    {
+        uint32_t blockFrames = (frameCount - done < MULTI_SENSOR_BLOCK_FRAMES) ? frameCount - done : MULTI_SENSOR_BLOCK_FRAMES;
+        multiSensor_runChannels(&frames[done * multiSensor_channelCount], blockFrames, 0, multiSensor_channelCount);
+        hitCount += multiSensor_fuse(blockFrames);
+    }
+    return hitCount;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_run                                                                             */
+/* Purpose: Processes the frames waiting in the frame buffer, in place, a contiguous block at a time.    */
+/*          A partial decimation period is left in the buffer for the next call.                         */
+/* Returns: The number of hits declared.                                                                 */
+/*********************************************************************************************************/
+uint32_t multiSensor_run()
+{
+    uint32_t hitCount = 0;
+    uint32_t available = multiSensor_frameCount();
+    while (available >= MULTI_SENSOR_DECIMATION)
+    {
+        uint32_t indexOut = multiSensor_indexOut;
+        uint32_t untilWrap = MULTI_SENSOR_FRAME_BUFFER_FRAMES - indexOut;
+        uint32_t blockFrames = available;
+        if (blockFrames > untilWrap)
+            blockFrames = untilWrap;
+        if (blockFrames > MULTI_SENSOR_BLOCK_FRAMES)
+            blockFrames = MULTI_SENSOR_BLOCK_FRAMES;
+        blockFrames -= blockFrames % MULTI_SENSOR_DECIMATION;
+        hitCount += multiSensor_processFrames(&multiSensor_frames[indexOut * multiSensor_channelCount], blockFrames);
+        // Hand the processed frames back to the ISR.
+        __atomic_store_n(&multiSensor_indexOut, (indexOut + blockFrames) % MULTI_SENSOR_FRAME_BUFFER_FRAMES, __ATOMIC_RELEASE);
+        available -= blockFrames;
+    }
+    return hitCount;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_hitDetected                                                                     */
+/* Purpose: Reports whether a hit has been declared and not cleared.                                     */
+/* Returns: true if there is an uncleared hit.                                                           */
+/*********************************************************************************************************/
+bool multiSensor_hitDetected()
+{
+    return multiSensor_hit;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_clearHit                                                                        */
+/* Purpose: Clears the detected hit.                                                                     */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void multiSensor_clearHit()
+{
+    multiSensor_hit = false;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_getLastHit                                                                      */
+/* Purpose: Copies the most recent fused hit (player DETECTOR_NO_HIT if there has been none).            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void multiSensor_getLastHit(multiSensor_hit_t* hit)
+{
+    *hit = multiSensor_lastHit;
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_getHitCounts                                                                    */
+/* Purpose: Copies the fused hit counts per player.                                                      */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void multiSensor_getHitCounts(detector_hitCount_t hitArray[])
+{
+    for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+        hitArray[p] = multiSensor_hitCounts[p];
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_getSensorHitCounts                                                              */
+/* Purpose: Copies, per sensor, the number of fused hits the sensor agreed on.                           */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void multiSensor_getSensorHitCounts(uint32_t sensorHits[])
+{
+    for (uint8_t c = 0; c < multiSensor_channelCount; c++)
+        sensorHits[c] = multiSensor_sensorHitCounts[c];
+}
+
+/*********************************************************************************************************/
+/* Function: multiSensor_getChannelDetector                                                              */
+/* Purpose: Gives access to the detector instance of a channel.                                          */
+/* Returns: A pointer to the instance.                                                                   */
+/*********************************************************************************************************/
+detector_ctx_t* multiSensor_getChannelDetector(uint8_t channel)
+{
+    return &multiSensor_detectors[channel];
+}
@@ -0,0 +1,105 @@
+#ifndef MULTISENSOR_H_
+#define MULTISENSOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "detector.h"
+
+// Multi-sensor acquisition and hit fusion for vests with several photodiodes.
+//
+// Acquisition: with MULTI_SENSOR_ENABLED, isr_function() calls multiSensor_acquire(), which reads
+// every channel once and stores the readings as one frame in a channel-interleaved frame buffer.
+// There is one interrupt per tick however many channels there are.
+//
+// Detection: each channel has its own detector instance (filter chain). Frames are processed in
+// blocks: every channel runs over the whole block on its own (multiSensor_runChannels()), then the
+// fusion stage (multiSensor_fuse()) walks the block one decimated sample at a time. Channels never
+// touch each other's state during the first step, so disjoint channel ranges can run on different
+// cores or threads (see host/multiSensorMain.c) and the cost per channel stays constant.
+//
+// Fusion: a channel votes for a player while its detector sees that player's power stand out.
+// When at least quorum channels have voted for the same player within
+// MULTI_SENSOR_COINCIDENCE_SAMPLES of each other, a hit is declared for that player, the sensors
+// that agreed are reported as a bit mask, and the vest is locked out like the single-sensor detector.
+//
+// Uncomment the line below (or build with -DMULTI_SENSOR_ENABLED) to have isr_function() acquire
+// frames for this module instead of filling the single-channel ADC buffer.
+//#define MULTI_SENSOR_ENABLED
+
+#define MULTI_SENSOR_MAX_CHANNELS 8
+#define MULTI_SENSOR_ANY_CHANNEL 1                  // Quorum for "any sensor".
+#define MULTI_SENSOR_BLOCK_FRAMES 1000              // Frames processed per block (10 ms); multiple of the decimation.
+#define MULTI_SENSOR_FRAME_BUFFER_FRAMES 10000      // Frame buffer capacity (100 ms); multiple of the block size.
+#define MULTI_SENSOR_COINCIDENCE_SAMPLES 1000       // Votes this close together (10 ms) agree.
+
+// XADC auxiliary inputs wired to the sensors, in frame order (the four JA Pmod channels first).
+// The AXI XADC keeps the latest conversion of auxiliary input n in the 16-bit register at
+// MULTI_SENSOR_XADC_DATA_OFFSET + 4 * (16 + n), MSB-justified.
+#define MULTI_SENSOR_XADC_CHANNELS {14, 7, 15, 6, 13, 5, 12, 4}
+#define MULTI_SENSOR_XADC_DATA_OFFSET 0x200
+#define MULTI_SENSOR_XADC_AUX_CHANNEL_BASE 16
+#define MULTI_SENSOR_XADC_DATA_SHIFT 4
+
+// One fused hit.
+typedef struct {
+    uint64_t frame;         // Frame (tick) at which the hit was declared.
+    int16_t player;         // Player that was hit.
+    uint8_t sensorMask;     // Bit n set: sensor n agreed.
+    uint8_t sensorCount;    // Number of sensors that agreed.
+} multiSensor_hit_t;
+
+// Sets up channelCount channels (1 - MULTI_SENSOR_MAX_CHANNELS) and the quorum needed to declare a
+// hit (MULTI_SENSOR_ANY_CHANNEL for any sensor). With useHardwareTimers the lockout and hit LED use
+// the lockout and hit-LED timers; otherwise the lockout is counted in frames. Empties the frame buffer.
+void multiSensor_init(uint8_t channelCount, uint8_t quorum, bool useHardwareTimers);
+
+// Returns the number of channels configured by multiSensor_init().
+uint8_t multiSensor_getChannelCount();
+
+// ISR side: reads every channel once and appends the frame to the frame buffer.
+void multiSensor_acquire();
+
+// Appends one frame (channelCount readings) to the frame buffer. Drops it if the buffer is full.
+void multiSensor_addFrame(const uint16_t frame[]);
+
+// Number of frames waiting in the frame buffer.
+uint32_t multiSensor_frameCount();
+
+// Number of frames dropped because the frame buffer was full.
+uint32_t multiSensor_overflowCount();
+
+// Main-loop side: processes every whole decimation's worth of frames waiting in the frame buffer.
+// Returns the number of hits declared.
+uint32_t multiSensor_run();
+
+// Processes frameCount interleaved frames (a multiple of the decimation factor) that are not in the
+// frame buffer, e.g. from a recording. Returns the number of hits declared.
+uint32_t multiSensor_processFrames(const uint16_t frames[], uint32_t frameCount);
+
+// First step of a block: runs channels [firstChannel, lastChannel) over frameCount frames
+// (at most MULTI_SENSOR_BLOCK_FRAMES, a multiple of the decimation factor) and records their votes.
+// Calls for disjoint channel ranges may run concurrently.
+void multiSensor_runChannels(const uint16_t frames[], uint32_t frameCount, uint8_t firstChannel, uint8_t lastChannel);
+
+// Second step of a block: fuses the votes recorded for the block. Returns the number of hits declared.
+uint32_t multiSensor_fuse(uint32_t frameCount);
+
+// Returns true if a hit was declared and not yet cleared.
+bool multiSensor_hitDetected();
+
+// Clears the detected hit.
+void multiSensor_clearHit();
+
+// Copies the most recent hit.
+void multiSensor_getLastHit(multiSensor_hit_t* hit);
+
+// Copies the number of fused hits per player.
+void multiSensor_getHitCounts(detector_hitCount_t hitArray[]);
+
+// Copies, per sensor, how many fused hits it took part in.
+void multiSensor_getSensorHitCounts(uint32_t sensorHits[]);
+
+// Returns the detector instance of a channel.
+detector_ctx_t* multiSensor_getChannelDetector(uint8_t channel);
+
+#endif /* MULTISENSOR_H_ */
@@ -0,0 +1,67 @@
+#ifndef ONESHOTTIMER_H_
+#define ONESHOTTIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "timerWheel.h"
+
+// One-shot timers measured against the timer wheel's free-running tick count (100 kHz).
+// Starting a timer records when it started and how long it runs; nothing happens while it runs,
+// and asking whether it is still running is a subtraction and a compare. A timer is two words,
+// so any number can run at once (a lockout per player, a timer per LED) at no per-tick cost.
+// Use a timer wheel callback instead when something has to happen at the moment of expiry.
+//
+// Differences of the 32-bit tick count are exact for 11.9 hours. oneShotTimer_running() moves the
+// start of an expired timer up, so a timer checked at least that often never appears to run again.
+
+#define ONE_SHOT_TIMER_STOPPED 0
+
+typedef struct {
+    volatile uint32_t startTick;       // Tick count when the timer was started.
+    volatile uint32_t durationTicks;   // ONE_SHOT_TIMER_STOPPED when not running.
+} oneShotTimer_t;
+
+// Starts (or restarts) timer to run for durationTicks ticks. Any context.
+static inline void oneShotTimer_start(oneShotTimer_t* timer, uint32_t durationTicks)
+{
+    // Stop first so a reader never pairs the new start with the old duration.
+    __atomic_store_n(&timer->durationTicks, (uint32_t) ONE_SHOT_TIMER_STOPPED, __ATOMIC_RELAXED);
+    __atomic_store_n(&timer->startTick, timerWheel_now(), __ATOMIC_RELAXED);
+    __atomic_store_n(&timer->durationTicks, durationTicks, __ATOMIC_RELEASE);
+}
+
+// Stops timer.
+static inline void oneShotTimer_stop(oneShotTimer_t* timer)
+{
+    __atomic_store_n(&timer->durationTicks, (uint32_t) ONE_SHOT_TIMER_STOPPED, __ATOMIC_RELAXED);
+}
+
+// Returns true if timer was started less than its duration ago.
+static inline bool oneShotTimer_running(oneShotTimer_t* timer)
+{
+    uint32_t durationTicks = __atomic_load_n(&timer->durationTicks, __ATOMIC_ACQUIRE);
+    uint32_t startTick = timer->startTick;
+    uint32_t now = timerWheel_now();
+    if (now - startTick < durationTicks)
+    {
+        return true;
+    }
+    // Expired: move the start up to the expiry so the tick count wrapping can't revive it. Does
+    // nothing if the timer was restarted meanwhile.
+    if (durationTicks != ONE_SHOT_TIMER_STOPPED)
+    {
+        __atomic_compare_exchange_n(&timer->startTick, &startTick, now - durationTicks, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+    return false;
+}
+
+// Returns the number of ticks before timer expires (0 if it is not running).
+static inline uint32_t oneShotTimer_remaining(oneShotTimer_t* timer)
+{
+    uint32_t durationTicks = __atomic_load_n(&timer->durationTicks, __ATOMIC_ACQUIRE);
+    uint32_t elapsedTicks = timerWheel_now() - timer->startTick;
+    return (elapsedTicks < durationTicks) ? durationTicks - elapsedTicks : 0;
+}
+
+#endif /* ONESHOTTIMER_H_ */
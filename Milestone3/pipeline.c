@@ -0,0 +1,344 @@
+/*********************************************************************************************************/
+/* File: pipeline.c                                                                                      */
+/* Purpose: Two-stage detector split across the two cores: FIR/decimation on core 0, IIR bank, power    */
+/*          and hit detection on core 1 (see pipeline.h).                                                */
+/*********************************************************************************************************/
+#include "pipeline.h"
+#include "filter.h"
+#include "isr.h"
+#include "lockoutTimer.h"
+#include "hitLedTimer.h"
+#include "profiler.h"
+#include "eventJournal.h"
+#include "supportFiles/interrupts.h"
+
+#define PIPELINE_DECIMATION_FACTOR FILTER_FIR_DECIMATION_FACTOR
+#define PIPELINE_INPUT_COUNT_CLEAR 0
+
+// The ring between the stages.
+static spscRing_t pipeline_ring;
+
+// Stage 1 state: the built-in filter (only its xQueue and FIR are used) and the decimation count.
+static filter_ctx_t* pipeline_stage1Filter;
+static uint8_t pipeline_inputCount;
+
+// Stage 2 state: a detector instance with a filter of its own.
+static detector_ctx_t pipeline_stage2Detector;
+static bool pipeline_stage2Initialized = false;
+static bool pipeline_useHardwareTimers;
+
+// Hits handed back from stage 2 to core 0, one ring entry (the player) per hit. Core 0 starts the
+// timers and drives the hit LED for each; stage 2 stays locked out until it has.
+static spscRing_t pipeline_hitRing;
+static uint32_t pipeline_hitsPublished;   // Stage 2 only.
+static uint32_t pipeline_hitsHandled;     // Core 0 only; read by the stage-2 lockout hook.
+static uint32_t pipeline_hitsConsumed;    // Core 0 only: hits already seen by pipeline_clearHit().
+
+/*********************************************************************************************************/
+/* Function: pipeline_lockoutTimerRunning                                                                */
+/* Purpose: Stage-2 lockout hook when the hardware timers are in use. A hit core 0 has not taken yet     */
+/*          counts as locked out, since its lockout timer has not been started.                          */
+/* Returns: true while a hit is waiting for core 0 or the lockout timer runs.                            */
+/*********************************************************************************************************/
+static bool pipeline_lockoutTimerRunning(detector_ctx_t* ctx)
+{
+    (void) ctx;
+    return __atomic_load_n(&pipeline_hitsHandled, __ATOMIC_ACQUIRE) != pipeline_hitsPublished || lockoutTimer_running();
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_onHit                                                                              */
+/* Purpose: Stage-2 hit hook: starts the sample-counted lockout (without hardware timers) and hands the  */
+/*          hit back to core 0, which starts the timers.                                                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void pipeline_onHit(detector_ctx_t* ctx, int16_t player)
+{
+    eventJournal_append(EVENT_JOURNAL_HIT, (uint8_t) player, (float) ctx->filter->currentPower[player], (float) ctx->hitThreshold);
+    if (!pipeline_useHardwareTimers)
+    {
+        ctx->lockoutRemaining = LOCKOUT_TIMER_EXPIRE_VALUE;
+    }
+    // The hit counts were updated before this hook ran; the push releases them along with the hit. The
+    // ring only fills if core 0 stops polling, and then the hit is only counted.
+    if (spscRing_push(&pipeline_hitRing, player))
+    {
+        pipeline_hitsPublished++;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_receiveHits                                                                        */
+/* Purpose: Core 0: takes the hits stage 2 handed back and, with hardware timers, starts the lockout and */
+/*          hit-LED timers for each (lighting the LED).                                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void pipeline_receiveHits()
+{
+    spscRing_data_t player;
+    while (spscRing_pop(&pipeline_hitRing, &player))
+    {
+        if (pipeline_useHardwareTimers)
+        {
+            lockoutTimer_start();
+            hitLedTimer_start();
+        }
+        // Stage 2 resumes detection once it sees this, by when the lockout timer is running.
+        __atomic_store_n(&pipeline_hitsHandled, pipeline_hitsHandled + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_init                                                                               */
+/* Purpose: Clears the ring and both stages and installs the stage-2 hooks.                              */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_init(bool useHardwareTimers)
+{
+    spscRing_init(&pipeline_ring);
+    spscRing_init(&pipeline_hitRing);
+    pipeline_stage1Filter = filter_getDefaultCtx();
+    pipeline_inputCount = PIPELINE_INPUT_COUNT_CLEAR;
+    // The stage-2 filter is allocated once and reset on later calls.
+    if (!pipeline_stage2Initialized)
+    {
+        detector_ctx_init(&pipeline_stage2Detector);
+        pipeline_stage2Initialized = true;
+    }
+    else
+    {
+        detector_ctx_reset(&pipeline_stage2Detector);
+    }
+    pipeline_useHardwareTimers = useHardwareTimers;
+    detector_ctx_setHooks(&pipeline_stage2Detector, useHardwareTimers ? pipeline_lockoutTimerRunning : NULL, pipeline_onHit, NULL);
+    pipeline_hitsPublished = 0;
+    pipeline_hitsHandled = 0;
+    pipeline_hitsConsumed = 0;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_stage1AddSample                                                                    */
+/* Purpose: Adds a raw sample to the FIR input and, every decimation period, pushes a FIR output into    */
+/*          the ring. Spins while the ring is full (stage 2 is behind).                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_stage1AddSample(uint16_t rawAdcValue)
+{
+    filter_ctx_addNewInput(pipeline_stage1Filter, detector_scaled_adc_value(rawAdcValue));
+    pipeline_inputCount++;
+    if (pipeline_inputCount >= PIPELINE_DECIMATION_FACTOR)
+    {
+        pipeline_inputCount = PIPELINE_INPUT_COUNT_CLEAR;
+        PROFILER_BEGIN(PROFILER_STAGE_FIR);
+        double firOutput = filter_ctx_firFilter(pipeline_stage1Filter);
+        PROFILER_END(PROFILER_STAGE_FIR);
+        // Dropping an output would corrupt the IIR history, so wait for room instead.
+        while (!spscRing_push(&pipeline_ring, firOutput))
+        {
+        }
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_stage1                                                                             */
+/* Purpose: Drains the ADC buffer through stage 1, the same way detector() drains it, then takes the     */
+/*          hits stage 2 handed back.                                                                    */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_stage1(bool interruptsEnabled)
+{
+    uint32_t elementCount = isr_adcBufferElementCount();
+    for (uint32_t i = 0; i < elementCount; i++)
+    {
+        uint16_t rawValue;
+        PROFILER_BEGIN(PROFILER_STAGE_ADC_DRAIN);
+        if (interruptsEnabled)
+        {
+            interrupts_disableArmInts();
+            rawValue = isr_removeDataFromAdcBuffer();
+            interrupts_enableArmInts();
+        }
+        else
+        {
+            rawValue = isr_removeDataFromAdcBuffer();
+        }
+        PROFILER_END(PROFILER_STAGE_ADC_DRAIN);
+        pipeline_stage1AddSample(rawValue);
+    }
+    pipeline_receiveHits();
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_stage2Poll                                                                         */
+/* Purpose: Runs every FIR output waiting in the ring through the stage-2 detector.                      */
+/* Returns: The number of FIR outputs processed.                                                         */
+/*********************************************************************************************************/
+uint32_t pipeline_stage2Poll()
+{
+    uint32_t processed = 0;
+    spscRing_data_t firOutput;
+    while (spscRing_pop(&pipeline_ring, &firOutput))
+    {
+        detector_ctx_addFirOutput(&pipeline_stage2Detector, firOutput);
+        processed++;
+    }
+    return processed;
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_hitDetected                                                                        */
+/* Purpose: Takes the hits stage 2 handed back and reports whether any has not been cleared.            */
+/* Returns: true if there is an uncleared hit.                                                           */
+/*********************************************************************************************************/
+bool pipeline_hitDetected()
+{
+    pipeline_receiveHits();
+    return pipeline_hitsHandled != pipeline_hitsConsumed;
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_clearHit                                                                           */
+/* Purpose: Marks every hit published so far as seen.                                                    */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_clearHit()
+{
+    pipeline_hitsConsumed = pipeline_hitsHandled;
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_getHitCounts                                                                       */
+/* Purpose: Copies the stage-2 hit counts. Counts are only ever incremented, so a copy taken while stage */
+/*          2 runs is at worst one hit behind.                                                           */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_getHitCounts(detector_hitCount_t hitArray[])
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    detector_ctx_getHitCounts(&pipeline_stage2Detector, hitArray);
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_getCurrentPowerValues                                                              */
+/* Purpose: Copies the stage-2 power values. Values may mix two updates while stage 2 runs, which is     */
+/*          fine for the histogram.                                                                      */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_getCurrentPowerValues(double powerValues[])
+{
+    filter_ctx_getCurrentPowerValues(pipeline_stage2Detector.filter, powerValues);
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_getStage2Detector                                                                  */
+/* Purpose: Gives access to the stage-2 detector instance.                                               */
+/* Returns: A pointer to the instance.                                                                   */
+/*********************************************************************************************************/
+detector_ctx_t* pipeline_getStage2Detector()
+{
+    return &pipeline_stage2Detector;
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_dump                                                                               */
+/* Purpose: Prints the statistics of both rings.                                                         */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_dump(FILE* out)
+{
+    spscRing_dump(out, "pipeline ring (FIR outputs)", &pipeline_ring);
+    spscRing_dump(out, "pipeline ring (hits)", &pipeline_hitRing);
+}
+
+#if defined(__arm__) && !defined(__linux__)
+#include "xil_io.h"
+#include "xil_cache.h"
+
+// After reset CPU1 sits in the boot ROM waiting for an event; on a sev it jumps to the address
+// stored in this OCM word (if non-zero).
+#define PIPELINE_CPU1_START_ADDRESS 0xFFFFFFF0
+#define PIPELINE_CORE1_STACK_WORDS 2048
+// ACTLR bits: SMP (take part in coherency) and FW (broadcast cache/TLB maintenance).
+#define PIPELINE_ACTLR_SMP_FW 0x41
+
+static uint32_t pipeline_core1Stack[PIPELINE_CORE1_STACK_WORDS] __attribute__((aligned(8)));
+uint32_t* pipeline_core1StackTop __asm__("pipeline_core1StackTop") = &pipeline_core1Stack[PIPELINE_CORE1_STACK_WORDS];
+
+// Core 0's MMU setup, copied into core 1 so both cores see memory the same way (shareable, cached).
+static uint32_t pipeline_core0Ttbr0;
+static uint32_t pipeline_core0Dacr;
+static uint32_t pipeline_core0Sctlr;
+
+void pipeline_core1Main() __asm__("pipeline_core1Main");
+void pipeline_core1Entry() __asm__("pipeline_core1Entry");
+
+// Core 1 starts here with no stack: set one up and continue in C.
+__asm__(
+    "    .text\n"
+    "    .arm\n"
+    "    .align 2\n"
+    "    .type pipeline_core1Entry, %function\n"
+    "pipeline_core1Entry:\n"
+    "    ldr r0, =pipeline_core1StackTop\n"
+    "    ldr sp, [r0]\n"
+    "    b pipeline_core1Main\n"
+    "    .ltorg\n");
+
+/*********************************************************************************************************/
+/* Function: pipeline_core1Main                                                                          */
+/* Purpose: Core 1 C entry: joins the coherency domain, turns on the MMU and caches with core 0's        */
+/*          translation table, then runs stage 2 forever.                                                */
+/* Returns: Never.                                                                                       */
+/*********************************************************************************************************/
+void pipeline_core1Main()
+{
+    uint32_t actlr;
+    __asm__ volatile("mrc p15, 0, %0, c1, c0, 1" : "=r"(actlr));
+    __asm__ volatile("mcr p15, 0, %0, c1, c0, 1" : : "r"(actlr | PIPELINE_ACTLR_SMP_FW));
+    Xil_L1ICacheInvalidate();
+    Xil_L1DCacheInvalidate();
+    __asm__ volatile("mcr p15, 0, %0, c8, c7, 0" : : "r"(0));                    // Invalidate the TLBs.
+    __asm__ volatile("mcr p15, 0, %0, c2, c0, 0" : : "r"(pipeline_core0Ttbr0));
+    __asm__ volatile("mcr p15, 0, %0, c3, c0, 0" : : "r"(pipeline_core0Dacr));
+    __asm__ volatile("dsb\n isb");
+    __asm__ volatile("mcr p15, 0, %0, c1, c0, 0" : : "r"(pipeline_core0Sctlr));
+    __asm__ volatile("isb");
+    while (true)
+    {
+        pipeline_stage2Poll();
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: pipeline_startSecondCore                                                                    */
+/* Purpose: Hands core 1 the stage-2 entry point and wakes it up. Later calls do nothing.                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_startSecondCore()
+{
+    static bool started = false;
+    // Core 1 never returns from stage 2, so only start it once.
+    if (started)
+    {
+        return;
+    }
+    started = true;
+    __asm__ volatile("mrc p15, 0, %0, c2, c0, 0" : "=r"(pipeline_core0Ttbr0));
+    __asm__ volatile("mrc p15, 0, %0, c3, c0, 0" : "=r"(pipeline_core0Dacr));
+    __asm__ volatile("mrc p15, 0, %0, c1, c0, 0" : "=r"(pipeline_core0Sctlr));
+    Xil_Out32(PIPELINE_CPU1_START_ADDRESS, (uint32_t) pipeline_core1Entry);
+    // Core 1 starts with its caches off, so everything it reads first must be in memory.
+    Xil_DCacheFlush();
+    __asm__ volatile("dsb\n sev");
+}
+#else
+/*********************************************************************************************************/
+/* Function: pipeline_startSecondCore                                                                    */
+/* Purpose: Nothing to start on a host; run pipeline_stage2Poll() from a thread instead.                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void pipeline_startSecondCore()
+{
+}
+#endif
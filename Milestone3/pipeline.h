@@ -0,0 +1,62 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "detector.h"
+#include "spscRing.h"
+
+// Two-stage pipelined detector that splits detector() across the two Cortex-A9 cores.
+//
+// Stage 1 (core 0, main loop): drains the ADC buffer, feeds the decimating FIR filter of the
+// built-in filter instance and pushes every FIR output into a single-producer/single-consumer ring.
+// Stage 2 (core 1): pops FIR outputs and runs the IIR bank, the power computation and hit
+// detection on a detector instance with its own filter. Each hit goes back to core 0 through a
+// second ring; core 0 starts the lockout and hit-LED timers, so no I/O happens on core 1.
+//
+// The same code runs on a Linux/PC host with one thread per stage (see host/pipelineMain.c).
+//
+// Uncomment the line below (or build with -DPIPELINE_ENABLED) to make the running modes use the
+// pipeline instead of detector(). Core 1 must not be running anything else.
+//#define PIPELINE_ENABLED
+
+// Sets up both stages. With useHardwareTimers, core 0 starts the lockout and hit-LED timers for each
+// hit like detector() does (in pipeline_stage1() and pipeline_hitDetected()) and stage 2 stays locked
+// out from the hit until the lockout timer ends; otherwise stage 2 counts the lockout in samples.
+// Call after filter_init() and before either stage runs.
+void pipeline_init(bool useHardwareTimers);
+
+// Stage 1: drains the ADC buffer (see detector() for interruptsEnabled) and takes the hits stage 2
+// handed back.
+void pipeline_stage1(bool interruptsEnabled);
+
+// Stage 1: runs one raw sample. Waits while the ring is full.
+void pipeline_stage1AddSample(uint16_t rawAdcValue);
+
+// Stage 2: processes every FIR output waiting in the ring. Returns how many were processed.
+uint32_t pipeline_stage2Poll();
+
+// Board only: starts core 1 running stage 2 forever (only the first call does anything).
+// Does nothing on a host.
+void pipeline_startSecondCore();
+
+// Core 0: takes the hits stage 2 handed back and returns true if any has not been cleared.
+bool pipeline_hitDetected();
+
+// Clears the detected hit(s) once they have been accounted for.
+void pipeline_clearHit();
+
+// Copies the stage-2 hit counts.
+void pipeline_getHitCounts(detector_hitCount_t hitArray[]);
+
+// Copies the stage-2 power values (for the histogram).
+void pipeline_getCurrentPowerValues(double powerValues[]);
+
+// Returns the detector instance run by stage 2 (for inspection once both stages are idle).
+detector_ctx_t* pipeline_getStage2Detector();
+
+// Prints the statistics of both rings (stage stalls and cross-core index re-reads).
+void pipeline_dump(FILE* out);
+
+#endif /* PIPELINE_H_ */
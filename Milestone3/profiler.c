@@ -0,0 +1,163 @@
+/*********************************************************************************************************/
+/* File: profiler.c                                                                                      */
+/* Purpose: Per-stage cycle counts aggregated into log2 histograms (see profiler.h).                     */
+/*********************************************************************************************************/
+#include "profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <string.h>
+
+#define PROFILER_DUMP_PERCENTILE 0.99
+#define PROFILER_HIGHEST_BIT 31
+
+static const char* profiler_stageNames[PROFILER_STAGE_COUNT] = {
+    "adc_drain", "fir", "iir_bank", "power", "hit_detection",
+    "timerWheel_tick"
+};
+
+static volatile profiler_stats_t profiler_stats[PROFILER_STAGE_COUNT];
+
+/*********************************************************************************************************/
+/* Function: profiler_init                                                                               */
+/* Purpose: Starts the cycle counter and clears the statistics.                                          */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void profiler_init()
+{
+    cycleCounter_init();
+    profiler_reset();
+}
+
+/*********************************************************************************************************/
+/* Function: profiler_reset                                                                              */
+/* Purpose: Clears the statistics of every stage.                                                        */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void profiler_reset()
+{
+    for (uint16_t i = 0; i < PROFILER_STAGE_COUNT; i++)
+    {
+        volatile profiler_stats_t* stats = &profiler_stats[i];
+        stats->count = 0;
+        stats->minCycles = UINT32_MAX;
+        stats->maxCycles = 0;
+        stats->totalCycles = 0;
+        for (uint16_t b = 0; b < PROFILER_BUCKET_COUNT; b++)
+        {
+            stats->buckets[b] = 0;
+        }
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: profiler_record                                                                             */
+/* Purpose: Adds one duration to a stage's statistics. The bucket is the index of the highest set bit.   */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void profiler_record(profiler_stage_t stage, profiler_cycles_t cycles)
+{
+    volatile profiler_stats_t* stats = &profiler_stats[stage];
+    stats->count++;
+    stats->totalCycles += cycles;
+    if (cycles < stats->minCycles)
+    {
+        stats->minCycles = cycles;
+    }
+    if (cycles > stats->maxCycles)
+    {
+        stats->maxCycles = cycles;
+    }
+    stats->buckets[PROFILER_HIGHEST_BIT - __builtin_clz(cycles | 1)]++;
+}
+
+/*********************************************************************************************************/
+/* Function: profiler_getStats                                                                           */
+/* Purpose: Copies the statistics of a stage.                                                            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void profiler_getStats(profiler_stage_t stage, profiler_stats_t* stats)
+{
+    memcpy(stats, (const void*) &profiler_stats[stage], sizeof(profiler_stats_t));
+}
+
+/*********************************************************************************************************/
+/* Function: profiler_getPercentile                                                                      */
+/* Purpose: Walks a stage's histogram until the requested fraction of durations is covered.              */
+/* Returns: The top of the bucket reached (clamped to the maximum), or 0 if the stage has no data.       */
+/*********************************************************************************************************/
+profiler_cycles_t profiler_getPercentile(profiler_stage_t stage, double percentile)
+{
+    profiler_stats_t stats;
+    profiler_getStats(stage, &stats);
+    if (stats.count == 0)
+    {
+        return 0;
+    }
+    uint32_t target = (uint32_t) (percentile * stats.count);
+    uint32_t covered = 0;
+    for (uint16_t b = 0; b < PROFILER_BUCKET_COUNT; b++)
+    {
+        covered += stats.buckets[b];
+        if (covered >= target && covered > 0)
+        {
+            uint64_t bucketTop = (2ULL << b) - 1;
+            return (bucketTop < stats.maxCycles) ? (profiler_cycles_t) bucketTop : stats.maxCycles;
+        }
+    }
+    return stats.maxCycles;
+}
+
+/*********************************************************************************************************/
+/* Function: profiler_getCyclesPerMicrosecond                                                            */
+/* Purpose: Returns the rate of the cycle counter.                                                       */
+/* Returns: Cycles per microsecond.                                                                      */
+/*********************************************************************************************************/
+double profiler_getCyclesPerMicrosecond()
+{
+    return cycleCounter_getCyclesPerMicrosecond();
+}
+
+/*********************************************************************************************************/
+/* Function: profiler_getStageName                                                                       */
+/* Purpose: Returns the printable name of a stage.                                                       */
+/* Returns: The name.                                                                                    */
+/*********************************************************************************************************/
+const char* profiler_getStageName(profiler_stage_t stage)
+{
+    return profiler_stageNames[stage];
+}
+
+/*********************************************************************************************************/
+/* Function: profiler_dump                                                                               */
+/* Purpose: Prints every stage that has data, followed by its non-empty histogram buckets.               */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void profiler_dump(FILE* out)
+{
+    fprintf(out, "profiler: %.1f cycles/us\n\r", cycleCounter_getCyclesPerMicrosecond());
+    fprintf(out, "%-18s %10s %8s %10s %8s %8s\n\r", "stage", "count", "min", "mean", "p99", "max");
+    for (uint16_t i = 0; i < PROFILER_STAGE_COUNT; i++)
+    {
+        profiler_stats_t stats;
+        profiler_getStats((profiler_stage_t) i, &stats);
+        if (stats.count == 0)
+        {
+            continue;
+        }
+        fprintf(out, "%-18s %10lu %8lu %10.1f %8lu %8lu\n\r", profiler_stageNames[i], (unsigned long) stats.count,
+                (unsigned long) stats.minCycles, (double) stats.totalCycles / stats.count,
+                (unsigned long) profiler_getPercentile((profiler_stage_t) i, PROFILER_DUMP_PERCENTILE),
+                (unsigned long) stats.maxCycles);
+        for (uint16_t b = 0; b < PROFILER_BUCKET_COUNT; b++)
+        {
+            if (stats.buckets[b] != 0)
+            {
+                fprintf(out, "    [%10lu, %10lu] %lu\n\r", (unsigned long) ((b == 0) ? 0 : (1UL << b)),
+                        (unsigned long) ((2ULL << b) - 1), (unsigned long) stats.buckets[b]);
+            }
+        }
+    }
+}
+
+#endif /* PROFILER_ENABLED */
@@ -0,0 +1,84 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include "cycleCounter.h"
+
+// The profiler counts CPU cycles spent in each stage of the detector and the ISR and
+// keeps a log2 histogram per stage. Bucket b counts durations in [2^b, 2^(b+1)) cycles
+// (bucket 0 also counts zero-cycle samples). Cycles come from cycleCounter.h: the
+// Cortex-A9 PMU cycle counter on the board, rdtsc on an x86 host.
+//
+// Uncomment the line below (or build with -DPROFILER_ENABLED) to compile in the
+// instrumentation points. When it is commented out PROFILER_BEGIN/PROFILER_END expand
+// to nothing and the functions below are empty inlines, so there is no run-time cost.
+//#define PROFILER_ENABLED
+
+// Instrumented stages. The first group runs in detector(), the second in isr_function().
+typedef enum {
+    PROFILER_STAGE_ADC_DRAIN,           // Removing one sample from the ADC buffer.
+    PROFILER_STAGE_FIR,                 // One decimating FIR output.
+    PROFILER_STAGE_IIR_BANK,            // All of the IIR filters for one decimated sample.
+    PROFILER_STAGE_POWER,               // All of the power computations for one decimated sample.
+    PROFILER_STAGE_HIT_DETECTION,       // One pass of the hit-detection algorithm.
+    PROFILER_STAGE_TIMER_WHEEL_TICK,    // timerWheel_tick(), including the callbacks it runs.
+    PROFILER_STAGE_COUNT
+} profiler_stage_t;
+
+#define PROFILER_BUCKET_COUNT 32   // One bucket per bit of profiler_cycles_t.
+
+typedef cycleCounter_cycles_t profiler_cycles_t;
+
+// Statistics for one stage.
+typedef struct {
+    uint32_t count;                              // Number of recorded durations.
+    profiler_cycles_t minCycles;                 // Shortest duration.
+    profiler_cycles_t maxCycles;                 // Longest duration.
+    uint64_t totalCycles;                        // Sum of all durations (for the mean).
+    uint32_t buckets[PROFILER_BUCKET_COUNT];     // log2 histogram.
+} profiler_stats_t;
+
+#ifdef PROFILER_ENABLED
+
+// Starts the cycle counter and clears all statistics.
+void profiler_init();
+
+// Clears all statistics.
+void profiler_reset();
+
+// Adds one duration to a stage. Called through PROFILER_END().
+void profiler_record(profiler_stage_t stage, profiler_cycles_t cycles);
+
+// Copies the statistics of a stage.
+void profiler_getStats(profiler_stage_t stage, profiler_stats_t* stats);
+
+// Returns the cycle count below which 'percentile' (0.0 - 1.0) of a stage's durations fall,
+// resolved to the top of the histogram bucket and clamped to the maximum.
+profiler_cycles_t profiler_getPercentile(profiler_stage_t stage, double percentile);
+
+// Returns the number of cycles per microsecond of cycleCounter_read().
+double profiler_getCyclesPerMicrosecond();
+
+// Returns the printable name of a stage.
+const char* profiler_getStageName(profiler_stage_t stage);
+
+// Prints every stage that has data: count, min, mean, p99, max and the non-empty buckets.
+// Use stdout to dump over the UART on the board, or an open file on the host.
+void profiler_dump(FILE* out);
+
+// Place around the code to be measured. Both must be in the same scope.
+#define PROFILER_BEGIN(stage) profiler_cycles_t profiler_start_##stage = cycleCounter_read()
+#define PROFILER_END(stage) profiler_record(stage, cycleCounter_read() - profiler_start_##stage)
+
+#else
+
+static inline void profiler_init() {}
+static inline void profiler_reset() {}
+static inline void profiler_dump(FILE*) {}
+#define PROFILER_BEGIN(stage)
+#define PROFILER_END(stage)
+
+#endif /* PROFILER_ENABLED */
+
+#endif /* PROFILER_H_ */
@@ -26,6 +26,17 @@
 #include "trigger.h"
 #include "lockoutTimer.h"
 #include "hitLedTimer.h"
+#include "profiler.h"
+#include "isrMonitor.h"
+#include "eventJournal.h"
+#include "telemetry.h"
+#include "pipeline.h"
+#include "scheduler.h"
+#include "displayThrottle.h"
+#include "deferredLog.h"
+#ifdef HISTOGRAM_COMPOSITOR_ENABLED
+#include "compositor.h"
+#endif
 #include <stdint.h>
 #include "supportFiles/utils.h"
 
@@ -37,7 +48,15 @@
 #define TOTAL_RUNTIME_TIMER INTERVAL_TIMER_TIMER_1   // Used to compute total run-time.
 #define MAIN_CUMULATIVE_TIMER INTERVAL_TIMER_TIMER_2 // Used to compute cumulative run-time in main.
 
-#define SYSTEM_TICKS_PER_HISTOGRAM_UPDATE 30000 // Update the histogram about 3 times per second.
+#define SYSTEM_TICKS_PER_HISTOGRAM_UPDATE 30000 // ISR ticks between histogram updates (about 3 times per second).
+
+// Main-loop tasks, in priority order (see scheduler.h). The detector and the inputs run on every
+// pass; display work is drawn a bar per slice and stops whenever the ADC buffer backs up.
+#define RUNNING_MODES_DETECTOR_PRIORITY 0
+#define RUNNING_MODES_INPUT_PRIORITY 1
+#define RUNNING_MODES_DISPLAY_PRIORITY 2
+#define RUNNING_MODES_DISPLAY_BUDGET_US 2000.0  // Display time per pass before the detector runs again.
+#define RUNNING_MODES_LOG_PRIORITY 3
 
 // The detector should run, on average, 2 times for each sample to keep up with the
 // incoming samples. Strictly speaking, this should be 1.0, but 1.0, on average,
@@ -51,6 +70,7 @@
 #define RUNNING_MODE_NORMAL_TEXT_COLOR DISPLAY_WHITE // White for reporting.
 #define RUNNING_MODE_SCREEN_X_ORIGIN 0  // Origin for reporting text.
 #define RUNNING_MODE_SCREEN_Y_ORIGIN 0  // Origin for reporting text.
+#define RUNNING_MODE_REPORT_P99 0.99    // Percentile shown in the ISR latency report.
 
 /*****************************************************************************
  * Uncomment the line below if you want the detector to avoid the frequency
@@ -58,6 +78,48 @@
  *****************************************************************************/
 //#define IGNORE_OWN_FREQUENCY
 
+// With PIPELINE_ENABLED (see pipeline.h) the modes below only run the first half of the
+// detector here; the second half runs on core 1. These wrappers pick the right calls.
+static void runningModes_runDetector(bool ignoreSelf) {
+#ifdef PIPELINE_ENABLED
+    pipeline_stage1(true);              // Interrupts are enabled; core 1 does the rest.
+#else
+    detector(true, ignoreSelf);         // Interrupts are enabled.
+#endif
+}
+
+static bool runningModes_hitDetected() {
+#ifdef PIPELINE_ENABLED
+    return pipeline_hitDetected();
+#else
+    return detector_hitDetected();
+#endif
+}
+
+static void runningModes_clearHit() {
+#ifdef PIPELINE_ENABLED
+    pipeline_clearHit();
+#else
+    detector_clearHit();
+#endif
+}
+
+static void runningModes_getHitCounts(detector_hitCount_t hitCounts[]) {
+#ifdef PIPELINE_ENABLED
+    pipeline_getHitCounts(hitCounts);
+#else
+    detector_getHitCounts(hitCounts);
+#endif
+}
+
+static void runningModes_getCurrentPowerValues(double powerValues[]) {
+#ifdef PIPELINE_ENABLED
+    pipeline_getCurrentPowerValues(powerValues);
+#else
+    filter_getCurrentPowerValues(powerValues);
+#endif
+}
+
 static uint32_t countInterruptsViaInterruptsIsrFlag = 0;  // Keep track of interrupts.
 static uint32_t detectorInvocationCount = 0;  // Keep track of detector invocations.
 
@@ -130,6 +192,13 @@ void runningModes_initAll() {
     lockoutTimer_init();
     hitLedTimer_init();
     trigger_init();
+    profiler_init();
+    eventJournal_init();
+    telemetry_init();
+#ifdef PIPELINE_ENABLED
+    pipeline_init(true);        // Stage 2 uses the lockout and hit-LED timers like detector().
+    pipeline_startSecondCore(); // Core 1 polls the pipeline from now on.
+#endif
 }
 
 // Returns the current switch-setting
@@ -142,6 +211,111 @@ uint16_t runningModes_getFrequencySetting() {
         return switchSetting;
 }
 
+static uint16_t runningModes_histogramBar = 0;          // Next bar to draw in a sliced histogram update.
+static uint16_t runningModes_hitCount = 0;              // Shots seen in shooter mode.
+static scheduler_taskId_t runningModes_hitPlotTaskId;   // Woken by a hit in shooter mode.
+
+// Continuous mode: runs the detector over whatever the ISR has queued.
+static bool runningModes_continuousDetectorTask(void* user) {
+    detectorInvocationCount++; // Used for run-time statistics.
+    displayThrottle_noteBacklog(isr_adcBufferElementCount()); // How far behind the detector is.
+    // Run filters, compute power, etc.
+    intervalTimer_start(MAIN_CUMULATIVE_TIMER); // Measure run-time when you are doing something.
+#ifdef IGNORE_OWN_FREQUENCY
+    runningModes_runDetector(true);   // true means ignore your set frequency.
+#else
+    runningModes_runDetector(false);  // false means don't ignore your set frequency.
+#endif
+    telemetry_service();              // Stream queued power frames (if TELEMETRY_ENABLED).
+    intervalTimer_stop(MAIN_CUMULATIVE_TIMER);
+    return false;
+}
+
+// Shooter mode: runs the detector after each interrupt and counts hits.
+static bool runningModes_shooterDetectorTask(void* user) {
+    if (!interrupts_isrFlagGlobal)   // Only do something if an interrupt has occurred.
+        return false;
+    intervalTimer_start(MAIN_CUMULATIVE_TIMER);  // Measure run-time when you are doing something.
+    countInterruptsViaInterruptsIsrFlag++;    // Keep track of the interrupt-count based on the global flag.
+    interrupts_isrFlagGlobal = 0;     // Reset the global flag.
+    // Run filters, compute power, run hit-detection.
+    detectorInvocationCount++; // Used for run-time statistics.
+    runningModes_runDetector(false);    // false means: do not ignore your set frequency.
+    telemetry_service();                // Stream queued power frames (if TELEMETRY_ENABLED).
+    //  runningModes_runDetector(true); // true means: ignore hits on your set frequency.
+    if (runningModes_hitDetected()) {  // Hit detected
+        runningModes_hitCount++;  // increment the hit count.
+        runningModes_clearHit();  // Clear the hit.
+        scheduler_wake(runningModes_hitPlotTaskId);  // Plot it when the display gets its turn.
+    }
+    intervalTimer_stop(MAIN_CUMULATIVE_TIMER);  // All done with actual processing.
+    return false;
+}
+
+// Reads the switches and the trigger button.
+static bool runningModes_inputTask(void* user) {
+    transmitter_setFrequencyNumber(runningModes_getFrequencySetting());
+    trigger_pollButtons();           // btn0 as a trigger (if TRIGGER_EDGE_INTERRUPTS_ENABLED).
+    return false;
+}
+
+// Draws the received power one bar per slice, taking a fresh copy of the power values first.
+static bool runningModes_powerPlotTask(void* user) {
+    if (runningModes_histogramBar == 0) {
+        double powerValues[FILTER_FREQUENCY_COUNT];      // Copy the current power values to here.
+        runningModes_getCurrentPowerValues(powerValues); // Copy the current power values.
+        histogram_setUserFrequencyPower(powerValues);
+    }
+    histogram_updateDisplayBar(runningModes_histogramBar++); // Plot the power values on the TFT.
+    if (runningModes_histogramBar < histogram_getBarCount())
+        return true;
+    runningModes_histogramBar = 0;
+    eventJournal_flush();            // Write out the journaled events (if EVENT_JOURNAL_ENABLED).
+    return false;
+}
+
+// Draws the hit counts one bar per slice.
+static bool runningModes_hitPlotTask(void* user) {
+    if (runningModes_histogramBar == 0) {
+        detector_hitCount_t hitCounts[DETECTOR_HIT_ARRAY_SIZE]; // Store the hit-counts here.
+        runningModes_getHitCounts(hitCounts);  // Get the current hit counts.
+        histogram_setUserHits(hitCounts);
+    }
+    histogram_updateDisplayBar(runningModes_histogramBar++); // Plot the hit counts on the TFT.
+    if (runningModes_histogramBar < histogram_getBarCount())
+        return true;
+    runningModes_histogramBar = 0;
+    eventJournal_flush();            // Write out the hit (if EVENT_JOURNAL_ENABLED).
+    return false;
+}
+
+// With the histogram drawn through the compositor, its flushes only queue the changed pixels and
+// this task sends them a chunk per slice, so the detector never waits on the TFT for more than a chunk.
+static void runningModes_addDisplayFlushTask() {
+#ifdef HISTOGRAM_COMPOSITOR_ENABLED
+    scheduler_addTask("tft_flush", compositor_task, NULL, RUNNING_MODES_DISPLAY_PRIORITY,
+                      SCHEDULER_EVERY_PASS, RUNNING_MODES_DISPLAY_BUDGET_US, true);
+    compositor_setAsync(true);
+#endif
+}
+
+// Prints what the transmitter and trigger logged (see TRANSMITTER_LOG_ENABLED and TRIGGER_LOG_ENABLED) a
+// batch per slice, once the display work is done.
+static void runningModes_addLogTask() {
+#ifdef DEFERRED_LOG_ENABLED
+    scheduler_addTask("log", deferredLog_task, NULL, RUNNING_MODES_LOG_PRIORITY,
+                      SCHEDULER_EVERY_PASS, RUNNING_MODES_DISPLAY_BUDGET_US, true);
+#endif
+}
+
+// Sends what is left of the last frame before the statistics are drawn over it.
+static void runningModes_finishDisplayFlush() {
+#ifdef HISTOGRAM_COMPOSITOR_ENABLED
+    compositor_setAsync(false);
+    compositor_dump(stdout);                // TFT transfer statistics over the UART.
+#endif
+}
+
 // This mode runs continuously until btn3 is pressed.
 // When btn3 is pressed, it exits and prints performance information to the TFT.
 // During operation, it continuously displays that received power on each channel, on the TFT.
@@ -151,7 +325,19 @@ void runningModes_continuous() {
     interrupts_initAll(true);                   // Init all interrupts (but does not enable the interrupts at the devices).
     interrupts_enableTimerGlobalInts();             // Allows the timer to generate interrupts.
     interrupts_startArmPrivateTimer();              // Start the private ARM timer running.
-    uint16_t histogramSystemTicks = 0;          // Only update the histogram display every so many ticks.
+    scheduler_init();
+    scheduler_addTask("detector", runningModes_continuousDetectorTask, NULL, RUNNING_MODES_DETECTOR_PRIORITY,
+                      SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, false);
+    scheduler_addTask("input", runningModes_inputTask, NULL, RUNNING_MODES_INPUT_PRIORITY,
+                      SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, false);
+    scheduler_taskId_t powerPlotTask = scheduler_addTask("power_plot", runningModes_powerPlotTask, NULL,
+                      RUNNING_MODES_DISPLAY_PRIORITY, SYSTEM_TICKS_PER_HISTOGRAM_UPDATE, RUNNING_MODES_DISPLAY_BUDGET_US, true);
+    scheduler_addTask("throttle", displayThrottle_task, NULL, RUNNING_MODES_INPUT_PRIORITY,
+                      DISPLAY_THROTTLE_WINDOW_TICKS, SCHEDULER_NO_BUDGET, false);
+    displayThrottle_init(powerPlotTask, SYSTEM_TICKS_PER_HISTOGRAM_UPDATE); // Sheds histogram work when the detector falls behind.
+    runningModes_addDisplayFlushTask();         // Sends the histogram to the TFT in chunks.
+    runningModes_addLogTask();
+    runningModes_histogramBar = 0;
     intervalTimer_reset(ISR_CUMULATIVE_TIMER);  // Used to measure ISR execution time.
     intervalTimer_reset(TOTAL_RUNTIME_TIMER);   // Used to measure total program execution time.
     intervalTimer_reset(MAIN_CUMULATIVE_TIMER); // Used to measure main-loop execution time.
@@ -161,70 +347,114 @@ void runningModes_continuous() {
     transmitter_run();                          // Start the transmitter.
     detectorInvocationCount = 0;                // Keep track of detector invocations.
     while (!(buttons_read() & BUTTONS_BTN3_MASK)) {   // Run until you detect btn3 pressed.
-        transmitter_setFrequencyNumber(runningModes_getFrequencySetting());
-        detectorInvocationCount++; // Used for run-time statistics.
-        histogramSystemTicks++;    // Keep track of ticks so you know when to update the histogram.
-        // Run filters, compute power, etc.
-        intervalTimer_start(MAIN_CUMULATIVE_TIMER); // Measure run-time when you are doing something.
-#ifdef IGNORE_OWN_FREQUENCY
-        detector(true, true);   // true, true means interrupts are enabled, ignore your set frequency.
-#else
-        detector(true, false);  // true, false means interrupts are enabled, don't ignore your set frequency.
-#endif
-        intervalTimer_stop(MAIN_CUMULATIVE_TIMER);
-        // If enough ticks have transpired, update the histogram.
-        if (histogramSystemTicks >= SYSTEM_TICKS_PER_HISTOGRAM_UPDATE) {
-            double powerValues[FILTER_FREQUENCY_COUNT];    // Copy the current power values to here.
-            filter_getCurrentPowerValues(powerValues);     // Copy the current power values.
-            histogram_plotUserFrequencyPower(powerValues); // Plot the power values on the TFT.
-            histogramSystemTicks = 0;                        // Reset the tick count and wait for the next update time.
-        }
+        scheduler_runPass();
     }
     interrupts_disableArmInts();            // Stop interrupts.
+    runningModes_finishDisplayFlush();      // Send the rest of the last histogram frame.
+    eventJournal_flush();                   // Write out the last journaled events.
+    deferredLog_drain(stdout, DEFERRED_LOG_DRAIN_ALL);  // And the rest of the log (if DEFERRED_LOG_ENABLED).
     runningModes_printRunTimeStatistics();  // Print the run-time statistics.
+    scheduler_dump(stdout);                 // Main-loop task statistics over the UART.
+    displayThrottle_dump(stdout);           // Display throttling decisions.
+    profiler_dump(stdout);                  // Per-stage cycle counts over the UART (if PROFILER_ENABLED).
+    telemetry_dump(stdout);                 // Telemetry link statistics (if TELEMETRY_ENABLED).
+#ifdef PIPELINE_ENABLED
+    pipeline_dump(stdout);                  // Ring statistics between the two cores.
+#endif
 }
 
 // Game-playing mode. Each shot is registered on the histogram on the TFT.
 #define MAX_HIT_COUNT 20  // Shooter mode terminates after this many shots.
 void runningModes_shooter() {
-    uint16_t hitCount = 0;
+    runningModes_hitCount = 0;
     detectorInvocationCount = 0;                // Keep track of detector invocations.
     runningModes_initAll();
     trigger_enable(); // Makes the trigger state machine responsive to the trigger.
     interrupts_initAll(true);             // Inits all interrupts but does not enable them.
     interrupts_enableTimerGlobalInts();       // Allows the timer to generate interrupts.
     interrupts_startArmPrivateTimer();        // Start the private ARM timer running.
-    uint16_t histogramSystemTicks = 0;        // Only update the histogram display every so many ticks.
+    scheduler_init();
+    scheduler_addTask("detector", runningModes_shooterDetectorTask, NULL, RUNNING_MODES_DETECTOR_PRIORITY,
+                      SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, false);
+    scheduler_addTask("input", runningModes_inputTask, NULL, RUNNING_MODES_INPUT_PRIORITY,
+                      SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, false);
+    runningModes_hitPlotTaskId = scheduler_addTask("hit_plot", runningModes_hitPlotTask, NULL, RUNNING_MODES_DISPLAY_PRIORITY,
+                                                   SCHEDULER_ONLY_WHEN_WOKEN, RUNNING_MODES_DISPLAY_BUDGET_US, true);
+    runningModes_addDisplayFlushTask();         // Sends the histogram to the TFT in chunks.
+    runningModes_addLogTask();
+    runningModes_histogramBar = 0;
     intervalTimer_reset(ISR_CUMULATIVE_TIMER);  // Used to measure ISR execution time.
     intervalTimer_reset(TOTAL_RUNTIME_TIMER);   // Used to measure total program execution time.
     intervalTimer_reset(MAIN_CUMULATIVE_TIMER); // Used to measure main-loop execution time.
     intervalTimer_start(TOTAL_RUNTIME_TIMER);   // Start measuring total execution time.
     interrupts_enableArmInts();       // The ARM will start seeing interrupts after this.
     lockoutTimer_start();                 // Ignore erroneous hits at startup (when all power values are essentially 0).
-    while ((!(buttons_read() & BUTTONS_BTN3_MASK)) && hitCount < MAX_HIT_COUNT) { // Run until you detect btn3 pressed.
-        if (interrupts_isrFlagGlobal) {  // Only do something if an interrupt has occurred.
-            intervalTimer_start(MAIN_CUMULATIVE_TIMER);  // Measure run-time when you are doing something.
-            histogramSystemTicks++;   // Keep track of ticks so you know when to update the histogram.
-            countInterruptsViaInterruptsIsrFlag++;    // Keep track of the interrupt-count based on the global flag.
-            interrupts_isrFlagGlobal = 0;     // Reset the global flag.
-            // Run filters, compute power, run hit-detection.
-            detectorInvocationCount++; // Used for run-time statistics.
-            detector(true, false);    // true, false means: interrupts are enabled, do not ignore your set frequency.
-            //  detector(true, true); // true, true means: interrupts are enabled, ignore hits on your set frequency.
-            if (detector_hitDetected()) {  // Hit detected
-                hitCount++;  // increment the hit count.
-                detector_clearHit();  // Clear the hit.
-                detector_hitCount_t hitCounts[DETECTOR_HIT_ARRAY_SIZE]; // Store the hit-counts here.
-                detector_getHitCounts(hitCounts);  // Get the current hit counts.
-                histogram_plotUserHits(hitCounts); // Plot the hit counts on the TFT.
-            }
-            uint16_t switchValue = switches_read();   // Read the switches and switch frequency as required.
-            transmitter_setFrequencyNumber(switchValue);
-        }
-        intervalTimer_stop(MAIN_CUMULATIVE_TIMER);  // All done with actual processing.
+    while ((!(buttons_read() & BUTTONS_BTN3_MASK)) && runningModes_hitCount < MAX_HIT_COUNT) { // Run until you detect btn3 pressed.
+        scheduler_runPass();
     }
     interrupts_disableArmInts();  // Done with loop, disable the interrupts.
     hitLedTimer_turnLedOff();     // Save power :-)
+    runningModes_finishDisplayFlush();  // Send the rest of the last histogram frame.
+    eventJournal_flush();         // Write out the last journaled events.
+    deferredLog_drain(stdout, DEFERRED_LOG_DRAIN_ALL);  // And the rest of the log (if DEFERRED_LOG_ENABLED).
     runningModes_printRunTimeStatistics();  // Print the run-time statistics to the TFT.
-    printf("Shooter mode terminated after detecting %d shots.\n\r", hitCount);
+    scheduler_dump(stdout);                 // Main-loop task statistics over the UART.
+    profiler_dump(stdout);                  // Per-stage cycle counts over the UART (if PROFILER_ENABLED).
+    telemetry_dump(stdout);                 // Telemetry link statistics (if TELEMETRY_ENABLED).
+#ifdef PIPELINE_ENABLED
+    pipeline_dump(stdout);                  // Ring statistics between the two cores.
+#endif
+    printf("Shooter mode terminated after detecting %d shots.\n\r", runningModes_hitCount);
+}
+
+// ISR latency measurement mode. Same load as continuous mode plus a live trigger, with the
+// ISR monitor timing every tick. Reports on the TFT and the UART when btn3 is pressed.
+bool runningModes_isrLatency(double budgetMicroseconds) {
+#ifndef ISR_MONITOR_ENABLED
+    printf("runningModes_isrLatency: uncomment ISR_MONITOR_ENABLED in isrMonitor.h to use this mode.\n\r");
+    return false;
+#else
+    runningModes_initAll();  // All necessary inits are called here.
+    isrMonitor_init();
+    isrMonitor_setBudgetMicroseconds(budgetMicroseconds);
+    trigger_enable();                           // Full load: the trigger state machine is live too.
+    interrupts_initAll(true);                   // Init all interrupts (but does not enable the interrupts at the devices).
+    interrupts_enableTimerGlobalInts();         // Allows the timer to generate interrupts.
+    interrupts_startArmPrivateTimer();          // Start the private ARM timer running.
+    uint16_t histogramSystemTicks = 0;          // Only update the histogram display every so many ticks.
+    transmitter_setContinuousMode(true);        // Run the transmitter continuously.
+    interrupts_enableArmInts();                 // The ARM will start seeing interrupts after this.
+    transmitter_run();                          // Start the transmitter.
+    while (!(buttons_read() & BUTTONS_BTN3_MASK)) {   // Run until you detect btn3 pressed.
+        trigger_pollButtons();                        // btn0 as a trigger (if TRIGGER_EDGE_INTERRUPTS_ENABLED).
+        transmitter_setFrequencyNumber(runningModes_getFrequencySetting());
+        histogramSystemTicks++;
+        detector(true, false);  // Interrupts are enabled, don't ignore your set frequency.
+        if (histogramSystemTicks >= SYSTEM_TICKS_PER_HISTOGRAM_UPDATE) {
+            double powerValues[FILTER_FREQUENCY_COUNT];    // Copy the current power values to here.
+            filter_getCurrentPowerValues(powerValues);     // Copy the current power values.
+            histogram_plotUserFrequencyPower(powerValues); // Plot the power values on the TFT.
+            histogramSystemTicks = 0;
+        }
+    }
+    interrupts_disableArmInts();            // Stop interrupts.
+    isrMonitor_dump(stdout);                // Full report over the UART.
+    // Summary on the TFT.
+    display_fillScreen(DISPLAY_BLACK);
+    display_setCursor(RUNNING_MODE_SCREEN_X_ORIGIN, RUNNING_MODE_SCREEN_Y_ORIGIN);
+    display_setTextSize(RUNNING_MODE_NORMAL_TEXT_SIZE);
+    display_setTextColor(RUNNING_MODE_NORMAL_TEXT_COLOR);
+    display_print("ISR ticks measured: "); display_println(isrMonitor_getTickCount()); display_println();
+    display_print("ISR p99 (us): "); display_println(isrMonitor_getDurationPercentileMicroseconds(RUNNING_MODE_REPORT_P99)); display_println();
+    display_print("ISR max (us): "); display_println(isrMonitor_getMaxDurationMicroseconds()); display_println();
+    display_print("Jitter p99 (us): "); display_println(isrMonitor_getJitterPercentileMicroseconds(RUNNING_MODE_REPORT_P99)); display_println();
+    display_print("Jitter max (us): "); display_println(isrMonitor_getMaxJitterMicroseconds()); display_println();
+    bool withinBudget = (isrMonitor_getOverrunCount() == 0);
+    if (!withinBudget) {
+        display_setTextColor(RUNNING_MODE_WARNING_TEXT_COLOR);
+        display_print("Overruns: "); display_println(isrMonitor_getOverrunCount());
+        display_println("(see UART for the sub-tick breakdown)");
+    }
+    return withinBudget;
+#endif
 }
@@ -2,6 +2,7 @@
     #define RUNNINGMODES_H_
 
     #include <stdint.h>
+    #include <stdbool.h>
 
     // This mode runs continously until btn3 is pressed.
     // When btn3 is pressed, it exits and prints performance information to the TFT.
@@ -16,6 +17,13 @@
     // Frequency is selected via the slide-switches.
     void runningModes_shooter();
 
+    // ISR latency measurement mode (requires ISR_MONITOR_ENABLED, see isrMonitor.h).
+    // Runs the same full load as continuous mode, with the trigger enabled, until btn3 is pressed.
+    // Every tick, isr_function() is timed on entry, after each sub-tick, and on exit.
+    // When btn3 is pressed, the ISR duration, jitter and overrun report goes to the TFT and the UART.
+    // Returns true if no tick exceeded the budget.
+    bool runningModes_isrLatency(double budgetMicroseconds);
+
     // Continuously cycles through all channels, shooting one pulse per channel.
     void runningModes_testShootAllChannels();
 
@@ -0,0 +1,249 @@
+/*********************************************************************************************************/
+/* File: scheduler.c                                                                                     */
+/* Purpose: Prioritized, budgeted cooperative tasks for the main loop (see scheduler.h).                 */
+/*********************************************************************************************************/
+#include "scheduler.h"
+#include "cycleCounter.h"
+#include "timerWheel.h"
+#include "isr.h"
+
+#define SCHEDULER_NO_BUDGET_CYCLES 0
+
+// One task and its bookkeeping.
+typedef struct {
+    const char* name;
+    scheduler_task_t task;
+    void* user;
+    uint8_t priority;
+    uint32_t periodTicks;
+    uint32_t budgetCycles;         // SCHEDULER_NO_BUDGET_CYCLES: no limit.
+    bool yieldsToBacklog;
+    bool pending;                  // Stopped early: resume on the next pass.
+    bool woken;                    // Due on the next pass regardless of the period.
+    uint32_t nextDueTick;
+    uint32_t runCycles;            // Time the current run has taken so far, over all its passes.
+    scheduler_stats_t stats;
+} scheduler_entry_t;
+
+static scheduler_entry_t scheduler_tasks[SCHEDULER_MAX_TASKS];
+static uint8_t scheduler_order[SCHEDULER_MAX_TASKS];   // Task ids, highest priority first.
+static uint8_t scheduler_taskCount = 0;
+static uint32_t scheduler_backlogWatermark = SCHEDULER_DEFAULT_BACKLOG_WATERMARK;
+
+/*********************************************************************************************************/
+/* Function: scheduler_init                                                                              */
+/* Purpose: Starts the cycle counter, removes all tasks and restores the default watermark.              */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void scheduler_init()
+{
+    cycleCounter_init();
+    scheduler_taskCount = 0;
+    scheduler_backlogWatermark = SCHEDULER_DEFAULT_BACKLOG_WATERMARK;
+}
+
+/*********************************************************************************************************/
+/* Function: scheduler_addTask                                                                           */
+/* Purpose: Adds a task to the table and inserts it in the run order behind the tasks of the same or     */
+/*          higher priority. It is due on the next pass.                                                 */
+/* Returns: The id of the task, or SCHEDULER_INVALID_TASK if the table is full.                          */
+/*********************************************************************************************************/
+scheduler_taskId_t scheduler_addTask(const char* name, scheduler_task_t task, void* user, uint8_t priority,
+                                     uint32_t periodTicks, double budgetMicroseconds, bool yieldsToBacklog)
+{
+    if (scheduler_taskCount >= SCHEDULER_MAX_TASKS)
+    {
+        printf("scheduler_addTask: no room for task %s.\n\r", name);
+        return SCHEDULER_INVALID_TASK;
+    }
+    scheduler_taskId_t id = scheduler_taskCount++;
+    scheduler_entry_t* entry = &scheduler_tasks[id];
+    entry->name = name;
+    entry->task = task;
+    entry->user = user;
+    entry->priority = priority;
+    entry->periodTicks = periodTicks;
+    entry->budgetCycles = (uint32_t) (budgetMicroseconds * cycleCounter_getCyclesPerMicrosecond());
+    entry->yieldsToBacklog = yieldsToBacklog;
+    entry->pending = false;
+    entry->runCycles = 0;
+    entry->woken = (periodTicks != SCHEDULER_ONLY_WHEN_WOKEN);
+    entry->nextDueTick = timerWheel_now();
+    entry->stats = (scheduler_stats_t) {0, 0, 0, 0, 0, 0, 0};
+
+    uint8_t position = id;
+    while (position > 0 && scheduler_tasks[scheduler_order[position - 1]].priority > priority)
+    {
+        scheduler_order[position] = scheduler_order[position - 1];
+        position--;
+    }
+    scheduler_order[position] = id;
+    return id;
+}
+
+/*********************************************************************************************************/
+/* Function: scheduler_wake                                                                              */
+/* Purpose: Makes a task due on the next pass.                                                           */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void scheduler_wake(scheduler_taskId_t id)
+{
+    if (id < scheduler_taskCount)
+    {
+        scheduler_tasks[id].woken = true;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: scheduler_setPeriod                                                                         */
+/* Purpose: Changes the period of a task. A start already scheduled further away than the new period     */
+/*          is brought forward to one period from now.                                                   */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void scheduler_setPeriod(scheduler_taskId_t id, uint32_t periodTicks)
+{
+    if (id >= scheduler_taskCount)
+    {
+        return;
+    }
+    scheduler_entry_t* entry = &scheduler_tasks[id];
+    entry->periodTicks = periodTicks;
+    uint32_t latest = timerWheel_now() + periodTicks;
+    if (periodTicks != SCHEDULER_ONLY_WHEN_WOKEN && (int32_t) (entry->nextDueTick - latest) > 0)
+    {
+        entry->nextDueTick = latest;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: scheduler_setBacklogWatermark                                                               */
+/* Purpose: Sets the ADC backlog above which tasks that yield to the backlog stop.                       */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void scheduler_setBacklogWatermark(uint32_t samples)
+{
+    scheduler_backlogWatermark = samples;
+}
+
+/*********************************************************************************************************/
+/* Function: scheduler_isDue                                                                             */
+/* Purpose: Checks whether a task should run on this pass. A task that starts fresh is next due a period */
+/*          after it was due this time, so the rate does not slip with the time it takes to run.         */
+/* Returns: True if the task should run.                                                                 */
+/*********************************************************************************************************/
+static bool scheduler_isDue(scheduler_entry_t* entry, uint32_t now)
+{
+    if (entry->pending)
+    {
+        return true;
+    }
+    if (entry->woken || entry->periodTicks == SCHEDULER_EVERY_PASS ||
+        (entry->periodTicks != SCHEDULER_ONLY_WHEN_WOKEN && (int32_t) (now - entry->nextDueTick) >= 0))
+    {
+        entry->woken = false;
+        entry->nextDueTick = ((int32_t) (now - entry->nextDueTick - entry->periodTicks) >= 0) ?
+                             now + entry->periodTicks : entry->nextDueTick + entry->periodTicks;
+        entry->stats.runs++;
+        return true;
+    }
+    return false;
+}
+
+/*********************************************************************************************************/
+/* Function: scheduler_runPass                                                                           */
+/* Purpose: Runs each due task in priority order, slice by slice, until it is done or has to yield. A    */
+/*          backlog yield ends the pass.                                                                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void scheduler_runPass()
+{
+    uint32_t now = timerWheel_now();
+    for (uint8_t i = 0; i < scheduler_taskCount; i++)
+    {
+        scheduler_entry_t* entry = &scheduler_tasks[scheduler_order[i]];
+        if (!scheduler_isDue(entry, now))
+        {
+            continue;
+        }
+        if (entry->yieldsToBacklog && isr_adcBufferElementCount() > scheduler_backlogWatermark)
+        {
+            entry->pending = true;
+            entry->stats.backlogYields++;
+            return;
+        }
+        cycleCounter_cycles_t start = cycleCounter_read();
+        cycleCounter_cycles_t elapsed;
+        bool more;
+        bool backlogged = false;
+        do
+        {
+            more = entry->task(entry->user);
+            entry->stats.slices++;
+            elapsed = cycleCounter_read() - start;
+            backlogged = more && entry->yieldsToBacklog && isr_adcBufferElementCount() > scheduler_backlogWatermark;
+        } while (more && !backlogged && (entry->budgetCycles == SCHEDULER_NO_BUDGET_CYCLES || elapsed < entry->budgetCycles));
+
+        entry->stats.totalCycles += elapsed;
+        entry->runCycles += elapsed;
+        entry->pending = more;
+        if (!more)
+        {
+            entry->stats.completions++;
+            if (entry->runCycles > entry->stats.maxCycles)
+            {
+                entry->stats.maxCycles = entry->runCycles;
+            }
+            entry->runCycles = 0;
+        }
+        else if (backlogged)
+        {
+            entry->stats.backlogYields++;
+            return;
+        }
+        else
+        {
+            entry->stats.budgetYields++;
+        }
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: scheduler_getStats                                                                          */
+/* Purpose: Copies the statistics of a task (zeros for an unknown id).                                   */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void scheduler_getStats(scheduler_taskId_t id, scheduler_stats_t* stats)
+{
+    if (id < scheduler_taskCount)
+    {
+        *stats = scheduler_tasks[id].stats;
+    }
+    else
+    {
+        *stats = (scheduler_stats_t) {0, 0, 0, 0, 0, 0, 0};
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: scheduler_dump                                                                              */
+/* Purpose: Prints one line per task, in run order. The times are per run, from the pass it was due on   */
+/*          to the one it finished in.                                                                   */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void scheduler_dump(FILE* out)
+{
+    double cyclesPerMicrosecond = cycleCounter_getCyclesPerMicrosecond();
+    fprintf(out, "scheduler: backlog watermark %lu samples\n\r", (unsigned long) scheduler_backlogWatermark);
+    fprintf(out, "%-12s %3s %9s %9s %10s %8s %8s %10s %10s\n\r", "task", "pri", "runs", "done", "slices",
+            "budget", "backlog", "mean(us)", "max(us)");
+    for (uint8_t i = 0; i < scheduler_taskCount; i++)
+    {
+        scheduler_entry_t* entry = &scheduler_tasks[scheduler_order[i]];
+        scheduler_stats_t* stats = &entry->stats;
+        fprintf(out, "%-12s %3u %9lu %9lu %10lu %8lu %8lu %10.1f %10.1f\n\r", entry->name, entry->priority,
+                (unsigned long) stats->runs, (unsigned long) stats->completions, (unsigned long) stats->slices,
+                (unsigned long) stats->budgetYields, (unsigned long) stats->backlogYields,
+                (stats->runs == 0) ? 0.0 : stats->totalCycles / cyclesPerMicrosecond / stats->runs,
+                stats->maxCycles / cyclesPerMicrosecond);
+    }
+}
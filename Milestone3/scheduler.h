@@ -0,0 +1,70 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// A cooperative scheduler for the main loop. A task is a function that does one slice of work and
+// returns true if it has more to do. scheduler_runPass() visits the tasks in priority order (0 first)
+// and runs each task that is due slice after slice until it is done, its time budget is used up, or,
+// for a task that yields to the detector, the ADC buffer holds more than the backlog watermark.
+// A task stopped early is resumed on a later pass. A backlog yield also ends the pass so the
+// highest-priority task (the detector) runs again before any more UI work.
+//
+// Slices are timed with cycleCounter_read(); a budget is checked between slices, so a slice should
+// be short (one histogram bar, one label). Periods are in ISR ticks of timerWheel_now().
+
+#define SCHEDULER_MAX_TASKS 8
+#define SCHEDULER_DEFAULT_BACKLOG_WATERMARK 500  // ADC samples (5 ms of input at 100 kHz).
+#define SCHEDULER_EVERY_PASS 0                   // Period of a task that is due on every pass.
+#define SCHEDULER_ONLY_WHEN_WOKEN UINT32_MAX     // Period of a task that runs only after scheduler_wake().
+#define SCHEDULER_NO_BUDGET 0.0                  // Budget of a task that always runs to completion.
+#define SCHEDULER_INVALID_TASK 0xFF              // Returned by scheduler_addTask() when the table is full.
+
+typedef uint8_t scheduler_taskId_t;
+
+// Runs one slice of a task. Returns true if the task has more to do.
+typedef bool (*scheduler_task_t)(void* user);
+
+// Statistics for one task.
+typedef struct {
+    uint32_t runs;              // Times the task was started because it was due.
+    uint32_t completions;       // Times it finished (its last slice returned false).
+    uint32_t slices;            // Slices run.
+    uint32_t budgetYields;      // Times it was stopped because it used up its budget.
+    uint32_t backlogYields;     // Times it was stopped because the ADC buffer passed the watermark.
+    uint32_t maxCycles;         // Longest completed run, summed over the passes it took.
+    uint64_t totalCycles;       // Total time it ran.
+} scheduler_stats_t;
+
+// Starts the cycle counter, removes all tasks and sets the default backlog watermark.
+void scheduler_init();
+
+// Adds a task. periodTicks is SCHEDULER_EVERY_PASS, SCHEDULER_ONLY_WHEN_WOKEN or the ticks from one
+// start to the next (a periodic task is also due on the first pass);
+// budgetMicroseconds is how long it may run in one pass (SCHEDULER_NO_BUDGET: no limit);
+// yieldsToBacklog makes it stop whenever the ADC buffer is over the watermark.
+// Returns the task's id, or SCHEDULER_INVALID_TASK if the table is full.
+scheduler_taskId_t scheduler_addTask(const char* name, scheduler_task_t task, void* user, uint8_t priority,
+                                     uint32_t periodTicks, double budgetMicroseconds, bool yieldsToBacklog);
+
+// Makes a task due on the next pass regardless of its period.
+void scheduler_wake(scheduler_taskId_t id);
+
+// Changes the period of a task; a start already due later than one new period from now is brought forward.
+void scheduler_setPeriod(scheduler_taskId_t id, uint32_t periodTicks);
+
+// Sets the number of ADC samples above which tasks that yield to the backlog stop.
+void scheduler_setBacklogWatermark(uint32_t samples);
+
+// Runs the due tasks once, in priority order.
+void scheduler_runPass();
+
+// Copies the statistics of a task.
+void scheduler_getStats(scheduler_taskId_t id, scheduler_stats_t* stats);
+
+// Prints the statistics of every task. Use stdout to dump over the UART on the board.
+void scheduler_dump(FILE* out);
+
+#endif /* SCHEDULER_H_ */
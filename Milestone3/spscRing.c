@@ -0,0 +1,109 @@
+/*********************************************************************************************************/
+/* File: spscRing.c                                                                                      */
+/* Purpose: Lock-free single-producer / single-consumer ring (see spscRing.h).                           */
+/*********************************************************************************************************/
+#include "spscRing.h"
+
+#define SPSC_RING_PERCENTAGE_MULTIPLIER 100.0
+
+/*********************************************************************************************************/
+/* Function: spscRing_init                                                                               */
+/* Purpose: Empties the ring and clears both sides' statistics.                                          */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void spscRing_init(spscRing_t* ring)
+{
+    ring->producer.index = 0;
+    ring->producer.cachedOtherIndex = 0;
+    ring->producer.refreshCount = 0;
+    ring->producer.stallCount = 0;
+    ring->producer.transferCount = 0;
+    ring->consumer = ring->producer;
+    // Make the cleared ring visible before either side starts.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/*********************************************************************************************************/
+/* Function: spscRing_push                                                                               */
+/* Purpose: Adds a value at the head of the ring. Producer side only.                                    */
+/* Returns: true if the value was added, false if the ring was full.                                     */
+/*********************************************************************************************************/
+bool spscRing_push(spscRing_t* ring, spscRing_data_t value)
+{
+    uint32_t head = ring->producer.index;
+    // Only look at the consumer's line when our copy of its index says there is no room.
+    if (head - ring->producer.cachedOtherIndex >= SPSC_RING_CAPACITY)
+    {
+        ring->producer.cachedOtherIndex = __atomic_load_n(&ring->consumer.index, __ATOMIC_ACQUIRE);
+        ring->producer.refreshCount++;
+        if (head - ring->producer.cachedOtherIndex >= SPSC_RING_CAPACITY)
+        {
+            ring->producer.stallCount++;
+            return false;
+        }
+    }
+    ring->data[head & SPSC_RING_INDEX_MASK] = value;
+    // Publish the value before the new head.
+    __atomic_store_n(&ring->producer.index, head + 1, __ATOMIC_RELEASE);
+    ring->producer.transferCount++;
+    return true;
+}
+
+/*********************************************************************************************************/
+/* Function: spscRing_pop                                                                                */
+/* Purpose: Removes the value at the tail of the ring. Consumer side only.                               */
+/* Returns: true if a value was stored in *value, false if the ring was empty.                           */
+/*********************************************************************************************************/
+bool spscRing_pop(spscRing_t* ring, spscRing_data_t* value)
+{
+    uint32_t tail = ring->consumer.index;
+    // Only look at the producer's line when our copy of its index says the ring is empty.
+    if (tail == ring->consumer.cachedOtherIndex)
+    {
+        ring->consumer.cachedOtherIndex = __atomic_load_n(&ring->producer.index, __ATOMIC_ACQUIRE);
+        ring->consumer.refreshCount++;
+        if (tail == ring->consumer.cachedOtherIndex)
+        {
+            ring->consumer.stallCount++;
+            return false;
+        }
+    }
+    *value = ring->data[tail & SPSC_RING_INDEX_MASK];
+    // Release the slot only after the value has been read.
+    __atomic_store_n(&ring->consumer.index, tail + 1, __ATOMIC_RELEASE);
+    ring->consumer.transferCount++;
+    return true;
+}
+
+/*********************************************************************************************************/
+/* Function: spscRing_elementCount                                                                       */
+/* Purpose: Returns how many values are waiting in the ring.                                             */
+/* Returns: The element count (a snapshot while either side is running).                                 */
+/*********************************************************************************************************/
+uint32_t spscRing_elementCount(spscRing_t* ring)
+{
+    // Consumer first: it never passes the producer, so the later producer read cannot be behind it.
+    uint32_t consumerIndex = __atomic_load_n(&ring->consumer.index, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&ring->producer.index, __ATOMIC_ACQUIRE) - consumerIndex;
+}
+
+/*********************************************************************************************************/
+/* Function: spscRing_dump                                                                               */
+/* Purpose: Prints the ring statistics. The re-read rate is the fraction of transfers that needed the    */
+/*          other side's cache line; near 0% means the sides rarely touch each other's data.             */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void spscRing_dump(FILE* out, const char* name, spscRing_t* ring)
+{
+    const spscRing_side_t* sides[] = {&ring->producer, &ring->consumer};
+    const char* sideNames[] = {"producer", "consumer"};
+    const char* stallNames[] = {"full", "empty"};
+    fprintf(out, "%s (capacity %d, %d-byte lines)\n\r", name, SPSC_RING_CAPACITY, SPSC_RING_CACHE_LINE_SIZE);
+    for (uint16_t i = 0; i < 2; i++)
+    {
+        double transfers = (sides[i]->transferCount > 0) ? sides[i]->transferCount : 1;
+        fprintf(out, "  %s: %lu transfers, %lu %s, %lu index re-reads (%.2f%%)\n\r", sideNames[i],
+                (unsigned long) sides[i]->transferCount, (unsigned long) sides[i]->stallCount, stallNames[i],
+                (unsigned long) sides[i]->refreshCount, sides[i]->refreshCount * SPSC_RING_PERCENTAGE_MULTIPLIER / transfers);
+    }
+}
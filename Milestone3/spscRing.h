@@ -0,0 +1,58 @@
+#ifndef SPSCRING_H_
+#define SPSCRING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Lock-free single-producer / single-consumer ring of doubles, for handing data from one
+// core (or thread) to another. Exactly one caller may push and exactly one may pop.
+//
+// The producer's and the consumer's indices live on separate cache lines so that the two
+// sides do not invalidate each other's line on every access. Each side also keeps a private
+// copy of the other side's index and only re-reads the real one (a cross-core cache-line
+// transfer) when the copy says the ring is full or empty. The number of those re-reads is
+// kept as a measure of how much the two sides contend for the ring.
+
+#if defined(__arm__)
+#define SPSC_RING_CACHE_LINE_SIZE 32    // Cortex-A9 L1 and PL310 L2 line size.
+#else
+#define SPSC_RING_CACHE_LINE_SIZE 64
+#endif
+
+#define SPSC_RING_CAPACITY 256          // Must be a power of two.
+#define SPSC_RING_INDEX_MASK (SPSC_RING_CAPACITY - 1)
+
+typedef double spscRing_data_t;
+
+// One side of the ring: written only by its owner.
+typedef struct {
+    uint32_t index;             // Producer: next slot to fill. Consumer: next slot to empty. Free-running.
+    uint32_t cachedOtherIndex;  // Last value read from the other side's index.
+    uint32_t refreshCount;      // Times the other side's index had to be re-read.
+    uint32_t stallCount;        // Times the ring was really full (producer) or empty (consumer).
+    uint32_t transferCount;     // Values pushed (producer) or popped (consumer).
+} __attribute__((aligned(SPSC_RING_CACHE_LINE_SIZE))) spscRing_side_t;
+
+typedef struct {
+    spscRing_side_t producer;
+    spscRing_side_t consumer;
+    spscRing_data_t data[SPSC_RING_CAPACITY] __attribute__((aligned(SPSC_RING_CACHE_LINE_SIZE)));
+} spscRing_t;
+
+// Empties the ring and clears its statistics. Neither side may be using the ring.
+void spscRing_init(spscRing_t* ring);
+
+// Producer only. Returns false (and leaves the ring alone) if the ring is full.
+bool spscRing_push(spscRing_t* ring, spscRing_data_t value);
+
+// Consumer only. Returns false if the ring is empty, otherwise stores the oldest value in *value.
+bool spscRing_pop(spscRing_t* ring, spscRing_data_t* value);
+
+// Number of values waiting. Exact only when neither side is running.
+uint32_t spscRing_elementCount(spscRing_t* ring);
+
+// Prints the transfer, stall and index re-read counts of both sides.
+void spscRing_dump(FILE* out, const char* name, spscRing_t* ring);
+
+#endif /* SPSCRING_H_ */
@@ -0,0 +1,370 @@
+/*********************************************************************************************************/
+/* File: telemetry.c                                                                                     */
+/* Purpose: Rate-limited, delta-encoded and checksummed power/hit frames streamed over the UART or a     */
+/*          host socket without blocking the detector (see telemetry.h).                                 */
+/*********************************************************************************************************/
+#include "telemetry.h"
+
+#ifdef TELEMETRY_ENABLED
+
+#include <math.h>
+#include <string.h>
+#include "filter.h"
+#include "detector.h"
+#if defined(__arm__) && !defined(__linux__)
+#include "xparameters.h"
+#include "xuartps_hw.h"
+#else
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#define TELEMETRY_BUFFER_MASK (TELEMETRY_TX_BUFFER_SIZE - 1)
+#define TELEMETRY_CRC_POLYNOMIAL 0x1021
+#define TELEMETRY_VARINT_MORE 0x80              // Set on every varint byte but the last.
+#define TELEMETRY_VARINT_BITS 7
+#define TELEMETRY_VARINT_MASK 0x7F
+#define TELEMETRY_LENGTH_INDEX 2                // Frame offsets.
+#define TELEMETRY_SEQUENCE_INDEX 3
+#define TELEMETRY_FLAGS_INDEX 4
+#define TELEMETRY_STEP_INDEX 5
+
+#if defined(__arm__) && !defined(__linux__)
+#define TELEMETRY_UART_BASEADDR XPAR_PS7_UART_1_BASEADDR   // The USB-UART (shared with printf).
+#else
+#define TELEMETRY_HOST_RECONNECT_CALLS 10000   // telemetry_service() calls between connection attempts.
+#define TELEMETRY_NO_SOCKET -1
+static int telemetry_socket = TELEMETRY_NO_SOCKET;
+static uint32_t telemetry_callsSinceConnect;
+#endif
+
+// Transmit buffer: telemetry_publish() adds whole frames at head, telemetry_service() sends from tail.
+// Both run in the main loop.
+static uint8_t telemetry_buffer[TELEMETRY_TX_BUFFER_SIZE];
+static uint32_t telemetry_head;
+static uint32_t telemetry_tail;
+
+// Encoder state.
+static uint32_t telemetry_stepDivider = TELEMETRY_DEFAULT_STEP_DIVIDER;
+static uint32_t telemetry_step;                 // Decimated samples offered so far.
+static uint32_t telemetry_stepsSinceFrame;
+static uint32_t telemetry_framesSinceKeyframe;
+static bool telemetry_keyframeNeeded;           // The receiver has no valid base for deltas.
+static uint8_t telemetry_sequence;
+static int16_t telemetry_previousCodes[FILTER_NUMBER_OF_PLAYERS];
+static telemetry_stats_t telemetry_stats;
+
+/*********************************************************************************************************/
+/* Function: telemetry_connect                                                                           */
+/* Purpose: Host only: connects to the receiver's socket if it is listening.                             */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+#if !(defined(__arm__) && !defined(__linux__))
+static void telemetry_connect()
+{
+    telemetry_callsSinceConnect = 0;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, TELEMETRY_HOST_SOCKET_PATH, sizeof(address.sun_path) - 1);
+    if (connect(fd, (struct sockaddr*) &address, sizeof(address)) < 0)
+    {
+        close(fd);
+        return;
+    }
+    telemetry_socket = fd;
+    // The receiver may have joined mid-stream; give it a base for the deltas.
+    telemetry_keyframeNeeded = true;
+}
+#endif
+
+/*********************************************************************************************************/
+/* Function: telemetry_init                                                                              */
+/* Purpose: Clears the transmit buffer, encoder state and statistics and opens the link.                 */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void telemetry_init()
+{
+    telemetry_head = 0;
+    telemetry_tail = 0;
+    telemetry_step = 0;
+    telemetry_stepsSinceFrame = 0;
+    telemetry_framesSinceKeyframe = 0;
+    telemetry_keyframeNeeded = true;
+    telemetry_sequence = 0;
+    memset(telemetry_previousCodes, 0, sizeof(telemetry_previousCodes));
+    memset(&telemetry_stats, 0, sizeof(telemetry_stats));
+#if !(defined(__arm__) && !defined(__linux__))
+    if (telemetry_socket == TELEMETRY_NO_SOCKET)
+    {
+        telemetry_connect();
+    }
+#endif
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_setStepDivider                                                                    */
+/* Purpose: Sets the configured frame rate (one frame per stepDivider decimated samples).                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void telemetry_setStepDivider(uint32_t stepDivider)
+{
+    telemetry_stepDivider = (stepDivider == 0) ? 1 : stepDivider;
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_crc16                                                                             */
+/* Purpose: Bitwise CRC-16/CCITT; frames are short and rare enough not to need a table.                  */
+/* Returns: The updated CRC.                                                                             */
+/*********************************************************************************************************/
+uint16_t telemetry_crc16(uint16_t crc, const uint8_t bytes[], uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        crc ^= (uint16_t) (bytes[i] << 8);
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ TELEMETRY_CRC_POLYNOMIAL) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_encodePower                                                                       */
+/* Purpose: Maps a power to TELEMETRY_CODE_SCALE codes per octave, saturating at the int16 range.        */
+/* Returns: The code.                                                                                    */
+/*********************************************************************************************************/
+int16_t telemetry_encodePower(double power)
+{
+    if (!(power > 0))
+    {
+        return TELEMETRY_ZERO_POWER_CODE;
+    }
+    double code = floor(log2(power) * TELEMETRY_CODE_SCALE + 0.5);
+    if (code > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (code <= TELEMETRY_ZERO_POWER_CODE)
+    {
+        return TELEMETRY_ZERO_POWER_CODE + 1;
+    }
+    return (int16_t) code;
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_decodePower                                                                       */
+/* Purpose: Inverse of telemetry_encodePower() (to within half a code).                                  */
+/* Returns: The power.                                                                                   */
+/*********************************************************************************************************/
+double telemetry_decodePower(int16_t code)
+{
+    if (code == TELEMETRY_ZERO_POWER_CODE)
+    {
+        return 0;
+    }
+    return exp2(code / TELEMETRY_CODE_SCALE);
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_adjustRate                                                                        */
+/* Purpose: Halves the frame rate while the transmit buffer is over half full and doubles it again once  */
+/*          it is under a quarter full.                                                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void telemetry_adjustRate()
+{
+    uint32_t used = telemetry_head - telemetry_tail;
+    if (used > TELEMETRY_TX_BUFFER_SIZE / 2 && telemetry_stats.backoffShift < TELEMETRY_MAX_BACKOFF_SHIFT)
+    {
+        telemetry_stats.backoffShift++;
+    }
+    else if (used < TELEMETRY_TX_BUFFER_SIZE / 4 && telemetry_stats.backoffShift > 0)
+    {
+        telemetry_stats.backoffShift--;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_publish                                                                           */
+/* Purpose: Builds a frame for this decimated sample if one is due (or it holds a hit) and queues it,    */
+/*          dropping it if the transmit buffer cannot take it.                                           */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void telemetry_publish(const double power[], int16_t hitPlayer)
+{
+    uint32_t step = telemetry_step++;
+    bool hit = (hitPlayer != DETECTOR_NO_HIT);
+    if (!hit && ++telemetry_stepsSinceFrame < (telemetry_stepDivider << telemetry_stats.backoffShift))
+    {
+        return;
+    }
+    telemetry_stats.framesSkipped += (1u << telemetry_stats.backoffShift) - 1;
+    telemetry_stepsSinceFrame = 0;
+    telemetry_adjustRate();
+
+    // Header.
+    uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+    bool keyframe = telemetry_keyframeNeeded || telemetry_framesSinceKeyframe >= TELEMETRY_KEYFRAME_INTERVAL;
+    frame[0] = TELEMETRY_SYNC_0;
+    frame[1] = TELEMETRY_SYNC_1;
+    frame[TELEMETRY_SEQUENCE_INDEX] = telemetry_sequence++;
+    frame[TELEMETRY_FLAGS_INDEX] = (uint8_t) ((keyframe ? TELEMETRY_FLAG_KEYFRAME : 0) |
+                                              (hit ? TELEMETRY_FLAG_HIT | (hitPlayer & TELEMETRY_FLAG_HIT_PLAYER_MASK) : 0));
+    for (uint8_t i = 0; i < sizeof(step); i++)
+    {
+        frame[TELEMETRY_STEP_INDEX + i] = (uint8_t) (step >> (8 * i));
+    }
+    uint32_t size = TELEMETRY_HEADER_SIZE;
+
+    // Payload: the codes themselves, or their zigzag-encoded changes.
+    int16_t codes[FILTER_NUMBER_OF_PLAYERS];
+    for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+    {
+        codes[p] = telemetry_encodePower(power[p]);
+        if (keyframe)
+        {
+            frame[size++] = (uint8_t) codes[p];
+            frame[size++] = (uint8_t) ((uint16_t) codes[p] >> 8);
+        }
+        else
+        {
+            int32_t delta = (int32_t) codes[p] - telemetry_previousCodes[p];
+            uint32_t zigzag = ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31);
+            while (zigzag > TELEMETRY_VARINT_MASK)
+            {
+                frame[size++] = (uint8_t) ((zigzag & TELEMETRY_VARINT_MASK) | TELEMETRY_VARINT_MORE);
+                zigzag >>= TELEMETRY_VARINT_BITS;
+            }
+            frame[size++] = (uint8_t) zigzag;
+        }
+    }
+    frame[TELEMETRY_LENGTH_INDEX] = (uint8_t) (size - TELEMETRY_SEQUENCE_INDEX);
+    uint16_t crc = telemetry_crc16(TELEMETRY_CRC_INITIAL_VALUE, &frame[TELEMETRY_LENGTH_INDEX], size - TELEMETRY_LENGTH_INDEX);
+    frame[size++] = (uint8_t) crc;
+    frame[size++] = (uint8_t) (crc >> 8);
+
+    // Queue the whole frame or none of it. After a drop the receiver's delta base is stale.
+    if (TELEMETRY_TX_BUFFER_SIZE - (telemetry_head - telemetry_tail) < size)
+    {
+        telemetry_stats.framesDropped++;
+        telemetry_keyframeNeeded = true;
+        return;
+    }
+    for (uint32_t i = 0; i < size; i++)
+    {
+        telemetry_buffer[(telemetry_head + i) & TELEMETRY_BUFFER_MASK] = frame[i];
+    }
+    telemetry_head += size;
+    memcpy(telemetry_previousCodes, codes, sizeof(codes));
+    telemetry_framesSinceKeyframe = keyframe ? 0 : telemetry_framesSinceKeyframe + 1;
+    telemetry_keyframeNeeded = false;
+    telemetry_stats.framesQueued++;
+    if (keyframe)
+    {
+        telemetry_stats.keyframes++;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_service                                                                           */
+/* Purpose: Moves queued bytes to the link until it would have to wait: the UART transmit FIFO on the   */
+/*          board, a non-blocking socket send on a host.                                                 */
+/* Returns: The number of bytes moved.                                                                   */
+/*********************************************************************************************************/
+uint32_t telemetry_service()
+{
+    uint32_t moved = 0;
+#if defined(__arm__) && !defined(__linux__)
+    while (telemetry_tail != telemetry_head && !XUartPs_IsTransmitFull(TELEMETRY_UART_BASEADDR))
+    {
+        XUartPs_WriteReg(TELEMETRY_UART_BASEADDR, XUARTPS_FIFO_OFFSET, telemetry_buffer[telemetry_tail & TELEMETRY_BUFFER_MASK]);
+        telemetry_tail++;
+        moved++;
+    }
+#else
+    if (telemetry_socket == TELEMETRY_NO_SOCKET)
+    {
+        // Nobody listening yet; the buffer fills and frames are dropped until somebody does.
+        if (++telemetry_callsSinceConnect >= TELEMETRY_HOST_RECONNECT_CALLS)
+        {
+            telemetry_connect();
+        }
+        return 0;
+    }
+    while (telemetry_tail != telemetry_head)
+    {
+        // Send the contiguous run up to the head or the end of the buffer.
+        uint32_t offset = telemetry_tail & TELEMETRY_BUFFER_MASK;
+        uint32_t count = telemetry_head - telemetry_tail;
+        if (count > TELEMETRY_TX_BUFFER_SIZE - offset)
+        {
+            count = TELEMETRY_TX_BUFFER_SIZE - offset;
+        }
+        ssize_t sent = send(telemetry_socket, &telemetry_buffer[offset], count, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent <= 0)
+        {
+            if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                // The receiver went away.
+                close(telemetry_socket);
+                telemetry_socket = TELEMETRY_NO_SOCKET;
+            }
+            break;
+        }
+        telemetry_tail += (uint32_t) sent;
+        moved += (uint32_t) sent;
+    }
+#endif
+    telemetry_stats.bytesSent += moved;
+    return moved;
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_close                                                                             */
+/* Purpose: Host only: closes the socket; queued bytes stay queued for the next connection.              */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void telemetry_close()
+{
+#if !(defined(__arm__) && !defined(__linux__))
+    if (telemetry_socket != TELEMETRY_NO_SOCKET)
+    {
+        close(telemetry_socket);
+        telemetry_socket = TELEMETRY_NO_SOCKET;
+    }
+#endif
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_getStats                                                                          */
+/* Purpose: Copies the link statistics.                                                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void telemetry_getStats(telemetry_stats_t* stats)
+{
+    *stats = telemetry_stats;
+}
+
+/*********************************************************************************************************/
+/* Function: telemetry_dump                                                                              */
+/* Purpose: Prints the link statistics.                                                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void telemetry_dump(FILE* out)
+{
+    fprintf(out, "telemetry: %lu frames queued (%lu keyframes), %lu dropped, %lu skipped by backoff, %lu bytes sent, rate 1/%lu\n\r",
+            (unsigned long) telemetry_stats.framesQueued, (unsigned long) telemetry_stats.keyframes,
+            (unsigned long) telemetry_stats.framesDropped, (unsigned long) telemetry_stats.framesSkipped,
+            (unsigned long) telemetry_stats.bytesSent, (unsigned long) (telemetry_stepDivider << telemetry_stats.backoffShift));
+}
+
+#endif /* TELEMETRY_ENABLED */
@@ -0,0 +1,106 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Telemetry streams the detector's power vector and hits off the board as small binary frames, far
+// more often than the TFT histogram can show them. On the board the frames go out of the UART;
+// on a host they go to a UNIX stream socket (TELEMETRY_HOST_SOCKET_PATH, see host/telemetryMain.c).
+//
+// detector() offers every decimated sample (10 kHz) to telemetry_publish(). A frame is built for one
+// sample out of every TELEMETRY_DEFAULT_STEP_DIVIDER (and for every hit) and queued in a transmit
+// buffer; telemetry_service(), called from the main loop, moves as many queued bytes to the link as
+// it accepts without waiting. Nothing ever blocks the detector:
+// - when the transmit buffer is more than half full the frame rate is halved (down to 1/16 of the
+//   configured rate) and raised again once the buffer drains,
+// - when a frame does not fit at all it is dropped and counted.
+//
+// Frame layout (multi-byte fields little-endian):
+//   0xA5 0x5A | length | sequence | flags | step (4) | payload | CRC-16
+// length counts the bytes from sequence to the end of the payload. step is the decimated-sample
+// number the power vector belongs to. The CRC-16/CCITT (polynomial 0x1021, initial 0xFFFF) covers
+// length through payload. Each power is sent as a 16-bit log2 code (TELEMETRY_CODE_SCALE codes per
+// octave, TELEMETRY_ZERO_POWER_CODE for zero). A keyframe carries the codes themselves; other frames
+// carry the change of each code since the previous frame as a zigzag varint, usually one byte.
+// A keyframe is sent every TELEMETRY_KEYFRAME_INTERVAL frames and right after a drop, so a receiver
+// can always resynchronize.
+//
+// Uncomment the line below (or build with -DTELEMETRY_ENABLED) to stream telemetry. When it is
+// commented out the functions below are empty inlines, so there is no run-time cost.
+//#define TELEMETRY_ENABLED
+
+#define TELEMETRY_SYNC_0 0xA5
+#define TELEMETRY_SYNC_1 0x5A
+#define TELEMETRY_HEADER_SIZE 9                 // Sync, length, sequence, flags and step.
+#define TELEMETRY_CRC_SIZE 2
+#define TELEMETRY_CRC_INITIAL_VALUE 0xFFFF
+#define TELEMETRY_MAX_FRAME_SIZE 64
+#define TELEMETRY_TX_BUFFER_SIZE 1024           // Transmit buffer; a power of two.
+#define TELEMETRY_DEFAULT_STEP_DIVIDER 50       // One frame per 50 decimated samples (200 frames/s).
+#define TELEMETRY_MAX_BACKOFF_SHIFT 4           // Slowest rate is 1/16 of the configured one.
+#define TELEMETRY_KEYFRAME_INTERVAL 100
+#define TELEMETRY_CODE_SCALE 256.0              // log2 codes per octave of power.
+#define TELEMETRY_ZERO_POWER_CODE INT16_MIN
+#define TELEMETRY_HOST_SOCKET_PATH "/tmp/ecen390-telemetry.sock"
+
+// Flags byte.
+#define TELEMETRY_FLAG_KEYFRAME 0x80
+#define TELEMETRY_FLAG_HIT 0x40                 // The low nibble holds the player that was hit.
+#define TELEMETRY_FLAG_HIT_PLAYER_MASK 0x0F
+
+// Link statistics.
+typedef struct {
+    uint32_t framesQueued;      // Frames built and queued.
+    uint32_t keyframes;         // Of which keyframes.
+    uint32_t framesDropped;     // Frames that did not fit in the transmit buffer.
+    uint32_t framesSkipped;     // Frames not built because the rate had been lowered.
+    uint32_t bytesSent;         // Bytes accepted by the link.
+    uint8_t backoffShift;       // Current rate is the configured rate divided by 2^backoffShift.
+} telemetry_stats_t;
+
+#ifdef TELEMETRY_ENABLED
+
+// Clears the transmit buffer and statistics and opens the link.
+void telemetry_init();
+
+// Sends one frame per stepDivider decimated samples (hits are always sent).
+void telemetry_setStepDivider(uint32_t stepDivider);
+
+// Offers the power vector of one decimated sample and the player hit on it (DETECTOR_NO_HIT if none).
+void telemetry_publish(const double power[], int16_t hitPlayer);
+
+// Main loop: moves queued bytes to the link without waiting. Returns the number of bytes moved.
+uint32_t telemetry_service();
+
+// Host: closes the socket so the receiver sees the end of the stream. Does nothing on the board.
+void telemetry_close();
+
+// Copies the link statistics.
+void telemetry_getStats(telemetry_stats_t* stats);
+
+// Prints the link statistics.
+void telemetry_dump(FILE* out);
+
+// Converts a power value to its 16-bit log2 code.
+int16_t telemetry_encodePower(double power);
+
+// Converts a 16-bit log2 code back to a power value.
+double telemetry_decodePower(int16_t code);
+
+// CRC-16/CCITT of a byte range, continuing from crc (start a frame with TELEMETRY_CRC_INITIAL_VALUE).
+uint16_t telemetry_crc16(uint16_t crc, const uint8_t bytes[], uint32_t count);
+
+#else
+
+static inline void telemetry_init() {}
+static inline void telemetry_setStepDivider(uint32_t) {}
+static inline void telemetry_publish(const double[], int16_t) {}
+static inline uint32_t telemetry_service() { return 0; }
+static inline void telemetry_close() {}
+static inline void telemetry_dump(FILE*) {}
+
+#endif /* TELEMETRY_ENABLED */
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,284 @@
+/*********************************************************************************************************/
+/* File: timerWheel.c                                                                                    */
+/* Purpose: Hierarchical timer wheel advanced by the ISR, with lock-free scheduling requests from other  */
+/*          contexts (see timerWheel.h).                                                                 */
+/*********************************************************************************************************/
+#include <stddef.h>
+#include "timerWheel.h"
+
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_MIN_DELAY 1
+
+// Requested operations.
+#define TIMER_WHEEL_REQUEST_NONE 0          // Overridden by a later *FromIsr() call.
+#define TIMER_WHEEL_REQUEST_SCHEDULE 1
+#define TIMER_WHEEL_REQUEST_CANCEL 2
+
+// A request is one word, so the ISR never sees an operation with another request's expiry.
+#define TIMER_WHEEL_REQUEST_OPERATION_MASK 0xFFFFFFFFULL
+#define TIMER_WHEEL_REQUEST_EXPIRES_SHIFT 32
+#define TIMER_WHEEL_REQUEST(operation, expires) (((uint64_t) (expires) << TIMER_WHEEL_REQUEST_EXPIRES_SHIFT) | (operation))
+
+// Slot lists, touched only by the ISR, and the tick being processed.
+static timerWheel_timer_t* timerWheel_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static volatile uint32_t timerWheel_ticks = 0;
+
+// Timers with a request posted from outside the ISR (a lock-free stack).
+static timerWheel_timer_t* timerWheel_requests = NULL;
+
+/*********************************************************************************************************/
+/* Function: timerWheel_unlink                                                                           */
+/* Purpose: Removes a timer from its slot, if it is in one.                                              */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void timerWheel_unlink(timerWheel_timer_t* timer)
+{
+
+    if (timer->link == NULL)
+    {
+        return;
+    }
+    *timer->link = timer->next;
+    if (timer->next != NULL)
+    {
+        timer->next->link = timer->link;
+    }
+    timer->next = NULL;
+    timer->link = NULL;
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_setRequestedOperation                                                            */
+/* Purpose: Replaces the operation of the timer's request and keeps the expiry posted with it.          */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void timerWheel_setRequestedOperation(timerWheel_timer_t* timer, uint8_t operation)
+{
+    uint64_t request = __atomic_load_n(&timer->request, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&timer->request, &request,
+                                        (request & ~TIMER_WHEEL_REQUEST_OPERATION_MASK) | operation, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_supersedeRequest                                                                 */
+/* Purpose: Makes a request still on the list do nothing, as a *FromIsr() call made after it wins.      */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void timerWheel_supersedeRequest(timerWheel_timer_t* timer)
+{
+    if (__atomic_load_n(&timer->requestPending, __ATOMIC_ACQUIRE))
+    {
+        timerWheel_setRequestedOperation(timer, TIMER_WHEEL_REQUEST_NONE);
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_insert                                                                           */
+/* Purpose: Puts a timer in the slot for its expiry: the lowest level whose span covers it. Expiries     */
+/*          already passed go in the slot being processed.                                               */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void timerWheel_insert(timerWheel_timer_t* timer)
+{
+    uint32_t now = timerWheel_ticks;
+    uint32_t delta = timer->expires - now;
+    if ((int32_t) delta < 0)
+    {
+        timer->expires = now;
+        delta = 0;
+    }
+    // Out of range: park it in the furthest slot; it is re-inserted when that slot moves down.
+    uint32_t slotTime = (delta > TIMER_WHEEL_MAX_DELAY) ? now + TIMER_WHEEL_MAX_DELAY : timer->expires;
+    uint8_t level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >> (TIMER_WHEEL_SLOT_BITS * (level + 1)))
+    {
+        level++;
+    }
+    timerWheel_timer_t** head = &timerWheel_slots[level][(slotTime >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK];
+    timer->next = *head;
+    if (*head != NULL)
+    {
+        (*head)->link = &timer->next;
+    }
+    *head = timer;
+    timer->link = head;
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_initTimer                                                                        */
+/* Purpose: Sets the callback of a timer and makes sure it is not scheduled.                            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void timerWheel_initTimer(timerWheel_timer_t* timer, timerWheel_callback_t callback, void* user)
+{
+    timerWheel_supersedeRequest(timer);
+    timerWheel_unlink(timer);
+    timer->callback = callback;
+    timer->user = user;
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_postRequest                                                                      */
+/* Purpose: Pushes a timer whose request was just recorded on the request list unless it is already     */
+/*          there.                                                                                       */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void timerWheel_postRequest(timerWheel_timer_t* timer)
+{
+    // The request must be visible before the flag is read (see timerWheel_applyRequests()).
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_exchange_n(&timer->requestPending, true, __ATOMIC_ACQ_REL))
+    {
+        return;
+    }
+    timerWheel_timer_t* head = __atomic_load_n(&timerWheel_requests, __ATOMIC_RELAXED);
+    do
+    {
+        timer->nextRequest = head;
+    } while (!__atomic_compare_exchange_n(&timerWheel_requests, &head, timer, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_schedule                                                                         */
+/* Purpose: Posts a request to fire timer delayTicks from now.                                           */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void timerWheel_schedule(timerWheel_timer_t* timer, uint32_t delayTicks)
+{
+    if (delayTicks < TIMER_WHEEL_MIN_DELAY)
+    {
+        delayTicks = TIMER_WHEEL_MIN_DELAY;
+    }
+    __atomic_store_n(&timer->request, TIMER_WHEEL_REQUEST(TIMER_WHEEL_REQUEST_SCHEDULE, timerWheel_ticks + delayTicks),
+                     __ATOMIC_RELEASE);
+    timerWheel_postRequest(timer);
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_cancel                                                                           */
+/* Purpose: Posts a request to cancel timer.                                                             */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void timerWheel_cancel(timerWheel_timer_t* timer)
+{
+    timerWheel_setRequestedOperation(timer, TIMER_WHEEL_REQUEST_CANCEL);
+    timerWheel_postRequest(timer);
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_scheduleFromIsr                                                                  */
+/* Purpose: Moves timer to the slot for delayTicks from now.                                             */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void timerWheel_scheduleFromIsr(timerWheel_timer_t* timer, uint32_t delayTicks)
+{
+    if (delayTicks < TIMER_WHEEL_MIN_DELAY)
+    {
+        delayTicks = TIMER_WHEEL_MIN_DELAY;
+    }
+    timerWheel_supersedeRequest(timer);
+    timerWheel_unlink(timer);
+    timer->expires = timerWheel_ticks + delayTicks;
+    timerWheel_insert(timer);
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_cancelFromIsr                                                                    */
+/* Purpose: Takes timer out of the wheel.                                                                */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void timerWheel_cancelFromIsr(timerWheel_timer_t* timer)
+{
+    timerWheel_supersedeRequest(timer);
+    timerWheel_unlink(timer);
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_applyRequests                                                                    */
+/* Purpose: Takes the whole request list and carries out each timer's latest request.                   */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void timerWheel_applyRequests()
+{
+    timerWheel_timer_t* timer = __atomic_exchange_n(&timerWheel_requests, (timerWheel_timer_t*) NULL, __ATOMIC_ACQUIRE);
+    while (timer != NULL)
+    {
+        timerWheel_timer_t* nextRequest = timer->nextRequest;
+        // Clear the flag first: a request posted from now on goes on the list again.
+        __atomic_store_n(&timer->requestPending, false, __ATOMIC_RELEASE);
+        // Pairs with the fence in timerWheel_postRequest(): either this read sees the poster's request or
+        // the poster sees the flag cleared and queues the timer again.
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        uint64_t request = __atomic_load_n(&timer->request, __ATOMIC_ACQUIRE);
+        uint8_t operation = (uint8_t) (request & TIMER_WHEEL_REQUEST_OPERATION_MASK);
+        if (operation != TIMER_WHEEL_REQUEST_NONE)
+        {
+            timerWheel_unlink(timer);
+        }
+        if (operation == TIMER_WHEEL_REQUEST_SCHEDULE)
+        {
+            timer->expires = (uint32_t) (request >> TIMER_WHEEL_REQUEST_EXPIRES_SHIFT);
+            timerWheel_insert(timer);
+        }
+        timer = nextRequest;
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_cascade                                                                          */
+/* Purpose: Re-inserts every timer of a slot of an upper level; they land a level (or more) lower.       */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void timerWheel_cascade(uint8_t level, uint32_t index)
+{
+    timerWheel_timer_t* timer;
+    while ((timer = timerWheel_slots[level][index]) != NULL)
+    {
+        timerWheel_unlink(timer);
+        timerWheel_insert(timer);
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_tick                                                                             */
+/* Purpose: Applies posted requests, moves upper-level slots down when level 0 wraps, runs the timers    */
+/*          due this tick and advances the wheel.                                                        */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void timerWheel_tick()
+{
+    if (__atomic_load_n(&timerWheel_requests, __ATOMIC_RELAXED) != NULL)
+    {
+        timerWheel_applyRequests();
+    }
+    uint32_t now = timerWheel_ticks;
+    uint32_t index = now & TIMER_WHEEL_SLOT_MASK;
+    // Each time a level wraps, the next slot of the level above comes due for redistribution.
+    for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS && index == 0; level++)
+    {
+        index = (now >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+        timerWheel_cascade(level, index);
+    }
+    // Callbacks may reschedule their own timer; it lands in another slot.
+    timerWheel_timer_t* timer;
+    timerWheel_timer_t** due = &timerWheel_slots[0][now & TIMER_WHEEL_SLOT_MASK];
+    while ((timer = *due) != NULL)
+    {
+        timerWheel_unlink(timer);
+        timer->callback(timer);
+    }
+    timerWheel_ticks = now + 1;
+}
+
+/*********************************************************************************************************/
+/* Function: timerWheel_now                                                                              */
+/* Purpose: Reports how far the wheel has advanced.                                                      */
+/* Returns: The tick count.                                                                              */
+/*********************************************************************************************************/
+uint32_t timerWheel_now()
+{
+    return timerWheel_ticks;
+}
@@ -0,0 +1,69 @@
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Hierarchical timer wheel driven by the 100 kHz ISR tick. Modules register a deadline and a
+// callback instead of being ticked every 10 us: isr_function() only calls timerWheel_tick(), which
+// advances the wheel by one tick and runs the callbacks that are due. A module with nothing
+// scheduled costs nothing, and adding a timed feature adds no per-tick work.
+//
+// The wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots. Level 0 holds timers due in
+// the next 64 ticks, one slot per tick; level n holds timers due within 64^(n+1) ticks, one slot
+// per 64^n ticks, and its slots are moved down a level as the wheel reaches them. Scheduling,
+// cancelling and firing a timer are O(1); moving a slot down costs one re-insert per timer in it.
+// Timers further out than TIMER_WHEEL_MAX_DELAY (168 s) wait at the top level and are re-inserted
+// until they are in range.
+//
+// Callbacks run in the ISR. Code running in the ISR (including callbacks) schedules and cancels
+// with the *FromIsr() functions, which act immediately. Any other code (the main loop, the second
+// core) uses timerWheel_schedule() and timerWheel_cancel(): these post a request on a lock-free
+// list that the next timerWheel_tick() applies, so the wheel itself is only ever touched by the ISR.
+// The last request made for a timer before a tick wins; a request made while a tick is under way
+// cannot stop the timer firing in that tick.
+
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_MAX_DELAY ((1UL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+typedef struct timerWheel_timer timerWheel_timer_t;
+
+// Called from the ISR when a timer expires.
+typedef void (*timerWheel_callback_t)(timerWheel_timer_t* timer);
+
+// A timer. Owned by the module that uses it; only touch it through the functions below.
+struct timerWheel_timer {
+    timerWheel_timer_t* next;           // Next timer in the same slot.
+    timerWheel_timer_t** link;          // Pointer that points at this timer (NULL if not scheduled).
+    uint32_t expires;                   // Tick at which the timer fires.
+    timerWheel_callback_t callback;
+    void* user;                         // For the owner.
+    timerWheel_timer_t* nextRequest;    // Next timer on the request list.
+    uint64_t request;                   // Posted by timerWheel_schedule()/timerWheel_cancel(): expiry and operation.
+    bool requestPending;                // On the request list.
+};
+
+// Sets the callback of a timer. Call before interrupts are running; cancels the timer if scheduled.
+void timerWheel_initTimer(timerWheel_timer_t* timer, timerWheel_callback_t callback, void* user);
+
+// Any context: (re)schedules timer to fire delayTicks ticks from now (at least 1).
+void timerWheel_schedule(timerWheel_timer_t* timer, uint32_t delayTicks);
+
+// Any context: cancels timer if it is scheduled.
+void timerWheel_cancel(timerWheel_timer_t* timer);
+
+// ISR and callbacks only: (re)schedules timer to fire delayTicks ticks from now (at least 1).
+void timerWheel_scheduleFromIsr(timerWheel_timer_t* timer, uint32_t delayTicks);
+
+// ISR and callbacks only: cancels timer if it is scheduled.
+void timerWheel_cancelFromIsr(timerWheel_timer_t* timer);
+
+// ISR only: applies posted requests, advances the wheel one tick and runs the callbacks due.
+void timerWheel_tick();
+
+// Returns the number of ticks the wheel has advanced.
+uint32_t timerWheel_now();
+
+#endif /* TIMERWHEEL_H_ */
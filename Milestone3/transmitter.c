@@ -1,21 +1,35 @@
 #include <stdio.h>
 #include "transmitter.h"
 #include "filter.h"
+#include "eventJournal.h"
+#include "timerWheel.h"
 #include "../Lab2/buttons.h"
 #include "../Lab2/switches.h"
 #include "supportFiles/utils.h"
 #include "supportFiles/mio.h"
+#include "deferredLog.h"
 
-#define TRANSMITTER_FIRE_TIME 20000
-#define TRANSMITTER_HIGH_TIMER_CLEAR 0
-#define TRANSMITTER_LOW_TIMER_CLEAR 0
-#define TRANSMITTER_TIMER_CLEAR 0
+// The test-mode trace (run from the timer wheel callbacks) goes to the deferred log (Common/deferredLog.h), if TRANSMITTER_LOG_ENABLED.
+#if defined(DEFERRED_LOG_ENABLED) && defined(TRANSMITTER_LOG_ENABLED)
+#define TRANSMITTER_LOG DEFERRED_LOG
+#else
+#define TRANSMITTER_LOG(...)
+#endif
+
+#define TRANSMITTER_FIRE_TIME TRANSMITTER_PULSE_WIDTH
 #define TRANSMITTER_FREQUENCY_CLEAR 0
+#define TRANSMITTER_MIN_EDGE_TICKS 1
 
 #define TRANSMITTER_JF_MIO_PIN 13
 #define TRANSMITTER_MIO_HIGH 1
 #define TRANSMITTER_MIO_LOW 0
 
+// Phase accumulator: the top TRANSMITTER_DDS_LUT_BITS bits of the phase index the output table.
+#define TRANSMITTER_DDS_LUT_SIZE (1 << TRANSMITTER_DDS_LUT_BITS)
+#define TRANSMITTER_DDS_INDEX_SHIFT (32 - TRANSMITTER_DDS_LUT_BITS)
+#define TRANSMITTER_DDS_PHASE_RANGE 4294967296.0        // 2^32: one cycle of the output.
+#define TRANSMITTER_DDS_NO_CHANGE 0                     // In transmitter_dds_next_change: the output never changes.
+
 #define TRANSMITTER_FIRE_TIME_TESTING 200
 #define TRANSMITTER_TEST_PERIOD_MS 10
 #define TRANSMITTER_TEST_MS_DELAY 300
@@ -27,18 +41,50 @@ enum transmitter_st_t
     transmitter_fire_low_st
 } transmitter_current_state = transmitter_idle_st;
 
-volatile static uint32_t transmitter_frequency;
-volatile static uint32_t transmitter_timer;
-volatile static uint32_t transmitter_high_timer;
-volatile static uint32_t transmitter_low_timer;
+// The output table (one period of the wave) and, for each entry, the index (counted on past the end
+// of the table) of the next entry with a different output.
+static uint8_t transmitter_dds_lut[TRANSMITTER_DDS_LUT_SIZE];
+static uint16_t transmitter_dds_next_change[TRANSMITTER_DDS_LUT_SIZE];
+
+// Phase increment per tick for each of the filter's players.
+static uint32_t transmitter_player_increments[FILTER_FREQUENCY_COUNT];
+
+// Settings; taken up at the start of each pulse.
+volatile static uint32_t transmitter_frequency;         // Phase increment per tick.
+volatile static uint16_t transmitter_frequency_number;
+volatile static uint32_t transmitter_burst_code;
+volatile static uint8_t transmitter_burst_bits;         // 0: no burst code.
+volatile static uint32_t transmitter_burst_chip_ticks;
+
+// The pulse going out.
+static uint32_t transmitter_phase_increment;
+static uint32_t transmitter_phase;                      // Phase at the last edge.
+static uint32_t transmitter_edge_ticks;                 // Ticks from the last edge to the pending one.
+static uint32_t transmitter_edge_tick;                  // timerWheel_now() at the last edge.
+static uint8_t transmitter_level;                       // Table output at the current phase.
+static bool transmitter_gate;                           // Current chip of the burst code.
+static uint32_t transmitter_pulse_code;
+static uint8_t transmitter_pulse_bits;
+static uint32_t transmitter_pulse_chip_ticks;
+static uint8_t transmitter_chip;
+
+static timerWheel_timer_t transmitter_edge_timer;       // Next change of the table output (or a start).
+static timerWheel_timer_t transmitter_chip_timer;       // Next chip of the burst code.
+static timerWheel_timer_t transmitter_pulse_timer;      // End of the pulse.
+static timerWheel_timer_t transmitter_retune_timer;     // A new frequency in continuous mode.
+
 volatile static bool transmitter_is_running;
 volatile static bool transmitter_trigger_detected;
 volatile static bool transmitter_continuous_mode;
 volatile static bool transmitter_test_mode;
 
-// The transmitter state machine generates a square wave output at the chosen frequency
-// as set by transmitter_setFrequencyNumber(). The step counts for the frequencies
-// are provided in filter.h
+// The transmitter generates a square wave at the chosen frequency as set by
+// transmitter_setFrequencyNumber() or transmitter_setFrequencyHz(). It is a direct digital
+// synthesizer: a 32-bit phase accumulator advances by frequency / 100 kHz * 2^32 per tick and
+// its top bits index an output table. Instead of adding every tick, a timer wheel callback
+// jumps the accumulator straight to the tick on which the table output next changes, so the
+// pin switches on exactly the ticks a per-tick accumulator would switch it and nothing runs
+// in between. An optional burst code gates the wave on and off, one bit per chip.
 
 void transmitter_debug_print()
 {
@@ -53,170 +99,286 @@ void transmitter_debug_print()
         switch(transmitter_current_state)
         {
             case transmitter_idle_st:
-                printf("transmitter_idle_st\n\r");
+                TRANSMITTER_LOG("transmitter_idle_st\n\r");
                 break;
 
             case transmitter_fire_high_st:
-                printf("transmitter_fire_high_st\n\r");
+                TRANSMITTER_LOG("transmitter_fire_high_st\n\r");
                 break;
 
             case transmitter_fire_low_st:
-                printf("transmitter_fire_low_st\n\r");
+                TRANSMITTER_LOG("transmitter_fire_low_st\n\r");
                 break;
         }
     }
 }
 
-// Standard init function.
-void transmitter_init()
+// Fills the output table with a square wave and works out where its output changes.
+static void transmitter_initDds()
 {
-    transmitter_is_running = false;
-    transmitter_trigger_detected = false;
-    transmitter_continuous_mode = false;
-    transmitter_test_mode = false;
-    transmitter_frequency = TRANSMITTER_FREQUENCY_CLEAR;
-    transmitter_timer = TRANSMITTER_HIGH_TIMER_CLEAR;
-    transmitter_high_timer = TRANSMITTER_HIGH_TIMER_CLEAR;
-    transmitter_low_timer = TRANSMITTER_LOW_TIMER_CLEAR;
+    for (uint16_t i = 0; i < TRANSMITTER_DDS_LUT_SIZE; i++)
+    {
+        transmitter_dds_lut[i] = (i < TRANSMITTER_DDS_LUT_SIZE / 2) ? TRANSMITTER_MIO_HIGH : TRANSMITTER_MIO_LOW;
+    }
 
-    mio_init(false);
-    mio_setPinAsOutput(TRANSMITTER_JF_MIO_PIN);
+    for (uint16_t i = 0; i < TRANSMITTER_DDS_LUT_SIZE; i++)
+    {
+        transmitter_dds_next_change[i] = TRANSMITTER_DDS_NO_CHANGE;
+        for (uint16_t j = i + 1; j <= i + TRANSMITTER_DDS_LUT_SIZE; j++)
+        {
+            if (transmitter_dds_lut[j % TRANSMITTER_DDS_LUT_SIZE] != transmitter_dds_lut[i])
+            {
+                transmitter_dds_next_change[i] = j;
+                break;
+            }
+        }
+    }
 }
 
-// Starts the transmitter.
-void transmitter_run()
+// Drives the pin from the table output and the burst code.
+static void transmitter_writeOutput()
 {
-    transmitter_trigger_detected = true;
-    transmitter_is_running = true;
+    bool high = transmitter_level && transmitter_gate;
+    mio_writePin(TRANSMITTER_JF_MIO_PIN, high ? TRANSMITTER_MIO_HIGH : TRANSMITTER_MIO_LOW);
+    transmitter_current_state = high ? transmitter_fire_high_st : transmitter_fire_low_st;
 }
 
-// Returns true if the transmitter is still running.
-bool transmitter_running()
+// Schedules the edge timer for the first tick on which the table output differs from the
+// output at the current phase. Nothing is scheduled if it never will.
+static void transmitter_scheduleEdge(timerWheel_timer_t* timer)
 {
-    return transmitter_is_running;
+    uint16_t nextChange = transmitter_dds_next_change[transmitter_phase >> TRANSMITTER_DDS_INDEX_SHIFT];
+    if (transmitter_phase_increment == 0 || nextChange == TRANSMITTER_DDS_NO_CHANGE)
+    {
+        return;
+    }
+    uint64_t distance = ((uint64_t) nextChange << TRANSMITTER_DDS_INDEX_SHIFT) - transmitter_phase;
+    uint64_t ticks = (distance + transmitter_phase_increment - 1) / transmitter_phase_increment;
+    transmitter_edge_ticks = (ticks < TRANSMITTER_MIN_EDGE_TICKS) ? TRANSMITTER_MIN_EDGE_TICKS : (uint32_t) ticks;
+    transmitter_edge_tick = timerWheel_now();
+    timerWheel_scheduleFromIsr(timer, transmitter_edge_ticks);
 }
 
-// Sets the frequency number. If this function is called while the
-// transmitter is running, the frequency will not be updated until the
-// transmitter stops and transmitter_run() is called again.
-void transmitter_setFrequencyNumber(uint16_t frequencyNumber)
+// Brings the phase up to the current tick (the pending edge is dropped).
+static void transmitter_catchUpPhase()
 {
-    transmitter_frequency = filter_frequencyTickTable[frequencyNumber % FILTER_FREQUENCY_COUNT]/2;
+    timerWheel_cancelFromIsr(&transmitter_edge_timer);
+    transmitter_phase += transmitter_phase_increment * (timerWheel_now() - transmitter_edge_tick);
+    transmitter_edge_tick = timerWheel_now();
 }
 
-// Standard tick function.
-void transmitter_tick()
+// Takes up the frequency and burst code settings.
+static void transmitter_loadSettings()
 {
-    //if (transmitter_test_mode)
-      //  transmitter_debug_print();
+    transmitter_phase_increment = transmitter_frequency;
+    transmitter_pulse_code = transmitter_burst_code;
+    transmitter_pulse_bits = transmitter_burst_bits;
+    transmitter_pulse_chip_ticks = transmitter_burst_chip_ticks;
+}
 
-    switch (transmitter_current_state)
+// Starts the burst code from its first chip (or leaves the wave ungated).
+static void transmitter_startBurst()
+{
+    transmitter_chip = 0;
+    transmitter_gate = true;
+    timerWheel_cancelFromIsr(&transmitter_chip_timer);
+    if (transmitter_pulse_bits > 0)
     {
-        case transmitter_idle_st:
-            if (transmitter_trigger_detected)
-            {
-                transmitter_trigger_detected = false;
-                mio_writePin(TRANSMITTER_JF_MIO_PIN, TRANSMITTER_MIO_HIGH);
-                transmitter_current_state = transmitter_fire_high_st;
-            }
-
-            else
-            {
-                transmitter_current_state = transmitter_idle_st;
-            }
+        transmitter_gate = (transmitter_pulse_code >> (transmitter_pulse_bits - 1)) & 1;
+        timerWheel_scheduleFromIsr(&transmitter_chip_timer, transmitter_pulse_chip_ticks);
+    }
+}
 
-            break;
+// Timer wheel callback: the next chip of the burst code, most significant bit first, repeating.
+static void transmitter_nextChip(timerWheel_timer_t* timer)
+{
+    transmitter_chip = (transmitter_chip + 1) % transmitter_pulse_bits;
+    transmitter_gate = (transmitter_pulse_code >> (transmitter_pulse_bits - 1 - transmitter_chip)) & 1;
+    transmitter_writeOutput();
+    timerWheel_scheduleFromIsr(timer, transmitter_pulse_chip_ticks);
+}
 
-        case transmitter_fire_high_st:
-            if (transmitter_timer >= TRANSMITTER_FIRE_TIME && !transmitter_continuous_mode)
-            {
-                transmitter_timer = TRANSMITTER_TIMER_CLEAR;
-                transmitter_high_timer = TRANSMITTER_HIGH_TIMER_CLEAR;
-                mio_writePin(TRANSMITTER_JF_MIO_PIN, TRANSMITTER_MIO_LOW);
-                transmitter_current_state = transmitter_idle_st;
-            }
+// Timer wheel callback: starts a pulse, or advances the phase to the pending edge and switches the output.
+static void transmitter_edge(timerWheel_timer_t* timer)
+{
+    if (transmitter_current_state == transmitter_idle_st)
+    {
+        transmitter_trigger_detected = false;
+        transmitter_loadSettings();
+        transmitter_phase = 0;
+        transmitter_startBurst();
+        timerWheel_scheduleFromIsr(&transmitter_pulse_timer, TRANSMITTER_FIRE_TIME);
+    }
 
-            else if (transmitter_high_timer >= transmitter_frequency)
-            {
-                transmitter_high_timer = TRANSMITTER_HIGH_TIMER_CLEAR;
-                mio_writePin(TRANSMITTER_JF_MIO_PIN, TRANSMITTER_MIO_LOW);
-                if (transmitter_test_mode)
-                    printf("\n");
-                transmitter_current_state = transmitter_fire_low_st;
-            }
+    else
+    {
+        transmitter_phase += transmitter_phase_increment * transmitter_edge_ticks;
+    }
 
-            else
-            {
-                transmitter_current_state = transmitter_fire_high_st;
-            }
-            
-            break;
+    transmitter_level = transmitter_dds_lut[transmitter_phase >> TRANSMITTER_DDS_INDEX_SHIFT];
+    transmitter_writeOutput();
+    transmitter_scheduleEdge(timer);
 
-        case transmitter_fire_low_st:
-            if (transmitter_timer >= TRANSMITTER_FIRE_TIME && !transmitter_continuous_mode)
-            {
-                transmitter_timer = TRANSMITTER_TIMER_CLEAR;
-                transmitter_low_timer = TRANSMITTER_LOW_TIMER_CLEAR;
-                mio_writePin(TRANSMITTER_JF_MIO_PIN, TRANSMITTER_MIO_LOW);
-                transmitter_current_state = transmitter_idle_st;
-            }
+    if (transmitter_test_mode)
+    {
+        transmitter_debug_print();
+        TRANSMITTER_LOG("%ld for %lu ticks\n\r", (long) transmitter_level, (unsigned long) transmitter_edge_ticks);
+    }
+}
 
-            else if (transmitter_low_timer >= transmitter_frequency)
-            {
-                transmitter_low_timer = TRANSMITTER_LOW_TIMER_CLEAR;
-                mio_writePin(TRANSMITTER_JF_MIO_PIN, TRANSMITTER_MIO_HIGH);
-                if (transmitter_test_mode)
-                    printf("\n");
-                transmitter_current_state = transmitter_fire_high_st;
-            }
+// Timer wheel callback: in continuous mode a new frequency takes over straight away, the phase
+// carrying on from where the old one left it.
+static void transmitter_retune(timerWheel_timer_t* timer)
+{
+    (void) timer;
+    if (!transmitter_continuous_mode || transmitter_current_state == transmitter_idle_st)
+    {
+        return; // The next pulse loads the new frequency.
+    }
+    transmitter_catchUpPhase();
+    transmitter_phase_increment = transmitter_frequency;
+    transmitter_level = transmitter_dds_lut[transmitter_phase >> TRANSMITTER_DDS_INDEX_SHIFT];
+    transmitter_writeOutput();
+    transmitter_scheduleEdge(&transmitter_edge_timer);
+}
 
-            else
-            {
-                transmitter_current_state = transmitter_fire_low_st;
-            }
+// Timer wheel callback: the pulse is over. In continuous mode the next pulse follows on with the
+// latest settings; otherwise the output goes low, and another pulse is sent only if
+// transmitter_run() was called during this one.
+static void transmitter_pulseEnd(timerWheel_timer_t* timer)
+{
+    if (transmitter_continuous_mode)
+    {
+        transmitter_catchUpPhase();
+        transmitter_loadSettings();
+        transmitter_startBurst();
+        transmitter_level = transmitter_dds_lut[transmitter_phase >> TRANSMITTER_DDS_INDEX_SHIFT];
+        transmitter_writeOutput();
+        transmitter_scheduleEdge(&transmitter_edge_timer);
+        timerWheel_scheduleFromIsr(timer, TRANSMITTER_FIRE_TIME);
+        return;
+    }
 
-            break;
+    timerWheel_cancelFromIsr(&transmitter_edge_timer);
+    timerWheel_cancelFromIsr(&transmitter_chip_timer);
+    mio_writePin(TRANSMITTER_JF_MIO_PIN, TRANSMITTER_MIO_LOW);
+    transmitter_current_state = transmitter_idle_st;
+    if (transmitter_test_mode)
+        transmitter_debug_print();
 
-        default:
-            transmitter_timer = TRANSMITTER_HIGH_TIMER_CLEAR;
-            transmitter_high_timer = TRANSMITTER_HIGH_TIMER_CLEAR;
-            transmitter_low_timer = TRANSMITTER_LOW_TIMER_CLEAR;
-            transmitter_current_state = transmitter_idle_st;
-            break;
+    // transmitter_run() was called during the pulse: send another one.
+    if (transmitter_trigger_detected)
+    {
+        timerWheel_scheduleFromIsr(&transmitter_edge_timer, TRANSMITTER_MIN_EDGE_TICKS);
     }
 
-    switch (transmitter_current_state)
+    else
     {
-        case transmitter_idle_st:
-            transmitter_is_running = false;
-            break;
+        transmitter_is_running = false;
+    }
+}
 
-        case transmitter_fire_high_st:
-            transmitter_is_running = true;
-            transmitter_timer++;
-            transmitter_high_timer++;
+// Standard init function.
+void transmitter_init()
+{
+    transmitter_is_running = false;
+    transmitter_trigger_detected = false;
+    transmitter_continuous_mode = false;
+    transmitter_test_mode = false;
+    transmitter_frequency_number = TRANSMITTER_FREQUENCY_NUMBER_NONE; // The first transmitter_setFrequencyNumber() always applies.
+    transmitter_frequency = transmitter_phaseIncrement(TRANSMITTER_FREQUENCY_CLEAR);
+    for (uint16_t i = 0; i < FILTER_FREQUENCY_COUNT; i++)
+    {
+        transmitter_player_increments[i] = transmitter_phaseIncrement(TRANSMITTER_TICK_RATE_HZ / filter_frequencyTickTable[i]);
+    }
+    transmitter_burst_bits = TRANSMITTER_NO_BURST_CODE;
+    transmitter_current_state = transmitter_idle_st;
+    transmitter_initDds();
+    timerWheel_initTimer(&transmitter_edge_timer, transmitter_edge, NULL);
+    timerWheel_initTimer(&transmitter_chip_timer, transmitter_nextChip, NULL);
+    timerWheel_initTimer(&transmitter_pulse_timer, transmitter_pulseEnd, NULL);
+    timerWheel_initTimer(&transmitter_retune_timer, transmitter_retune, NULL);
 
-            if (transmitter_test_mode)
-            {
-                transmitter_debug_print();
-                printf("1");
-            }
+    mio_init(false);
+    mio_setPinAsOutput(TRANSMITTER_JF_MIO_PIN);
+}
 
-            break;
+// Starts the transmitter.
+void transmitter_run()
+{
+    eventJournal_append(EVENT_JOURNAL_SHOT, (uint8_t) transmitter_frequency_number, 0, 0);
+    transmitter_trigger_detected = true;
+    // A run while a pulse is going out is picked up when that pulse ends.
+    if (!transmitter_is_running)
+    {
+        transmitter_is_running = true;
+        timerWheel_schedule(&transmitter_edge_timer, TRANSMITTER_MIN_EDGE_TICKS);
+    }
+}
 
-        case transmitter_fire_low_st:
-            transmitter_is_running = true;
-            transmitter_timer++;
-            transmitter_low_timer++;
+// Returns true if the transmitter is still running.
+bool transmitter_running()
+{
+    return transmitter_is_running;
+}
 
-            if (transmitter_test_mode)
-            {
-                transmitter_debug_print();
-                printf("0");
-            }
+// Has a continuous transmission switch to a frequency just set (see transmitter_retune()).
+static void transmitter_requestRetune()
+{
+    if (transmitter_continuous_mode && transmitter_is_running)
+    {
+        timerWheel_schedule(&transmitter_retune_timer, TRANSMITTER_MIN_EDGE_TICKS);
+    }
+}
 
-            break;
+// Sets the frequency number. If this function is called while the
+// transmitter is running, the frequency will not be updated until the
+// transmitter stops and transmitter_run() is called again (in continuous
+// mode it is updated on the next tick).
+void transmitter_setFrequencyNumber(uint16_t frequencyNumber)
+{
+    frequencyNumber %= FILTER_FREQUENCY_COUNT;
+    // The main loop sets the frequency on every pass; only actual changes do anything.
+    if (frequencyNumber == transmitter_frequency_number)
+    {
+        return;
     }
+    eventJournal_append(EVENT_JOURNAL_FREQUENCY_CHANGE, (uint8_t) frequencyNumber, 0, 0);
+    transmitter_frequency_number = frequencyNumber;
+    transmitter_frequency = transmitter_player_increments[frequencyNumber];
+    transmitter_requestRetune();
+}
+
+// Sets any frequency below TRANSMITTER_MAX_FREQUENCY_HZ, fractions of a hertz included (for players
+// beyond the filter's table). Takes effect like transmitter_setFrequencyNumber().
+void transmitter_setFrequencyHz(double frequencyHz)
+{
+    // Not one of the players: shots are journaled as TRANSMITTER_FREQUENCY_NUMBER_NONE.
+    transmitter_frequency_number = TRANSMITTER_FREQUENCY_NUMBER_NONE;
+    transmitter_frequency = transmitter_phaseIncrement(frequencyHz);
+    transmitter_requestRetune();
+}
+
+// Returns the phase increment per tick for a frequency (clamped to 0..TRANSMITTER_MAX_FREQUENCY_HZ).
+uint32_t transmitter_phaseIncrement(double frequencyHz)
+{
+    if (frequencyHz <= 0.0)
+        return 0;
+    if (frequencyHz > TRANSMITTER_MAX_FREQUENCY_HZ)
+        frequencyHz = TRANSMITTER_MAX_FREQUENCY_HZ;
+    return (uint32_t) (frequencyHz / TRANSMITTER_TICK_RATE_HZ * TRANSMITTER_DDS_PHASE_RANGE + 0.5);
+}
+
+// Gates the wave with a burst code identifying the shooter: bitCount bits of code, most
+// significant first, each lasting chipTicks ticks, repeated for the whole pulse. A bitCount of
+// TRANSMITTER_NO_BURST_CODE sends the plain wave. Takes effect like transmitter_setFrequencyNumber().
+void transmitter_setBurstCode(uint32_t code, uint8_t bitCount, uint32_t chipTicks)
+{
+    if (bitCount > TRANSMITTER_MAX_BURST_BITS)
+        bitCount = TRANSMITTER_MAX_BURST_BITS;
+    transmitter_burst_code = code;
+    transmitter_burst_chip_ticks = (chipTicks < TRANSMITTER_MIN_EDGE_TICKS) ? TRANSMITTER_MIN_EDGE_TICKS : chipTicks;
+    transmitter_burst_bits = bitCount;
 }
 
 // Runs the transmitter continuously.
@@ -224,7 +386,7 @@ void transmitter_tick()
 // To set continuous mode, you must invoke this function prior to calling transmitter_run().
 // If the transmitter is in currently in continuous mode, it will stop running if this function is
 // invoked with continuousModeFlag == false. It can stop immediately or wait until the last 200 ms pulse is complete.
-// NOTE: while running continuously, the transmitter will change frequencies at the end of each 200 ms pulse.
+// NOTE: while running continuously, the transmitter changes frequency on the tick after it is set.
 void transmitter_setContinuousMode(bool continuousModeFlag)
 {
     transmitter_continuous_mode = continuousModeFlag;
@@ -262,7 +424,10 @@ void transmitter_runTest()
             transmitter_run();
 
             // Not continuous mode.
-            while (transmitter_running() && !(buttons_read() & BUTTONS_BTN1_MASK)) {}
+            while (transmitter_running() && !(buttons_read() & BUTTONS_BTN1_MASK))
+            {
+                deferredLog_drain(stdout, DEFERRED_LOG_DRAIN_ALL);  // Print the test-mode trace.
+            }
             utils_msDelay(TRANSMITTER_TEST_MS_DELAY);
         }
 
@@ -285,6 +450,7 @@ void transmitter_runTest()
             uint16_t switchValue = switches_read() % FILTER_FREQUENCY_COUNT;
 
             transmitter_setFrequencyNumber(switchValue);
+            deferredLog_drain(stdout, DEFERRED_LOG_DRAIN_ALL);
         }
 
 
@@ -3,11 +3,25 @@
 
 #define TRANSMITTER_OUTPUT_PIN 13			// JF1 (pg. 25 of ZYBO reference manual).
 #define TRANSMITTER_PULSE_WIDTH 20000	// Based on a system tick-rate of 100 kHz.
+#define TRANSMITTER_TICK_RATE_HZ 100000.0
+#define TRANSMITTER_MAX_FREQUENCY_HZ 50000.0	// Half the tick rate.
+#define TRANSMITTER_DDS_LUT_BITS 8			// The output table has 2^8 entries per period.
+#define TRANSMITTER_NO_BURST_CODE 0
+#define TRANSMITTER_MAX_BURST_BITS 32
+#define TRANSMITTER_FREQUENCY_NUMBER_NONE 0xFF	// Journaled player of shots set with transmitter_setFrequencyHz().
+
+// Uncomment to log the test-mode trace (transmitter_enableTestMode()) through the deferred log
+// (with DEFERRED_LOG_ENABLED, see Common/deferredLog.h). Without it test mode prints nothing: the
+// trace comes from the timer wheel callbacks, which must not wait on the UART.
+//#define TRANSMITTER_LOG_ENABLED
+
 #include <stdint.h>
 
 // The transmitter state machine generates a square wave output at the chosen frequency
 // as set by transmitter_setFrequencyNumber(). The step counts for the frequencies
-// are provided in filter.h
+// are provided in filter.h. The wave comes from a 32-bit phase accumulator and an
+// output table, so any frequency can be set with transmitter_setFrequencyHz(), and the
+// wave can be keyed with a burst code identifying the shooter.
 
 // Standard init function.
 void transmitter_init();
@@ -20,22 +34,33 @@ bool transmitter_running();
 
 // Sets the frequency number. If this function is called while the
 // transmitter is running, the frequency will not be updated until the
-// transmitter stops and transmitter_run() is called again.
+// transmitter stops and transmitter_run() is called again (in continuous
+// mode it is updated on the next tick).
 void transmitter_setFrequencyNumber(uint16_t frequencyNumber);
 
-// Standard tick function.
-void transmitter_tick();
+// Sets any frequency below TRANSMITTER_MAX_FREQUENCY_HZ, fractions of a hertz included (for players
+// beyond the filter's table). Takes effect like transmitter_setFrequencyNumber(); shots are then
+// journaled with player TRANSMITTER_FREQUENCY_NUMBER_NONE.
+void transmitter_setFrequencyHz(double frequencyHz);
+
+// Returns the phase increment per tick for a frequency (clamped to 0..TRANSMITTER_MAX_FREQUENCY_HZ).
+uint32_t transmitter_phaseIncrement(double frequencyHz);
+
+// Gates the wave with a burst code identifying the shooter: bitCount bits of code, most
+// significant first, each lasting chipTicks ticks, repeated for the whole pulse. A bitCount of
+// TRANSMITTER_NO_BURST_CODE sends the plain wave. Takes effect like transmitter_setFrequencyNumber().
+void transmitter_setBurstCode(uint32_t code, uint8_t bitCount, uint32_t chipTicks);
 
 // Runs the transmitter continuously.
 // if continuousModeFlag == true, transmitter runs continuously, otherwise, transmits one pulse-width and stops.
 // To set continuous mode, you must invoke this function prior to calling transmitter_run().
 // If the transmitter is in currently in continuous mode, it will stop running if this function is
 // invoked with continuousModeFlag == false. It can stop immediately or wait until the last 200 ms pulse is complete.
-// NOTE: while running continuously, the transmitter will change frequencies at the end of each 200 ms pulse.
+// NOTE: while running continuously, the transmitter changes frequency on the tick after it is set.
 void transmitter_setContinuousMode(bool continuousModeFlag);
 
 // This is provided for testing as explained in the transmitter section of the web-page. When enabled,
-// debug prints are enabled to help to demonstrate the behavior of the transmitter.
+// debug prints are enabled to help to demonstrate the behavior of the transmitter (see TRANSMITTER_LOG_ENABLED).
 void transmitter_enableTestMode();
 
 // This is provided for testing as explained in the transmitter section of the web-page. When disabled,
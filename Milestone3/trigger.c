@@ -6,14 +6,33 @@
 #include <stdio.h>
 #include "trigger.h"
 #include "transmitter.h"
+#include "timerWheel.h"
+#include "oneShotTimer.h"
+#include "gpioEdge.h"
 #include "../Lab2/buttons.h"
 #include "supportFiles/utils.h"
 #include "supportFiles/mio.h"
+#include "deferredLog.h"
 
-// Required defines for defining the fire time and debouncing the timers.
-#define FIRE_TIME_UP 50000
-#define PULL_TIME_UP 3000
-#define RELEASE_TIME_UP 3000
+// triggerControl_stateDebugPrint() goes to the deferred log (Common/deferredLog.h), if TRIGGER_LOG_ENABLED.
+#if defined(DEFERRED_LOG_ENABLED) && defined(TRIGGER_LOG_ENABLED)
+#define TRIGGER_LOG DEFERRED_LOG
+#else
+#define TRIGGER_LOG(...)
+#endif
+
+// The state machine is run by a timer wheel callback every TRIGGER_POLL_TICKS ticks (100 us) rather than every tick.
+#define TRIGGER_POLL_TICKS 10
+
+// Required defines for defining the fire time and debouncing the timers (in polls).
+#define FIRE_TIME_UP (50000 / TRIGGER_POLL_TICKS)
+#define PULL_TIME_UP (3000 / TRIGGER_POLL_TICKS)
+#define RELEASE_TIME_UP (3000 / TRIGGER_POLL_TICKS)
+
+// Debounce and fire times in timer wheel ticks for the edge-interrupt trigger.
+#define TRIGGER_EDGE_PULL_TICKS 3000
+#define TRIGGER_EDGE_RELEASE_TICKS 3000
+#define TRIGGER_EDGE_FIRE_TICKS 50000
 
 // Required defines for initial value, MIO pin, and MIO pin output when the trigger is pressed.
 #define INITIAL 0
@@ -33,6 +52,26 @@ volatile static uint16_t pullCount;
 volatile static uint16_t fireCount;
 volatile uint16_t releaseCount;
 
+#ifdef TRIGGER_EDGE_INTERRUPTS_ENABLED
+// Raw input levels (updated on each edge) and when the last edge happened.
+volatile static uint8_t triggerGunLevel;
+volatile static uint8_t triggerButtonLevel;
+volatile static uint32_t triggerLastEdgeTick;
+
+// Debounced state; a debounce timer is pending from the first edge until the input is settled.
+volatile static bool triggerDebouncedPressed;
+volatile static bool triggerDebouncePending;
+static timerWheel_timer_t triggerDebounceTimer;
+static void trigger_debounce(timerWheel_timer_t* timer);
+
+// Holds off another shot until a fire time after the last one.
+static oneShotTimer_t triggerFireHold;
+#else
+// Runs the state machine while the trigger is enabled.
+static timerWheel_timer_t triggerPollTimer;
+static void trigger_poll(timerWheel_timer_t* timer);
+#endif
+
 // Enum used to control the states of the trigger state machine.
 enum triggerControl_st {
     triggerControl_idle_st, //We want an idle state
@@ -66,16 +105,126 @@ void trigger_init() {
     if(triggerPressed()) {
         ignoreGunInput = true;
     }
+
+    // Rearmed below: the trigger is live from init, as it was when the ISR ticked it.
+    triggerEnable_g = false;
+#ifdef TRIGGER_EDGE_INTERRUPTS_ENABLED
+    timerWheel_initTimer(&triggerDebounceTimer, trigger_debounce, NULL);
+    triggerDebouncePending = false;
+    triggerDebouncedPressed = false;
+    oneShotTimer_stop(&triggerFireHold);
+#else
+    timerWheel_initTimer(&triggerPollTimer, trigger_poll, NULL);
+#endif
+    trigger_enable();
+}
+
+#ifdef TRIGGER_EDGE_INTERRUPTS_ENABLED
+/*********************************************************************************************************/
+/* Function: trigger_inputPressed                                                                        */
+/* Purpose: To provide the raw state of the trigger from the levels recorded at the last edges.          */
+/* Returns: A boolean value specifying if the trigger is pulled.                                         */
+/*********************************************************************************************************/
+static bool trigger_inputPressed() {
+    return (!ignoreGunInput && (triggerGunLevel == GUN_TRIGGER_PRESSED)) || triggerButtonLevel;
+}
+
+/*********************************************************************************************************/
+/* Function: trigger_recordEdge                                                                          */
+/* Purpose: To note that an input changed at tick and, unless a debounce is already pending, to check    */
+/*          the input again once it could have settled. Bounces only move the last edge tick.            */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void trigger_recordEdge(uint32_t tick) {
+    triggerLastEdgeTick = tick;
+    if(!__atomic_exchange_n(&triggerDebouncePending, true, __ATOMIC_ACQ_REL)) {
+        timerWheel_schedule(&triggerDebounceTimer, triggerDebouncedPressed ? TRIGGER_EDGE_RELEASE_TICKS : TRIGGER_EDGE_PULL_TICKS);
+    }
+}
+
+/*********************************************************************************************************/
+/* Function: trigger_gunEdge                                                                             */
+/* Purpose: GPIO edge callback for the gun trigger pin.                                                  */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void trigger_gunEdge(uint8_t pin, uint8_t level, uint32_t tick) {
+    (void) pin;
+    triggerGunLevel = level;
+    trigger_recordEdge(tick);
 }
 
+/*********************************************************************************************************/
+/* Function: trigger_debounce                                                                            */
+/* Purpose: Timer wheel callback, due a debounce time after the first edge. If the input has changed     */
+/*          since, it waits until a debounce time after the last edge; once it is quiet that long, the   */
+/*          debounced state follows the input and a new press fires the transmitter.                     */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+static void trigger_debounce(timerWheel_timer_t* timer) {
+    uint32_t needed = triggerDebouncedPressed ? TRIGGER_EDGE_RELEASE_TICKS : TRIGGER_EDGE_PULL_TICKS;
+    uint32_t lastEdgeTick = triggerLastEdgeTick;
+    uint32_t quiet = timerWheel_now() - lastEdgeTick;
+    if(quiet < needed) {
+        timerWheel_scheduleFromIsr(timer, needed - quiet); // Still bouncing: check again later.
+        return;
+    }
+    __atomic_store_n(&triggerDebouncePending, false, __ATOMIC_SEQ_CST);
+    bool pressed = trigger_inputPressed();
+    if(pressed != triggerDebouncedPressed) {
+        triggerDebouncedPressed = pressed;
+        if(pressed && !oneShotTimer_running(&triggerFireHold)) {
+            transmitter_run(); // Fire the gun!!!!
+            oneShotTimer_start(&triggerFireHold, TRIGGER_EDGE_FIRE_TICKS);
+        }
+    }
+    // An edge that came in while the debounce was finishing saw it pending: check it now.
+    if(triggerLastEdgeTick != lastEdgeTick && !__atomic_exchange_n(&triggerDebouncePending, true, __ATOMIC_ACQ_REL)) {
+        timerWheel_scheduleFromIsr(timer, triggerDebouncedPressed ? TRIGGER_EDGE_RELEASE_TICKS : TRIGGER_EDGE_PULL_TICKS);
+    }
+}
+#endif
+
 /*********************************************************************************************************/
 /* Function: trigger_enable                                                                              */
 /* Purpose: To enable the trigger state machine.                                                         */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
 void trigger_enable() {
-    // Set the trigger enable variable to true.
-    triggerEnable_g = true;
+#ifdef TRIGGER_EDGE_INTERRUPTS_ENABLED
+    // Take the current levels and listen for edges; nothing runs until one comes in.
+    if(!triggerEnable_g) {
+        triggerEnable_g = true;
+        triggerGunLevel = mio_readPin(TRIGGER_GUN_TRIGGER_MIO_PIN);
+        triggerButtonLevel = (buttons_read() & BUTTONS_BTN0_MASK) ? 1 : 0;
+        triggerDebouncedPressed = trigger_inputPressed();
+        if(!ignoreGunInput && !(gpioEdge_init() && gpioEdge_enablePin(TRIGGER_GUN_TRIGGER_MIO_PIN, trigger_gunEdge))) {
+            printf("trigger_enable: gun trigger edge interrupt unavailable.\n\r");
+        }
+    }
+#else
+    // Set the trigger enable variable to true and start polling the trigger.
+    if(!triggerEnable_g) {
+        triggerEnable_g = true;
+        timerWheel_schedule(&triggerPollTimer, TRIGGER_POLL_TICKS);
+    }
+#endif
+}
+
+/*********************************************************************************************************/
+/* Function: trigger_pollButtons                                                                         */
+/* Purpose: To pass changes of btn0 (which has no interrupt) to the edge-interrupt trigger.              */
+/* Returns: VOID                                                                                         */
+/*********************************************************************************************************/
+void trigger_pollButtons() {
+#ifdef TRIGGER_EDGE_INTERRUPTS_ENABLED
+    if(triggerEnable_g) {
+        uint8_t level = (buttons_read() & BUTTONS_BTN0_MASK) ? 1 : 0;
+        if(level != triggerButtonLevel) {
+            triggerButtonLevel = level;
+            trigger_recordEdge(timerWheel_now());
+        }
+    }
+#endif
 }
 
 /*********************************************************************************************************/
@@ -88,6 +237,7 @@ bool trigger_releaseDetected() {
     return touched_g;
 }
 
+#ifndef TRIGGER_EDGE_INTERRUPTS_ENABLED
 /*********************************************************************************************************/
 /* Function: triggerControl_stateDebugPrint                                                              */
 /* Purpose: To print the current state of the state machine.                                             */
@@ -105,26 +255,26 @@ void triggerControl_stateDebugPrint() {
         //Set previous state to current state
         switch (triggerControl_currentState) { //Make a switch statement
         case triggerControl_idle_st: //Idle state case
-            printf("triggerControl_idle_st\n\r"); //Print idle state
+            TRIGGER_LOG("triggerControl_idle_st\n\r"); //Print idle state
             break; //Break
         case triggerControl_debouncePullTimer_st:
             //Wait debounce pull timer state case
-            printf("triggerControl_debouncePullTimer_st\n\r");
+            TRIGGER_LOG("triggerControl_debouncePullTimer_st\n\r");
             //Print debounce timer state
             break; //Break
         case triggerControl_fire_st: //Fire state case
-            printf("triggerControl_fire_st\n\r");
-            printf("D\n\r");
+            TRIGGER_LOG("triggerControl_fire_st\n\r");
+            TRIGGER_LOG("D\n\r");
             //Print the fire state
             break; //Break
         case triggerControl_waitTilReleased_st:
             //Wait til released state case
-            printf("triggerControl_waitTilReleased_st\n\r");
+            TRIGGER_LOG("triggerControl_waitTilReleased_st\n\r");
             //Print wait til released state
             break; //Break
         case triggerControl_debounceReleaseTimer_st: //Debounce release timer state case
-            printf("triggerControl_debounceReleaseTimer_st\n\r"); //Print final state
-            printf("U\n\r");
+            TRIGGER_LOG("triggerControl_debounceReleaseTimer_st\n\r"); //Print final state
+            TRIGGER_LOG("U\n\r");
             break; //Break
         default: //Default case
             break; //Break
@@ -133,11 +283,13 @@ void triggerControl_stateDebugPrint() {
 }
 
 /*********************************************************************************************************/
-/* Function: trigger_tick                                                                                */
+/* Function: trigger_poll                                                                                */
 /* Purpose: To "tick" the state machine. This is the heart of the state machine, controlling actions.    */
+/*          Run by the timer wheel every TRIGGER_POLL_TICKS ticks.                                       */
 /* Returns: VOID                                                                                         */
 /*********************************************************************************************************/
-void trigger_tick() {
+static void trigger_poll(timerWheel_timer_t* timer) {
+    timerWheel_scheduleFromIsr(timer, TRIGGER_POLL_TICKS); // Poll again.
     //triggerControl_stateDebugPrint(); //Call the state debug print
 
     //---------------------------------------->State actions
@@ -240,6 +392,7 @@ void trigger_tick() {
             break; //Break
     }
 }
+#endif
 
 /*********************************************************************************************************/
 /* Function: trigger_runTest                                                                             */
@@ -251,11 +404,15 @@ void trigger_runTest()
     // Inform the user that the trigger test is running.
     printf("Started trigger run test...\n\r");
 
-    // Initialize the trigger.
+    // Initialize and enable the trigger.
     trigger_init();
+    trigger_enable();
 
     // Let the ISR function run the ticks (and keep going until button 1 is pushed).
-    while (!(buttons_read() & BUTTONS_BTN1_MASK)) {}
+    while (!(buttons_read() & BUTTONS_BTN1_MASK)) {
+        trigger_pollButtons(); // btn0 fires too.
+        deferredLog_drain(stdout, DEFERRED_LOG_DRAIN_ALL); // Print the state changes.
+    }
 
     // If button 1 is pushed (the kill button).
     if ((buttons_read() & BUTTONS_BTN1_MASK))
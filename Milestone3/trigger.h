@@ -4,18 +4,29 @@
 // The trigger state machine debounces both the press and release of gun trigger.
 // Ultimately, it will activate the transmitter when a debounced press is detected.
 
+// Uncomment to take the gun trigger from a GPIO edge interrupt instead of polling it every 100 us.
+// Each edge is timestamped and a single timer wheel callback is due a debounce time after it, so
+// the 100 kHz ISR does no trigger work while nobody is pulling the trigger. btn0 has no interrupt;
+// the main loop passes its changes on with trigger_pollButtons().
+//#define TRIGGER_EDGE_INTERRUPTS_ENABLED
+
+// Uncomment to log the polled state machine's state changes (with DEFERRED_LOG_ENABLED, see
+// Common/deferredLog.h).
+//#define TRIGGER_LOG_ENABLED
+
 // Init trigger data-structures.
 // Determines whether the trigger switch of the gun is connected (see discussion in lab web pages).
-// Initializes the mio subsystem.
+// Initializes the mio subsystem. Leaves the trigger enabled (see trigger_enable()).
 void trigger_init();
 
-// Enable the trigger state machine. The trigger state-machine is inactive until this function is called.
-// This allows you to ignore the trigger when helpful (mostly useful for testing).
+// Enable the trigger state machine: starts polling the trigger (or listening for its edges).
+// trigger_init() already does this; calling it again does nothing.
 // I don't have an associated trigger_disable() function because I don't need to disable the trigger.
 void trigger_enable();
 
-// Standard tick function.
-void trigger_tick();
+// Call from the main loop: reports btn0 changes to the edge-interrupt trigger
+// (does nothing unless TRIGGER_EDGE_INTERRUPTS_ENABLED).
+void trigger_pollButtons();
 
 void trigger_runTest();
 
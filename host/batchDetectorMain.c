@@ -0,0 +1,468 @@
+/**********************************************************************************/
+/* File: batchDetectorMain.c                                                      */
+/* Purpose: Offline detector for auditing recorded games. Runs every capture      */
+/*          given on the command line through the detector, split into shards     */
+/*          that are processed in parallel, and prints the merged hit timeline    */
+/*          and per-player totals.                                                */
+/*          See the build notes below the banner.                                 */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/batchDetectorMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/detector.c Milestone3/filter.c Milestone3/isr.c Milestone3/sort.c
+//       Milestone3/lockoutTimer.c Milestone3/hitLedTimer.c Milestone3/timerWheel.c
+//       Milestone3/transmitter.c Milestone3/trigger.c Milestone3/profiler.c
+//       Milestone3/cycleCounter.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o batchDetector
+//
+// Usage:
+//   batchDetector [--threads n] [--shard-seconds s] [--warmup-ms ms]
+//                 [--compare-serial] capture...
+//
+// Each capture is cut into shards of --shard-seconds (60 by default) and every shard is a
+// work item; worker threads pull items off a shared counter, so the load balances itself
+// and the only shared write is that counter. A shard is run on a private detector instance
+// (detector_ctx_t) starting --warmup-ms (1000 by default) before the shard so that the
+// filter history, the power window and any lockout are the same as in a serial run when the
+// shard proper begins. Hits found during the warm-up belong to the previous shard and are
+// not reported. The warm-up must cover the power window (20 ms of samples), so values below
+// about 100 ms can change the result. A lockout chain longer than the warm-up (shots less
+// than half a second apart) is repaired afterwards by a sequential pass that re-runs a
+// shard, seeded with its predecessor's final lockout, only where the two disagree.
+//
+// --compare-serial also runs every capture start to finish on one thread and exits with
+// status 1 if the two timelines differ.
+//
+// Output: one "file<TAB>sample<TAB>seconds<TAB>player" line per hit in time order,
+// followed by the number of hits per player. Timing goes to stderr.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "capture.h"
+#include "detector.h"
+
+#define BATCH_DEFAULT_SHARD_SECONDS 60
+#define BATCH_DEFAULT_WARMUP_MS 1000
+#define BATCH_MAX_THREADS 256
+#define BATCH_BYTES_PER_SAMPLE 2
+#define BATCH_MS_PER_SECOND 1000
+#define BATCH_NS_PER_SECOND 1000000000.0
+#define BATCH_INITIAL_HIT_CAPACITY 64
+
+// Exit codes.
+#define BATCH_OK 0
+#define BATCH_MISMATCH 1
+#define BATCH_ERROR 2
+
+// A capture mapped into memory.
+typedef struct {
+    const char* path;
+    const uint8_t* bytes;       // Raw little-endian samples.
+    uint32_t sampleCount;
+    size_t mappedLength;
+} batch_capture_t;
+
+// One detected hit.
+typedef struct {
+    uint32_t sample;            // Sample index within the capture.
+    int16_t player;
+} batch_hit_t;
+
+// A growable list of hits.
+typedef struct {
+    batch_hit_t* hits;
+    uint32_t count;
+    uint32_t capacity;
+} batch_hitList_t;
+
+// One shard of one capture, plus the hits found in it.
+typedef struct {
+    uint32_t captureIndex;
+    uint32_t begin;             // First sample reported by this shard.
+    uint32_t end;               // One past the last sample.
+    uint32_t lockoutAtBegin;    // Detector lockout left just before begin.
+    uint32_t lockoutAtEnd;      // Detector lockout left after the last sample.
+    batch_hitList_t result;
+} batch_workItem_t;
+
+// Shared by all worker threads. nextItem is the only field written while they run.
+typedef struct {
+    const batch_capture_t* captures;
+    batch_workItem_t* items;
+    uint32_t itemCount;
+    uint32_t warmupSamples;
+    uint32_t nextItem;
+} batch_job_t;
+
+/**********************************************************************************/
+/* Function: readSample                                                           */
+/* Purpose: Decodes sample index of a capture (little-endian, so the result does  */
+/*          not depend on the host byte order or alignment).                      */
+/* Returns: The raw ADC code.                                                     */
+/**********************************************************************************/
+static inline uint16_t readSample(const batch_capture_t* capture, uint32_t index)
+{
+    const uint8_t* bytes = capture->bytes + (size_t) index * BATCH_BYTES_PER_SAMPLE;
+    return (uint16_t) (bytes[0] | (bytes[1] << 8));
+}
+
+/**********************************************************************************/
+/* Function: mapCapture                                                           */
+/* Purpose: Maps a capture file read-only into memory.                            */
+/* Returns: true on success; prints the reason and returns false otherwise.       */
+/**********************************************************************************/
+static bool mapCapture(const char* path, batch_capture_t* capture)
+{
+    capture->path = path;
+    capture->bytes = NULL;
+    capture->sampleCount = 0;
+    capture->mappedLength = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "could not open %s\n", path);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        fprintf(stderr, "could not stat %s\n", path);
+        close(fd);
+        return false;
+    }
+    capture->sampleCount = (uint32_t) (info.st_size / BATCH_BYTES_PER_SAMPLE);
+    capture->mappedLength = (size_t) info.st_size;
+    // An empty file has nothing to map but is still a valid (empty) capture.
+    if (capture->mappedLength > 0)
+    {
+        void* mapping = mmap(NULL, capture->mappedLength, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            fprintf(stderr, "could not map %s\n", path);
+            close(fd);
+            return false;
+        }
+        madvise(mapping, capture->mappedLength, MADV_SEQUENTIAL);
+        capture->bytes = (const uint8_t*) mapping;
+    }
+    close(fd);
+    return true;
+}
+
+/**********************************************************************************/
+/* Function: unmapCapture                                                         */
+/* Purpose: Releases a mapping made by mapCapture().                              */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void unmapCapture(batch_capture_t* capture)
+{
+    if (capture->bytes != NULL)
+    {
+        munmap((void*) capture->bytes, capture->mappedLength);
+        capture->bytes = NULL;
+    }
+}
+
+/**********************************************************************************/
+/* Function: appendHit                                                            */
+/* Purpose: Adds a hit to a list, growing it as needed.                           */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void appendHit(batch_hitList_t* list, uint32_t sample, int16_t player)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = (list->capacity == 0) ? BATCH_INITIAL_HIT_CAPACITY : list->capacity * 2;
+        list->hits = (batch_hit_t*) realloc(list->hits, list->capacity * sizeof(batch_hit_t));
+    }
+    list->hits[list->count].sample = sample;
+    list->hits[list->count].player = player;
+    list->count++;
+}
+
+/**********************************************************************************/
+/* Function: runRange                                                             */
+/* Purpose: Runs samples [start, end) of a capture through the detector as it     */
+/*          stands, keeping only the hits at or after reportFrom.                 */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void runRange(detector_ctx_t* detector, const batch_capture_t* capture,
+                     uint32_t start, uint32_t reportFrom, uint32_t end, batch_hitList_t* hits)
+{
+    for (uint32_t i = start; i < end; i++)
+    {
+        int16_t player = detector_ctx_addSample(detector, readSample(capture, i));
+        if (player != DETECTOR_NO_HIT && i >= reportFrom)
+        {
+            appendHit(hits, i, player);
+        }
+    }
+}
+
+/**********************************************************************************/
+/* Function: runShard                                                             */
+/* Purpose: Runs the warm-up and then the shard proper of a work item on a fresh  */
+/*          detector. If seedLockout is not NULL the lockout found at the end of  */
+/*          the warm-up is replaced by *seedLockout (the previous shard's real    */
+/*          lockout) before the shard proper starts.                              */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void runShard(detector_ctx_t* detector, const batch_capture_t* capture, batch_workItem_t* item,
+                     uint32_t warmupSamples, const uint32_t* seedLockout)
+{
+    uint32_t start = (item->begin > warmupSamples) ? item->begin - warmupSamples : 0;
+    detector_ctx_reset(detector);
+    item->result.count = 0;
+    runRange(detector, capture, start, item->begin, item->begin, &item->result);
+    if (seedLockout != NULL)
+    {
+        detector->lockoutRemaining = *seedLockout;
+    }
+    item->lockoutAtBegin = detector->lockoutRemaining;
+    runRange(detector, capture, item->begin, item->begin, item->end, &item->result);
+    item->lockoutAtEnd = detector->lockoutRemaining;
+}
+
+/**********************************************************************************/
+/* Function: worker                                                               */
+/* Purpose: Thread body: claims work items until none are left and runs each one  */
+/*          on the thread's own detector instance.                                */
+/* Returns: NULL                                                                  */
+/**********************************************************************************/
+static void* worker(void* argument)
+{
+    batch_job_t* job = (batch_job_t*) argument;
+    detector_ctx_t detector;
+    detector_ctx_init(&detector);
+    while (true)
+    {
+        uint32_t index = __atomic_fetch_add(&job->nextItem, 1, __ATOMIC_RELAXED);
+        if (index >= job->itemCount)
+        {
+            break;
+        }
+        batch_workItem_t* item = &job->items[index];
+        runShard(&detector, &job->captures[item->captureIndex], item, job->warmupSamples, NULL);
+    }
+    detector_ctx_destroy(&detector);
+    return NULL;
+}
+
+/**********************************************************************************/
+/* Function: secondsSince                                                         */
+/* Purpose: Wall-clock time elapsed since start.                                  */
+/* Returns: Seconds as a double.                                                  */
+/**********************************************************************************/
+static double secondsSince(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / BATCH_NS_PER_SECOND;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t threadCount = (uint32_t) sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t shardSeconds = BATCH_DEFAULT_SHARD_SECONDS;
+    uint32_t warmupMs = BATCH_DEFAULT_WARMUP_MS;
+    bool compareSerial = false;
+    int firstPath = argc;
+
+    // Parse the command line; everything after the options is a capture.
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--threads") && hasValue)
+            threadCount = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--shard-seconds") && hasValue)
+            shardSeconds = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--warmup-ms") && hasValue)
+            warmupMs = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--compare-serial"))
+            compareSerial = true;
+        else if (argv[i][0] != '-')
+        {
+            firstPath = i;
+            break;
+        }
+        else
+        {
+            firstPath = argc;
+            break;
+        }
+    }
+    if (firstPath >= argc || threadCount == 0 || shardSeconds == 0)
+    {
+        fprintf(stderr, "usage: %s [--threads n] [--shard-seconds s] [--warmup-ms ms] "
+                "[--compare-serial] capture...\n", argv[0]);
+        return BATCH_ERROR;
+    }
+    if (threadCount > BATCH_MAX_THREADS)
+    {
+        threadCount = BATCH_MAX_THREADS;
+    }
+
+    // Map the captures.
+    uint32_t captureCount = (uint32_t) (argc - firstPath);
+    batch_capture_t* captures = (batch_capture_t*) calloc(captureCount, sizeof(batch_capture_t));
+    uint64_t totalSamples = 0;
+    for (uint32_t c = 0; c < captureCount; c++)
+    {
+        if (!mapCapture(argv[firstPath + c], &captures[c]))
+        {
+            return BATCH_ERROR;
+        }
+        totalSamples += captures[c].sampleCount;
+    }
+
+    // Cut every capture into shards, in file then time order so the results merge by concatenation.
+    uint32_t shardSamples = shardSeconds * CAPTURE_SAMPLE_RATE_HZ;
+    uint32_t itemCount = 0;
+    for (uint32_t c = 0; c < captureCount; c++)
+    {
+        itemCount += (captures[c].sampleCount + shardSamples - 1) / shardSamples;
+    }
+    batch_workItem_t* items = (batch_workItem_t*) calloc(itemCount > 0 ? itemCount : 1, sizeof(batch_workItem_t));
+    uint32_t itemIndex = 0;
+    for (uint32_t c = 0; c < captureCount; c++)
+    {
+        for (uint32_t begin = 0; begin < captures[c].sampleCount; begin += shardSamples)
+        {
+            items[itemIndex].captureIndex = c;
+            items[itemIndex].begin = begin;
+            items[itemIndex].end = (captures[c].sampleCount - begin > shardSamples) ? begin + shardSamples : captures[c].sampleCount;
+            itemIndex++;
+        }
+    }
+
+    // Run the shards.
+    batch_job_t job;
+    job.captures = captures;
+    job.items = items;
+    job.itemCount = itemCount;
+    job.warmupSamples = (uint32_t) ((uint64_t) warmupMs * CAPTURE_SAMPLE_RATE_HZ / BATCH_MS_PER_SECOND);
+    job.nextItem = 0;
+    if (threadCount > itemCount && itemCount > 0)
+    {
+        threadCount = itemCount;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_t threads[BATCH_MAX_THREADS];
+    for (uint32_t t = 0; t < threadCount; t++)
+    {
+        pthread_create(&threads[t], NULL, worker, &job);
+    }
+    for (uint32_t t = 0; t < threadCount; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    // The warm-up rebuilds the filter state but not a lockout chain that started before it
+    // (shots closer together than the lockout keep extending it). Walk the shards in order and
+    // re-run any shard that began with a different lockout than its predecessor ended with.
+    uint32_t rerunCount = 0;
+    detector_ctx_t fixupDetector;
+    detector_ctx_init(&fixupDetector);
+    for (uint32_t i = 1; i < itemCount; i++)
+    {
+        batch_workItem_t* previous = &items[i - 1];
+        batch_workItem_t* item = &items[i];
+        if (item->captureIndex == previous->captureIndex && item->lockoutAtBegin != previous->lockoutAtEnd)
+        {
+            runShard(&fixupDetector, &captures[item->captureIndex], item, job.warmupSamples, &previous->lockoutAtEnd);
+            rerunCount++;
+        }
+    }
+    detector_ctx_destroy(&fixupDetector);
+    double parallelSeconds = secondsSince(&start);
+
+    // Merge the timelines and count hits per player.
+    uint32_t playerTotals[FILTER_NUMBER_OF_PLAYERS];
+    memset(playerTotals, 0, sizeof(playerTotals));
+    for (uint32_t i = 0; i < itemCount; i++)
+    {
+        const batch_workItem_t* item = &items[i];
+        for (uint32_t h = 0; h < item->result.count; h++)
+        {
+            const batch_hit_t* hit = &item->result.hits[h];
+            printf("%s\t%u\t%.5f\t%d\n", captures[item->captureIndex].path, hit->sample,
+                   (double) hit->sample / CAPTURE_SAMPLE_RATE_HZ, hit->player);
+            playerTotals[hit->player]++;
+        }
+    }
+    for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+    {
+        printf("player %d: %u hits\n", p, playerTotals[p]);
+    }
+    fprintf(stderr, "%u capture(s), %u shard(s) (%u re-run), %u thread(s): %.2f s of audio in %.3f s (%.1fx real time)\n",
+            captureCount, itemCount, rerunCount, threadCount, (double) totalSamples / CAPTURE_SAMPLE_RATE_HZ,
+            parallelSeconds, (double) totalSamples / CAPTURE_SAMPLE_RATE_HZ / parallelSeconds);
+
+    // Optionally check the sharded timeline against a single start-to-finish pass.
+    int status = BATCH_OK;
+    if (compareSerial)
+    {
+        uint32_t mismatches = 0;
+        detector_ctx_t detector;
+        detector_ctx_init(&detector);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        itemIndex = 0;
+        for (uint32_t c = 0; c < captureCount; c++)
+        {
+            batch_hitList_t serial = {NULL, 0, 0};
+            detector_ctx_reset(&detector);
+            runRange(&detector, &captures[c], 0, 0, captures[c].sampleCount, &serial);
+            // Walk the shards of this capture alongside the serial list.
+            uint32_t s = 0;
+            for (; itemIndex < itemCount && items[itemIndex].captureIndex == c; itemIndex++)
+            {
+                const batch_hitList_t* sharded = &items[itemIndex].result;
+                for (uint32_t h = 0; h < sharded->count; h++, s++)
+                {
+                    if (s >= serial.count || serial.hits[s].sample != sharded->hits[h].sample ||
+                        serial.hits[s].player != sharded->hits[h].player)
+                    {
+                        mismatches++;
+                    }
+                }
+            }
+            // Serial hits the shards never reached are mismatches too.
+            if (s < serial.count)
+            {
+                mismatches += serial.count - s;
+            }
+            free(serial.hits);
+        }
+        double serialSeconds = secondsSince(&start);
+        detector_ctx_destroy(&detector);
+        fprintf(stderr, "serial pass: %.3f s (speedup %.2fx), %u mismatch(es)\n",
+                serialSeconds, serialSeconds / parallelSeconds, mismatches);
+        if (mismatches > 0)
+        {
+            status = BATCH_MISMATCH;
+        }
+    }
+
+    for (uint32_t i = 0; i < itemCount; i++)
+    {
+        free(items[i].result.hits);
+    }
+    free(items);
+    for (uint32_t c = 0; c < captureCount; c++)
+    {
+        unmapCapture(&captures[c]);
+    }
+    free(captures);
+    return status;
+}
@@ -0,0 +1,183 @@
+/**********************************************************************************/
+/* File: benchmarkMain.c                                                          */
+/* Purpose: Host front end for the detector benchmark (Milestone3/benchmark.c).   */
+/*          Replays a recorded capture (or a synthesized one) through the         */
+/*          pipeline, writes JSON results and optionally fails when a stage is    */
+/*          slower than a saved baseline.                                         */
+/*          See the build notes below the banner.                                 */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/benchmarkMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/benchmark.c Milestone3/capture.c Milestone3/detector.c
+//       Milestone3/filter.c Milestone3/isr.c Milestone3/sort.c
+//       Milestone3/lockoutTimer.c Milestone3/hitLedTimer.c Milestone3/timerWheel.c
+//       Milestone3/transmitter.c Milestone3/trigger.c Milestone3/profiler.c
+//       Milestone3/cycleCounter.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o benchmark
+//
+// Usage:
+//   benchmark [--capture file] [--seconds n] [--save-capture file]
+//             [--json file] [--baseline file] [--tolerance percent]
+//             [--profile file]
+//
+// --profile needs -DPROFILER_ENABLED on the build line; it writes the per-stage cycle
+// histograms gathered while the suite ran (see Milestone3/profiler.h).
+//
+// Typical use: save a baseline with --json baseline.json, then after a change run
+// with --baseline baseline.json; the exit status is 1 if any stage slowed down by
+// more than the tolerance (10% by default).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "benchmark.h"
+#include "capture.h"
+#include "profiler.h"
+
+// Synthesized capture used when no --capture is given.
+#define BENCHMARK_MAIN_DEFAULT_SECONDS 5
+#define BENCHMARK_MAIN_SHOT_SPACING 50000   // A shot every half second.
+#define BENCHMARK_MAIN_AMPLITUDE 1000
+#define BENCHMARK_MAIN_SEED 1
+
+// Exit codes.
+#define BENCHMARK_MAIN_OK 0
+#define BENCHMARK_MAIN_REGRESSION 1
+#define BENCHMARK_MAIN_ERROR 2
+
+/**********************************************************************************/
+/* Function: readTextFile                                                         */
+/* Purpose: Reads a whole text file into a newly allocated, terminated string.    */
+/* Returns: The string (caller frees), or NULL if the file could not be read.     */
+/**********************************************************************************/
+static char* readTextFile(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = (char*) malloc(length + 1);
+    size_t read = fread(text, 1, length, file);
+    text[read] = '\0';
+    fclose(file);
+    return text;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* capturePath = NULL;
+    const char* saveCapturePath = NULL;
+    const char* jsonPath = NULL;
+    const char* baselinePath = NULL;
+    const char* profilePath = NULL;
+    double tolerancePercent = BENCHMARK_DEFAULT_TOLERANCE;
+    uint32_t seconds = BENCHMARK_MAIN_DEFAULT_SECONDS;
+
+    // Parse the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--capture") && hasValue)
+            capturePath = argv[++i];
+        else if (!strcmp(argv[i], "--seconds") && hasValue)
+            seconds = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--save-capture") && hasValue)
+            saveCapturePath = argv[++i];
+        else if (!strcmp(argv[i], "--json") && hasValue)
+            jsonPath = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && hasValue)
+            baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--tolerance") && hasValue)
+            tolerancePercent = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--profile") && hasValue)
+            profilePath = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: %s [--capture file] [--seconds n] [--save-capture file] "
+                    "[--json file] [--baseline file] [--tolerance percent] [--profile file]\n", argv[0]);
+            return BENCHMARK_MAIN_ERROR;
+        }
+    }
+
+    // Load the recorded input, or synthesize some.
+    uint16_t* samples = NULL;
+    uint32_t sampleCount = 0;
+    if (capturePath != NULL)
+    {
+        sampleCount = capture_load(capturePath, &samples);
+        if (sampleCount == 0)
+        {
+            return BENCHMARK_MAIN_ERROR;
+        }
+    }
+    else
+    {
+        sampleCount = seconds * CAPTURE_SAMPLE_RATE_HZ;
+        samples = (uint16_t*) malloc(sampleCount * sizeof(uint16_t));
+        capture_synthesizeShots(samples, sampleCount, BENCHMARK_MAIN_SHOT_SPACING, BENCHMARK_MAIN_AMPLITUDE, BENCHMARK_MAIN_SEED);
+    }
+    if (saveCapturePath != NULL && !capture_save(saveCapturePath, samples, sampleCount))
+    {
+        free(samples);
+        return BENCHMARK_MAIN_ERROR;
+    }
+
+    // Run the suite and report.
+    profiler_init();
+    benchmark_result_t results[BENCHMARK_MAX_RESULTS];
+    uint16_t resultCount = benchmark_runAll(samples, sampleCount, results);
+    free(samples);
+    benchmark_printJson(stdout, results, resultCount);
+    if (profilePath != NULL)
+    {
+#ifdef PROFILER_ENABLED
+        FILE* profileFile = fopen(profilePath, "w");
+        if (profileFile == NULL)
+        {
+            fprintf(stderr, "could not write %s\n", profilePath);
+            return BENCHMARK_MAIN_ERROR;
+        }
+        profiler_dump(profileFile);
+        fclose(profileFile);
+#else
+        fprintf(stderr, "--profile: rebuild with -DPROFILER_ENABLED\n");
+#endif
+    }
+    if (jsonPath != NULL)
+    {
+        FILE* jsonFile = fopen(jsonPath, "w");
+        if (jsonFile == NULL)
+        {
+            fprintf(stderr, "could not write %s\n", jsonPath);
+            return BENCHMARK_MAIN_ERROR;
+        }
+        benchmark_printJson(jsonFile, results, resultCount);
+        fclose(jsonFile);
+    }
+
+    // Compare against the baseline.
+    if (baselinePath != NULL)
+    {
+        char* baseline = readTextFile(baselinePath);
+        if (baseline == NULL)
+        {
+            fprintf(stderr, "could not read %s\n", baselinePath);
+            return BENCHMARK_MAIN_ERROR;
+        }
+        uint16_t regressionCount = benchmark_compareToBaseline(results, resultCount, baseline, tolerancePercent);
+        free(baseline);
+        if (regressionCount > 0)
+        {
+            printf("%d benchmark(s) regressed by more than %.1f%%\n", regressionCount, tolerancePercent);
+            return BENCHMARK_MAIN_REGRESSION;
+        }
+    }
+    return BENCHMARK_MAIN_OK;
+}
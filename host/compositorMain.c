@@ -0,0 +1,289 @@
+/**********************************************************************************/
+/* File: compositorMain.c                                                         */
+/* Purpose: Host check for the compositor (Common/compositor.c). Draws the same   */
+/*          random frames straight to the display and through the compositor,     */
+/*          flushed synchronously, from a scheduler-style task and from the host  */
+/*          worker thread, and checks that every drained frame matches the direct */
+/*          one, that an async flush sends nothing and that no task call sends    */
+/*          more than one chunk. See the build notes below the banner.            */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon
+//       host/compositorMain.c host/supportFiles/*.c Common/*.c
+//       -o compositor
+//
+// Usage:
+//   compositor [--frames n] [--seed n]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "supportFiles/display.h"
+#include "compositor.h"
+
+#define COMPOSITOR_MAIN_DEFAULT_FRAMES 2000
+#define COMPOSITOR_MAIN_OPS_PER_FRAME 6
+#define COMPOSITOR_MAIN_CHECK_FRAMES 50       // Frames between drained-frame comparisons.
+#define COMPOSITOR_MAIN_MAX_SLICES 3          // Task calls between frames: 0 to this many.
+#define COMPOSITOR_MAIN_SPECKLE_ONE_IN 100    // Odds of a frame of scattered pixels.
+#define COMPOSITOR_MAIN_SPECKLE_PIXELS 1200   // More runs than COMPOSITOR_MAX_QUEUED_RECTS.
+#define COMPOSITOR_MAIN_MAX_SHAPE 60          // Largest shape, in pixels.
+#define COMPOSITOR_MAIN_TEXT_SIZE 8
+
+// Exit codes.
+#define COMPOSITOR_MAIN_OK 0
+#define COMPOSITOR_MAIN_MISMATCH 1
+#define COMPOSITOR_MAIN_ERROR 2
+
+typedef enum {
+    COMPOSITOR_MAIN_DIRECT,         // display_ calls: the reference.
+    COMPOSITOR_MAIN_SYNC,           // compositor_flush() sends the frame.
+    COMPOSITOR_MAIN_ASYNC_TASK,     // compositor_task() sends it a chunk at a time.
+    COMPOSITOR_MAIN_ASYNC_WORKER,   // The worker thread sends it.
+    COMPOSITOR_MAIN_MODE_COUNT
+} compositorMain_mode_t;
+
+static const char* modeNames[COMPOSITOR_MAIN_MODE_COUNT] = {"direct", "sync", "async_task", "async_worker"};
+
+/**********************************************************************************/
+/* Function: randomCoordinate                                                     */
+/* Purpose: Picks a coordinate a little beyond the screen on either side, so      */
+/*          clipping is exercised too.                                            */
+/* Returns: The coordinate.                                                       */
+/**********************************************************************************/
+static int16_t randomCoordinate(int16_t size)
+{
+    return (int16_t) (rand() % (size + 2 * COMPOSITOR_MAIN_MAX_SHAPE)) - COMPOSITOR_MAIN_MAX_SHAPE;
+}
+
+/**********************************************************************************/
+/* Function: drawRandomOp                                                         */
+/* Purpose: Draws one random primitive, straight to the display or through the    */
+/*          compositor. The random sequence is the same either way.               */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void drawRandomOp(bool direct)
+{
+    int16_t x = randomCoordinate(DISPLAY_WIDTH);
+    int16_t y = randomCoordinate(DISPLAY_HEIGHT);
+    int16_t w = 1 + rand() % COMPOSITOR_MAIN_MAX_SHAPE;
+    int16_t h = 1 + rand() % COMPOSITOR_MAIN_MAX_SHAPE;
+    uint16_t color = (uint16_t) rand();
+    switch (rand() % 5)
+    {
+    case 0:
+        direct ? display_fillRect(x, y, w, h, color) : compositor_fillRect(x, y, w, h, color);
+        break;
+    case 1:
+        direct ? display_drawLine(x, y, x + w, y + h, color) : compositor_drawLine(x, y, x + w, y + h, color);
+        break;
+    case 2:
+        direct ? display_fillCircle(x, y, w / 2, color) : compositor_fillCircle(x, y, w / 2, color);
+        break;
+    case 3:
+        direct ? display_fillTriangle(x, y, x + w, y, x, y + h, color) :
+                 compositor_fillTriangle(x, y, x + w, y, x, y + h, color);
+        break;
+    default:
+    {
+        char text[COMPOSITOR_MAIN_TEXT_SIZE];
+        snprintf(text, sizeof(text), "%d", rand() % 100000);
+        uint8_t size = 1 + rand() % 3;
+        if (direct)
+        {
+            display_setCursor(x, y);
+            display_setTextColor(color);
+            display_setTextSize(size);
+            display_print(text);
+        }
+        else
+        {
+            compositor_setCursor(x, y);
+            compositor_setTextColor(color);
+            compositor_setTextSize(size);
+            compositor_print(text);
+        }
+        break;
+    }
+    }
+}
+
+/**********************************************************************************/
+/* Function: drawRandomFrame                                                      */
+/* Purpose: Draws a frame's worth of random primitives, or now and then a frame   */
+/*          of scattered pixels with more runs than the compositor can queue.     */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void drawRandomFrame(bool direct)
+{
+    if (rand() % COMPOSITOR_MAIN_SPECKLE_ONE_IN == 0)
+    {
+        for (uint16_t i = 0; i < COMPOSITOR_MAIN_SPECKLE_PIXELS; i++)
+        {
+            int16_t x = rand() % DISPLAY_WIDTH;
+            int16_t y = rand() % DISPLAY_HEIGHT;
+            uint16_t color = (uint16_t) rand();
+            direct ? display_drawPixel(x, y, color) : compositor_drawPixel(x, y, color);
+        }
+        return;
+    }
+    for (uint16_t i = 0; i < COMPOSITOR_MAIN_OPS_PER_FRAME; i++)
+    {
+        drawRandomOp(direct);
+    }
+}
+
+// The isr would normally call this; nothing here runs the timer interrupt.
+void isr_function()
+{
+}
+
+// Pixels sent through the windowed transfer so far.
+static uint64_t windowPixels()
+{
+    display_stats_t stats;
+    display_getStats(&stats);
+    return stats.pixels[DISPLAY_OP_WINDOW];
+}
+
+/**********************************************************************************/
+/* Function: runMode                                                              */
+/* Purpose: Draws the random frames in one mode and stores the frame hash after   */
+/*          every COMPOSITOR_MAIN_CHECK_FRAMES frames (drained first).            */
+/* Returns: The number of async flushes that sent pixels plus the number of task  */
+/*          calls that sent more than one chunk.                                  */
+/**********************************************************************************/
+static uint32_t runMode(compositorMain_mode_t mode, uint32_t frames, uint32_t seed, uint32_t* hashes)
+{
+    srand(seed);
+    display_init();
+    bool direct = (mode == COMPOSITOR_MAIN_DIRECT);
+    bool async = (mode == COMPOSITOR_MAIN_ASYNC_TASK || mode == COMPOSITOR_MAIN_ASYNC_WORKER);
+    if (!direct)
+    {
+        compositor_init();
+        compositor_setAsync(async);
+    }
+    if (mode == COMPOSITOR_MAIN_ASYNC_WORKER)
+    {
+        compositor_startWorker();
+    }
+    uint32_t errors = 0;
+    uint64_t maxTaskPixels = 0;
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        drawRandomFrame(direct);
+        if (mode == COMPOSITOR_MAIN_ASYNC_TASK)
+        {
+            uint64_t before = windowPixels();
+            compositor_flush();
+            errors += (windowPixels() != before) ? 1 : 0;
+            // Leave a varying part of each frame unsent, as a busy main loop would.
+            for (uint32_t slice = 0; slice < frame % (COMPOSITOR_MAIN_MAX_SLICES + 1); slice++)
+            {
+                before = windowPixels();
+                compositor_task(NULL);
+                uint64_t sent = windowPixels() - before;
+                maxTaskPixels = (sent > maxTaskPixels) ? sent : maxTaskPixels;
+                errors += (sent > COMPOSITOR_CHUNK_PIXELS) ? 1 : 0;
+            }
+        }
+        else if (!direct)
+        {
+            compositor_flush();
+        }
+        if ((frame + 1) % COMPOSITOR_MAIN_CHECK_FRAMES == 0)
+        {
+            if (!direct)
+            {
+                compositor_waitFrameComplete();
+            }
+            hashes[frame / COMPOSITOR_MAIN_CHECK_FRAMES] = display_getFrameHash();
+        }
+    }
+    if (mode == COMPOSITOR_MAIN_ASYNC_WORKER)
+    {
+        compositor_stopWorker();
+    }
+    if (direct)
+    {
+        display_stats_t stats;
+        display_getStats(&stats);
+        uint64_t pixels = 0;
+        for (uint16_t op = 0; op < DISPLAY_OP_COUNT; op++)
+        {
+            pixels += stats.pixels[op];
+        }
+        printf("%-13s %llu pixels drawn\n", modeNames[mode], (unsigned long long) pixels);
+        return errors;
+    }
+    compositor_setAsync(false);
+    compositor_stats_t stats;
+    compositor_getStats(&stats);
+    printf("%-13s %llu pixels sent in %lu frames (%lu held flushes, %lu sent whole), %lu chunks",
+           modeNames[mode], (unsigned long long) stats.pixelsSent, (unsigned long) stats.frames,
+           (unsigned long) stats.heldFlushes, (unsigned long) stats.wholeFrames, (unsigned long) stats.chunks);
+    if (mode == COMPOSITOR_MAIN_ASYNC_TASK)
+    {
+        printf(", largest task call %llu pixels", (unsigned long long) maxTaskPixels);
+    }
+    printf("\n");
+    return errors;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t frames = COMPOSITOR_MAIN_DEFAULT_FRAMES;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--frames") && hasValue)
+            frames = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && hasValue)
+            seed = (uint32_t) atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--frames n] [--seed n]\n", argv[0]);
+            return COMPOSITOR_MAIN_ERROR;
+        }
+    }
+    uint32_t checks = frames / COMPOSITOR_MAIN_CHECK_FRAMES;
+    if (checks == 0)
+    {
+        fprintf(stderr, "--frames must be at least %d\n", COMPOSITOR_MAIN_CHECK_FRAMES);
+        return COMPOSITOR_MAIN_ERROR;
+    }
+
+    uint32_t* hashes[COMPOSITOR_MAIN_MODE_COUNT];
+    uint32_t mismatches = 0;
+    for (uint16_t mode = 0; mode < COMPOSITOR_MAIN_MODE_COUNT; mode++)
+    {
+        hashes[mode] = (uint32_t*) calloc(checks, sizeof(uint32_t));
+        if (hashes[mode] == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            return COMPOSITOR_MAIN_ERROR;
+        }
+        uint32_t errors = runMode((compositorMain_mode_t) mode, frames, seed, hashes[mode]);
+        if (errors > 0)
+        {
+            printf("%s: %u flushes or task calls sent more than allowed\n", modeNames[mode], errors);
+            mismatches++;
+        }
+        for (uint32_t check = 0; check < checks; check++)
+        {
+            if (hashes[mode][check] != hashes[COMPOSITOR_MAIN_DIRECT][check])
+            {
+                printf("%s: frame %u is 0x%08x, drawn directly 0x%08x\n", modeNames[mode],
+                       (check + 1) * COMPOSITOR_MAIN_CHECK_FRAMES, hashes[mode][check],
+                       hashes[COMPOSITOR_MAIN_DIRECT][check]);
+                mismatches++;
+                break;
+            }
+        }
+    }
+    printf("%s\n", (mismatches == 0) ? "all frames match" : "MISMATCH");
+    return (mismatches == 0) ? COMPOSITOR_MAIN_OK : COMPOSITOR_MAIN_MISMATCH;
+}
@@ -0,0 +1,204 @@
+/**********************************************************************************/
+/* File: displayMain.c                                                            */
+/* Purpose: Render cost and golden frames for the screens of the labs. Draws each */
+/*          step into the host framebuffer (host/supportFiles/display.c), prints  */
+/*          the calls, transfers and pixel writes it took and checks the frame    */
+/*          against its golden hash. See the build notes below the banner.        */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon -IMilestone1 -IMilestone3 -ILab2 -ILab4 -ILab5 -ILab6 -ILab7
+//       host/displayMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/histogram.c Milestone3/filter.c Milestone1/queue.c
+//       Lab4/clockDisplay.c Lab5/ticTacToeDisplay.c Lab6/simonDisplay.c
+//       Lab7/wamDisplay.c Lab7/wamControl.c Lab2/buttons.c Lab2/switches.c
+//       -o display
+//
+// Add -DHISTOGRAM_COMPOSITOR_ENABLED -DCLOCK_DISPLAY_COMPOSITOR_ENABLED to draw the histogram
+// and the clock through the compositor: every frame must still match its golden hash, while
+// the pixels column drops to what each flush sent. Add -DGLYPH_CACHE_ENABLED to draw the
+// labels and scores from the glyph cache (the clock digits always are): the frames must match
+// again, with one transfer per character.
+//
+// Usage:
+//   display [ppmDirectory]
+// Writes each step's frame to ppmDirectory/<step>.ppm when a directory is given. A step that
+// draws differently from its golden frame is a mismatch: look at its PPM, and if the new frame
+// is right, put the printed hash in displayMain_steps[].
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "supportFiles/display.h"
+#include "histogram.h"
+#include "clockDisplay.h"
+#include "ticTacToeDisplay.h"
+#include "simonDisplay.h"
+#include "wamDisplay.h"
+
+#define DISPLAY_MAIN_HISTOGRAM_BARS 10   // One bar per player frequency.
+#define DISPLAY_MAIN_PATH_SIZE 256
+#define DISPLAY_MAIN_SECONDS_PER_HOUR 3600
+#define DISPLAY_MAIN_WAM_SEED 390         // Picks the moles (and how long each is up) in wam_moles.
+#define DISPLAY_MAIN_WAM_TICKS 200
+#define DISPLAY_MAIN_WAM_ACTIVATE_EVERY 10
+
+// Exit codes.
+#define DISPLAY_MAIN_OK 0
+#define DISPLAY_MAIN_MISMATCH 1
+#define DISPLAY_MAIN_ERROR 2
+
+// One step: drawing done on top of the previous step's frame, and the hash it should leave.
+typedef struct {
+    const char* name;
+    void (*draw)();
+    uint32_t goldenHash;
+} displayMain_step_t;
+
+/**********************************************************************************/
+/* Function: setHistogramBars                                                     */
+/* Purpose: Sets every bar to a height from the given step, moved by the given    */
+/*          nudges (if any), labelled with it.                                    */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void setHistogramBars(uint16_t step, const int16_t* nudges)
+{
+    histogram_data_t heights[DISPLAY_MAIN_HISTOGRAM_BARS];
+    char labels[DISPLAY_MAIN_HISTOGRAM_BARS][HISTOGRAM_BAR_TOP_MAX_LABEL_WIDTH_IN_CHARS];
+    for (uint16_t i = 0; i < DISPLAY_MAIN_HISTOGRAM_BARS; i++)
+    {
+        heights[i] = (i * step + step) % HISTOGRAM_MAX_BAR_DATA_IN_PIXELS + (nudges ? nudges[i] : 0);
+        snprintf(labels[i], sizeof(labels[i]), "%u", heights[i]);
+    }
+    histogram_setAllBars(heights, labels);
+}
+
+// Small moves on top of histogram_change: bars grow and shrink by less than a label's height
+// and by more, drop to 0, and stay put.
+static const int16_t displayMain_histogramNudges[DISPLAY_MAIN_HISTOGRAM_BARS] = {3, -3, 0, 12, -1, -2, 5, -20, 0, -2};
+
+static void histogramInit() { histogram_init(DISPLAY_MAIN_HISTOGRAM_BARS); }
+static void histogramBars() { setHistogramBars(37, NULL); histogram_updateDisplay(); }
+static void histogramChange() { setHistogramBars(41, NULL); histogram_updateDisplay(); }
+static void histogramNudge() { setHistogramBars(41, displayMain_histogramNudges); histogram_updateDisplay(); }
+static void clockInit() { display_init(); clockDisplay_init(); }
+static void clockSecond() { clockDisplay_advanceTimeOneSecond(); clockDisplay_updateTimeDisplay(false); }
+
+// An hour of ticks from clock_second: every digit changes, and the hour's tens digit goes blank.
+static void clockHour()
+{
+    for (uint16_t i = 0; i < DISPLAY_MAIN_SECONDS_PER_HOUR; i++)
+    {
+        clockSecond();
+    }
+}
+
+static void ticTacToeBoard() { display_init(); ticTacToeDisplay_init(); ticTacToeDisplay_drawBoardLines(); }
+
+static void ticTacToeMoves()
+{
+    ticTacToeDisplay_drawX(0, 0, false);
+    ticTacToeDisplay_drawO(1, 1, false);
+    ticTacToeDisplay_drawX(2, 2, false);
+}
+
+static void ticTacToeReset() { ticTacToeDisplay_reset(); }
+
+static void simonButtons() { display_init(); simonDisplay_drawAllButtons(); }
+static void simonSquare() { simonDisplay_drawSquare(0, false); }
+static void wamSplash() { wamDisplay_init(); wamDisplay_drawSplashScreen(false); }
+
+static void wamBoard()
+{
+    wamDisplay_drawSplashScreen(true);
+    wamDisplay_drawMoleBoard(false);
+    wamDisplay_drawScoreScreen(false);
+}
+
+static void wamHit() { wamDisplay_setHitScore(1); }
+
+// Moles come up, are redrawn every tick while they are up, and go back down as misses.
+static void wamMoles()
+{
+    srand(DISPLAY_MAIN_WAM_SEED);
+    for (uint16_t i = 0; i < DISPLAY_MAIN_WAM_TICKS; i++)
+    {
+        if (i % DISPLAY_MAIN_WAM_ACTIVATE_EVERY == 0)
+        {
+            wamDisplay_activateRandomMole();
+        }
+        wamDisplay_updateAllMoleTickCounts();
+    }
+}
+
+// The isr would normally call this; nothing here runs the timer interrupt.
+void isr_function()
+{
+}
+
+static displayMain_step_t displayMain_steps[] = {
+    {"histogram_init", histogramInit, 0x232f584d},
+    {"histogram_bars", histogramBars, 0xd6e66d1e},
+    {"histogram_change", histogramChange, 0x9199ec82},
+    {"histogram_nudge", histogramNudge, 0xccec7250},
+    {"clock_init", clockInit, 0xc7eca2d0},
+    {"clock_second", clockSecond, 0xad433f20},
+    {"clock_hour", clockHour, 0xd897eba0},
+    {"ticTacToe_board", ticTacToeBoard, 0x2324a0f5},
+    {"ticTacToe_moves", ticTacToeMoves, 0x6c87a035},
+    {"ticTacToe_reset", ticTacToeReset, 0x2324a0f5},
+    {"simon_buttons", simonButtons, 0x98085485},
+    {"simon_square", simonSquare, 0x1108a505},
+    {"wam_splash", wamSplash, 0x1e9469d3},
+    {"wam_board", wamBoard, 0x998db9a8},
+    {"wam_hit", wamHit, 0x391ed9b0},
+    {"wam_moles", wamMoles, 0x912caad8},
+};
+
+int main(int argc, char* argv[])
+{
+    if (argc > 2)
+    {
+        printf("usage: %s [ppmDirectory]\n", argv[0]);
+        return DISPLAY_MAIN_ERROR;
+    }
+    const char* ppmDirectory = (argc == 2) ? argv[1] : NULL;
+    uint32_t mismatches = 0;
+    printf("%-18s %8s %10s %10s %10s  %-10s\n", "step", "calls", "transfers", "pixels", "changed", "hash");
+    for (uint16_t i = 0; i < sizeof(displayMain_steps) / sizeof(displayMain_steps[0]); i++)
+    {
+        displayMain_step_t* step = &displayMain_steps[i];
+        display_resetStats();
+        step->draw();
+
+        display_stats_t stats;
+        display_getStats(&stats);
+        uint32_t calls = 0;
+        uint64_t transfers = 0;
+        uint64_t pixels = 0;
+        uint64_t changed = 0;
+        for (uint16_t op = 0; op < DISPLAY_OP_COUNT; op++)
+        {
+            calls += stats.calls[op];
+            transfers += stats.transfers[op];
+            pixels += stats.pixels[op];
+            changed += stats.changedPixels[op];
+        }
+        uint32_t hash = display_getFrameHash();
+        bool ok = hash == step->goldenHash;
+        mismatches += ok ? 0 : 1;
+        printf("%-18s %8lu %10llu %10llu %10llu  0x%08lx%s\n", step->name, (unsigned long) calls,
+               (unsigned long long) transfers, (unsigned long long) pixels, (unsigned long long) changed,
+               (unsigned long) hash, ok ? "" : " (MISMATCH)");
+
+        if (ppmDirectory != NULL)
+        {
+            char path[DISPLAY_MAIN_PATH_SIZE];
+            snprintf(path, sizeof(path), "%s/%s.ppm", ppmDirectory, step->name);
+            if (!display_writePpm(path))
+            {
+                return DISPLAY_MAIN_ERROR;
+            }
+        }
+    }
+    return (mismatches == 0) ? DISPLAY_MAIN_OK : DISPLAY_MAIN_MISMATCH;
+}
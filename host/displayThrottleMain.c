@@ -0,0 +1,171 @@
+/**********************************************************************************/
+/* File: displayThrottleMain.c                                                    */
+/* Purpose: Host check for the display throttle (Milestone3/displayThrottle.c).   */
+/*          Plays backlog high-water marks window by window and checks the level  */
+/*          moves up at once and down only after steady headroom, that the        */
+/*          histogram task's rate follows, and that the histogram skips labels    */
+/*          and small bar moves when told to. Build notes below the banner.       */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/displayThrottleMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/displayThrottle.c Milestone3/histogram.c Milestone3/scheduler.c
+//       Milestone3/detector.c Milestone3/filter.c Milestone3/isr.c Milestone3/sort.c
+//       Milestone3/lockoutTimer.c Milestone3/hitLedTimer.c Milestone3/timerWheel.c
+//       Milestone3/transmitter.c Milestone3/trigger.c Milestone3/profiler.c
+//       Milestone3/cycleCounter.c Milestone3/multiSensor.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o displayThrottle
+//
+// Usage:
+//   displayThrottle
+
+#include <stdio.h>
+#include "displayThrottle.h"
+#include "histogram.h"
+#include "scheduler.h"
+#include "timerWheel.h"
+
+#define DISPLAY_THROTTLE_MAIN_PERIOD 30000     // SYSTEM_TICKS_PER_HISTOGRAM_UPDATE.
+#define DISPLAY_THROTTLE_MAIN_BEHIND 1500      // Above the raise threshold.
+#define DISPLAY_THROTTLE_MAIN_HOLD 500         // Between the thresholds.
+#define DISPLAY_THROTTLE_MAIN_QUIET 50         // Below the lower threshold.
+#define DISPLAY_THROTTLE_MAIN_RATE_SPAN 120000 // Ticks over which the display task runs are counted.
+#define DISPLAY_THROTTLE_MAIN_BAR 100          // Starting bar height in the histogram check.
+
+// Exit codes.
+#define DISPLAY_THROTTLE_MAIN_OK 0
+#define DISPLAY_THROTTLE_MAIN_MISMATCH 1
+
+static uint32_t displayRuns;   // Runs of the stand-in histogram task.
+
+/**********************************************************************************/
+/* Function: displayTask                                                          */
+/* Purpose: Stand-in histogram task: counts its runs.                             */
+/* Returns: False.                                                                */
+/**********************************************************************************/
+static bool displayTask(void* user)
+{
+    (void) user;
+    displayRuns++;
+    return false;
+}
+
+/**********************************************************************************/
+/* Function: playWindows                                                          */
+/* Purpose: Ends count windows, each with the given high-water mark, and checks   */
+/*          the level reached.                                                    */
+/* Returns: 1 on a mismatch, 0 otherwise.                                         */
+/**********************************************************************************/
+static uint32_t playWindows(const char* what, uint32_t count, uint32_t highWater, displayThrottle_level_t expected)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        displayThrottle_noteBacklog(highWater / 2);
+        displayThrottle_noteBacklog(highWater);
+        displayThrottle_update();
+    }
+    displayThrottle_stats_t stats;
+    displayThrottle_getStats(&stats);
+    bool ok = stats.level == expected;
+    printf("%-46s %-13s%s\n", what, displayThrottle_getLevelName(stats.level), ok ? "" : " (MISMATCH)");
+    return ok ? 0 : 1;
+}
+
+/**********************************************************************************/
+/* Function: countDisplayRuns                                                     */
+/* Purpose: Ticks the wheel over DISPLAY_THROTTLE_MAIN_RATE_SPAN ticks with a     */
+/*          scheduler pass per tick.                                              */
+/* Returns: The number of times the display task ran.                            */
+/**********************************************************************************/
+static uint32_t countDisplayRuns()
+{
+    displayRuns = 0;
+    for (uint32_t t = 0; t < DISPLAY_THROTTLE_MAIN_RATE_SPAN; t++)
+    {
+        timerWheel_tick();
+        scheduler_runPass();
+    }
+    return displayRuns;
+}
+
+/**********************************************************************************/
+/* Function: checkHistogram                                                       */
+/* Purpose: Checks the histogram's label skipping and bar coalescing counters.    */
+/* Returns: The number of mismatches.                                             */
+/**********************************************************************************/
+static uint32_t checkHistogram()
+{
+    uint32_t mismatches = 0;
+    histogram_init(HISTOGRAM_MAX_BAR_COUNT);
+    histogram_setBarData(0, DISPLAY_THROTTLE_MAIN_BAR, "1");
+    histogram_updateDisplayBar(0);
+
+    histogram_setMinBarChange(DISPLAY_THROTTLE_COALESCE_PIXELS);
+    histogram_setBarData(0, DISPLAY_THROTTLE_MAIN_BAR + DISPLAY_THROTTLE_COALESCE_PIXELS / 2, "1");
+    histogram_updateDisplayBar(0);
+    histogram_setBarData(0, DISPLAY_THROTTLE_MAIN_BAR + DISPLAY_THROTTLE_COALESCE_PIXELS - 1, "1");
+    histogram_updateDisplayBar(0);
+    // Measured from the height drawn, not from the last update.
+    histogram_setBarData(0, DISPLAY_THROTTLE_MAIN_BAR + DISPLAY_THROTTLE_COALESCE_PIXELS, "1");
+    histogram_updateDisplayBar(0);
+    histogram_updateDisplayBar(0);
+    if (histogram_getCoalescedBarCount() != 2)
+    {
+        printf("  coalesced %u bar redraws, expected 2\n", histogram_getCoalescedBarCount());
+        mismatches++;
+    }
+
+    histogram_setTopLabelsEnabled(false);
+    histogram_setBarData(0, DISPLAY_THROTTLE_MAIN_BAR + DISPLAY_THROTTLE_COALESCE_PIXELS, "2");
+    histogram_updateDisplayBar(0);
+    histogram_setBarData(0, DISPLAY_THROTTLE_MAIN_BAR, "3");
+    histogram_updateDisplayBar(0);
+    histogram_setTopLabelsEnabled(true);
+    histogram_updateDisplayBar(0);
+    histogram_updateDisplayBar(0);
+    if (histogram_getSkippedLabelCount() != 2)
+    {
+        printf("  skipped %u top labels, expected 2\n", histogram_getSkippedLabelCount());
+        mismatches++;
+    }
+    printf("%-46s %u coalesced, %u labels skipped\n", "histogram load shedding", histogram_getCoalescedBarCount(),
+           histogram_getSkippedLabelCount());
+    return mismatches;
+}
+
+int main()
+{
+    uint32_t mismatches = checkHistogram();
+
+    scheduler_init();
+    scheduler_taskId_t task = scheduler_addTask("display", displayTask, NULL, 0, DISPLAY_THROTTLE_MAIN_PERIOD,
+                                                SCHEDULER_NO_BUDGET, false);
+    displayThrottle_init(task, DISPLAY_THROTTLE_MAIN_PERIOD);
+    uint32_t fullRuns = countDisplayRuns();
+
+    mismatches += playWindows("behind for a window", 1, DISPLAY_THROTTLE_MAIN_BEHIND, DISPLAY_THROTTLE_REDUCED_RATE);
+    uint32_t reducedRuns = countDisplayRuns();
+    mismatches += playWindows("behind for two more", 2, DISPLAY_THROTTLE_MAIN_BEHIND, DISPLAY_THROTTLE_COALESCED);
+    mismatches += playWindows("still behind: stays at the top", 3, DISPLAY_THROTTLE_MAIN_BEHIND, DISPLAY_THROTTLE_COALESCED);
+    mismatches += playWindows("headroom, one window short", DISPLAY_THROTTLE_LOWER_WINDOWS - 1, DISPLAY_THROTTLE_MAIN_QUIET,
+                              DISPLAY_THROTTLE_COALESCED);
+    mismatches += playWindows("headroom long enough: one level down", 1, DISPLAY_THROTTLE_MAIN_QUIET, DISPLAY_THROTTLE_NO_LABELS);
+    mismatches += playWindows("in between resets the headroom count", DISPLAY_THROTTLE_LOWER_WINDOWS - 1,
+                              DISPLAY_THROTTLE_MAIN_QUIET, DISPLAY_THROTTLE_NO_LABELS);
+    mismatches += playWindows("", 1, DISPLAY_THROTTLE_MAIN_HOLD, DISPLAY_THROTTLE_NO_LABELS);
+    mismatches += playWindows("", DISPLAY_THROTTLE_LOWER_WINDOWS - 1, DISPLAY_THROTTLE_MAIN_QUIET, DISPLAY_THROTTLE_NO_LABELS);
+    mismatches += playWindows("headroom again: down to reduced rate", 1, DISPLAY_THROTTLE_MAIN_QUIET, DISPLAY_THROTTLE_REDUCED_RATE);
+    mismatches += playWindows("and back to full", DISPLAY_THROTTLE_LOWER_WINDOWS, DISPLAY_THROTTLE_MAIN_QUIET, DISPLAY_THROTTLE_FULL);
+    uint32_t restoredRuns = countDisplayRuns();
+
+    printf("%-46s full %u, reduced %u, restored %u\n", "display task runs per 1.2 s", fullRuns, reducedRuns, restoredRuns);
+    if (reducedRuns * DISPLAY_THROTTLE_RATE_DIVISOR > fullRuns || restoredRuns < fullRuns - 1)
+    {
+        printf("  display rate did not follow the level\n");
+        mismatches++;
+    }
+    displayThrottle_dump(stdout);
+    return (mismatches == 0) ? DISPLAY_THROTTLE_MAIN_OK : DISPLAY_THROTTLE_MAIN_MISMATCH;
+}
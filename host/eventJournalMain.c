@@ -0,0 +1,264 @@
+/**********************************************************************************/
+/* File: eventJournalMain.c                                                       */
+/* Purpose: Host check and decoder for the event journal                          */
+/*          (Milestone3/eventJournal.c). Measures the cost of one append, has     */
+/*          several threads append while the main thread flushes and checks that  */
+/*          no record is lost, duplicated or torn, and prints journal files.      */
+/*          See the build notes below the banner.                                 */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -DEVENT_JOURNAL_ENABLED -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/eventJournalMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/eventJournal.c Milestone3/cycleCounter.c
+//       Milestone3/detector.c Milestone3/filter.c Milestone3/isr.c Milestone3/sort.c
+//       Milestone3/lockoutTimer.c Milestone3/hitLedTimer.c Milestone3/timerWheel.c
+//       Milestone3/transmitter.c Milestone3/trigger.c Milestone3/profiler.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o eventJournal
+//
+// Usage:
+//   eventJournal [--threads n] [--events n]     stress test and append cost
+//   eventJournal --dump file                    print a journal (e.g. captured from the UART)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "cycleCounter.h"
+#include "eventJournal.h"
+
+#define EVENT_JOURNAL_MAIN_DEFAULT_THREADS 3
+#define EVENT_JOURNAL_MAIN_DEFAULT_EVENTS 1000000    // Per thread.
+#define EVENT_JOURNAL_MAIN_MAX_THREADS 16
+#define EVENT_JOURNAL_MAIN_COST_ROUNDS 100           // Timed rounds of EVENT_JOURNAL_CAPACITY appends.
+
+// Exit codes.
+#define EVENT_JOURNAL_MAIN_OK 0
+#define EVENT_JOURNAL_MAIN_MISMATCH 1
+#define EVENT_JOURNAL_MAIN_ERROR 2
+
+// What the checking sink has seen.
+static uint32_t sinkRecords = 0;
+static uint32_t sinkErrors = 0;
+static uint16_t sinkNextSequence = 0;
+static uint32_t sinkPerThread[EVENT_JOURNAL_MAIN_MAX_THREADS];
+static uint32_t sinkLastValue[EVENT_JOURNAL_MAIN_MAX_THREADS];
+
+// Appender threads that have appended all of their events.
+static uint32_t appendersFinished = 0;
+
+typedef struct {
+    uint8_t thread;
+    uint32_t events;
+} appender_t;
+
+/**********************************************************************************/
+/* Function: discardSink                                                          */
+/* Purpose: Sink for the cost measurement.                                        */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void discardSink(const eventJournal_record_t records[], uint32_t count)
+{
+    (void) records;
+    (void) count;
+}
+
+/**********************************************************************************/
+/* Function: checkingSink                                                         */
+/* Purpose: Checks that sequence numbers follow on and that every thread's        */
+/*          records arrive intact and in the order that thread appended them.     */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void checkingSink(const eventJournal_record_t records[], uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const eventJournal_record_t* record = &records[i];
+        // Each appender writes its running count into both power and reference.
+        uint32_t value = (uint32_t) record->power;
+        if (record->sequence != sinkNextSequence || record->player >= EVENT_JOURNAL_MAIN_MAX_THREADS ||
+            record->power != record->reference || value <= sinkLastValue[record->player])
+        {
+            sinkErrors++;
+        }
+        else
+        {
+            sinkLastValue[record->player] = value;
+            sinkPerThread[record->player]++;
+        }
+        sinkNextSequence = (uint16_t) (record->sequence + 1);
+        sinkRecords++;
+    }
+}
+
+/**********************************************************************************/
+/* Function: appenderThread                                                       */
+/* Purpose: Appends events tagged with the thread number and a running count.     */
+/* Returns: NULL                                                                  */
+/**********************************************************************************/
+static void* appenderThread(void* argument)
+{
+    const appender_t* appender = (const appender_t*) argument;
+    // Counts stay below 2^24 so they are exact as floats.
+    for (uint32_t i = 1; i <= appender->events; i++)
+    {
+        eventJournal_append(EVENT_JOURNAL_SHOT, appender->thread, (float) i, (float) i);
+    }
+    __atomic_fetch_add(&appendersFinished, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**********************************************************************************/
+/* Function: dumpFile                                                             */
+/* Purpose: Prints every record of a journal file, skipping bytes that are not    */
+/*          part of a frame with a good CRC (console output on a UART capture).   */
+/* Returns: An exit code.                                                         */
+/**********************************************************************************/
+static int dumpFile(const char* path)
+{
+    static const char* typeNames[] = {"?", "hit", "shot", "lockout", "frequency"};
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return EVENT_JOURNAL_MAIN_ERROR;
+    }
+    uint8_t frame[EVENT_JOURNAL_FRAME_SIZE];
+    uint32_t filled = 0;
+    uint32_t skipped = 0;
+    uint32_t expected = 0;
+    bool first = true;
+    while (true)
+    {
+        filled += (uint32_t) fread(&frame[filled], 1, sizeof(frame) - filled, file);
+        if (filled < sizeof(frame))
+        {
+            skipped += filled;
+            break;
+        }
+        uint32_t crcIndex = EVENT_JOURNAL_FRAME_SIZE - EVENT_JOURNAL_CRC_SIZE;
+        uint16_t crc = (uint16_t) (frame[crcIndex] | (frame[crcIndex + 1] << 8));
+        if (frame[0] != EVENT_JOURNAL_SYNC_0 || frame[1] != EVENT_JOURNAL_SYNC_1 ||
+            frame[EVENT_JOURNAL_LENGTH_INDEX] != sizeof(eventJournal_record_t) ||
+            eventJournal_crc16(EVENT_JOURNAL_CRC_INITIAL_VALUE, &frame[EVENT_JOURNAL_LENGTH_INDEX],
+                               crcIndex - EVENT_JOURNAL_LENGTH_INDEX) != crc)
+        {
+            // Not a frame here: drop one byte and look again.
+            memmove(frame, &frame[1], --filled);
+            skipped++;
+            continue;
+        }
+        filled = 0;
+        if (skipped != 0)
+        {
+            printf("# %u bytes skipped\n", skipped);
+            skipped = 0;
+        }
+        eventJournal_record_t record;
+        memcpy(&record, &frame[EVENT_JOURNAL_FRAME_HEADER_SIZE], sizeof(record));
+        // Appends never leave a gap, so a gap means frames were lost on the way.
+        if (!first && record.sequence != (uint16_t) expected)
+        {
+            printf("# %d records lost\n", (uint16_t) (record.sequence - expected));
+        }
+        first = false;
+        expected = (uint16_t) (record.sequence + 1);
+        const char* type = (record.type <= EVENT_JOURNAL_FREQUENCY_CHANGE) ? typeNames[record.type] : typeNames[0];
+        printf("%u\t%.5f s\t%s\t", record.sequence, record.tick / 100000.0, type);
+        if (record.player == EVENT_JOURNAL_NO_PLAYER)
+            printf("-");
+        else
+            printf("%d", record.player);
+        printf("\t%g\t%g\n", record.power, record.reference);
+    }
+    if (skipped != 0)
+    {
+        printf("# %u bytes skipped\n", skipped);
+    }
+    fclose(file);
+    return EVENT_JOURNAL_MAIN_OK;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t threadCount = EVENT_JOURNAL_MAIN_DEFAULT_THREADS;
+    uint32_t events = EVENT_JOURNAL_MAIN_DEFAULT_EVENTS;
+
+    // Parse the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--dump") && hasValue)
+            return dumpFile(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && hasValue)
+            threadCount = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--events") && hasValue)
+            events = (uint32_t) atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--threads n] [--events n] | --dump file\n", argv[0]);
+            return EVENT_JOURNAL_MAIN_ERROR;
+        }
+    }
+    if (threadCount < 1 || threadCount > EVENT_JOURNAL_MAIN_MAX_THREADS || events < 1 || events >= (1 << 24))
+    {
+        fprintf(stderr, "need 1 <= threads <= %d and 1 <= events < 2^24\n", EVENT_JOURNAL_MAIN_MAX_THREADS);
+        return EVENT_JOURNAL_MAIN_ERROR;
+    }
+
+    // Cost of an uncontended append, a ring's worth at a time.
+    cycleCounter_init();
+    eventJournal_init();
+    eventJournal_setSink(discardSink);
+    uint64_t totalCycles = 0;
+    for (uint32_t round = 0; round < EVENT_JOURNAL_MAIN_COST_ROUNDS; round++)
+    {
+        cycleCounter_cycles_t start = cycleCounter_read();
+        for (uint32_t i = 0; i < EVENT_JOURNAL_CAPACITY; i++)
+        {
+            eventJournal_append(EVENT_JOURNAL_HIT, (uint8_t) i, 1.0f, 2.0f);
+        }
+        totalCycles += (cycleCounter_cycles_t) (cycleCounter_read() - start);
+        eventJournal_flush();
+    }
+    printf("append: %.1f cycles\n", (double) totalCycles / (EVENT_JOURNAL_MAIN_COST_ROUNDS * EVENT_JOURNAL_CAPACITY));
+
+    // Appenders against a flushing main thread.
+    eventJournal_init();
+    eventJournal_setSink(checkingSink);
+    pthread_t threads[EVENT_JOURNAL_MAIN_MAX_THREADS];
+    appender_t appenders[EVENT_JOURNAL_MAIN_MAX_THREADS];
+    for (uint32_t t = 0; t < threadCount; t++)
+    {
+        appenders[t].thread = (uint8_t) t;
+        appenders[t].events = events;
+        pthread_create(&threads[t], NULL, appenderThread, &appenders[t]);
+    }
+    while (true)
+    {
+        bool done = (__atomic_load_n(&appendersFinished, __ATOMIC_ACQUIRE) == threadCount);
+        if (eventJournal_flush() == 0 && done)
+        {
+            break;
+        }
+    }
+    for (uint32_t t = 0; t < threadCount; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    uint32_t dropped = eventJournal_droppedCount();
+    uint64_t appended = (uint64_t) threadCount * events;
+    printf("%llu appended, %u flushed, %u dropped, %u bad records\n", (unsigned long long) appended, sinkRecords, dropped, sinkErrors);
+    int status = EVENT_JOURNAL_MAIN_OK;
+    if (sinkErrors != 0 || sinkRecords + dropped != appended)
+    {
+        status = EVENT_JOURNAL_MAIN_MISMATCH;
+    }
+    if (status != EVENT_JOURNAL_MAIN_OK)
+    {
+        printf("journal lost or damaged records\n");
+    }
+    return status;
+}
@@ -0,0 +1,291 @@
+/**********************************************************************************/
+/* File: multiSensorMain.c                                                        */
+/* Purpose: Host check of the multi-sensor detector (Milestone3/multiSensor.c).   */
+/*          Synthesizes a recording for several sensors, fuses it on one thread   */
+/*          and with the channels split across threads, checks that both declare  */
+/*          the same hits and reports the cost per sample per channel for         */
+/*          increasing channel counts.                                            */
+/*          See the build notes below the banner.                                 */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/multiSensorMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/multiSensor.c Milestone3/capture.c
+//       Milestone3/detector.c Milestone3/filter.c Milestone3/isr.c Milestone3/sort.c
+//       Milestone3/lockoutTimer.c Milestone3/hitLedTimer.c Milestone3/timerWheel.c
+//       Milestone3/transmitter.c Milestone3/trigger.c Milestone3/profiler.c
+//       Milestone3/cycleCounter.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o multiSensor
+//
+// Usage:
+//   multiSensor [--channels n] [--quorum n] [--threads n] [--seconds n]
+//
+// Every fourth sensor is shadowed (sees only noise) and the others see the shot at
+// decreasing strength, so the sensor masks of the declared hits should leave them out.
+// The scaling table should show a roughly constant cost per sample per channel.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "capture.h"
+#include "detector.h"
+#include "filter.h"
+#include "multiSensor.h"
+
+#define MULTI_SENSOR_MAIN_DEFAULT_CHANNELS 4
+#define MULTI_SENSOR_MAIN_DEFAULT_QUORUM 2
+#define MULTI_SENSOR_MAIN_DEFAULT_THREADS 2
+#define MULTI_SENSOR_MAIN_DEFAULT_SECONDS 10
+#define MULTI_SENSOR_MAIN_SHOT_SPACING 70000    // A shot every 0.7 seconds.
+#define MULTI_SENSOR_MAIN_AMPLITUDE 1000        // Shot strength on the best-placed sensor.
+#define MULTI_SENSOR_MAIN_AMPLITUDE_STEP 250    // Each following sensor sees the shot this much weaker.
+#define MULTI_SENSOR_MAIN_SHADOW_PERIOD 4       // Every fourth sensor is shadowed.
+#define MULTI_SENSOR_MAIN_MAX_HITS 4096
+#define MULTI_SENSOR_MAIN_NS_PER_SECOND 1000000000.0
+
+// Exit codes.
+#define MULTI_SENSOR_MAIN_OK 0
+#define MULTI_SENSOR_MAIN_MISMATCH 1
+#define MULTI_SENSOR_MAIN_ERROR 2
+
+// The fused hits of one run.
+typedef struct {
+    multiSensor_hit_t hits[MULTI_SENSOR_MAIN_MAX_HITS];
+    uint32_t count;
+} hitList_t;
+
+// Work shared with the channel threads: the block being processed and each thread's channel range.
+static pthread_barrier_t blockStart;
+static pthread_barrier_t blockDone;
+static const uint16_t* blockFrames = NULL;
+static uint32_t blockFrameCount = 0;
+static bool workDone = false;
+
+typedef struct {
+    uint8_t firstChannel;
+    uint8_t lastChannel;
+} channelRange_t;
+
+/**********************************************************************************/
+/* Function: secondsSince                                                         */
+/* Purpose: Wall-clock time elapsed since start.                                  */
+/* Returns: Seconds as a double.                                                  */
+/**********************************************************************************/
+static double secondsSince(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / MULTI_SENSOR_MAIN_NS_PER_SECOND;
+}
+
+/**********************************************************************************/
+/* Function: synthesize                                                           */
+/* Purpose: Builds an interleaved recording: every sensor sees the same shots at  */
+/*          its own strength, with its own noise.                                 */
+/* Returns: The frames (caller frees).                                            */
+/**********************************************************************************/
+static uint16_t* synthesize(uint8_t channelCount, uint32_t frameCount)
+{
+    uint16_t* frames = (uint16_t*) malloc((size_t) frameCount * channelCount * sizeof(uint16_t));
+    uint16_t* channel = (uint16_t*) malloc(frameCount * sizeof(uint16_t));
+    for (uint8_t c = 0; c < channelCount; c++)
+    {
+        uint8_t position = c % MULTI_SENSOR_MAIN_SHADOW_PERIOD;
+        uint16_t amplitude = (position == MULTI_SENSOR_MAIN_SHADOW_PERIOD - 1) ? 0 : MULTI_SENSOR_MAIN_AMPLITUDE - position * MULTI_SENSOR_MAIN_AMPLITUDE_STEP;
+        capture_synthesizeShots(channel, frameCount, MULTI_SENSOR_MAIN_SHOT_SPACING, amplitude, c + 1);
+        for (uint32_t f = 0; f < frameCount; f++)
+        {
+            frames[(size_t) f * channelCount + c] = channel[f];
+        }
+    }
+    free(channel);
+    return frames;
+}
+
+/**********************************************************************************/
+/* Function: recordHits                                                           */
+/* Purpose: Appends the hit just declared to the list.                            */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void recordHits(uint32_t newHits, hitList_t* list)
+{
+    // multiSensor_fuse() only keeps the last hit; a block is far shorter than the lockout,
+    // so it declares at most one.
+    if (newHits > 0 && list->count < MULTI_SENSOR_MAIN_MAX_HITS)
+    {
+        multiSensor_getLastHit(&list->hits[list->count++]);
+    }
+}
+
+/**********************************************************************************/
+/* Function: runSerial                                                            */
+/* Purpose: Processes the whole recording on this thread.                         */
+/* Returns: Seconds taken.                                                        */
+/**********************************************************************************/
+static double runSerial(const uint16_t frames[], uint32_t frameCount, uint8_t channelCount, uint8_t quorum, hitList_t* list)
+{
+    multiSensor_init(channelCount, quorum, false);
+    list->count = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t done = 0; done < frameCount; done += MULTI_SENSOR_BLOCK_FRAMES)
+    {
+        recordHits(multiSensor_processFrames(&frames[(size_t) done * channelCount], MULTI_SENSOR_BLOCK_FRAMES), list);
+    }
+    return secondsSince(&start);
+}
+
+/**********************************************************************************/
+/* Function: channelThread                                                        */
+/* Purpose: Runs one channel range over every block the main thread hands out.    */
+/* Returns: NULL                                                                  */
+/**********************************************************************************/
+static void* channelThread(void* argument)
+{
+    const channelRange_t* range = (const channelRange_t*) argument;
+    while (true)
+    {
+        pthread_barrier_wait(&blockStart);
+        if (workDone)
+        {
+            break;
+        }
+        multiSensor_runChannels(blockFrames, blockFrameCount, range->firstChannel, range->lastChannel);
+        pthread_barrier_wait(&blockDone);
+    }
+    return NULL;
+}
+
+/**********************************************************************************/
+/* Function: runThreaded                                                          */
+/* Purpose: Splits the channels across threadCount threads (this one included)   */
+/*          and fuses each block on this thread once every range is done.         */
+/* Returns: Seconds taken.                                                        */
+/**********************************************************************************/
+static double runThreaded(const uint16_t frames[], uint32_t frameCount, uint8_t channelCount, uint8_t quorum, uint8_t threadCount, hitList_t* list)
+{
+    multiSensor_init(channelCount, quorum, false);
+    list->count = 0;
+    channelRange_t ranges[MULTI_SENSOR_MAX_CHANNELS];
+    pthread_t threads[MULTI_SENSOR_MAX_CHANNELS];
+    for (uint8_t t = 0; t < threadCount; t++)
+    {
+        ranges[t].firstChannel = (uint8_t) (t * channelCount / threadCount);
+        ranges[t].lastChannel = (uint8_t) ((t + 1) * channelCount / threadCount);
+    }
+    pthread_barrier_init(&blockStart, NULL, threadCount);
+    pthread_barrier_init(&blockDone, NULL, threadCount);
+    workDone = false;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint8_t t = 1; t < threadCount; t++)
+    {
+        pthread_create(&threads[t], NULL, channelThread, &ranges[t]);
+    }
+    for (uint32_t done = 0; done < frameCount; done += MULTI_SENSOR_BLOCK_FRAMES)
+    {
+        blockFrames = &frames[(size_t) done * channelCount];
+        blockFrameCount = MULTI_SENSOR_BLOCK_FRAMES;
+        pthread_barrier_wait(&blockStart);
+        multiSensor_runChannels(blockFrames, blockFrameCount, ranges[0].firstChannel, ranges[0].lastChannel);
+        pthread_barrier_wait(&blockDone);
+        recordHits(multiSensor_fuse(blockFrameCount), list);
+    }
+    workDone = true;
+    pthread_barrier_wait(&blockStart);
+    for (uint8_t t = 1; t < threadCount; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    double seconds = secondsSince(&start);
+    pthread_barrier_destroy(&blockStart);
+    pthread_barrier_destroy(&blockDone);
+    return seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t channelCount = MULTI_SENSOR_MAIN_DEFAULT_CHANNELS;
+    uint32_t quorum = MULTI_SENSOR_MAIN_DEFAULT_QUORUM;
+    uint32_t threadCount = MULTI_SENSOR_MAIN_DEFAULT_THREADS;
+    uint32_t seconds = MULTI_SENSOR_MAIN_DEFAULT_SECONDS;
+
+    // Parse the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--channels") && hasValue)
+            channelCount = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--quorum") && hasValue)
+            quorum = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && hasValue)
+            threadCount = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seconds") && hasValue)
+            seconds = (uint32_t) atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--channels n] [--quorum n] [--threads n] [--seconds n]\n", argv[0]);
+            return MULTI_SENSOR_MAIN_ERROR;
+        }
+    }
+    if (channelCount < 1 || channelCount > MULTI_SENSOR_MAX_CHANNELS || quorum < 1 || quorum > channelCount ||
+        threadCount < 1 || threadCount > channelCount || seconds < 1)
+    {
+        fprintf(stderr, "need 1 <= quorum <= channels <= %d, 1 <= threads <= channels and seconds >= 1\n", MULTI_SENSOR_MAX_CHANNELS);
+        return MULTI_SENSOR_MAIN_ERROR;
+    }
+    uint32_t frameCount = seconds * CAPTURE_SAMPLE_RATE_HZ;
+    frameCount -= frameCount % MULTI_SENSOR_BLOCK_FRAMES;
+    filter_init();
+
+    // Fuse on one thread and split across threads; both must declare the same hits.
+    static hitList_t serial;
+    static hitList_t threaded;
+    uint16_t* frames = synthesize((uint8_t) channelCount, frameCount);
+    double serialSeconds = runSerial(frames, frameCount, (uint8_t) channelCount, (uint8_t) quorum, &serial);
+    double threadedSeconds = runThreaded(frames, frameCount, (uint8_t) channelCount, (uint8_t) quorum, (uint8_t) threadCount, &threaded);
+    free(frames);
+
+    int status = MULTI_SENSOR_MAIN_OK;
+    if (serial.count != threaded.count)
+    {
+        status = MULTI_SENSOR_MAIN_MISMATCH;
+    }
+    for (uint32_t h = 0; h < serial.count; h++)
+    {
+        const multiSensor_hit_t* hit = &serial.hits[h];
+        printf("frame %llu\tplayer %d\tsensors 0x%02x (%d)\n", (unsigned long long) hit->frame, hit->player, hit->sensorMask, hit->sensorCount);
+        if (h < threaded.count && memcmp(hit, &threaded.hits[h], sizeof(*hit)) != 0)
+        {
+            status = MULTI_SENSOR_MAIN_MISMATCH;
+        }
+    }
+    uint32_t sensorHits[MULTI_SENSOR_MAX_CHANNELS];
+    multiSensor_getSensorHitCounts(sensorHits);
+    for (uint32_t c = 0; c < channelCount; c++)
+    {
+        printf("sensor %d: part of %d hits\n", c, sensorHits[c]);
+    }
+    printf("%d hits; %d channels, quorum %d: %.3f s on 1 thread, %.3f s on %d threads (%.2fx)\n", serial.count,
+           channelCount, quorum, serialSeconds, threadedSeconds, threadCount, serialSeconds / threadedSeconds);
+
+    // Cost per sample per channel as the channel count grows (one thread, any-sensor quorum).
+    for (uint8_t channels = 1; channels <= MULTI_SENSOR_MAX_CHANNELS; channels *= 2)
+    {
+        static hitList_t scaling;
+        uint16_t* scalingFrames = synthesize(channels, frameCount);
+        double scalingSeconds = runSerial(scalingFrames, frameCount, channels, MULTI_SENSOR_ANY_CHANNEL, &scaling);
+        free(scalingFrames);
+        printf("%d channels: %.1f ns per sample per channel\n", channels,
+               scalingSeconds * MULTI_SENSOR_MAIN_NS_PER_SECOND / ((double) frameCount * channels));
+    }
+    if (status != MULTI_SENSOR_MAIN_OK)
+    {
+        printf("serial and threaded hits differ\n");
+    }
+    return status;
+}
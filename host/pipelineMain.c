@@ -0,0 +1,183 @@
+/**********************************************************************************/
+/* File: pipelineMain.c                                                           */
+/* Purpose: Host measurement of the two-stage pipelined detector                  */
+/*          (Milestone3/pipeline.c). Runs a capture through the detector on one   */
+/*          thread, then through the pipeline with one thread per stage, checks   */
+/*          that both find the same hits and reports the speedup and the ring     */
+/*          statistics.                                                           */
+/*          See the build notes below the banner.                                 */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/pipelineMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/pipeline.c Milestone3/spscRing.c Milestone3/capture.c
+//       Milestone3/detector.c Milestone3/filter.c Milestone3/isr.c Milestone3/sort.c
+//       Milestone3/lockoutTimer.c Milestone3/hitLedTimer.c Milestone3/timerWheel.c
+//       Milestone3/transmitter.c Milestone3/trigger.c Milestone3/profiler.c
+//       Milestone3/cycleCounter.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o pipeline
+//
+// Usage:
+//   pipeline [--capture file] [--seconds n]
+//
+// Needs at least two idle cores to show a speedup: stage 2 busy-polls the ring.
+// The ring statistics show how often each side found the ring full or empty and how
+// often it had to re-read the other side's index (a cache-line transfer between cores).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "capture.h"
+#include "detector.h"
+#include "filter.h"
+#include "pipeline.h"
+
+#define PIPELINE_MAIN_DEFAULT_SECONDS 30
+#define PIPELINE_MAIN_SHOT_SPACING 70000    // A shot every 0.7 seconds.
+#define PIPELINE_MAIN_AMPLITUDE 1000
+#define PIPELINE_MAIN_SEED 1
+#define PIPELINE_MAIN_NS_PER_SECOND 1000000000.0
+
+// Exit codes.
+#define PIPELINE_MAIN_OK 0
+#define PIPELINE_MAIN_MISMATCH 1
+#define PIPELINE_MAIN_ERROR 2
+
+// Set by the main thread once stage 1 has pushed its last FIR output.
+static bool stage1Done = false;
+
+/**********************************************************************************/
+/* Function: secondsSince                                                         */
+/* Purpose: Wall-clock time elapsed since start.                                  */
+/* Returns: Seconds as a double.                                                  */
+/**********************************************************************************/
+static double secondsSince(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / PIPELINE_MAIN_NS_PER_SECOND;
+}
+
+/**********************************************************************************/
+/* Function: stage2Thread                                                         */
+/* Purpose: Plays the part of core 1: polls the ring until stage 1 has finished   */
+/*          and the ring is empty.                                                */
+/* Returns: NULL                                                                  */
+/**********************************************************************************/
+static void* stage2Thread(void* argument)
+{
+    (void) argument;
+    while (true)
+    {
+        bool done = __atomic_load_n(&stage1Done, __ATOMIC_ACQUIRE);
+        if (pipeline_stage2Poll() == 0 && done)
+        {
+            break;
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* capturePath = NULL;
+    uint32_t seconds = PIPELINE_MAIN_DEFAULT_SECONDS;
+
+    // Parse the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--capture") && hasValue)
+            capturePath = argv[++i];
+        else if (!strcmp(argv[i], "--seconds") && hasValue)
+            seconds = (uint32_t) atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--capture file] [--seconds n]\n", argv[0]);
+            return PIPELINE_MAIN_ERROR;
+        }
+    }
+
+    // Load the recorded input, or synthesize some.
+    uint16_t* samples = NULL;
+    uint32_t sampleCount = 0;
+    if (capturePath != NULL)
+    {
+        sampleCount = capture_load(capturePath, &samples);
+        if (sampleCount == 0)
+        {
+            return PIPELINE_MAIN_ERROR;
+        }
+    }
+    else
+    {
+        sampleCount = seconds * CAPTURE_SAMPLE_RATE_HZ;
+        samples = (uint16_t*) malloc(sampleCount * sizeof(uint16_t));
+        capture_synthesizeShots(samples, sampleCount, PIPELINE_MAIN_SHOT_SPACING, PIPELINE_MAIN_AMPLITUDE, PIPELINE_MAIN_SEED);
+    }
+
+    // Reference: the whole detector on one thread.
+    detector_ctx_t serial;
+    detector_ctx_init(&serial);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        detector_ctx_addSample(&serial, samples[i]);
+    }
+    double serialSeconds = secondsSince(&start);
+
+    // Pipelined: this thread is stage 1, a second thread is stage 2.
+    filter_init();
+    pipeline_init(false);
+    pthread_t stage2;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&stage2, NULL, stage2Thread, NULL);
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        pipeline_stage1AddSample(samples[i]);
+    }
+    __atomic_store_n(&stage1Done, true, __ATOMIC_RELEASE);
+    pthread_join(stage2, NULL);
+    double pipelinedSeconds = secondsSince(&start);
+    free(samples);
+
+    // Compare the hit counts.
+    detector_hitCount_t serialHits[FILTER_NUMBER_OF_PLAYERS];
+    detector_hitCount_t pipelinedHits[FILTER_NUMBER_OF_PLAYERS];
+    detector_ctx_getHitCounts(&serial, serialHits);
+    pipeline_getHitCounts(pipelinedHits);
+    int status = PIPELINE_MAIN_OK;
+    uint32_t pipelinedHitTotal = 0;
+    for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+    {
+        printf("player %d: %d hits serial, %d hits pipelined\n", p, serialHits[p], pipelinedHits[p]);
+        if (serialHits[p] != pipelinedHits[p])
+        {
+            status = PIPELINE_MAIN_MISMATCH;
+        }
+        pipelinedHitTotal += pipelinedHits[p];
+    }
+    // This thread plays core 0: the hits must have come back through the hit ring.
+    if (pipeline_hitDetected() != (pipelinedHitTotal > 0))
+    {
+        printf("hits were not handed back to stage 1\n");
+        status = PIPELINE_MAIN_MISMATCH;
+    }
+    detector_ctx_destroy(&serial);
+
+    double audioSeconds = (double) sampleCount / CAPTURE_SAMPLE_RATE_HZ;
+    printf("serial:    %.3f s for %.1f s of samples (%.1fx real time)\n", serialSeconds, audioSeconds, audioSeconds / serialSeconds);
+    printf("pipelined: %.3f s for %.1f s of samples (%.1fx real time), speedup %.2fx\n",
+           pipelinedSeconds, audioSeconds, audioSeconds / pipelinedSeconds, serialSeconds / pipelinedSeconds);
+    pipeline_dump(stdout);
+    if (status != PIPELINE_MAIN_OK)
+    {
+        printf("hit counts differ\n");
+    }
+    return status;
+}
@@ -0,0 +1,292 @@
+/**********************************************************************************/
+/* File: schedulerMain.c                                                          */
+/* Purpose: Host check for the main-loop scheduler (Milestone3/scheduler.c).      */
+/*          Checks run order, periods, wake-ups, budget and backlog yields, then  */
+/*          runs a detector against a slow display with the ADC buffer filled in  */
+/*          real time, once drawn in one go and once sliced, and compares the     */
+/*          worst backlog the detector sees. See the build notes below the banner.*/
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/schedulerMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/scheduler.c Milestone3/detector.c Milestone3/filter.c
+//       Milestone3/isr.c Milestone3/sort.c Milestone3/lockoutTimer.c
+//       Milestone3/hitLedTimer.c Milestone3/timerWheel.c Milestone3/transmitter.c
+//       Milestone3/trigger.c Milestone3/profiler.c Milestone3/cycleCounter.c
+//       Milestone3/multiSensor.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o scheduler
+//
+// Usage:
+//   scheduler [--seconds n]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cycleCounter.h"
+#include "isr.h"
+#include "scheduler.h"
+#include "timerWheel.h"
+
+#define SCHEDULER_MAIN_DEFAULT_SECONDS 2.0
+#define SCHEDULER_MAIN_SAMPLE_US 10.0         // One ADC sample per ISR tick at 100 kHz.
+#define SCHEDULER_MAIN_BAR_COUNT 25           // HISTOGRAM_MAX_BAR_COUNT.
+#define SCHEDULER_MAIN_BAR_US 400.0           // Simulated cost of drawing one bar.
+#define SCHEDULER_MAIN_DISPLAY_BUDGET_US 1000.0
+#define SCHEDULER_MAIN_DISPLAY_PERIOD 30000   // SYSTEM_TICKS_PER_HISTOGRAM_UPDATE.
+#define SCHEDULER_MAIN_WATERMARK 200
+#define SCHEDULER_MAIN_LOG_SIZE 16
+
+// Exit codes.
+#define SCHEDULER_MAIN_OK 0
+#define SCHEDULER_MAIN_MISMATCH 1
+#define SCHEDULER_MAIN_ERROR 2
+
+// Order in which the functional-check tasks ran.
+static char runLog[SCHEDULER_MAIN_LOG_SIZE + 1];
+static uint8_t runLogLength;
+static uint32_t slicesLeft;     // Slices the sliced check task still has to run.
+
+// Load-run state.
+static double cyclesPerSample;
+static cycleCounter_cycles_t lastProduced;
+static uint32_t maxBacklog;
+static uint32_t drainedSamples;
+static uint16_t nextBar;
+
+/**********************************************************************************/
+/* Function: logTask                                                              */
+/* Purpose: Check task: appends its letter (user) to the run log.                 */
+/* Returns: False (done in one slice).                                            */
+/**********************************************************************************/
+static bool logTask(void* user)
+{
+    if (runLogLength < SCHEDULER_MAIN_LOG_SIZE)
+        runLog[runLogLength++] = *(const char*) user;
+    runLog[runLogLength] = 0;
+    return false;
+}
+
+/**********************************************************************************/
+/* Function: slicedLogTask                                                        */
+/* Purpose: Check task: logs one letter per slice for slicesLeft slices.          */
+/* Returns: True while slices are left.                                           */
+/**********************************************************************************/
+static bool slicedLogTask(void* user)
+{
+    logTask(user);
+    return --slicesLeft > 0;
+}
+
+/**********************************************************************************/
+/* Function: expectLog                                                            */
+/* Purpose: Runs one pass and compares the run log with the expected order.       */
+/* Returns: 1 on a mismatch, 0 otherwise.                                         */
+/**********************************************************************************/
+static uint32_t expectLog(const char* what, const char* expected)
+{
+    runLogLength = 0;
+    runLog[0] = 0;
+    scheduler_runPass();
+    bool ok = strcmp(runLog, expected) == 0;
+    printf("%-44s ran \"%s\"%s\n", what, runLog, ok ? "" : " (MISMATCH)");
+    if (!ok)
+        printf("  expected \"%s\"\n", expected);
+    return ok ? 0 : 1;
+}
+
+/**********************************************************************************/
+/* Function: checkFunctions                                                       */
+/* Purpose: Priority order, periods, wake-ups and backlog yields, one pass at a   */
+/*          time with the wheel and the ADC buffer driven by hand.                */
+/* Returns: The number of mismatches.                                             */
+/**********************************************************************************/
+static uint32_t checkFunctions()
+{
+    static const char a = 'a', b = 'b', c = 'c', d = 'd', e = 'e';
+    uint32_t mismatches = 0;
+    isr_init();
+    scheduler_init();
+    scheduler_setBacklogWatermark(SCHEDULER_MAIN_WATERMARK);
+    scheduler_addTask("c", logTask, (void*) &c, 2, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, true);
+    scheduler_addTask("a", logTask, (void*) &a, 0, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, false);
+    scheduler_addTask("d", logTask, (void*) &d, 3, 10, SCHEDULER_NO_BUDGET, false);
+    scheduler_taskId_t wakeId = scheduler_addTask("e", logTask, (void*) &e, 4, SCHEDULER_ONLY_WHEN_WOKEN, SCHEDULER_NO_BUDGET, false);
+    scheduler_addTask("b", logTask, (void*) &b, 1, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, false);
+
+    mismatches += expectLog("first pass: priority order, periodic due", "abcd");
+    mismatches += expectLog("second pass: periodic not due yet", "abc");
+    for (uint32_t t = 0; t < 10; t++)
+        timerWheel_tick();
+    mismatches += expectLog("ten ticks later: periodic due again", "abcd");
+    scheduler_wake(wakeId);
+    mismatches += expectLog("woken task runs once", "abce");
+    mismatches += expectLog("and not again until woken", "abc");
+    for (uint32_t i = 0; i <= SCHEDULER_MAIN_WATERMARK; i++)
+        isr_addDataToAdcBuffer(0);
+    for (uint32_t t = 0; t < 10; t++)
+        timerWheel_tick();
+    mismatches += expectLog("backlog over the watermark ends the pass", "ab");
+    isr_init();
+    mismatches += expectLog("drained: yielded task and the rest run", "abcd");
+
+    scheduler_init();
+    scheduler_setBacklogWatermark(SCHEDULER_MAIN_WATERMARK);
+    scheduler_addTask("a", logTask, (void*) &a, 0, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, false);
+    scheduler_addTask("b", slicedLogTask, (void*) &b, 1, SCHEDULER_ONLY_WHEN_WOKEN, SCHEDULER_NO_BUDGET, true);
+    scheduler_wake(1);
+    slicesLeft = 3;
+    mismatches += expectLog("unbudgeted sliced task runs to the end", "abbb");
+    for (uint32_t i = 0; i <= SCHEDULER_MAIN_WATERMARK; i++)
+        isr_addDataToAdcBuffer(0);
+    scheduler_wake(1);
+    slicesLeft = 3;
+    mismatches += expectLog("sliced task held back by the backlog", "a");
+    isr_init();
+    mismatches += expectLog("and resumed once it drains", "abbb");
+    mismatches += expectLog("done: not due again", "a");
+    return mismatches;
+}
+
+/**********************************************************************************/
+/* Function: produceSamples                                                       */
+/* Purpose: Plays the part of the ISR: adds one sample and one wheel tick for     */
+/*          each 10 us of real time since the last call.                          */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void produceSamples()
+{
+    cycleCounter_cycles_t now = cycleCounter_read();
+    uint32_t samples = (uint32_t) ((now - lastProduced) / cyclesPerSample);
+    lastProduced += (cycleCounter_cycles_t) (samples * cyclesPerSample);
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        isr_addDataToAdcBuffer(0);
+        timerWheel_tick();
+    }
+}
+
+/**********************************************************************************/
+/* Function: spin                                                                 */
+/* Purpose: Busy-waits for a number of microseconds, producing samples meanwhile. */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void spin(double microseconds)
+{
+    cycleCounter_cycles_t start = cycleCounter_read();
+    cycleCounter_cycles_t cycles = (cycleCounter_cycles_t) (microseconds * cycleCounter_getCyclesPerMicrosecond());
+    while (cycleCounter_read() - start < cycles)
+        produceSamples();
+}
+
+/**********************************************************************************/
+/* Function: detectorTask                                                         */
+/* Purpose: Load task: notes the backlog and drains the ADC buffer.               */
+/* Returns: False.                                                                */
+/**********************************************************************************/
+static bool detectorTask(void* user)
+{
+    (void) user;
+    produceSamples();
+    uint32_t backlog = isr_adcBufferElementCount();
+    if (backlog > maxBacklog)
+        maxBacklog = backlog;
+    for (uint32_t i = 0; i < backlog; i++)
+        isr_removeDataFromAdcBuffer();
+    drainedSamples += backlog;
+    return false;
+}
+
+/**********************************************************************************/
+/* Function: wholeDisplayTask                                                     */
+/* Purpose: Load task: draws every bar in one go, like histogram_updateDisplay(). */
+/* Returns: False.                                                                */
+/**********************************************************************************/
+static bool wholeDisplayTask(void* user)
+{
+    (void) user;
+    for (uint16_t bar = 0; bar < SCHEDULER_MAIN_BAR_COUNT; bar++)
+        spin(SCHEDULER_MAIN_BAR_US);
+    return false;
+}
+
+/**********************************************************************************/
+/* Function: slicedDisplayTask                                                    */
+/* Purpose: Load task: draws one bar per slice.                                   */
+/* Returns: True until the last bar is drawn.                                     */
+/**********************************************************************************/
+static bool slicedDisplayTask(void* user)
+{
+    (void) user;
+    spin(SCHEDULER_MAIN_BAR_US);
+    if (++nextBar < SCHEDULER_MAIN_BAR_COUNT)
+        return true;
+    nextBar = 0;
+    return false;
+}
+
+/**********************************************************************************/
+/* Function: runLoad                                                              */
+/* Purpose: Runs the detector and a display task for a while in real time.        */
+/* Returns: The worst backlog the detector saw.                                   */
+/**********************************************************************************/
+static uint32_t runLoad(const char* name, scheduler_task_t display, bool sliced, double seconds)
+{
+    isr_init();
+    scheduler_init();
+    scheduler_setBacklogWatermark(SCHEDULER_MAIN_WATERMARK);
+    scheduler_addTask("detector", detectorTask, NULL, 0, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET, false);
+    scheduler_taskId_t displayId = scheduler_addTask("display", display, NULL, 1, SCHEDULER_MAIN_DISPLAY_PERIOD,
+                                                     sliced ? SCHEDULER_MAIN_DISPLAY_BUDGET_US : SCHEDULER_NO_BUDGET, sliced);
+    maxBacklog = 0;
+    drainedSamples = 0;
+    nextBar = 0;
+    uint32_t passes = 0;
+    lastProduced = cycleCounter_read();
+    cycleCounter_cycles_t start = lastProduced;
+    cycleCounter_cycles_t duration = (cycleCounter_cycles_t) (seconds * 1e6 * cycleCounter_getCyclesPerMicrosecond());
+    while (cycleCounter_read() - start < duration)
+    {
+        scheduler_runPass();
+        passes++;
+    }
+    scheduler_stats_t detector, displayStats;
+    scheduler_getStats(0, &detector);
+    scheduler_getStats(displayId, &displayStats);
+    printf("%-10s worst backlog %6u samples, %u redraws, %u yields, %.2f detector runs per 100 samples\n", name,
+           maxBacklog, displayStats.completions, displayStats.budgetYields + displayStats.backlogYields,
+           drainedSamples ? 100.0 * detector.runs / drainedSamples : 0.0);
+    return maxBacklog;
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = SCHEDULER_MAIN_DEFAULT_SECONDS;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--seconds n]\n", argv[0]);
+            return SCHEDULER_MAIN_ERROR;
+        }
+    }
+
+    cycleCounter_init();
+    cyclesPerSample = SCHEDULER_MAIN_SAMPLE_US * cycleCounter_getCyclesPerMicrosecond();
+    uint32_t mismatches = checkFunctions();
+
+    uint32_t wholeBacklog = runLoad("whole", wholeDisplayTask, false, seconds);
+    uint32_t slicedBacklog = runLoad("sliced", slicedDisplayTask, true, seconds);
+    // A whole redraw holds the detector off for all the bars; sliced, for about a budget and a bar
+    // (plus whatever the host's own scheduler adds, hence the loose bound).
+    if (slicedBacklog * 2 >= wholeBacklog)
+    {
+        printf("slicing did not halve the worst backlog (%u vs %u samples)\n", slicedBacklog, wholeBacklog);
+        mismatches++;
+    }
+    scheduler_dump(stdout);
+    return (mismatches == 0) ? SCHEDULER_MAIN_OK : SCHEDULER_MAIN_MISMATCH;
+}
@@ -0,0 +1,352 @@
+/**********************************************************************************/
+/* File: display.c                                                                */
+/* Purpose: Host stand-in for supportFiles/display.c. Draws into an RGB565        */
+/*          framebuffer with the driver's rasterization (Common/raster.c) and     */
+/*          counts calls and pixel writes per primitive (see display.h).          */
+/**********************************************************************************/
+#include "display.h"
+#include "raster.h"
+
+#define DISPLAY_PPM_MAX_VALUE 255
+#define DISPLAY_FNV_OFFSET_BASIS 2166136261u
+#define DISPLAY_FNV_PRIME 16777619u
+#define DISPLAY_NUMBER_DIGITS 16   // Room for a formatted number.
+
+static uint16_t display_framebuffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+static raster_surface_t display_surface = {&display_framebuffer[0][0], DISPLAY_WIDTH, DISPLAY_HEIGHT, NULL, NULL, 0, 0, 0};
+static raster_text_t display_text;
+static display_stats_t display_stats;
+static display_op_t display_op;   // Primitive the surface's writes are counted under.
+
+// The open window of display_setAddrWindow() and the next pixel display_pushColors() writes.
+static int16_t display_windowX0, display_windowY0, display_windowX1, display_windowY1;
+static int16_t display_windowX, display_windowY;
+
+/**********************************************************************************/
+/* Function: display_settle                                                       */
+/* Purpose: Moves the surface's write counts into the counters of the primitive   */
+/*          that made them.                                                       */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void display_settle()
+{
+    display_stats.pixels[display_op] += display_surface.writes;
+    display_stats.changedPixels[display_op] += display_surface.changes;
+    display_stats.transfers[display_op] += display_surface.transfers;
+    display_surface.writes = 0;
+    display_surface.changes = 0;
+    display_surface.transfers = 0;
+}
+
+/**********************************************************************************/
+/* Function: display_begin                                                        */
+/* Purpose: Starts a public drawing call: counts it and directs the pixel writes  */
+/*          to it.                                                                */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void display_begin(display_op_t op)
+{
+    display_settle();
+    display_op = op;
+    display_stats.calls[op]++;
+}
+
+/**********************************************************************************/
+/* Function: display_init                                                         */
+/* Purpose: Clears the framebuffer to black, resets the text settings and clears  */
+/*          the cost counters.                                                    */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+void display_init()
+{
+    raster_init(&display_surface, &display_framebuffer[0][0], DISPLAY_WIDTH, DISPLAY_HEIGHT, NULL, NULL);
+    raster_fillRect(&display_surface, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_BLACK);
+    raster_initText(&display_text);
+    display_setAddrWindow(0, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1);
+    display_resetStats();
+}
+
+// The labs only use the landscape rotation, which is the framebuffer's layout.
+void display_setRotation(uint8_t) {}
+int16_t display_width() { return DISPLAY_WIDTH; }
+int16_t display_height() { return DISPLAY_HEIGHT; }
+
+void display_fillScreen(uint16_t color)
+{
+    display_begin(DISPLAY_OP_FILL_SCREEN);
+    raster_fillRect(&display_surface, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, color);
+}
+
+void display_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    display_begin(DISPLAY_OP_PIXEL);
+    raster_drawPixel(&display_surface, x, y, color);
+}
+
+void display_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    display_begin(DISPLAY_OP_LINE);
+    raster_drawLine(&display_surface, x0, y0, x1, y1, color);
+}
+
+void display_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    display_begin(DISPLAY_OP_FAST_LINE);
+    raster_fillRect(&display_surface, x, y, 1, h, color);
+}
+
+void display_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    display_begin(DISPLAY_OP_FAST_LINE);
+    raster_fillRect(&display_surface, x, y, w, 1, color);
+}
+
+void display_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    display_begin(DISPLAY_OP_RECT);
+    raster_drawRect(&display_surface, x, y, w, h, color);
+}
+
+void display_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    display_begin(DISPLAY_OP_FILL_RECT);
+    raster_fillRect(&display_surface, x, y, w, h, color);
+}
+
+void display_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    display_begin(DISPLAY_OP_CIRCLE);
+    raster_drawCircle(&display_surface, x0, y0, r, color);
+}
+
+void display_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    display_begin(DISPLAY_OP_FILL_CIRCLE);
+    raster_fillCircle(&display_surface, x0, y0, r, color);
+}
+
+void display_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+    display_begin(DISPLAY_OP_TRIANGLE);
+    raster_drawTriangle(&display_surface, x0, y0, x1, y1, x2, y2, color);
+}
+
+void display_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+    display_begin(DISPLAY_OP_FILL_TRIANGLE);
+    raster_fillTriangle(&display_surface, x0, y0, x1, y1, x2, y2, color);
+}
+
+void display_setCursor(int16_t x, int16_t y)
+{
+    display_text.cursorX = x;
+    display_text.cursorY = y;
+}
+
+void display_setTextColor(uint16_t color)
+{
+    display_text.color = color;
+    display_text.backgroundColor = color;
+}
+
+void display_setTextColor(uint16_t color, uint16_t backgroundColor)
+{
+    display_text.color = color;
+    display_text.backgroundColor = backgroundColor;
+}
+
+void display_setTextSize(uint8_t size) { display_text.size = (size > 0) ? size : 1; }
+void display_setTextWrap(bool wrap) { display_text.wrap = wrap; }
+
+void display_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t backgroundColor, uint8_t size)
+{
+    display_begin(DISPLAY_OP_CHAR);
+    raster_drawChar(&display_surface, x, y, c, color, backgroundColor, size);
+}
+
+// Numbers print like the board's Print class: decimal, doubles with two decimals.
+void display_print(const char* str)
+{
+    display_begin(DISPLAY_OP_TEXT);
+    raster_print(&display_surface, &display_text, str);
+}
+
+void display_print(char c)
+{
+    char str[] = {c, '\0'};
+    display_print(str);
+}
+
+void display_print(int32_t value)
+{
+    char str[DISPLAY_NUMBER_DIGITS];
+    snprintf(str, sizeof(str), "%ld", (long) value);
+    display_print(str);
+}
+
+void display_print(uint32_t value)
+{
+    char str[DISPLAY_NUMBER_DIGITS];
+    snprintf(str, sizeof(str), "%lu", (unsigned long) value);
+    display_print(str);
+}
+
+void display_print(double value)
+{
+    char str[DISPLAY_NUMBER_DIGITS];
+    snprintf(str, sizeof(str), "%.2f", value);
+    display_print(str);
+}
+
+void display_println(const char* str) { display_print(str); display_println(); }
+void display_println(char c) { display_print(c); display_println(); }
+void display_println(int32_t value) { display_print(value); display_println(); }
+void display_println(uint32_t value) { display_print(value); display_println(); }
+void display_println(double value) { display_print(value); display_println(); }
+void display_println() { display_print("\r\n"); }
+
+void display_setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    display_begin(DISPLAY_OP_WINDOW);
+    display_surface.transfers++;
+    display_windowX0 = x0;
+    display_windowY0 = y0;
+    display_windowX1 = x1;
+    display_windowY1 = y1;
+    display_windowX = x0;
+    display_windowY = y0;
+}
+
+/**********************************************************************************/
+/* Function: display_pushColors                                                   */
+/* Purpose: Writes pixels into the open window, row by row. Pixels past the end   */
+/*          of the window are dropped.                                            */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+void display_pushColors(const uint16_t* colors, uint32_t count)
+{
+    display_settle();
+    display_op = DISPLAY_OP_WINDOW;
+    for (uint32_t i = 0; i < count && display_windowY <= display_windowY1; i++)
+    {
+        raster_drawPixel(&display_surface, display_windowX, display_windowY, colors[i]);
+        if (++display_windowX > display_windowX1)
+        {
+            display_windowX = display_windowX0;
+            display_windowY++;
+        }
+    }
+    display_surface.transfers = 0;   // The pixels stream into the window already opened.
+}
+
+bool display_isTouched() { return false; }
+void display_clearOldTouchData() {}
+void display_getTouchedPoint(int16_t* x, int16_t* y, uint8_t* z)
+{
+    *x = 0;
+    *y = 0;
+    *z = 0;
+}
+
+const uint16_t* display_getFramebuffer()
+{
+    return &display_framebuffer[0][0];
+}
+
+uint16_t display_getPixel(int16_t x, int16_t y)
+{
+    return (x < 0 || y < 0 || x >= DISPLAY_WIDTH || y >= DISPLAY_HEIGHT) ? DISPLAY_BLACK : display_framebuffer[y][x];
+}
+
+uint32_t display_getFrameHash()
+{
+    uint32_t hash = DISPLAY_FNV_OFFSET_BASIS;
+    const uint8_t* bytes = (const uint8_t*) display_framebuffer;
+    for (uint32_t i = 0; i < sizeof(display_framebuffer); i++)
+    {
+        hash = (hash ^ bytes[i]) * DISPLAY_FNV_PRIME;
+    }
+    return hash;
+}
+
+/**********************************************************************************/
+/* Function: display_writePpm                                                     */
+/* Purpose: Writes the framebuffer as a P6 image, each RGB565 channel scaled to   */
+/*          0..255.                                                               */
+/* Returns: False if the file could not be written.                               */
+/**********************************************************************************/
+bool display_writePpm(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        printf("display_writePpm: cannot open %s.\n\r", path);
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n%d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_PPM_MAX_VALUE);
+    for (int16_t y = 0; y < DISPLAY_HEIGHT; y++)
+    {
+        for (int16_t x = 0; x < DISPLAY_WIDTH; x++)
+        {
+            uint16_t color = display_framebuffer[y][x];
+            uint8_t rgb[] = {(uint8_t) (((color >> 11) & 0x1F) * DISPLAY_PPM_MAX_VALUE / 0x1F),
+                             (uint8_t) (((color >> 5) & 0x3F) * DISPLAY_PPM_MAX_VALUE / 0x3F),
+                             (uint8_t) ((color & 0x1F) * DISPLAY_PPM_MAX_VALUE / 0x1F)};
+            fwrite(rgb, sizeof(rgb), 1, file);
+        }
+    }
+    bool ok = !ferror(file);
+    if (fclose(file) != 0 || !ok)
+    {
+        printf("display_writePpm: cannot write %s.\n\r", path);
+        return false;
+    }
+    return true;
+}
+
+void display_getStats(display_stats_t* stats)
+{
+    display_settle();
+    *stats = display_stats;
+}
+
+void display_resetStats()
+{
+    display_settle();
+    display_stats = (display_stats_t) {};
+}
+
+/**********************************************************************************/
+/* Function: display_dumpStats                                                    */
+/* Purpose: Prints a line per primitive that was used, and the totals.            */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+void display_dumpStats(FILE* out)
+{
+    display_settle();
+    static const char* names[DISPLAY_OP_COUNT] = {
+        "fillScreen", "pixel", "line", "fastLine", "rect", "fillRect", "circle", "fillCircle",
+        "triangle", "fillTriangle", "char", "text", "window"
+    };
+    uint32_t calls = 0;
+    uint64_t transfers = 0;
+    uint64_t pixels = 0;
+    uint64_t changed = 0;
+    fprintf(out, "%-13s %8s %10s %10s %10s\n", "primitive", "calls", "transfers", "pixels", "changed");
+    for (uint16_t op = 0; op < DISPLAY_OP_COUNT; op++)
+    {
+        if (display_stats.calls[op] == 0)
+        {
+            continue;
+        }
+        fprintf(out, "%-13s %8lu %10llu %10llu %10llu\n", names[op], (unsigned long) display_stats.calls[op],
+                (unsigned long long) display_stats.transfers[op], (unsigned long long) display_stats.pixels[op],
+                (unsigned long long) display_stats.changedPixels[op]);
+        calls += display_stats.calls[op];
+        transfers += display_stats.transfers[op];
+        pixels += display_stats.pixels[op];
+        changed += display_stats.changedPixels[op];
+    }
+    fprintf(out, "%-13s %8lu %10llu %10llu %10llu\n", "total", (unsigned long) calls, (unsigned long long) transfers,
+            (unsigned long long) pixels, (unsigned long long) changed);
+}
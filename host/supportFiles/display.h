@@ -0,0 +1,134 @@
+/**********************************************************************************/
+/* File: display.h                                                                */
+/* Purpose: Host stand-in for supportFiles/display.h (320x240 ILI9341 TFT with a  */
+/*          touch panel). Drawing goes into an RGB565 framebuffer in memory, with */
+/*          the calls and pixel writes counted per primitive. The touch panel is  */
+/*          never touched.                                                        */
+/**********************************************************************************/
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define DISPLAY_WIDTH 320
+#define DISPLAY_HEIGHT 240
+
+// Size of a character at text-size 1.
+#define DISPLAY_CHAR_WIDTH 6
+#define DISPLAY_CHAR_HEIGHT 8
+
+// RGB565 colors.
+#define DISPLAY_BLACK 0x0000
+#define DISPLAY_BLUE 0x001F
+#define DISPLAY_DARK_BLUE 0x0010
+#define DISPLAY_RED 0xF800
+#define DISPLAY_DARK_RED 0x8000
+#define DISPLAY_GREEN 0x07E0
+#define DISPLAY_DARK_GREEN 0x0400
+#define DISPLAY_CYAN 0x07FF
+#define DISPLAY_DARK_CYAN 0x0410
+#define DISPLAY_MAGENTA 0xF81F
+#define DISPLAY_YELLOW 0xFFE0
+#define DISPLAY_DARK_YELLOW 0x8400
+#define DISPLAY_WHITE 0xFFFF
+#define DISPLAY_GRAY 0x8410
+
+// Init and configuration.
+void display_init();
+void display_setRotation(uint8_t rotation);
+int16_t display_width();
+int16_t display_height();
+
+// Drawing primitives.
+void display_fillScreen(uint16_t color);
+void display_drawPixel(int16_t x, int16_t y, uint16_t color);
+void display_drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+void display_drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+void display_drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+void display_drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void display_fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void display_drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void display_fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+void display_drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+void display_fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+
+// Text.
+void display_setCursor(int16_t x, int16_t y);
+void display_setTextColor(uint16_t color);
+void display_setTextColor(uint16_t color, uint16_t backgroundColor);
+void display_setTextSize(uint8_t size);
+void display_setTextWrap(bool wrap);
+void display_drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t backgroundColor, uint8_t size);
+void display_print(const char* str);
+void display_print(char c);
+void display_print(int32_t value);
+void display_print(uint32_t value);
+void display_print(double value);
+void display_println(const char* str);
+void display_println(char c);
+void display_println(int32_t value);
+void display_println(uint32_t value);
+void display_println(double value);
+void display_println();
+
+// Windowed transfer, as in the driver: set a window (inclusive corners), then stream its
+// pixels row by row, left to right. One window costs one command sequence however many
+// pixels follow.
+void display_setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+void display_pushColors(const uint16_t* colors, uint32_t count);
+
+// Touch panel.
+bool display_isTouched();
+void display_clearOldTouchData();
+void display_getTouchedPoint(int16_t* x, int16_t* y, uint8_t* z);
+
+// Host only. Primitives the calls are counted under. Calls made by another primitive (the lines
+// of a rectangle, the characters printed by display_print()) count under the outer call.
+typedef enum {
+    DISPLAY_OP_FILL_SCREEN,
+    DISPLAY_OP_PIXEL,
+    DISPLAY_OP_LINE,
+    DISPLAY_OP_FAST_LINE,          // display_drawFastHLine() and display_drawFastVLine().
+    DISPLAY_OP_RECT,
+    DISPLAY_OP_FILL_RECT,
+    DISPLAY_OP_CIRCLE,
+    DISPLAY_OP_FILL_CIRCLE,
+    DISPLAY_OP_TRIANGLE,
+    DISPLAY_OP_FILL_TRIANGLE,
+    DISPLAY_OP_CHAR,               // display_drawChar().
+    DISPLAY_OP_TEXT,               // display_print() and display_println().
+    DISPLAY_OP_WINDOW,             // display_setAddrWindow(), with the pixels pushed after it.
+    DISPLAY_OP_COUNT
+} display_op_t;
+
+// Host only. Cost counters, by primitive. Pixels are writes that landed on the screen (what the
+// TFT would be sent); changed pixels are the ones whose color actually changed. Transfers are the
+// address windows the driver opens, each with its own command overhead on the SPI bus: one per
+// pixel or filled rectangle (a character is a rectangle per font pixel) and one per
+// display_setAddrWindow().
+typedef struct {
+    uint32_t calls[DISPLAY_OP_COUNT];
+    uint64_t transfers[DISPLAY_OP_COUNT];
+    uint64_t pixels[DISPLAY_OP_COUNT];
+    uint64_t changedPixels[DISPLAY_OP_COUNT];
+} display_stats_t;
+
+// Host only. Reads back the framebuffer (rows of DISPLAY_WIDTH pixels, top row first).
+const uint16_t* display_getFramebuffer();
+uint16_t display_getPixel(int16_t x, int16_t y);
+
+// Host only. FNV-1a hash of the framebuffer, for golden-frame checks.
+uint32_t display_getFrameHash();
+
+// Host only. Writes the framebuffer as a binary PPM (P6) image.
+// Returns false if the file could not be written.
+bool display_writePpm(const char* path);
+
+// Host only. Copies, clears and prints the cost counters. display_init() also clears them.
+void display_getStats(display_stats_t* stats);
+void display_resetStats();
+void display_dumpStats(FILE* out);
+
+#endif /* DISPLAY_H_ */
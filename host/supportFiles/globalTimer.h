@@ -0,0 +1,12 @@
+/**********************************************************************************/
+/* File: globalTimer.h                                                            */
+/* Purpose: Host stand-in for supportFiles/globalTimer.h. The lab code only       */
+/*          includes this header; timestamps are taken with XTime_GetTime()       */
+/*          (see xtime_l.h), which reads the same 64-bit global timer.            */
+/**********************************************************************************/
+#ifndef GLOBALTIMER_H_
+#define GLOBALTIMER_H_
+
+#include "xtime_l.h"
+
+#endif /* GLOBALTIMER_H_ */
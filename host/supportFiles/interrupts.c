@@ -0,0 +1,92 @@
+/**********************************************************************************/
+/* File: interrupts.c                                                             */
+/* Purpose: Host stand-in for supportFiles/interrupts.c.                          */
+/**********************************************************************************/
+#include "interrupts.h"
+
+// The timer runs at 100 kHz in the laser-tag project.
+#define INTERRUPTS_DEFAULT_TICKS_PER_SECOND 100000
+
+// Provided by the project (Milestone3/isr.c).
+void isr_function();
+
+volatile int interrupts_isrFlagGlobal = 0;
+
+static volatile bool interrupts_armIntsEnabled = false;
+static volatile bool interrupts_timerIntsEnabled = false;
+static volatile bool interrupts_timerRunning = false;
+static volatile u32 interrupts_invocationCount = 0;
+static volatile u32 interrupts_adcData = 0;
+
+int interrupts_initAll(bool usePrivateTimer)
+{
+    (void) usePrivateTimer;
+    interrupts_invocationCount = 0;
+    return 0;
+}
+
+void interrupts_setPrivateTimerLoadValue(u32 loadValue)
+{
+    (void) loadValue;
+}
+
+u32 interrupts_getPrivateTimerTicksPerSecond()
+{
+    return INTERRUPTS_DEFAULT_TICKS_PER_SECOND;
+}
+
+void interrupts_startArmPrivateTimer()
+{
+    interrupts_timerRunning = true;
+}
+
+void interrupts_stopArmPrivateTimer()
+{
+    interrupts_timerRunning = false;
+}
+
+void interrupts_enableTimerGlobalInts()
+{
+    interrupts_timerIntsEnabled = true;
+}
+
+void interrupts_disableTimerGlobalInts()
+{
+    interrupts_timerIntsEnabled = false;
+}
+
+void interrupts_enableArmInts()
+{
+    interrupts_armIntsEnabled = true;
+}
+
+void interrupts_disableArmInts()
+{
+    interrupts_armIntsEnabled = false;
+}
+
+u32 interrupts_isrInvocationCount()
+{
+    return interrupts_invocationCount;
+}
+
+u32 interrupts_getAdcData()
+{
+    return interrupts_adcData;
+}
+
+void interrupts_setAdcData(u32 adcData)
+{
+    interrupts_adcData = adcData;
+}
+
+// Runs isr_function() the way the timer interrupt handler would.
+void interrupts_simulateTick()
+{
+    if (interrupts_armIntsEnabled && interrupts_timerIntsEnabled && interrupts_timerRunning)
+    {
+        interrupts_invocationCount++;
+        isr_function();
+        interrupts_isrFlagGlobal = 1;
+    }
+}
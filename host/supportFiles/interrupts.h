@@ -0,0 +1,41 @@
+/**********************************************************************************/
+/* File: interrupts.h                                                             */
+/* Purpose: Host stand-in for supportFiles/interrupts.h. There is no timer on the */
+/*          host; tools call interrupts_simulateTick() to play the part of the    */
+/*          100 kHz timer interrupt, which invokes isr_function().                */
+/**********************************************************************************/
+#ifndef INTERRUPTS_H_
+#define INTERRUPTS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint32_t u32;
+
+// Set by the (simulated) timer interrupt, cleared by the main loop.
+extern volatile int interrupts_isrFlagGlobal;
+
+// Interrupt setup. Always succeeds on the host.
+int interrupts_initAll(bool usePrivateTimer);
+void interrupts_setPrivateTimerLoadValue(u32 loadValue);
+u32 interrupts_getPrivateTimerTicksPerSecond();
+void interrupts_startArmPrivateTimer();
+void interrupts_stopArmPrivateTimer();
+void interrupts_enableTimerGlobalInts();
+void interrupts_disableTimerGlobalInts();
+void interrupts_enableArmInts();
+void interrupts_disableArmInts();
+
+// Returns the number of times the timer ISR has run.
+u32 interrupts_isrInvocationCount();
+
+// Returns the most recent XADC sample.
+u32 interrupts_getAdcData();
+
+// Host only: sets the value returned by interrupts_getAdcData().
+void interrupts_setAdcData(u32 adcData);
+
+// Host only: runs one timer interrupt (isr_function()) if interrupts are enabled.
+void interrupts_simulateTick();
+
+#endif /* INTERRUPTS_H_ */
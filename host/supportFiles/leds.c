@@ -0,0 +1,29 @@
+/**********************************************************************************/
+/* File: leds.c                                                                   */
+/* Purpose: Host stand-in for supportFiles/leds.c.                                */
+/**********************************************************************************/
+#include "leds.h"
+
+#define LEDS_MASK 0xF
+
+static int leds_value = 0;
+
+// Initializes the LEDs (all off).
+int leds_init(bool printFailedStatusFlag)
+{
+    (void) printFailedStatusFlag;
+    leds_value = 0;
+    return 0;
+}
+
+// Remembers the value written to the LEDs.
+void leds_write(int value)
+{
+    leds_value = value & LEDS_MASK;
+}
+
+// Returns the last value written to the LEDs.
+int leds_read()
+{
+    return leds_value;
+}
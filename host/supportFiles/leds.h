@@ -0,0 +1,21 @@
+/**********************************************************************************/
+/* File: leds.h                                                                   */
+/* Purpose: Host stand-in for supportFiles/leds.h. The last value written is kept */
+/*          so host tools can observe it.                                         */
+/**********************************************************************************/
+#ifndef LEDS_H_
+#define LEDS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Initializes the LEDs. printFailedStatusFlag is ignored on the host.
+int leds_init(bool printFailedStatusFlag);
+
+// Writes the lower four bits of value to LD0-LD3.
+void leds_write(int value);
+
+// Host only: returns the last value written with leds_write().
+int leds_read();
+
+#endif /* LEDS_H_ */
@@ -0,0 +1,45 @@
+/**********************************************************************************/
+/* File: mio.c                                                                    */
+/* Purpose: Host stand-in for supportFiles/mio.c.                                 */
+/**********************************************************************************/
+#include "mio.h"
+
+static uint8_t mio_pinLevel[MIO_PIN_COUNT];
+
+// Clears all of the pin levels.
+int mio_init(bool printFailedStatusFlag)
+{
+    (void) printFailedStatusFlag;
+    for (uint8_t i = 0; i < MIO_PIN_COUNT; i++)
+    {
+        mio_pinLevel[i] = 0;
+    }
+    return 0;
+}
+
+// Pin direction is not modelled on the host.
+void mio_setPinAsInput(uint8_t pinNumber)
+{
+    (void) pinNumber;
+}
+
+// Pin direction is not modelled on the host.
+void mio_setPinAsOutput(uint8_t pinNumber)
+{
+    (void) pinNumber;
+}
+
+// Stores the level of the pin.
+void mio_writePin(uint8_t pinNumber, uint8_t value)
+{
+    if (pinNumber < MIO_PIN_COUNT)
+    {
+        mio_pinLevel[pinNumber] = value ? 1 : 0;
+    }
+}
+
+// Returns the stored level of the pin.
+uint8_t mio_readPin(uint8_t pinNumber)
+{
+    return (pinNumber < MIO_PIN_COUNT) ? mio_pinLevel[pinNumber] : 0;
+}
@@ -0,0 +1,25 @@
+/**********************************************************************************/
+/* File: mio.h                                                                    */
+/* Purpose: Host stand-in for supportFiles/mio.h. Pin levels are held in memory   */
+/*          so host tools can drive inputs and observe outputs.                   */
+/**********************************************************************************/
+#ifndef MIO_H_
+#define MIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MIO_PIN_COUNT 54
+
+// Initializes the MIO pins. printFailedStatusFlag is ignored on the host.
+int mio_init(bool printFailedStatusFlag);
+
+// Configures the direction of a pin.
+void mio_setPinAsInput(uint8_t pinNumber);
+void mio_setPinAsOutput(uint8_t pinNumber);
+
+// Writes/reads the level of a pin.
+void mio_writePin(uint8_t pinNumber, uint8_t value);
+uint8_t mio_readPin(uint8_t pinNumber);
+
+#endif /* MIO_H_ */
@@ -0,0 +1,18 @@
+/**********************************************************************************/
+/* File: utils.c                                                                  */
+/* Purpose: Host stand-in for supportFiles/utils.c.                               */
+/**********************************************************************************/
+#include <time.h>
+#include "utils.h"
+
+#define UTILS_MS_PER_SECOND 1000
+#define UTILS_NS_PER_MS 1000000
+
+// Sleeps for the given number of milliseconds.
+void utils_msDelay(uint32_t milliseconds)
+{
+    struct timespec delay;
+    delay.tv_sec = milliseconds / UTILS_MS_PER_SECOND;
+    delay.tv_nsec = (long) (milliseconds % UTILS_MS_PER_SECOND) * UTILS_NS_PER_MS;
+    nanosleep(&delay, NULL);
+}
@@ -0,0 +1,13 @@
+/**********************************************************************************/
+/* File: utils.h                                                                  */
+/* Purpose: Host stand-in for supportFiles/utils.h.                               */
+/**********************************************************************************/
+#ifndef UTILS_H_
+#define UTILS_H_
+
+#include <stdint.h>
+
+// Busy-waits (sleeps on the host) for the given number of milliseconds.
+void utils_msDelay(uint32_t milliseconds);
+
+#endif /* UTILS_H_ */
@@ -0,0 +1,343 @@
+/**********************************************************************************/
+/* File: telemetryMain.c                                                          */
+/* Purpose: Host receiver and loopback check for the telemetry link               */
+/*          (Milestone3/telemetry.c). Listens on the telemetry socket and decodes */
+/*          frames. In loopback mode it also plays a synthesized capture through  */
+/*          the ISR and detector() and checks every decoded power vector against  */
+/*          what the detector computed.                                           */
+/*          See the build notes below the banner.                                 */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -DTELEMETRY_ENABLED -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/telemetryMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/telemetry.c Milestone3/capture.c
+//       Milestone3/detector.c Milestone3/filter.c Milestone3/isr.c Milestone3/sort.c
+//       Milestone3/lockoutTimer.c Milestone3/hitLedTimer.c Milestone3/timerWheel.c
+//       Milestone3/transmitter.c Milestone3/trigger.c Milestone3/profiler.c
+//       Milestone3/cycleCounter.c Milestone3/multiSensor.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o telemetry
+//
+// Usage:
+//   telemetry --listen                          print the frames of whoever connects
+//   telemetry [--seconds n] [--divider n]       loopback check
+//
+// A small --divider asks for more frames than the socket drains between detector() calls,
+// which exercises the rate backoff and the drop counters.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "capture.h"
+#include "detector.h"
+#include "filter.h"
+#include "isr.h"
+#include "lockoutTimer.h"
+#include "hitLedTimer.h"
+#include "telemetry.h"
+#include "supportFiles/interrupts.h"
+
+#define TELEMETRY_MAIN_DEFAULT_SECONDS 10
+#define TELEMETRY_MAIN_SHOT_SPACING 70000       // A shot every 0.7 seconds.
+#define TELEMETRY_MAIN_AMPLITUDE 1000
+#define TELEMETRY_MAIN_SEED 1
+#define TELEMETRY_MAIN_READ_SIZE 4096
+
+// Exit codes.
+#define TELEMETRY_MAIN_OK 0
+#define TELEMETRY_MAIN_MISMATCH 1
+#define TELEMETRY_MAIN_ERROR 2
+
+// Receiver state: the frame being assembled and what has been decoded.
+typedef struct {
+    uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+    uint32_t frameSize;
+    int16_t codes[FILTER_NUMBER_OF_PLAYERS];
+    bool haveBase;                  // A keyframe has been received since the last gap.
+    bool first;
+    uint8_t nextSequence;
+    uint32_t frames;
+    uint32_t keyframes;
+    uint32_t hits;
+    uint32_t crcErrors;
+    uint32_t sequenceGaps;
+    uint32_t mismatches;            // Loopback only: decoded codes that differ from the detector's.
+    bool print;
+} receiver_t;
+
+// Loopback: the codes the detector produced for every decimated sample.
+static int16_t* expectedCodes = NULL;
+static uint32_t expectedSteps = 0;
+
+/**********************************************************************************/
+/* Function: decodeFrame                                                          */
+/* Purpose: Checks and decodes one complete frame.                                */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void decodeFrame(receiver_t* receiver)
+{
+    const uint8_t* frame = receiver->frame;
+    uint32_t payloadEnd = receiver->frameSize - TELEMETRY_CRC_SIZE;
+    uint16_t crc = (uint16_t) (frame[payloadEnd] | (frame[payloadEnd + 1] << 8));
+    if (telemetry_crc16(TELEMETRY_CRC_INITIAL_VALUE, &frame[2], payloadEnd - 2) != crc)
+    {
+        receiver->crcErrors++;
+        receiver->haveBase = false;
+        return;
+    }
+    uint8_t sequence = frame[3];
+    uint8_t flags = frame[4];
+    uint32_t step = (uint32_t) frame[5] | ((uint32_t) frame[6] << 8) | ((uint32_t) frame[7] << 16) | ((uint32_t) frame[8] << 24);
+    if (!receiver->first && sequence != receiver->nextSequence)
+    {
+        receiver->sequenceGaps++;
+    }
+    receiver->first = false;
+    receiver->nextSequence = (uint8_t) (sequence + 1);
+    receiver->frames++;
+
+    uint32_t offset = TELEMETRY_HEADER_SIZE;
+    if (flags & TELEMETRY_FLAG_KEYFRAME)
+    {
+        receiver->keyframes++;
+        for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++, offset += 2)
+        {
+            receiver->codes[p] = (int16_t) (frame[offset] | (frame[offset + 1] << 8));
+        }
+        receiver->haveBase = true;
+    }
+    else
+    {
+        for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+        {
+            uint32_t zigzag = 0;
+            for (uint8_t shift = 0; offset < payloadEnd; shift += 7)
+            {
+                uint8_t byte = frame[offset++];
+                zigzag |= (uint32_t) (byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                {
+                    break;
+                }
+            }
+            int32_t delta = (int32_t) (zigzag >> 1) ^ -(int32_t) (zigzag & 1);
+            receiver->codes[p] = (int16_t) (receiver->codes[p] + delta);
+        }
+    }
+    if (flags & TELEMETRY_FLAG_HIT)
+    {
+        receiver->hits++;
+    }
+    if (!receiver->haveBase)
+    {
+        return;
+    }
+    if (expectedCodes != NULL && step < expectedSteps &&
+        memcmp(receiver->codes, &expectedCodes[(size_t) step * FILTER_NUMBER_OF_PLAYERS], sizeof(receiver->codes)) != 0)
+    {
+        receiver->mismatches++;
+    }
+    if (receiver->print)
+    {
+        printf("%u\t%c", step, (flags & TELEMETRY_FLAG_KEYFRAME) ? 'K' : ' ');
+        if (flags & TELEMETRY_FLAG_HIT)
+            printf(" hit %d", flags & TELEMETRY_FLAG_HIT_PLAYER_MASK);
+        for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+        {
+            printf("\t%.3g", telemetry_decodePower(receiver->codes[p]));
+        }
+        printf("\n");
+    }
+}
+
+/**********************************************************************************/
+/* Function: receiveBytes                                                         */
+/* Purpose: Finds frames in the byte stream (resynchronizing on the sync bytes)  */
+/*          and decodes them.                                                     */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void receiveBytes(receiver_t* receiver, const uint8_t bytes[], uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t byte = bytes[i];
+        if ((receiver->frameSize == 0 && byte != TELEMETRY_SYNC_0) || (receiver->frameSize == 1 && byte != TELEMETRY_SYNC_1))
+        {
+            receiver->frameSize = 0;
+            continue;
+        }
+        receiver->frame[receiver->frameSize++] = byte;
+        if (receiver->frameSize == 3 && byte + 3 + TELEMETRY_CRC_SIZE > TELEMETRY_MAX_FRAME_SIZE)
+        {
+            receiver->frameSize = 0;
+            continue;
+        }
+        if (receiver->frameSize > 3 && receiver->frameSize == (uint32_t) receiver->frame[2] + 3 + TELEMETRY_CRC_SIZE)
+        {
+            decodeFrame(receiver);
+            receiver->frameSize = 0;
+        }
+    }
+}
+
+/**********************************************************************************/
+/* Function: listenSocket                                                         */
+/* Purpose: Creates the socket telemetry_init() connects to.                      */
+/* Returns: The listening socket, or -1.                                          */
+/**********************************************************************************/
+static int listenSocket()
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, TELEMETRY_HOST_SOCKET_PATH, sizeof(address.sun_path) - 1);
+    unlink(TELEMETRY_HOST_SOCKET_PATH);
+    if (fd < 0 || bind(fd, (struct sockaddr*) &address, sizeof(address)) < 0 || listen(fd, 1) < 0)
+    {
+        perror(TELEMETRY_HOST_SOCKET_PATH);
+        return -1;
+    }
+    return fd;
+}
+
+/**********************************************************************************/
+/* Function: receiverThread                                                       */
+/* Purpose: Accepts one connection and decodes it until it closes.                */
+/* Returns: NULL                                                                  */
+/**********************************************************************************/
+static void* receiverThread(void* argument)
+{
+    receiver_t* receiver = (receiver_t*) argument;
+    int listener = listenSocket();
+    if (listener < 0)
+    {
+        return NULL;
+    }
+    int connection = accept(listener, NULL, NULL);
+    uint8_t bytes[TELEMETRY_MAIN_READ_SIZE];
+    ssize_t count;
+    while ((count = read(connection, bytes, sizeof(bytes))) > 0)
+    {
+        receiveBytes(receiver, bytes, (uint32_t) count);
+    }
+    close(connection);
+    close(listener);
+    unlink(TELEMETRY_HOST_SOCKET_PATH);
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    static receiver_t receiver;
+    receiver.first = true;
+    uint32_t seconds = TELEMETRY_MAIN_DEFAULT_SECONDS;
+    uint32_t divider = TELEMETRY_DEFAULT_STEP_DIVIDER;
+    bool listenOnly = false;
+
+    // Parse the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--listen"))
+            listenOnly = true;
+        else if (!strcmp(argv[i], "--seconds") && hasValue)
+            seconds = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--divider") && hasValue)
+            divider = (uint32_t) atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s --listen | [--seconds n] [--divider n]\n", argv[0]);
+            return TELEMETRY_MAIN_ERROR;
+        }
+    }
+    if (listenOnly)
+    {
+        receiver.print = true;
+        receiverThread(&receiver);
+        return TELEMETRY_MAIN_OK;
+    }
+
+    // Start listening before telemetry_init() connects.
+    pthread_t receiving;
+    pthread_create(&receiving, NULL, receiverThread, &receiver);
+    while (access(TELEMETRY_HOST_SOCKET_PATH, F_OK) != 0)
+    {
+        usleep(1000);
+    }
+    usleep(10000);
+
+    uint32_t sampleCount = seconds * CAPTURE_SAMPLE_RATE_HZ;
+    uint16_t* samples = (uint16_t*) malloc(sampleCount * sizeof(uint16_t));
+    capture_synthesizeShots(samples, sampleCount, TELEMETRY_MAIN_SHOT_SPACING, TELEMETRY_MAIN_AMPLITUDE, TELEMETRY_MAIN_SEED);
+    expectedSteps = sampleCount / FILTER_FIR_DECIMATION_FACTOR;
+    expectedCodes = (int16_t*) malloc((size_t) expectedSteps * FILTER_NUMBER_OF_PLAYERS * sizeof(int16_t));
+
+    // The live path: the ISR fills the ADC buffer and detector() drains it, one sample at a time.
+    filter_init();
+    detector_init();
+    isr_init();
+    lockoutTimer_init();
+    hitLedTimer_init();
+    telemetry_init();
+    telemetry_setStepDivider(divider);
+    interrupts_initAll(true);
+    interrupts_enableTimerGlobalInts();
+    interrupts_startArmPrivateTimer();
+    interrupts_enableArmInts();
+    uint32_t step = 0;
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        interrupts_setAdcData(samples[i]);
+        interrupts_simulateTick();
+        detector(false, false);
+        if ((i + 1) % FILTER_FIR_DECIMATION_FACTOR == 0)
+        {
+            double power[FILTER_NUMBER_OF_PLAYERS];
+            filter_getCurrentPowerValues(power);
+            for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+            {
+                expectedCodes[(size_t) step * FILTER_NUMBER_OF_PLAYERS + p] = telemetry_encodePower(power[p]);
+            }
+            step++;
+        }
+        telemetry_service();
+    }
+    while (telemetry_service() > 0)
+    {
+    }
+    free(samples);
+
+    // Closing our end lets the receiver finish.
+    telemetry_stats_t stats;
+    telemetry_getStats(&stats);
+    telemetry_close();
+    pthread_join(receiving, NULL);
+
+    detector_hitCount_t hitCounts[FILTER_NUMBER_OF_PLAYERS];
+    detector_getHitCounts(hitCounts);
+    uint32_t detectorHits = 0;
+    for (uint16_t p = 0; p < FILTER_NUMBER_OF_PLAYERS; p++)
+    {
+        detectorHits += hitCounts[p];
+    }
+    telemetry_dump(stdout);
+    printf("received %u frames (%u keyframes, %u hits), %u CRC errors, %u sequence gaps, %u mismatched vectors; detector found %u hits\n",
+           receiver.frames, receiver.keyframes, receiver.hits, receiver.crcErrors, receiver.sequenceGaps, receiver.mismatches, detectorHits);
+    free(expectedCodes);
+
+    // Every queued frame must arrive intact and decode to what the detector computed; a gap is
+    // only allowed where a frame was dropped.
+    if (receiver.frames != stats.framesQueued || receiver.crcErrors != 0 || receiver.mismatches != 0 ||
+        receiver.sequenceGaps > stats.framesDropped || (stats.framesDropped == 0 && receiver.hits != detectorHits))
+    {
+        printf("telemetry stream does not match the detector\n");
+        return TELEMETRY_MAIN_MISMATCH;
+    }
+    return TELEMETRY_MAIN_OK;
+}
@@ -0,0 +1,308 @@
+/**********************************************************************************/
+/* File: timerWheelMain.c                                                         */
+/* Purpose: Host check for the timer wheel (Milestone3/timerWheel.c). Schedules,  */
+/*          reschedules and cancels timers at random against a reference that     */
+/*          knows when each one is due, has threads post requests while the main  */
+/*          thread ticks, and measures the cost of a tick.                        */
+/*          See the build notes below the banner.                                 */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -IMilestone3
+//       host/timerWheelMain.c Milestone3/timerWheel.c Milestone3/cycleCounter.c
+//       -o timerWheel
+//
+// Usage:
+//   timerWheel [--timers n] [--ticks n] [--seed n]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "cycleCounter.h"
+#include "timerWheel.h"
+
+#define TIMER_WHEEL_MAIN_DEFAULT_TIMERS 1000
+#define TIMER_WHEEL_MAIN_DEFAULT_TICKS 20000000     // Longer than TIMER_WHEEL_MAX_DELAY.
+#define TIMER_WHEEL_MAIN_OPERATIONS_PER_TICK 0.05   // Average random operations per tick.
+#define TIMER_WHEEL_MAIN_POSTER_THREADS 3
+#define TIMER_WHEEL_MAIN_POSTER_TIMERS 8            // Per thread.
+#define TIMER_WHEEL_MAIN_POSTER_TICKS 2000000
+#define TIMER_WHEEL_MAIN_YIELD_TICKS 1000           // Let the posting threads run on a single core.
+#define TIMER_WHEEL_MAIN_COST_TICKS 1000000
+#define TIMER_WHEEL_MAIN_COST_PENDING 1000          // Far-off timers during the loaded measurement.
+#define TIMER_WHEEL_MAIN_NOT_DUE UINT64_MAX
+
+// Exit codes.
+#define TIMER_WHEEL_MAIN_OK 0
+#define TIMER_WHEEL_MAIN_MISMATCH 1
+#define TIMER_WHEEL_MAIN_ERROR 2
+
+// Reference state of one timer of the random test.
+typedef struct {
+    timerWheel_timer_t timer;
+    uint64_t due;           // Tick the timer must fire on, or TIMER_WHEEL_MAIN_NOT_DUE.
+    uint32_t period;        // Non-zero: the callback reschedules the timer this far ahead.
+} checkedTimer_t;
+
+static checkedTimer_t* checkedTimers;
+static uint64_t currentTick = 0;    // Ticks run, without the 32-bit wrap.
+static uint32_t fired = 0;
+static uint32_t errors = 0;
+
+// One timer of a posting thread.
+typedef struct {
+    timerWheel_timer_t timer;
+    uint32_t firedAt;       // Written by the callback.
+    bool done;
+} postedTimer_t;
+
+static postedTimer_t postedTimers[TIMER_WHEEL_MAIN_POSTER_THREADS][TIMER_WHEEL_MAIN_POSTER_TIMERS];
+static uint32_t postedErrors = 0;
+static uint32_t postedFired = 0;
+static bool tickingDone = false;
+
+/**********************************************************************************/
+/* Function: randomDelay                                                          */
+/* Purpose: Picks a delay that lands on any level of the wheel, now and then one  */
+/*          past its range.                                                       */
+/* Returns: The delay in ticks (at least 1).                                      */
+/**********************************************************************************/
+static uint32_t randomDelay()
+{
+    uint32_t level = rand() % (TIMER_WHEEL_LEVELS + 1);
+    uint32_t range = (level == TIMER_WHEEL_LEVELS) ? TIMER_WHEEL_MAX_DELAY + TIMER_WHEEL_MAX_DELAY / 4
+                                                   : 1u << (TIMER_WHEEL_SLOT_BITS * (level + 1));
+    return 1 + (uint32_t) (((uint64_t) rand() * RAND_MAX + rand()) % range);
+}
+
+/**********************************************************************************/
+/* Function: checkedCallback                                                      */
+/* Purpose: Checks that the timer fired on the tick the reference expects and    */
+/*          reschedules periodic timers.                                          */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void checkedCallback(timerWheel_timer_t* timer)
+{
+    checkedTimer_t* checked = (checkedTimer_t*) timer->user;
+    if (checked->due != currentTick)
+    {
+        if (errors++ < 10)
+            printf("timer %ld fired on tick %llu, due %llu\n", (long) (checked - checkedTimers),
+                   (unsigned long long) currentTick, (unsigned long long) checked->due);
+    }
+    fired++;
+    checked->due = TIMER_WHEEL_MAIN_NOT_DUE;
+    if (checked->period != 0)
+    {
+        timerWheel_scheduleFromIsr(timer, checked->period);
+        checked->due = currentTick + checked->period;
+    }
+}
+
+/**********************************************************************************/
+/* Function: postedCallback                                                       */
+/* Purpose: Records when a posting thread's timer fired.                          */
+/* Returns: VOID                                                                  */
+/**********************************************************************************/
+static void postedCallback(timerWheel_timer_t* timer)
+{
+    postedTimer_t* posted = (postedTimer_t*) timer->user;
+    posted->firedAt = timerWheel_now();
+    __atomic_store_n(&posted->done, true, __ATOMIC_RELEASE);
+}
+
+/**********************************************************************************/
+/* Function: posterThread                                                         */
+/* Purpose: Keeps its timers scheduled with timerWheel_schedule(), posting again  */
+/*          as each fires, and checks none fires earlier than asked.              */
+/* Returns: NULL                                                                  */
+/**********************************************************************************/
+static void* posterThread(void* argument)
+{
+    postedTimer_t* timers = (postedTimer_t*) argument;
+    uint32_t earliest[TIMER_WHEEL_MAIN_POSTER_TIMERS];
+    bool armed[TIMER_WHEEL_MAIN_POSTER_TIMERS] = {false};
+    uint32_t seed = (uint32_t) (timers - postedTimers[0]);
+    while (!__atomic_load_n(&tickingDone, __ATOMIC_ACQUIRE))
+    {
+        for (uint32_t i = 0; i < TIMER_WHEEL_MAIN_POSTER_TIMERS; i++)
+        {
+            postedTimer_t* posted = &timers[i];
+            if (armed[i] && !__atomic_load_n(&posted->done, __ATOMIC_ACQUIRE))
+            {
+                continue;
+            }
+            if (armed[i])
+            {
+                if ((int32_t) (posted->firedAt - earliest[i]) < 0)
+                    __atomic_fetch_add(&postedErrors, 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&postedFired, 1, __ATOMIC_RELAXED);
+            }
+            seed = seed * 1103515245 + 12345;
+            uint32_t delay = 1 + (seed >> 16) % 200;
+            __atomic_store_n(&posted->done, false, __ATOMIC_RELAXED);
+            earliest[i] = timerWheel_now() + delay;
+            armed[i] = true;
+            timerWheel_schedule(&posted->timer, delay);
+        }
+    }
+    return NULL;
+}
+
+/**********************************************************************************/
+/* Function: nsPerTick                                                            */
+/* Purpose: Times TIMER_WHEEL_MAIN_COST_TICKS calls of timerWheel_tick().         */
+/* Returns: Nanoseconds per tick.                                                 */
+/**********************************************************************************/
+static double nsPerTick()
+{
+    cycleCounter_cycles_t start = cycleCounter_read();
+    for (uint32_t i = 0; i < TIMER_WHEEL_MAIN_COST_TICKS; i++)
+    {
+        timerWheel_tick();
+    }
+    cycleCounter_cycles_t cycles = (cycleCounter_cycles_t) (cycleCounter_read() - start);
+    return cycles / cycleCounter_getCyclesPerMicrosecond() * 1000.0 / TIMER_WHEEL_MAIN_COST_TICKS;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t timerCount = TIMER_WHEEL_MAIN_DEFAULT_TIMERS;
+    uint32_t ticks = TIMER_WHEEL_MAIN_DEFAULT_TICKS;
+    uint32_t seed = 1;
+
+    // Parse the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if (!strcmp(argv[i], "--timers") && hasValue)
+            timerCount = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--ticks") && hasValue)
+            ticks = (uint32_t) atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && hasValue)
+            seed = (uint32_t) atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--timers n] [--ticks n] [--seed n]\n", argv[0]);
+            return TIMER_WHEEL_MAIN_ERROR;
+        }
+    }
+    if (timerCount < 1)
+    {
+        fprintf(stderr, "need at least one timer\n");
+        return TIMER_WHEEL_MAIN_ERROR;
+    }
+    srand(seed);
+    cycleCounter_init();
+
+    // Cost of a tick with nothing due, with the wheel empty and with far-off timers pending.
+    double emptyNs = nsPerTick();
+    static timerWheel_timer_t farTimers[TIMER_WHEEL_MAIN_COST_PENDING];
+    for (uint32_t i = 0; i < TIMER_WHEEL_MAIN_COST_PENDING; i++)
+    {
+        timerWheel_initTimer(&farTimers[i], NULL, NULL);
+        timerWheel_scheduleFromIsr(&farTimers[i], TIMER_WHEEL_MAX_DELAY);
+    }
+    double loadedNs = nsPerTick();
+    for (uint32_t i = 0; i < TIMER_WHEEL_MAIN_COST_PENDING; i++)
+    {
+        timerWheel_cancelFromIsr(&farTimers[i]);
+    }
+    printf("tick: %.2f ns empty, %.2f ns with %d timers pending\n", emptyNs, loadedNs, TIMER_WHEEL_MAIN_COST_PENDING);
+
+    // Random test. Operations act at once (the *FromIsr() calls) or at the next tick (requests).
+    checkedTimers = (checkedTimer_t*) calloc(timerCount, sizeof(checkedTimer_t));
+    if (checkedTimers == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return TIMER_WHEEL_MAIN_ERROR;
+    }
+    for (uint32_t i = 0; i < timerCount; i++)
+    {
+        timerWheel_initTimer(&checkedTimers[i].timer, checkedCallback, &checkedTimers[i]);
+        checkedTimers[i].due = TIMER_WHEEL_MAIN_NOT_DUE;
+    }
+    uint32_t operationThreshold = (uint32_t) (RAND_MAX * TIMER_WHEEL_MAIN_OPERATIONS_PER_TICK);
+    uint32_t operations = 0;
+    currentTick = timerWheel_now();
+    for (uint32_t tick = 0; tick < ticks; tick++)
+    {
+        while ((uint32_t) rand() < operationThreshold)
+        {
+            checkedTimer_t* checked = &checkedTimers[rand() % timerCount];
+            uint32_t delay = randomDelay();
+            switch (rand() % 5)
+            {
+                case 0:
+                    timerWheel_cancelFromIsr(&checked->timer);
+                    checked->due = TIMER_WHEEL_MAIN_NOT_DUE;
+                    checked->period = 0;
+                    break;
+                case 1:
+                    timerWheel_cancel(&checked->timer);
+                    checked->due = TIMER_WHEEL_MAIN_NOT_DUE;
+                    checked->period = 0;
+                    break;
+                case 2:
+                    timerWheel_schedule(&checked->timer, delay);
+                    checked->due = currentTick + delay;
+                    checked->period = 0;
+                    break;
+                case 3:
+                    // A short periodic timer, like the transmitter's edges.
+                    delay = 1 + delay % 100;
+                    timerWheel_scheduleFromIsr(&checked->timer, delay);
+                    checked->due = currentTick + delay;
+                    checked->period = delay;
+                    break;
+                default:
+                    timerWheel_scheduleFromIsr(&checked->timer, delay);
+                    checked->due = currentTick + delay;
+                    checked->period = 0;
+                    break;
+            }
+            operations++;
+        }
+        timerWheel_tick();
+        currentTick++;
+    }
+    // Timers due before the end must have fired.
+    for (uint32_t i = 0; i < timerCount; i++)
+    {
+        if (checkedTimers[i].due < currentTick)
+        {
+            if (errors++ < 10)
+                printf("timer %u due on tick %llu never fired\n", i, (unsigned long long) checkedTimers[i].due);
+        }
+        timerWheel_cancelFromIsr(&checkedTimers[i].timer);
+    }
+    printf("random: %u operations over %u ticks, %u timers fired, %u errors\n", operations, ticks, fired, errors);
+
+    // Requests posted by other threads while this one ticks.
+    pthread_t threads[TIMER_WHEEL_MAIN_POSTER_THREADS];
+    for (uint32_t t = 0; t < TIMER_WHEEL_MAIN_POSTER_THREADS; t++)
+    {
+        for (uint32_t i = 0; i < TIMER_WHEEL_MAIN_POSTER_TIMERS; i++)
+        {
+            timerWheel_initTimer(&postedTimers[t][i].timer, postedCallback, &postedTimers[t][i]);
+        }
+        pthread_create(&threads[t], NULL, posterThread, postedTimers[t]);
+    }
+    for (uint32_t tick = 0; tick < TIMER_WHEEL_MAIN_POSTER_TICKS; tick++)
+    {
+        timerWheel_tick();
+        if (tick % TIMER_WHEEL_MAIN_YIELD_TICKS == 0)
+            sched_yield();
+    }
+    __atomic_store_n(&tickingDone, true, __ATOMIC_RELEASE);
+    for (uint32_t t = 0; t < TIMER_WHEEL_MAIN_POSTER_THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    printf("posted: %d threads, %u timers fired, %u fired early\n", TIMER_WHEEL_MAIN_POSTER_THREADS, postedFired, postedErrors);
+
+    free(checkedTimers);
+    return (errors == 0 && postedErrors == 0) ? TIMER_WHEEL_MAIN_OK : TIMER_WHEEL_MAIN_MISMATCH;
+}
@@ -0,0 +1,176 @@
+/**********************************************************************************/
+/* File: transmitterMain.c                                                        */
+/* Purpose: Host check for the phase-accumulator transmitter                      */
+/*          (Milestone3/transmitter.c). Runs pulses at table, fractional and      */
+/*          out-of-table frequencies, with and without burst codes, and checks    */
+/*          the pin tick by tick against an accumulator that adds every tick.     */
+/*          See the build notes below the banner.                                 */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/transmitterMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/transmitter.c Milestone3/timerWheel.c Milestone3/filter.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o transmitter
+//
+// Usage:
+//   transmitter
+
+#include <stdio.h>
+#include "filter.h"
+#include "timerWheel.h"
+#include "transmitter.h"
+#include "supportFiles/mio.h"
+
+#define TRANSMITTER_MAIN_DDS_INDEX_SHIFT (32 - TRANSMITTER_DDS_LUT_BITS)
+#define TRANSMITTER_MAIN_HALF_TABLE (1 << (TRANSMITTER_DDS_LUT_BITS - 1))
+#define TRANSMITTER_MAIN_TAIL_TICKS 100     // Ticks checked after the pulse (the pin must stay low).
+#define TRANSMITTER_MAIN_CONTINUOUS_PULSES 3
+
+// Exit codes.
+#define TRANSMITTER_MAIN_OK 0
+#define TRANSMITTER_MAIN_MISMATCH 1
+
+// One checked pulse.
+typedef struct {
+    const char* name;
+    double frequencyHz;     // <= 0: use frequency number 'player'.
+    uint16_t player;
+    uint32_t code;
+    uint8_t bits;
+    uint32_t chipTicks;
+} pulse_t;
+
+// The isr would normally do this; the pulses are run by ticking the wheel directly.
+void isr_function()
+{
+}
+
+/**********************************************************************************/
+/* Function: expectedLevel                                                        */
+/* Purpose: The pin level k ticks into a pulse, from an accumulator that adds the */
+/*          increment every tick and a chip counter.                              */
+/* Returns: The expected pin level.                                               */
+/**********************************************************************************/
+static uint8_t expectedLevel(uint32_t increment, const pulse_t* pulse, uint32_t k)
+{
+    uint32_t phase = increment * k;
+    uint8_t level = ((phase >> TRANSMITTER_MAIN_DDS_INDEX_SHIFT) < TRANSMITTER_MAIN_HALF_TABLE) ? 1 : 0;
+    if (pulse->bits == TRANSMITTER_NO_BURST_CODE)
+        return level;
+    uint32_t chip = (k / pulse->chipTicks) % pulse->bits;
+    return level & ((pulse->code >> (pulse->bits - 1 - chip)) & 1);
+}
+
+/**********************************************************************************/
+/* Function: checkPulse                                                           */
+/* Purpose: Sends one pulse and compares the pin with the reference every tick.   */
+/* Returns: The number of ticks on which they differ.                             */
+/**********************************************************************************/
+static uint32_t checkPulse(const pulse_t* pulse)
+{
+    uint32_t increment;
+    if (pulse->frequencyHz > 0.0)
+    {
+        transmitter_setFrequencyHz(pulse->frequencyHz);
+        increment = transmitter_phaseIncrement(pulse->frequencyHz);
+    }
+    else
+    {
+        transmitter_setFrequencyNumber(pulse->player);
+        increment = transmitter_phaseIncrement(TRANSMITTER_TICK_RATE_HZ / filter_frequencyTickTable[pulse->player]);
+    }
+    transmitter_setBurstCode(pulse->code, pulse->bits, pulse->chipTicks);
+
+    // transmitter_run() is a request, so the pulse starts on the second tick after it.
+    uint32_t mismatches = 0, edges = 0;
+    uint8_t previous = 0;
+    transmitter_run();
+    timerWheel_tick();
+    for (uint32_t k = 0; k < TRANSMITTER_PULSE_WIDTH + TRANSMITTER_MAIN_TAIL_TICKS; k++)
+    {
+        timerWheel_tick();
+        uint8_t level = mio_readPin(TRANSMITTER_OUTPUT_PIN);
+        uint8_t expected = (k < TRANSMITTER_PULSE_WIDTH) ? expectedLevel(increment, pulse, k) : 0;
+        if (level != expected && mismatches++ < 5)
+            printf("  %s: tick %u of the pulse is %d, expected %d\n", pulse->name, k, level, expected);
+        edges += (level != previous);
+        previous = level;
+    }
+    if (transmitter_running())
+    {
+        printf("  %s: still running after the pulse\n", pulse->name);
+        mismatches++;
+    }
+    printf("%-28s %10.3f Hz  %5u edges  %u mismatched ticks\n", pulse->name,
+           increment / 4294967296.0 * TRANSMITTER_TICK_RATE_HZ, edges, mismatches);
+    return mismatches;
+}
+
+/**********************************************************************************/
+/* Function: checkContinuous                                                      */
+/* Purpose: Runs continuously, changing frequency mid-pulse, and checks the new   */
+/*          frequency is taken up on the tick after the request, with the phase   */
+/*          carried on.                                                           */
+/* Returns: The number of mismatched ticks.                                       */
+/**********************************************************************************/
+static uint32_t checkContinuous()
+{
+    uint32_t mismatches = 0;
+    uint32_t phase = 0;
+    transmitter_setBurstCode(0, TRANSMITTER_NO_BURST_CODE, 1);
+    transmitter_setFrequencyNumber(0);
+    uint32_t increment = transmitter_phaseIncrement(TRANSMITTER_TICK_RATE_HZ / filter_frequencyTickTable[0]);
+    transmitter_setContinuousMode(true);
+    transmitter_run();
+    timerWheel_tick();
+    for (uint32_t pulse = 0; pulse < TRANSMITTER_MAIN_CONTINUOUS_PULSES; pulse++)
+    {
+        uint32_t nextIncrement = transmitter_phaseIncrement(1234.5 + pulse * 100.0);
+        for (uint32_t k = 0; k < TRANSMITTER_PULSE_WIDTH; k++)
+        {
+            if (k == TRANSMITTER_PULSE_WIDTH / 2)
+                transmitter_setFrequencyHz(1234.5 + pulse * 100.0);
+            timerWheel_tick();
+            uint8_t expected = ((phase >> TRANSMITTER_MAIN_DDS_INDEX_SHIFT) < TRANSMITTER_MAIN_HALF_TABLE) ? 1 : 0;
+            if (mio_readPin(TRANSMITTER_OUTPUT_PIN) != expected && mismatches++ < 5)
+                printf("  continuous: pulse %u tick %u differs\n", pulse, k);
+            phase += increment;
+            // Requested before tick P/2, the retune runs on tick P/2 + 1 (still reached at the old rate).
+            if (k == TRANSMITTER_PULSE_WIDTH / 2)
+                increment = nextIncrement;
+        }
+    }
+    transmitter_setContinuousMode(false);
+    for (uint32_t k = 0; k < TRANSMITTER_PULSE_WIDTH; k++)
+    {
+        timerWheel_tick();
+    }
+    if (transmitter_running() || mio_readPin(TRANSMITTER_OUTPUT_PIN) != 0)
+        mismatches++;
+    printf("%-28s %u pulses, %u mismatched ticks\n", "continuous, retuned", TRANSMITTER_MAIN_CONTINUOUS_PULSES, mismatches);
+    return mismatches;
+}
+
+int main()
+{
+    static const pulse_t pulses[] = {
+        {"player 0", 0.0, 0, 0, TRANSMITTER_NO_BURST_CODE, 1},
+        {"player 9", 0.0, 9, 0, TRANSMITTER_NO_BURST_CODE, 1},
+        {"fractional 1471.3 Hz", 1471.3, 0, 0, TRANSMITTER_NO_BURST_CODE, 1},
+        {"extra player 4545.45 Hz", 4545.45, 0, 0, TRANSMITTER_NO_BURST_CODE, 1},
+        {"near limit 33333.3 Hz", 33333.3, 0, 0, TRANSMITTER_NO_BURST_CODE, 1},
+        {"player 3, code 10110010", 0.0, 3, 0xB2, 8, 1000},
+        {"player 5, code 101 fast", 0.0, 5, 0x5, 3, 37},
+    };
+
+    transmitter_init();
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < sizeof(pulses) / sizeof(pulses[0]); i++)
+    {
+        mismatches += checkPulse(&pulses[i]);
+    }
+    mismatches += checkContinuous();
+    return (mismatches == 0) ? TRANSMITTER_MAIN_OK : TRANSMITTER_MAIN_MISMATCH;
+}
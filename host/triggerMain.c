@@ -0,0 +1,136 @@
+/**********************************************************************************/
+/* File: triggerMain.c                                                            */
+/* Purpose: Host check for the edge-interrupt trigger (Milestone3/trigger.c with  */
+/*          TRIGGER_EDGE_INTERRUPTS_ENABLED). Plays bouncy presses and releases   */
+/*          through the simulated GPIO interrupt and checks when, and how often,  */
+/*          the transmitter fires. See the build notes below the banner.          */
+/**********************************************************************************/
+
+// Build (from the repository root):
+//   g++ -O2 -x c++ -pthread -DTRIGGER_EDGE_INTERRUPTS_ENABLED -Ihost -ICommon -IMilestone1 -ILab2 -ILab3 -IMilestone3
+//       host/triggerMain.c host/supportFiles/*.c Common/*.c
+//       Milestone3/trigger.c Milestone3/gpioEdge.c Milestone3/transmitter.c
+//       Milestone3/timerWheel.c Milestone3/filter.c
+//       Milestone1/queue.c Lab2/buttons.c Lab2/switches.c Lab3/intervalTimer.c
+//       -o trigger
+//
+// Usage:
+//   trigger
+
+#include <stdio.h>
+#include <time.h>
+#include "gpioEdge.h"
+#include "timerWheel.h"
+#include "transmitter.h"
+#include "trigger.h"
+
+#define TRIGGER_MAIN_GUN_PIN 10             // TRIGGER_GUN_TRIGGER_MIO_PIN in trigger.c.
+#define TRIGGER_MAIN_DEBOUNCE_TICKS 3000    // Pull and release debounce times in trigger.c.
+#define TRIGGER_MAIN_REQUEST_TICKS 2        // A request from outside the ISR lands within two ticks.
+#define TRIGGER_MAIN_SETTLE_TICKS 80000     // Ticks run after each gesture (past the fire hold).
+#define TRIGGER_MAIN_IDLE_TICKS 10000000
+
+// Exit codes.
+#define TRIGGER_MAIN_OK 0
+#define TRIGGER_MAIN_MISMATCH 1
+
+// One gesture: the pin is set to levels[i] offsets[i] ticks after the gesture starts.
+typedef struct {
+    const char* name;
+    uint8_t edgeCount;
+    uint32_t offsets[8];
+    uint8_t levels[8];
+    uint32_t expectedShots;
+    uint32_t firstShotOffset;   // Ticks after the gesture starts the first shot is due (if any).
+} gesture_t;
+
+// The isr would normally do this; the gestures are run by ticking the wheel directly.
+void isr_function()
+{
+}
+
+/**********************************************************************************/
+/* Function: playGesture                                                          */
+/* Purpose: Ticks the wheel through a gesture and the settling time after it,     */
+/*          counting transmitter pulses and noting when the first one started.    */
+/* Returns: The number of mismatches with the gesture's expectations.             */
+/**********************************************************************************/
+static uint32_t playGesture(const gesture_t* gesture)
+{
+    uint32_t shots = 0, firstShot = 0;
+    uint8_t edge = 0;
+    bool wasRunning = transmitter_running();
+    uint32_t lastOffset = gesture->offsets[gesture->edgeCount - 1];
+    for (uint32_t t = 0; t <= lastOffset + TRIGGER_MAIN_SETTLE_TICKS; t++)
+    {
+        while (edge < gesture->edgeCount && gesture->offsets[edge] == t)
+        {
+            gpioEdge_simulateLevel(TRIGGER_MAIN_GUN_PIN, gesture->levels[edge++]);
+        }
+        timerWheel_tick();
+        bool running = transmitter_running();
+        if (running && !wasRunning && shots++ == 0)
+            firstShot = t;
+        wasRunning = running;
+    }
+
+    uint32_t mismatches = 0;
+    if (shots != gesture->expectedShots)
+    {
+        printf("  %s: %u shots, expected %u\n", gesture->name, shots, gesture->expectedShots);
+        mismatches++;
+    }
+    if (shots > 0 && gesture->expectedShots > 0 &&
+        (firstShot < gesture->firstShotOffset || firstShot > gesture->firstShotOffset + TRIGGER_MAIN_REQUEST_TICKS))
+    {
+        printf("  %s: fired at tick %u, expected %u\n", gesture->name, firstShot, gesture->firstShotOffset);
+        mismatches++;
+    }
+    printf("%-34s %u shots", gesture->name, shots);
+    if (shots > 0)
+        printf(" (first at tick %u)", firstShot);
+    printf("\n");
+    return mismatches;
+}
+
+/**********************************************************************************/
+/* Function: idleTickNanoseconds                                                  */
+/* Purpose: Times wheel ticks with the trigger enabled and nobody pulling it.     */
+/* Returns: The average cost of a tick in nanoseconds.                            */
+/**********************************************************************************/
+static double idleTickNanoseconds()
+{
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t t = 0; t < TRIGGER_MAIN_IDLE_TICKS; t++)
+    {
+        timerWheel_tick();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    return ((stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec)) / TRIGGER_MAIN_IDLE_TICKS;
+}
+
+int main()
+{
+    const uint32_t debounce = TRIGGER_MAIN_DEBOUNCE_TICKS;
+    static const gesture_t gestures[] = {
+        {"clean press", 1, {0}, {1}, 1, debounce},
+        {"clean release", 1, {0}, {0}, 0, 0},
+        {"bouncy press", 5, {0, 200, 350, 750, 850}, {1, 0, 1, 0, 1}, 1, 850 + debounce},
+        {"bouncy release", 5, {0, 300, 400, 2900, 3100}, {0, 1, 0, 1, 0}, 0, 0},
+        {"glitch shorter than debounce", 2, {0, 1000}, {1, 0}, 0, 0},
+        {"re-press within the fire time", 3, {0, 10000, 20000}, {1, 0, 1}, 1, debounce},
+        {"release", 1, {0}, {0}, 0, 0},
+    };
+
+    transmitter_init();
+    trigger_init();
+    trigger_enable();
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < sizeof(gestures) / sizeof(gestures[0]); i++)
+    {
+        mismatches += playGesture(&gestures[i]);
+    }
+    printf("idle tick with the trigger enabled: %.1f ns\n", idleTickNanoseconds());
+    return (mismatches == 0) ? TRIGGER_MAIN_OK : TRIGGER_MAIN_MISMATCH;
+}
@@ -0,0 +1,27 @@
+/**********************************************************************************/
+/* File: xil_io.h                                                                 */
+/* Purpose: Host stand-in for the Xilinx register access functions. Reads return  */
+/*          zero (no buttons pressed, switches down, timers stopped) and writes   */
+/*          are dropped.                                                          */
+/**********************************************************************************/
+#ifndef XIL_IO_H_
+#define XIL_IO_H_
+
+#include <stdint.h>
+#include "xparameters.h"
+
+// Reads a 32-bit device register. Always 0 on the host.
+static inline uint32_t Xil_In32(uintptr_t addr)
+{
+    (void) addr;
+    return 0;
+}
+
+// Writes a 32-bit device register. Ignored on the host.
+static inline void Xil_Out32(uintptr_t addr, uint32_t value)
+{
+    (void) addr;
+    (void) value;
+}
+
+#endif /* XIL_IO_H_ */
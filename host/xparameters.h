@@ -0,0 +1,28 @@
+/**********************************************************************************/
+/* File: xparameters.h                                                            */
+/* Purpose: Host stand-in for the Xilinx generated xparameters.h. Only the        */
+/*          symbols referenced by the lab code are provided so that the board     */
+/*          independent modules (queue, filter, detector, ...) build on a PC.     */
+/**********************************************************************************/
+#ifndef XPARAMETERS_H_
+#define XPARAMETERS_H_
+
+// Processor clock of the Zybo Cortex-A9.
+#define XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ 650000000
+
+// AXI interval timers (Lab3).
+#define XPAR_AXI_TIMER_0_BASEADDR 0x42800000
+#define XPAR_AXI_TIMER_0_CLOCK_FREQ_HZ 100000000
+#define XPAR_AXI_TIMER_1_BASEADDR 0x42840000
+#define XPAR_AXI_TIMER_1_CLOCK_FREQ_HZ 100000000
+#define XPAR_AXI_TIMER_2_BASEADDR 0x42880000
+#define XPAR_AXI_TIMER_2_CLOCK_FREQ_HZ 100000000
+
+// AXI GPIO for the push buttons and slide switches (Lab2).
+#define XPAR_PUSH_BUTTONS_BASEADDR 0x41240000
+#define XPAR_SLIDE_SWITCHES_BASEADDR 0x41280000
+
+// AXI XADC (multi-sensor acquisition).
+#define XPAR_XADC_WIZ_0_BASEADDR 0x43C00000
+
+#endif /* XPARAMETERS_H_ */
@@ -0,0 +1,26 @@
+/**********************************************************************************/
+/* File: xtime_l.h                                                                */
+/* Purpose: Host stand-in for the Xilinx standalone xtime_l.h. On the board       */
+/*          XTime_GetTime() reads the 64-bit Cortex-A9 global timer; on the host  */
+/*          it reads the monotonic clock in nanoseconds.                          */
+/**********************************************************************************/
+#ifndef XTIME_L_H_
+#define XTIME_L_H_
+
+#include <stdint.h>
+#include <time.h>
+
+typedef uint64_t XTime;
+
+// Counts per second of XTime_GetTime() (nanoseconds on the host).
+#define COUNTS_PER_SECOND 1000000000ULL
+
+// Returns the current time.
+static inline void XTime_GetTime(XTime* xtime)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    *xtime = (XTime) now.tv_sec * COUNTS_PER_SECOND + (XTime) now.tv_nsec;
+}
+
+#endif /* XTIME_L_H_ */